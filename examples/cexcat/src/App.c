@@ -84,8 +84,8 @@ App__process_csv(App_c* app, io_c* file)
 
     struct csvcols
     {
-        u64 col_idx;    // dict key
-        char name[128]; // dict value
+        u64 col_idx; // dict key
+        str_c name;  // dict value (view into `contents`, no copy)
     };
 
     e$goto(sbuf.create(&rbuf, 1024, app->allocator), fail);
@@ -107,7 +107,7 @@ App__process_csv(App_c* app, io_c* file)
                 struct csvcols col_rec = { .col_idx = tok.idx.i };
                 var col = str.strip(*tok.val);
                 io.printf("%ld: '%S'\n", tok.idx.i, col);
-                e$goto(str.copy(col, col_rec.name, arr$len(col_rec.name)), fail);
+                col_rec.name = col;
                 e$goto(dict.set(&csvmap, &col_rec), fail);
             }
             continue;
@@ -133,7 +133,7 @@ App__process_csv(App_c* app, io_c* file)
                 goto fail;
             }
             var col = str.strip(*tok.val);
-            e$goto(sbuf.sprintf(&rbuf, "\"%s\": \"%S\", ", rec->name, col), fail);
+            e$goto(sbuf.sprintf(&rbuf, "\"%S\": \"%S\", ", rec->name, col), fail);
         }
         e$goto(sbuf.sprintf(&rbuf, "},\n"), fail);
     }
@@ -55,6 +55,8 @@ struct hashmap {
     uint8_t loadfactor;
     uint8_t growpower;
     bool oom;
+    size_t keyoffset;
+    bool readonly;
     void *buckets;
     void *spare;
     void *edata;
@@ -64,6 +66,13 @@ void hashmap_set_grow_by_power(struct hashmap *map, size_t power) {
     map->growpower = power < 1 ? 1 : power > 16 ? 16 : power;
 }
 
+// hashmap_set_key_offset sets offset of the key field inside the item.
+// NOTE: CEX addition, hash and compare functions always receive a pointer to
+// the key (i.e. item + keyoffset), for lookups the `key` pointer is passed as is.
+void hashmap_set_key_offset(struct hashmap *map, size_t keyoffset) {
+    map->keyoffset = keyoffset;
+}
+
 static double clamp_load_factor(double factor, double default_factor) {
     // Check for NaN and clamp between 50% and 90%
     return factor != factor ? default_factor : 
@@ -205,6 +214,7 @@ static void free_elements(struct hashmap *map) {
 // the currently number of allocated buckets. This is an optimization to ensure
 // that this operation does not perform any allocations.
 void hashmap_clear(struct hashmap *map, bool update_cap) {
+    if (map->readonly) return;
     map->count = 0;
     free_elements(map);
     if (update_cap) {
@@ -241,7 +251,8 @@ static bool resize0(struct hashmap *map, size_t new_cap) {
                 memcpy(bucket, entry, map->bucketsz);
                 break;
             }
-            if (bucket->dib < entry->dib) {
+            if (bucket->dib < entry->dib ||
+                (bucket->dib == entry->dib && bucket->hash > entry->hash)) {
                 memcpy(map2->spare, bucket, map->bucketsz);
                 memcpy(bucket, entry, map->bucketsz);
                 memcpy(entry, map2->spare, map->bucketsz);
@@ -272,6 +283,7 @@ const void *hashmap_set_with_hash(struct hashmap *map, const void *item,
 {
     hash = clip_hash(hash);
     map->oom = false;
+    if (map->readonly) return NULL;
     if (map->count >= map->growat) {
         if (!resize(map, map->nbuckets*(1<<map->growpower))) {
             map->oom = true;
@@ -296,7 +308,8 @@ const void *hashmap_set_with_hash(struct hashmap *map, const void *item,
         }
         bitem = bucket_item(bucket);
         if (entry->hash == bucket->hash && (!map->compare ||
-            map->compare(eitem, bitem, map->udata) == 0))
+            map->compare((char*)eitem+map->keyoffset,
+                         (char*)bitem+map->keyoffset, map->udata) == 0))
         {
             memcpy(map->spare, bitem, map->elsize);
             memcpy(bitem, eitem, map->elsize);
@@ -318,7 +331,168 @@ const void *hashmap_set_with_hash(struct hashmap *map, const void *item,
 // may allocate memory. If the system is unable to allocate additional
 // memory then NULL is returned and hashmap_oom() returns true.
 const void *hashmap_set(struct hashmap *map, const void *item) {
-    return hashmap_set_with_hash(map, item, get_hash(map, item));
+    return hashmap_set_with_hash(map, item, 
+        get_hash(map, (char*)item+map->keyoffset));
+}
+
+// hashmap_insert_with_hash works like hashmap_insert but you provide your
+// own hash. The 'hash' callback provided to the hashmap_new function
+// will not be called
+// NOTE: CEX addition, buckets with the same distance from home are ordered by
+// hash, so all items with equal keys always occupy a contiguous bucket run.
+bool hashmap_insert_with_hash(struct hashmap *map, const void *item,
+    uint64_t hash)
+{
+    hash = clip_hash(hash);
+    map->oom = false;
+    if (map->readonly) return false;
+    if (map->count >= map->growat) {
+        if (!resize(map, map->nbuckets*(1<<map->growpower))) {
+            map->oom = true;
+            return false;
+        }
+    }
+
+    struct bucket *entry = map->edata;
+    entry->hash = hash;
+    entry->dib = 1;
+    memcpy(bucket_item(entry), item, map->elsize);
+
+    size_t i = entry->hash & map->mask;
+    while(1) {
+        struct bucket *bucket = bucket_at(map, i);
+        if (bucket->dib == 0) {
+            memcpy(bucket, entry, map->bucketsz);
+            map->count++;
+            return true;
+        }
+        if (bucket->dib < entry->dib ||
+            (bucket->dib == entry->dib && bucket->hash > entry->hash)) {
+            memcpy(map->spare, bucket, map->bucketsz);
+            memcpy(bucket, entry, map->bucketsz);
+            memcpy(entry, map->spare, map->bucketsz);
+        }
+        i = (i + 1) & map->mask;
+        entry->dib += 1;
+    }
+}
+
+// hashmap_insert inserts an item into the hash map, items with equal keys are
+// kept (i.e. multimap semantics), use hashmap_iter_key() to get all of them.
+// Don't mix hashmap_insert() and hashmap_set() calls on the same map.
+// Returns false if the system is unable to allocate additional memory, and
+// hashmap_oom() returns true.
+bool hashmap_insert(struct hashmap *map, const void *item) {
+    return hashmap_insert_with_hash(map, item, 
+        get_hash(map, (char*)item+map->keyoffset));
+}
+
+// hashmap_iter_key iterates over all items which are equal to `key`.
+// Cursor `i` must be initialized to 0 at the beginning of the loop. The map
+// must not be modified during the iteration.
+// NOTE: CEX addition, equal keys are expected to be in a contiguous run of
+// buckets, (see hashmap_insert).
+bool hashmap_iter_key(struct hashmap *map, const void *key, size_t *i, 
+    void **item)
+{
+    uint64_t hash;
+    size_t j;
+    if (*i == 0) {
+        hash = get_hash(map, key);
+        j = hash & map->mask;
+        size_t dib = 1;
+        while(1) {
+            struct bucket *bucket = bucket_at(map, j);
+            if (bucket->dib < dib) return false;
+            if (bucket->hash == hash) break;
+            j = (j + 1) & map->mask;
+            dib++;
+        }
+    } else {
+        // cursor points to the next bucket after the last found item
+        hash = bucket_at(map, *i - 1)->hash;
+        j = *i & map->mask;
+    }
+    while(1) {
+        struct bucket *bucket = bucket_at(map, j);
+        if (!bucket->dib || bucket->hash != hash) return false;
+        void *bitem = bucket_item(bucket);
+        if (!map->compare || map->compare(key, 
+                (char*)bitem+map->keyoffset, map->udata) == 0) {
+            *i = j + 1;
+            *item = bitem;
+            return true;
+        }
+        j = (j + 1) & map->mask;
+    }
+}
+
+// hashmap_reserve grows the map capacity to fit at least `count` items
+// without extra resizing. Returns false if the system is unable to allocate
+// additional memory, and hashmap_oom() returns true.
+// NOTE: CEX addition
+bool hashmap_reserve(struct hashmap *map, size_t count) {
+    map->oom = false;
+    if (map->readonly) return false;
+    size_t ncap = map->nbuckets;
+    while ((size_t)(ncap * (map->loadfactor / 100.0)) <= count) {
+        ncap *= 2;
+    }
+    if (ncap == map->nbuckets) {
+        return true;
+    }
+    if (!resize(map, ncap)) {
+        map->oom = true;
+        return false;
+    }
+    return true;
+}
+
+// hashmap_attach_buckets replaces map buckets by an external bucket array
+// (e.g. mmapped file image of another map with the same elsize/seeds). The map
+// becomes read-only, all modifying operations are ignored, and external
+// buckets are not freed by hashmap_free(). Returns false if the buckets are not
+// a valid table for this map: stored hash of any item doesn't match (i.e.
+// different hash function or seeds, corrupted item), its distance from home
+// bucket is wrong, or number of occupied buckets is not count (there must be
+// at least one empty bucket, otherwise lookups never end). Validation hashes
+// every item, O(nbuckets).
+// NOTE: CEX addition
+bool hashmap_attach_buckets(struct hashmap *map, void *buckets, 
+    size_t nbuckets, size_t count)
+{
+    if (nbuckets == 0 || (nbuckets & (nbuckets-1)) != 0 || count >= nbuckets) {
+        return false;
+    }
+    size_t mask = nbuckets-1;
+    size_t noccupied = 0;
+    for (size_t i = 0; i < nbuckets; i++) {
+        struct bucket *bucket = bucket_at0(buckets, map->bucketsz, i);
+        if (!bucket->dib) continue;
+        uint64_t hash = get_hash(map, (char*)bucket_item(bucket)+map->keyoffset);
+        if (bucket->hash != hash) {
+            return false;
+        }
+        if (bucket->dib != ((i - (hash & mask)) & mask) + 1) {
+            return false;
+        }
+        noccupied++;
+    }
+    if (noccupied != count) {
+        return false;
+    }
+    if (!map->readonly) {
+        map->free(map->buckets);
+    }
+    map->readonly = true;
+    map->buckets = buckets;
+    map->nbuckets = nbuckets;
+    map->cap = nbuckets;
+    map->count = count;
+    map->mask = nbuckets-1;
+    map->growat = nbuckets;
+    map->shrinkat = 0;
+    return true;
 }
 
 // hashmap_get_with_hash works like hashmap_get but you provide your
@@ -334,7 +508,8 @@ const void *hashmap_get_with_hash(struct hashmap *map, const void *key,
         if (!bucket->dib) return NULL;
         if (bucket->hash == hash) {
             void *bitem = bucket_item(bucket);
-            if (!map->compare || map->compare(key, bitem, map->udata) == 0) {
+            if (!map->compare || map->compare(key, 
+                    (char*)bitem+map->keyoffset, map->udata) == 0) {
                 return bitem;
             }
         }
@@ -368,6 +543,7 @@ const void *hashmap_delete_with_hash(struct hashmap *map, const void *key,
 {
     hash = clip_hash(hash);
     map->oom = false;
+    if (map->readonly) return NULL;
     size_t i = hash & map->mask;
     while(1) {
         struct bucket *bucket = bucket_at(map, i);
@@ -376,7 +552,7 @@ const void *hashmap_delete_with_hash(struct hashmap *map, const void *key,
         }
         void *bitem = bucket_item(bucket);
         if (bucket->hash == hash && (!map->compare ||
-            map->compare(key, bitem, map->udata) == 0))
+            map->compare(key, (char*)bitem+map->keyoffset, map->udata) == 0))
         {
             memcpy(map->spare, bitem, map->elsize);
             bucket->dib = 0;
@@ -420,8 +596,10 @@ size_t hashmap_count(struct hashmap *map) {
 // if present, to free any data referenced in the elements of the hashmap.
 void hashmap_free(struct hashmap *map) {
     if (!map) return;
-    free_elements(map);
-    map->free(map->buckets);
+    if (!map->readonly) {
+        free_elements(map);
+        map->free(map->buckets);
+    }
     map->free(map);
 }
 
@@ -50,6 +50,12 @@ const void *hashmap_delete_with_hash(struct hashmap *map, const void *key, uint6
 const void *hashmap_set_with_hash(struct hashmap *map, const void *item, uint64_t hash);
 void hashmap_set_grow_by_power(struct hashmap *map, size_t power);
 void hashmap_set_load_factor(struct hashmap *map, double load_factor);
+void hashmap_set_key_offset(struct hashmap *map, size_t keyoffset);
+bool hashmap_insert(struct hashmap *map, const void *item);
+bool hashmap_insert_with_hash(struct hashmap *map, const void *item, uint64_t hash);
+bool hashmap_iter_key(struct hashmap *map, const void *key, size_t *i, void **item);
+bool hashmap_reserve(struct hashmap *map, size_t count);
+bool hashmap_attach_buckets(struct hashmap *map, void *buckets, size_t nbuckets, size_t count);
 
 
 // DEPRECATED: use `hashmap_new_with_allocator`
@@ -204,6 +204,7 @@ PERFORMANCE vs MSVC 2008 32-/64-bit (GCC is even slower than MSVC):
 #define STB_SPRINTF_MIN 512 // how many characters per callback
 #endif
 typedef char* STBSP_SPRINTFCB(const char* buf, void* user, int len);
+typedef struct sbuf_fmt_s sbuf_fmt_s; // NOTE: CEX pre-compiled format, defined in sbuf.h
 
 #ifndef STB_SPRINTF_DECORATE
 #define STB_SPRINTF_DECORATE(name)                                                                 \
@@ -214,6 +215,8 @@ STBSP__PUBLICDEF int
 STB_SPRINTF_DECORATE(vfprintf)(FILE* stream, const char* format, va_list va);
 STBSP__PUBLICDEF int
 STB_SPRINTF_DECORATE(fprintf)(FILE* stream, const char* format, ...);
+STBSP__PUBLICDEF int
+STB_SPRINTF_DECORATE(vfprintf_fmt)(FILE* stream, const sbuf_fmt_s* fmt, va_list va);
 
 STBSP__PUBLICDEC int STB_SPRINTF_DECORATE(vsprintf)(char* buf, char const* fmt, va_list va);
 STBSP__PUBLICDEC int
@@ -232,4 +235,22 @@ STBSP__PUBLICDEC int STB_SPRINTF_DECORATE(vsprintfcb)(
 );
 STBSP__PUBLICDEC void STB_SPRINTF_DECORATE(set_separators)(char comma, char period);
 
+// CEX: pre-compiled format strings, returns number of ops (conversions + trailing literal), or -1
+// if format has more than SBUF_FMT_MAXOPS conversions
+STBSP__PUBLICDEC int STB_SPRINTF_DECORATE(compile)(sbuf_fmt_s* out, char const* fmt);
+STBSP__PUBLICDEC int STB_SPRINTF_DECORATE(vsprintfcb_fmt)(
+    STBSP_SPRINTFCB* callback,
+    void* user,
+    char* buf,
+    const sbuf_fmt_s* fmt,
+    va_list va
+);
+
+// CEX: format-free number conversion, buf must be at least 32 bytes, returns length
+STBSP__PUBLICDEC int STB_SPRINTF_DECORATE(u64toa)(char* buf, unsigned long long value);
+#ifndef STB_SPRINTF_NOFLOAT
+// shortest round-trip representation (%g layout, exponent when X < -4 or X >= 17)
+STBSP__PUBLICDEC int STB_SPRINTF_DECORATE(dtoa)(char* buf, double value);
+#endif
+
 #endif // STB_SPRINTF_H_INCLUDE
@@ -12,6 +12,7 @@ const struct _CEX_Error_struct Error = {
     .skip = "ShouldBeSkipped",       // NOT an error, function result must be skipped
     .empty = "EmptyError",           // resource is empty
     .eof = "EOF",                    // end of file reached
+    .timeout = "TimeoutError",       // operation timed out
     .argsparse = "ProgramArgsError", // program arguments empty or incorrect
     .runtime = "RuntimeError",       // generic runtime error
     .assert = "AssertError",         // generic runtime check
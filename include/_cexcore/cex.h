@@ -58,6 +58,7 @@ extern const struct _CEX_Error_struct
     Exc skip;
     Exc empty;
     Exc eof;
+    Exc timeout;
     Exc argsparse;
     Exc runtime;
     Exc assert;
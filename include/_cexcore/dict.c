@@ -3,6 +3,16 @@
 #include <stdarg.h>
 #include <time.h>
 #include "list.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef CEX_DICT_HASH_FUNC
+// Hash function family for dict_c string keys, must be hashmap_*(data, len, seed0, seed1)
+// compatible. Default is seeded xxhash3, use hashmap_sip if you need DoS resistance.
+#define CEX_DICT_HASH_FUNC hashmap_xxhash3
+#endif
 
 static inline u64
 hm_int_hash_simple(u64 x)
@@ -69,7 +79,7 @@ dict__hashfunc__str_cmp(const void* a, const void* b, void* udata)
 
 
 /**
- * @brief Compares static char[] buffer keys **must be null terminated**
+ * @brief Hashes static char[] buffer keys **must be null terminated**
  *
  * @param item
  * @param seed0
@@ -79,7 +89,46 @@ dict__hashfunc__str_cmp(const void* a, const void* b, void* udata)
 static u64
 dict__hashfunc__str_hash(const void* item, u64 seed0, u64 seed1)
 {
-    return hashmap_sip(item, strlen((char*)item), seed0, seed1);
+    return CEX_DICT_HASH_FUNC(item, strlen((char*)item), seed0, seed1);
+}
+
+/**
+ * @brief Compares str_c keys (length aware, no null terminator required)
+ *
+ * @param a  str_c*
+ * @param b  str_c*
+ * @param udata  (unused)
+ * @return compared int value
+ */
+static int
+dict__hashfunc__cexstr_cmp(const void* a, const void* b, void* udata)
+{
+    (void)udata;
+    const str_c* sa = a;
+    const str_c* sb = b;
+
+    if (sa->len != sb->len) {
+        return (sa->len < sb->len) ? -1 : 1;
+    }
+    if (sa->buf == sb->buf) {
+        return 0;
+    }
+    return memcmp(sa->buf, sb->buf, sa->len);
+}
+
+/**
+ * @brief Hashes str_c keys by length, without strlen() or copying into char[] buffer
+ *
+ * @param item str_c*
+ * @param seed0
+ * @param seed1
+ * @return
+ */
+static u64
+dict__hashfunc__cexstr_hash(const void* item, u64 seed0, u64 seed1)
+{
+    const str_c* s = item;
+    return CEX_DICT_HASH_FUNC(s->buf, s->len, seed0, seed1);
 }
 
 
@@ -97,13 +146,9 @@ dict_create(
     void* udata
 )
 {
-
-    if (item_key_offsetof != 0) {
-        uassert(
-            item_key_offsetof != 0 &&
-            "hashtable key offset must be 1st in struct, or set item_key_offsetof to 0 and custom hash/compare funcs"
-        );
-        return Error.integrity;
+    if (item_key_offsetof >= item_size) {
+        uassert(item_key_offsetof < item_size && "key offset is out of item bounds");
+        return Error.argument;
     }
 
     if (item_align > alignof(size_t)) {
@@ -118,6 +163,7 @@ dict_create(
 
     time_t now = time(NULL);
 
+    *self = (dict_c){ 0 };
     self->hashmap = hashmap_new_with_allocator(
         allocator->malloc,
         allocator->realloc,
@@ -134,6 +180,7 @@ dict_create(
     if (self->hashmap == NULL) {
         return Error.memory;
     }
+    hashmap_set_key_offset(self->hashmap, item_key_offsetof);
 
     return Error.ok;
 }
@@ -152,6 +199,11 @@ dict_set(dict_c* self, const void* item)
     uassert(self != NULL);
     uassert(self->hashmap != NULL);
 
+    if (self->_image != NULL) {
+        uassert(self->_image == NULL && "dict is read-only (loaded image)");
+        return Error.integrity;
+    }
+
     const void* set_result = hashmap_set(self->hashmap, item);
     if (set_result == NULL && hashmap_oom(self->hashmap)) {
         return Error.memory;
@@ -174,6 +226,20 @@ dict_geti(dict_c* self, u64 key)
     return (void*)hashmap_get(self->hashmap, &key);
 }
 
+/**
+ * @brief Get item by str_c key (for dicts with str_c key field)
+ *
+ * @param self dict() instance
+ * @param key str_c key
+ */
+void*
+dict_gets(dict_c* self, str_c key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return (void*)hashmap_get(self->hashmap, &key);
+}
+
 /**
  * @brief Get item by generic key pointer (including strings)
  *
@@ -218,6 +284,9 @@ dict_destroy(dict_c* self)
             hashmap_free(self->hashmap);
             self->hashmap = NULL;
         }
+        if (self->_image != NULL) {
+            munmap(self->_image, self->_image_len);
+        }
         memset(self, 0, sizeof(*self));
     }
 }
@@ -251,6 +320,20 @@ dict_deli(dict_c* self, u64 key)
     return (void*)hashmap_delete(self->hashmap, &key);
 }
 
+/**
+ * @brief Delete item by str_c key (for dicts with str_c key field)
+ *
+ * @param self dict() instance
+ * @param key str_c key
+ */
+void*
+dict_dels(dict_c* self, str_c key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return (void*)hashmap_delete(self->hashmap, &key);
+}
+
 /**
  * @brief Delete item by generic key pointer (including strings)
  *
@@ -343,6 +426,195 @@ dict_tolist(dict_c* self, void* listptr, const Allocator_i* allocator)
     return Error.ok;
 }
 
+typedef struct
+{
+    char magic[8];   // "CEXDICT\0"
+    u32 version;     // image format version
+    u32 endian;      // 0x01020304 in native byte order (images are not portable across archs)
+    u64 header_size; // offset of bucket array from the beginning of the file
+    u64 elsize;
+    u64 bucketsz;
+    u64 nbuckets;
+    u64 count;
+    u64 keyoffset;
+    u64 seed0;
+    u64 seed1;
+} dict__image_header_s;
+
+#define _CEX_DICT_IMAGE_VERSION 1
+#define _CEX_DICT_IMAGE_HEADER_SIZE 128
+_Static_assert(sizeof(dict__image_header_s) <= _CEX_DICT_IMAGE_HEADER_SIZE, "size");
+
+/**
+ * @brief Saves dict() hash table into the file as is (pointer-free image), which can be loaded
+ * via dict.load_image() without any deserialization.
+ *
+ * NOTE: dict items must not contain pointers (str_c keys are not supported)
+ *
+ * @param self dict() instance
+ * @param path output file path
+ * @return
+ */
+Exception
+dict_save_image(dict_c* self, const char* path)
+{
+    if (self == NULL || self->hashmap == NULL || path == NULL) {
+        return Error.argument;
+    }
+
+    struct hashmap* hm = self->hashmap;
+    if (hm->hash == dict__hashfunc__cexstr_hash) {
+        uassert(false && "str_c keys are pointers, and can't be saved into image");
+        return Error.argument;
+    }
+
+    dict__image_header_s header = {
+        .magic = "CEXDICT",
+        .version = _CEX_DICT_IMAGE_VERSION,
+        .endian = 0x01020304,
+        .header_size = _CEX_DICT_IMAGE_HEADER_SIZE,
+        .elsize = hm->elsize,
+        .bucketsz = hm->bucketsz,
+        .nbuckets = hm->nbuckets,
+        .count = hm->count,
+        .keyoffset = hm->keyoffset,
+        .seed0 = hm->seed0,
+        .seed1 = hm->seed1,
+    };
+    char header_buf[_CEX_DICT_IMAGE_HEADER_SIZE] = { 0 };
+    memcpy(header_buf, &header, sizeof(header));
+
+    FILE* fh = fopen(path, "wb");
+    if (fh == NULL) {
+        return Error.io;
+    }
+
+    Exc result = EOK;
+    if (fwrite(header_buf, sizeof(header_buf), 1, fh) != 1 ||
+        fwrite(hm->buckets, hm->bucketsz, hm->nbuckets, fh) != hm->nbuckets) {
+        result = Error.io;
+    }
+    if (fclose(fh) != 0) {
+        result = Error.io;
+    }
+    return result;
+}
+
+/**
+ * @brief Loads read-only dict() from the image made by dict.save_image(), the file is mmapped
+ * (shared pages across processes), and queried in place. Use dict$load_image() macro.
+ *
+ * NOTE: dict.set() returns Error.integrity, and dict.del*() / dict.clear() are ignored.
+ * NOTE: every item is re-hashed on load to validate the image (O(n), but no copying)
+ *
+ * @param self dict() instance
+ * @param path image file path
+ * @param item_size must match with saved dict item_size
+ * @param item_key_offsetof must match with saved dict item_key_offsetof
+ * @param hash_func must be the same as saved dict hash_func
+ * @param compare_func
+ * @param allocator
+ * @return
+ */
+Exception
+dict_load_image(
+    dict_c* self,
+    const char* path,
+    size_t item_size,
+    size_t item_key_offsetof,
+    dict_hash_func_f hash_func,
+    dict_compare_func_f compare_func,
+    const Allocator_i* allocator
+)
+{
+    if (self == NULL || path == NULL || allocator == NULL) {
+        return Error.argument;
+    }
+    if (hash_func == dict__hashfunc__cexstr_hash) {
+        uassert(false && "str_c keys are pointers, and can't be loaded from image");
+        return Error.argument;
+    }
+
+    *self = (dict_c){ 0 };
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return (errno == ENOENT) ? Error.not_found : Error.io;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return Error.io;
+    }
+    if ((size_t)st.st_size < _CEX_DICT_IMAGE_HEADER_SIZE) {
+        close(fd);
+        return Error.integrity;
+    }
+
+    void* image = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        return Error.io;
+    }
+
+    Exc result = Error.integrity;
+    dict__image_header_s* h = image;
+    if (memcmp(h->magic, "CEXDICT", 8) != 0 || h->version != _CEX_DICT_IMAGE_VERSION ||
+        h->endian != 0x01020304 || h->header_size != _CEX_DICT_IMAGE_HEADER_SIZE) {
+        goto fail;
+    }
+    if (h->elsize != item_size || h->keyoffset != item_key_offsetof) {
+        result = Error.argument;
+        goto fail;
+    }
+    if (h->nbuckets == 0 || (h->nbuckets & (h->nbuckets - 1)) != 0 || h->count >= h->nbuckets) {
+        goto fail;
+    }
+    if (h->bucketsz > ((size_t)st.st_size - h->header_size) / h->nbuckets) {
+        goto fail;
+    }
+
+    self->hashmap = hashmap_new_with_allocator(
+        allocator->malloc,
+        allocator->realloc,
+        allocator->free,
+        item_size,
+        0,
+        h->seed0,
+        h->seed1,
+        hash_func,
+        compare_func,
+        NULL,
+        NULL
+    );
+    if (self->hashmap == NULL) {
+        result = Error.memory;
+        goto fail;
+    }
+    hashmap_set_key_offset(self->hashmap, item_key_offsetof);
+
+    struct hashmap* hm = self->hashmap;
+    if (hm->bucketsz != h->bucketsz) {
+        goto fail;
+    }
+    if (!hashmap_attach_buckets(hm, (char*)image + h->header_size, h->nbuckets, h->count)) {
+        // hash function / seed mismatch, or corrupted buckets
+        goto fail;
+    }
+    self->_image = image;
+    self->_image_len = st.st_size;
+
+    return EOK;
+
+fail:
+    if (self->hashmap) {
+        hashmap_free(self->hashmap);
+    }
+    munmap(image, st.st_size);
+    *self = (dict_c){ 0 };
+    return result;
+}
+
 const struct __module__dict dict = {
     // Autogenerated by CEX
     // clang-format off
@@ -352,17 +624,23 @@ const struct __module__dict dict = {
         .u64_hash = dict__hashfunc__u64_hash,
         .str_cmp = dict__hashfunc__str_cmp,
         .str_hash = dict__hashfunc__str_hash,
+        .cexstr_cmp = dict__hashfunc__cexstr_cmp,
+        .cexstr_hash = dict__hashfunc__cexstr_hash,
     },  // sub-module .hashfunc <<<
     .create = dict_create,
     .set = dict_set,
     .geti = dict_geti,
+    .gets = dict_gets,
     .get = dict_get,
     .len = dict_len,
     .destroy = dict_destroy,
     .clear = dict_clear,
     .deli = dict_deli,
+    .dels = dict_dels,
     .del = dict_del,
     .iter = dict_iter,
     .tolist = dict_tolist,
+    .save_image = dict_save_image,
+    .load_image = dict_load_image,
     // clang-format on
 };
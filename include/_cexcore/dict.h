@@ -5,7 +5,9 @@
 
 typedef struct dict_c
 {
-    void* hashmap; // any generic hashmap implementation
+    void* hashmap;     // any generic hashmap implementation
+    void* _image;      // read-only mmapped image, see dict.load_image()
+    size_t _image_len; // mmapped image length
 } dict_c;
 
 typedef u64 (*dict_hash_func_f)(const void* item, u64 seed0, u64 seed1);
@@ -16,11 +18,23 @@ typedef void (*dict_elfree_func_f)(void* item);
 // Hack for getting hash/cmp functions by a type of key field
 // https://gustedt.wordpress.com/2015/05/11/the-controlling-expression-of-_generic/
 // FIX: this is not compatible with MSVC
+// NOTE: str_c keys store only a view, key bytes live outside the dict item (e.g. mmapped file or
+// interned string arena), and they must outlive the dict
 #define _dict$hashfunc_field(strucfield)                                                           \
-    _Generic(&(strucfield), u64 *: dict.hashfunc.u64_hash, char(*)[]: dict.hashfunc.str_hash)
+    _Generic(                                                                                      \
+        &(strucfield),                                                                             \
+        u64 *: dict.hashfunc.u64_hash,                                                             \
+        char(*)[]: dict.hashfunc.str_hash,                                                         \
+        str_c *: dict.hashfunc.cexstr_hash                                                         \
+    )
 
 #define _dict$cmpfunc_field(strucfield)                                                            \
-    _Generic(&(strucfield), u64 *: dict.hashfunc.u64_cmp, char(*)[]: dict.hashfunc.str_cmp)
+    _Generic(                                                                                      \
+        &(strucfield),                                                                             \
+        u64 *: dict.hashfunc.u64_cmp,                                                              \
+        char(*)[]: dict.hashfunc.str_cmp,                                                          \
+        str_c *: dict.hashfunc.cexstr_cmp                                                          \
+    )
 
 #define _dict$hashfunc(struct, field) _dict$hashfunc_field(((struct){ 0 }.field))
 
@@ -43,6 +57,19 @@ typedef void (*dict_elfree_func_f)(void* item);
     )
 
 
+// Loads read-only dict image made by dict.save_image(), struct_type/key_field_name must match
+// with saved dict()
+#define dict$load_image(self, struct_type, key_field_name, path, allocator)                        \
+    dict.load_image(                                                                               \
+        self,                                                                                      \
+        path,                                                                                      \
+        sizeof(struct_type),                                                                       \
+        offsetof(struct_type, key_field_name),                                                     \
+        _dict$hashfunc(struct_type, key_field_name),                                               \
+        _dict$cmpfunc(struct_type, key_field_name),                                                \
+        allocator                                                                                  \
+    )
+
 struct __module__dict
 {
     // Autogenerated by CEX
@@ -84,7 +111,7 @@ struct {  // sub-module .hashfunc >>>
     (*str_cmp)(const void* a, const void* b, void* udata);
 
     /**
-     * @brief Compares static char[] buffer keys **must be null terminated**
+     * @brief Hashes static char[] buffer keys **must be null terminated**
      *
      * @param item
      * @param seed0
@@ -94,6 +121,28 @@ struct {  // sub-module .hashfunc >>>
     u64
     (*str_hash)(const void* item, u64 seed0, u64 seed1);
 
+    /**
+     * @brief Compares str_c keys (length aware, no null terminator required)
+     *
+     * @param a  str_c*
+     * @param b  str_c*
+     * @param udata  (unused)
+     * @return compared int value
+     */
+    int
+    (*cexstr_cmp)(const void* a, const void* b, void* udata);
+
+    /**
+     * @brief Hashes str_c keys by length, without strlen() or copying into char[] buffer
+     *
+     * @param item str_c*
+     * @param seed0
+     * @param seed1
+     * @return
+     */
+    u64
+    (*cexstr_hash)(const void* item, u64 seed0, u64 seed1);
+
 } hashfunc;  // sub-module .hashfunc <<<
 Exception
 (*create)(dict_c* self, size_t item_size, size_t item_align, size_t item_key_offsetof, size_t capacity, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator, dict_elfree_func_f elfree, void* udata);
@@ -117,6 +166,15 @@ Exception
 void*
 (*geti)(dict_c* self, u64 key);
 
+/**
+ * @brief Get item by str_c key (for dicts with str_c key field)
+ *
+ * @param self dict() instance
+ * @param key str_c key
+ */
+void*
+(*gets)(dict_c* self, str_c key);
+
 /**
  * @brief Get item by generic key pointer (including strings)
  *
@@ -161,6 +219,15 @@ void
 void*
 (*deli)(dict_c* self, u64 key);
 
+/**
+ * @brief Delete item by str_c key (for dicts with str_c key field)
+ *
+ * @param self dict() instance
+ * @param key str_c key
+ */
+void*
+(*dels)(dict_c* self, str_c key);
+
 /**
  * @brief Delete item by generic key pointer (including strings)
  *
@@ -176,6 +243,38 @@ void*
 Exception
 (*tolist)(dict_c* self, void* listptr, const Allocator_i* allocator);
 
+/**
+ * @brief Saves dict() hash table into the file as is (pointer-free image), which can be loaded
+ * via dict.load_image() without any deserialization.
+ *
+ * NOTE: dict items must not contain pointers (str_c keys are not supported)
+ *
+ * @param self dict() instance
+ * @param path output file path
+ * @return
+ */
+Exception
+(*save_image)(dict_c* self, const char* path);
+
+/**
+ * @brief Loads read-only dict() from the image made by dict.save_image(), the file is mmapped
+ * (shared pages across processes), and queried in place. Use dict$load_image() macro.
+ *
+ * NOTE: dict.set() returns Error.integrity, and dict.del*() / dict.clear() are ignored.
+ * NOTE: every item is re-hashed on load to validate the image (O(n), but no copying)
+ *
+ * @param self dict() instance
+ * @param path image file path
+ * @param item_size must match with saved dict item_size
+ * @param item_key_offsetof must match with saved dict item_key_offsetof
+ * @param hash_func must be the same as saved dict hash_func
+ * @param compare_func
+ * @param allocator
+ * @return
+ */
+Exception
+(*load_image)(dict_c* self, const char* path, size_t item_size, size_t item_key_offsetof, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator);
+
     // clang-format on
 };
 extern const struct __module__dict dict; // CEX Autogen
@@ -0,0 +1,265 @@
+#include "hashset.h"
+#include "_hashmap.h"
+#include "list.h"
+#include <time.h>
+
+/**
+ * @brief Creates new hashset() instance (use hashset$new() macro to pick hash/cmp by key type)
+ *
+ * @param self hashset() instance
+ * @param key_size size of key in bytes
+ * @param key_align key alignment (must not exceed alignof(size_t))
+ * @param capacity initial capacity, 0 - default (16)
+ * @param hash_func key hash function (see dict.hashfunc)
+ * @param compare_func key compare function (see dict.hashfunc)
+ * @param allocator
+ * @return Error.argument on bad arguments, Error.memory on allocation failure
+ */
+Exception
+hashset_create(
+    hashset_c* self,
+    size_t key_size,
+    size_t key_align,
+    size_t capacity,
+    dict_hash_func_f hash_func,
+    dict_compare_func_f compare_func,
+    const Allocator_i* allocator
+)
+{
+    if (self == NULL || allocator == NULL || hash_func == NULL || compare_func == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        uassert(allocator != NULL && "allocator invalid");
+        uassert(hash_func != NULL && "hash_func is NULL");
+        uassert(compare_func != NULL && "compare_func is NULL");
+        return Error.argument;
+    }
+
+    if (key_size == 0) {
+        uassert(key_size > 0 && "zero key_size");
+        return Error.argument;
+    }
+
+    if (key_align > alignof(size_t)) {
+        uassert(key_align <= alignof(size_t) && "key alignment exceed regular pointer alignment");
+        return Error.argument;
+    }
+
+    time_t now = time(NULL);
+
+    self->hashmap = hashmap_new_with_allocator(
+        allocator->malloc,
+        allocator->realloc,
+        allocator->free,
+        key_size,
+        capacity,
+        now,                     // seed0
+        hm_int_hash_simple(now), // seed1
+        hash_func,
+        compare_func,
+        NULL,
+        NULL
+    );
+    if (self->hashmap == NULL) {
+        return Error.memory;
+    }
+
+    return Error.ok;
+}
+
+/**
+ * @brief Add key to the set (no-op if key already exists)
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ * @return Error.memory on allocation failure
+ */
+Exception
+hashset_add(hashset_c* self, const void* key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+
+    const void* set_result = hashmap_set(self->hashmap, key);
+    if (set_result == NULL && hashmap_oom(self->hashmap)) {
+        return Error.memory;
+    }
+
+    return EOK;
+}
+
+/**
+ * @brief Add all keys from list_c (list element type must match set key type)
+ *
+ * @param self hashset() instance
+ * @param listptr list_c or list$define() instance of keys
+ * @return
+ */
+Exception
+hashset_extend(hashset_c* self, void* listptr)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+
+    if (listptr == NULL) {
+        return Error.argument;
+    }
+
+    struct hashmap* hm = self->hashmap;
+    list_c* lst = listptr;
+    if (lst->len == 0) {
+        return EOK;
+    }
+    list_head_s* head = (list_head_s*)((char*)lst->arr - _CEX_LIST_BUF);
+    uassert(head->header.magic == 0x1eed && "not a list / bad pointer");
+    if (head->header.elsize != hm->elsize) {
+        uassert(false && "list element size doesn't match with hashset key size");
+        return Error.argument;
+    }
+
+    if (!hashmap_reserve(hm, hm->count + lst->len)) {
+        return Error.memory;
+    }
+
+    char* key = lst->arr;
+    for (size_t i = 0; i < lst->len; i++, key += hm->elsize) {
+        if (hashmap_set(hm, key) == NULL && hashmap_oom(hm)) {
+            return Error.memory;
+        }
+    }
+    return EOK;
+}
+
+/**
+ * @brief Check if key exists in the set
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ */
+bool
+hashset_has(hashset_c* self, const void* key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return hashmap_get(self->hashmap, key) != NULL;
+}
+
+/**
+ * @brief Delete key from the set
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ * @return true if key existed
+ */
+bool
+hashset_del(hashset_c* self, const void* key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return hashmap_delete(self->hashmap, key) != NULL;
+}
+
+/**
+ * @brief Number of keys in the set
+ *
+ * @param self hashset() instance
+ */
+size_t
+hashset_len(hashset_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return hashmap_count(self->hashmap);
+}
+
+/**
+ * @brief Clear all keys (allocated capacity unchanged)
+ *
+ * @param self hashset() instance
+ */
+void
+hashset_clear(hashset_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    hashmap_clear(self->hashmap, false);
+}
+
+/**
+ * @brief Free hashset() instance
+ *
+ * @param self hashset() instance
+ */
+void
+hashset_destroy(hashset_c* self)
+{
+    if (self != NULL) {
+        if (self->hashmap != NULL) {
+            hashmap_free(self->hashmap);
+            self->hashmap = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Iterates over set keys (in arbitrary order), set must not be changed during iteration
+ *
+ * for$iter(u64, it, hashset.iter(&set, &it.iterator))
+ */
+void*
+hashset_iter(hashset_c* self, cex_iterator_s* iterator)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    uassert(iterator != NULL);
+
+    struct hashmap* hm = self->hashmap;
+
+    struct iter_ctx
+    {
+        size_t nbuckets;
+        size_t count;
+        size_t cursor;
+        size_t counter;
+    }* ctx = (struct iter_ctx*)iterator->_ctx;
+    _Static_assert(sizeof(*ctx) <= sizeof(iterator->_ctx), "ctx size overflow");
+    _Static_assert(alignof(struct iter_ctx) == alignof(size_t), "ctx alignment mismatch");
+
+    if (unlikely(iterator->val == NULL)) {
+        if (hm->count == 0) {
+            return NULL;
+        }
+        *ctx = (struct iter_ctx){
+            .count = hm->count,
+            .nbuckets = hm->nbuckets,
+        };
+    } else {
+        ctx->counter++;
+    }
+
+    if (unlikely(ctx->count != hm->count || ctx->nbuckets != hm->nbuckets)) {
+        uassert(ctx->count == hm->count && "hashset changed during iteration");
+        uassert(ctx->nbuckets == hm->nbuckets && "hashset changed during iteration");
+        return NULL;
+    }
+
+    if (hashmap_iter(hm, &ctx->cursor, &iterator->val)) {
+        iterator->idx.i = ctx->counter;
+        return iterator->val;
+    } else {
+        return NULL;
+    }
+}
+const struct __module__hashset hashset = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = hashset_create,
+    .add = hashset_add,
+    .extend = hashset_extend,
+    .has = hashset_has,
+    .del = hashset_del,
+    .len = hashset_len,
+    .clear = hashset_clear,
+    .destroy = hashset_destroy,
+    .iter = hashset_iter,
+    // clang-format on
+};
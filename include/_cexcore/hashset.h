@@ -0,0 +1,117 @@
+#pragma once
+#include "cex.h"
+#include "dict.h"
+
+/**
+ * @brief Hash set (key only container), uses the same open addressing hashmap as dict_c
+ */
+typedef struct hashset_c
+{
+    void* hashmap; // any generic hashmap implementation
+} hashset_c;
+
+// NOTE: key_type can be u64, char[N] (null terminated), or str_c (key bytes must outlive the set)
+#define hashset$new(self, key_type, allocator)                                                     \
+    hashset.create(                                                                                \
+        self,                                                                                      \
+        sizeof(key_type),                                                                          \
+        _Alignof(key_type),                                                                        \
+        0, /* capacity = 0, default is 16 */                                                       \
+        _dict$hashfunc_field(((key_type){ 0 })),                                                   \
+        _dict$cmpfunc_field(((key_type){ 0 })),                                                    \
+        allocator                                                                                  \
+    )
+struct __module__hashset
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates new hashset() instance (use hashset$new() macro to pick hash/cmp by key type)
+ *
+ * @param self hashset() instance
+ * @param key_size size of key in bytes
+ * @param key_align key alignment (must not exceed alignof(size_t))
+ * @param capacity initial capacity, 0 - default (16)
+ * @param hash_func key hash function (see dict.hashfunc)
+ * @param compare_func key compare function (see dict.hashfunc)
+ * @param allocator
+ * @return Error.argument on bad arguments, Error.memory on allocation failure
+ */
+Exception
+(*create)(hashset_c* self, size_t key_size, size_t key_align, size_t capacity, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator);
+
+/**
+ * @brief Add key to the set (no-op if key already exists)
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ * @return Error.memory on allocation failure
+ */
+Exception
+(*add)(hashset_c* self, const void* key);
+
+/**
+ * @brief Add all keys from list_c (list element type must match set key type)
+ *
+ * @param self hashset() instance
+ * @param listptr list_c or list$define() instance of keys
+ * @return
+ */
+Exception
+(*extend)(hashset_c* self, void* listptr);
+
+/**
+ * @brief Check if key exists in the set
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ */
+bool
+(*has)(hashset_c* self, const void* key);
+
+/**
+ * @brief Delete key from the set
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ * @return true if key existed
+ */
+bool
+(*del)(hashset_c* self, const void* key);
+
+/**
+ * @brief Number of keys in the set
+ *
+ * @param self hashset() instance
+ */
+size_t
+(*len)(hashset_c* self);
+
+/**
+ * @brief Clear all keys (allocated capacity unchanged)
+ *
+ * @param self hashset() instance
+ */
+void
+(*clear)(hashset_c* self);
+
+/**
+ * @brief Free hashset() instance
+ *
+ * @param self hashset() instance
+ */
+void
+(*destroy)(hashset_c* self);
+
+/**
+ * @brief Iterates over set keys (in arbitrary order), set must not be changed during iteration
+ *
+ * for$iter(u64, it, hashset.iter(&set, &it.iterator))
+ */
+void*
+(*iter)(hashset_c* self, cex_iterator_s* iterator);
+
+    // clang-format on
+};
+extern const struct __module__hashset hashset; // CEX Autogen
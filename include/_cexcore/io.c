@@ -2,8 +2,32 @@
 #include "_stb_sprintf.h"
 #include "cex.h"
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#if defined(__linux__) && defined(__LP64__)
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(__LP64__) && defined(SYS_sync_file_range)
+#define IO__HAS_SYNC_FILE_RANGE 1
+// NOTE: only defined with _GNU_SOURCE
+#ifndef SYNC_FILE_RANGE_WAIT_BEFORE
+#define SYNC_FILE_RANGE_WAIT_BEFORE 1
+#define SYNC_FILE_RANGE_WRITE 2
+#define SYNC_FILE_RANGE_WAIT_AFTER 4
+#endif
+#else
+#define IO__HAS_SYNC_FILE_RANGE 0
+#endif
+
 Exception
 io_fopen(io_c* self, const char* filename, const char* mode, const Allocator_i* allocator)
 {
@@ -44,6 +68,74 @@ io_fopen(io_c* self, const char* filename, const char* mode, const Allocator_i*
 
 }
 
+Exception
+io_fopen_atomic(io_c* self, const char* filename, u32 flags, const Allocator_i* allocator)
+{
+    if (self == NULL) {
+        uassert(self != NULL);
+        return Error.argument;
+    }
+    if (filename == NULL || filename[0] == '\0') {
+        uassert(filename != NULL);
+        return Error.argument;
+    }
+    if (allocator == NULL) {
+        uassert(allocator != NULL);
+        return Error.argument;
+    }
+    *self = (io_c){ 0 };
+
+    // temp file is in the same directory, so rename() is atomic (same file system)
+    size_t len = strlen(filename);
+    const char* base = strrchr(filename, '/');
+    size_t dir_len = (base != NULL) ? (size_t)(base - filename) + 1 : 0;
+    base = filename + dir_len;
+    if (base[0] == '\0') {
+        return Error.argument; // directory
+    }
+
+    // "<dir>/.<base>.<pid>.<counter>.tmp" + '\0' + filename
+    size_t tmp_size = len + 1 + 48;
+    char* path = allocator->malloc(tmp_size + len + 1);
+    if (path == NULL) {
+        return Error.memory;
+    }
+
+    static u32 counter = 0;
+    for (u32 attempt = 0; attempt < 100; attempt++) {
+        int n = snprintf(
+            path,
+            tmp_size,
+            "%.*s.%s.%d.%u.tmp",
+            (int)dir_len,
+            filename,
+            base,
+            (int)getpid(),
+            __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED)
+        );
+        uassert(n > 0 && (size_t)n < tmp_size);
+        (void)n;
+
+        // "x" - O_EXCL, the file is created with 0666 & ~umask like io.fopen(..., "w")
+        self->_fh = allocator->fopen(path, "wx");
+        if (self->_fh != NULL || errno != EEXIST) {
+            break;
+        }
+    }
+    if (self->_fh == NULL) {
+        Exc result = (errno == ENOENT) ? Error.not_found : strerror(errno);
+        allocator->free(path);
+        return result;
+    }
+
+    memcpy(path + strlen(path) + 1, filename, len + 1);
+    self->_atomic_path = path;
+    self->_allocator = allocator;
+    self->_flags.is_sync = (flags & IO_ATOMIC_SYNC) != 0;
+    self->_flags.is_dontneed = (flags & IO_ATOMIC_DONTNEED) != 0;
+    return Error.ok;
+}
+
 Exception
 io_fattach(io_c* self, FILE* fh, const Allocator_i* allocator)
 {
@@ -380,6 +472,40 @@ fail:
     return result;
 }
 
+// IO_ATOMIC_DONTNEED: drops every full IO_ATOMIC_DONTNEED_CHUNK of written data from page cache,
+// errors are ignored here, io.commit() does final fdatasync() and reports them
+static inline void
+io__atomic_dontneed(io_c* self)
+{
+    if (likely(!self->_flags.is_dontneed)) {
+        return;
+    }
+    long pos = ftell(self->_fh);
+    if (pos < 0 || (size_t)pos < self->_dontneed_off + IO_ATOMIC_DONTNEED_CHUNK) {
+        return;
+    }
+    if (fflush(self->_fh) != 0) {
+        return;
+    }
+
+    // only clean pages can be dropped, write out the chunk and wait for it
+    int fd = fileno(self->_fh);
+    off_t off = self->_dontneed_off;
+    off_t len = pos - off;
+#if IO__HAS_SYNC_FILE_RANGE
+    int flags = SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER;
+    if (syscall(SYS_sync_file_range, fd, off, len, flags) == -1) {
+        return;
+    }
+#else
+    if (fdatasync(fd) == -1) {
+        return;
+    }
+#endif
+    (void)posix_fadvise(fd, off, len, POSIX_FADV_DONTNEED);
+    self->_dontneed_off = pos;
+}
+
 Exception
 io_fprintf(io_c* self, const char* format, ...)
 {
@@ -394,6 +520,28 @@ io_fprintf(io_c* self, const char* format, ...)
     if (result == -1) {
         return Error.io;
     } else {
+        io__atomic_dontneed(self);
+        return Error.ok;
+    }
+}
+
+Exception
+io_fprintf_fmt(io_c* self, const sbuf_fmt_s* fmt, ...)
+{
+    uassert(self != NULL);
+    uassert(self->_fh != NULL);
+    uassert(fmt != NULL);
+    uassert(fmt->fmt != NULL && "not compiled");
+
+    va_list va;
+    va_start(va, fmt);
+    int result = STB_SPRINTF_DECORATE(vfprintf_fmt)(self->_fh, fmt, va);
+    va_end(va);
+
+    if (result == -1) {
+        return Error.io;
+    } else {
+        io__atomic_dontneed(self);
         return Error.ok;
     }
 }
@@ -428,10 +576,104 @@ io_write(io_c* self, void* restrict obj_buffer, size_t obj_el_size, size_t obj_c
     if (ret_count != obj_count) {
         return Error.io;
     } else {
+        io__atomic_dontneed(self);
         return Error.ok;
     }
 }
 
+static Exception
+io__writev_fd(int fd, struct iovec* iov, int iovcnt, size_t* written)
+{
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (unlikely(n < 0)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return Error.io;
+        }
+        *written += n;
+        // partial write: skip fully written parts, and continue from the middle of the next one
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return Error.ok;
+}
+
+// written (optional) - bytes passed to file (also on failure), big payloads bypass stdio buffer
+// so they are already in fd on partial failure
+Exception
+io_writev(io_c* self, str_c* parts, size_t n, size_t* written)
+{
+    uassert(self != NULL);
+    uassert(self->_fh != NULL);
+
+    size_t nwritten = 0;
+    if (written == NULL) {
+        written = &nwritten;
+    }
+    *written = 0;
+
+    if (parts == NULL) {
+        return Error.argument;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (unlikely(parts[i].buf == NULL && parts[i].len > 0)) {
+            return Error.argument;
+        }
+        total += parts[i].len;
+    }
+
+    if (total < IO_WRITEV_MIN_SIZE) {
+        // small payload is cheaper to copy into stdio buffer than to make a syscall
+        for (size_t i = 0; i < n; i++) {
+            if (parts[i].len == 0) {
+                continue;
+            }
+            size_t nw = fwrite(parts[i].buf, 1, parts[i].len, self->_fh);
+            *written += nw;
+            if (nw != parts[i].len) {
+                return Error.io;
+            }
+        }
+        io__atomic_dontneed(self);
+        return Error.ok;
+    }
+
+    // keep order of data which is already buffered by stdio
+    e$ret(io_flush(self));
+
+    int fd = fileno(self->_fh);
+    struct iovec iov[64];
+    int iovcnt = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (parts[i].len == 0) {
+            continue;
+        }
+        iov[iovcnt++] = (struct iovec){ .iov_base = parts[i].buf, .iov_len = parts[i].len };
+        if (iovcnt == arr$len(iov) || iovcnt == IOV_MAX) {
+            e$ret(io__writev_fd(fd, iov, iovcnt, written));
+            iovcnt = 0;
+        }
+    }
+    if (iovcnt > 0) {
+        e$ret(io__writev_fd(fd, iov, iovcnt, written));
+    }
+
+    io__atomic_dontneed(self);
+    return Error.ok;
+}
+
 void
 io_close(io_c* self)
 {
@@ -443,6 +685,13 @@ io_close(io_c* self)
             self->_allocator->fclose(self->_fh);
         }
 
+        if (self->_atomic_path != NULL) {
+            // not committed atomic write, target file is untouched
+            uassert(self->_allocator != NULL && "allocator not set");
+            (void)unlink(self->_atomic_path);
+            self->_allocator->free(self->_atomic_path);
+        }
+
         if (self->_fbuf != NULL) {
             uassert(self->_allocator != NULL && "allocator not set");
             self->_allocator->free(self->_fbuf);
@@ -452,11 +701,94 @@ io_close(io_c* self)
     }
 }
 
+Exception
+io_commit(io_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->_fh != NULL);
+
+    if (self->_atomic_path == NULL) {
+        return Error.argument; // not opened by io.fopen_atomic()
+    }
+
+    const char* tmp_path = self->_atomic_path;
+    const char* target = tmp_path + strlen(tmp_path) + 1;
+    Exc result = Error.ok;
+    int fd = fileno(self->_fh);
+
+    if (fflush(self->_fh) != 0) {
+        result = Error.io;
+        goto end;
+    }
+    if (self->_flags.is_sync || self->_flags.is_dontneed) {
+        // only clean pages can be dropped from page cache
+        if (fdatasync(fd) == -1) {
+            result = Error.io;
+            goto end;
+        }
+    }
+    if (self->_flags.is_dontneed) {
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+    // replaced file keeps its permissions
+    struct stat st;
+    if (stat(target, &st) == 0) {
+        (void)fchmod(fd, st.st_mode & 07777);
+    }
+
+    int ret = self->_allocator->fclose(self->_fh);
+    self->_fh = NULL;
+    if (ret != 0) {
+        result = Error.io; // i.e. delayed write error
+        goto end;
+    }
+    if (rename(tmp_path, target) == -1) {
+        result = Error.io;
+        goto end;
+    }
+    tmp_path = NULL;
+
+    if (self->_flags.is_sync) {
+        // make rename durable
+        const char* base = strrchr(target, '/');
+        char dir[PATH_MAX];
+        if (base == NULL) {
+            memcpy(dir, ".", 2);
+        } else if (base == target) {
+            memcpy(dir, "/", 2);
+        } else if ((size_t)(base - target) < sizeof(dir)) {
+            memcpy(dir, target, base - target);
+            dir[base - target] = '\0';
+        } else {
+            result = Error.overflow;
+            goto end;
+        }
+        int dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd == -1 || fsync(dir_fd) == -1) {
+            result = Error.io;
+        }
+        if (dir_fd != -1) {
+            close(dir_fd);
+        }
+    }
+
+end:
+    if (tmp_path == NULL) {
+        // committed, nothing to remove on close
+        self->_allocator->free(self->_atomic_path);
+        self->_atomic_path = NULL;
+    }
+    io_close(self);
+    return result;
+}
+
 
 const struct __module__io io = {
     // Autogenerated by CEX
     // clang-format off
     .fopen = io_fopen,
+    .fopen_atomic = io_fopen_atomic,
     .fattach = io_fattach,
     .fileno = io_fileno,
     .isatty = io_isatty,
@@ -469,8 +801,11 @@ const struct __module__io io = {
     .readall = io_readall,
     .readline = io_readline,
     .fprintf = io_fprintf,
+    .fprintf_fmt = io_fprintf_fmt,
     .printf = io_printf,
     .write = io_write,
+    .writev = io_writev,
     .close = io_close,
+    .commit = io_commit,
     // clang-format on
 };
@@ -1,8 +1,24 @@
 #pragma once
 #include "str.h"
+#include "sbuf.h"
 #include "cex.h"
 #include <stdio.h>
 
+// io.writev() payloads smaller than this go through stdio buffer, bigger ones bypass it
+#ifndef IO_WRITEV_MIN_SIZE
+#define IO_WRITEV_MIN_SIZE 4096
+#endif
+
+// io.fopen_atomic() writes into a temp file in the same directory, io.commit() renames it over
+// the target file, io.close() without io.commit() removes it (target is untouched, e.g. on error)
+#define IO_ATOMIC_SYNC 0x1     // fdatasync() file before rename, and fsync() its directory after
+#define IO_ATOMIC_DONTNEED 0x2 // drop written pages from page cache while writing and on commit
+
+// IO_ATOMIC_DONTNEED: written data is synced and dropped from page cache every this many bytes,
+// so big outputs don't evict hot pages of other files long before io.commit()
+#ifndef IO_ATOMIC_DONTNEED_CHUNK
+#define IO_ATOMIC_DONTNEED_CHUNK (8 * 1024 * 1024)
+#endif
 
 typedef struct io_c
 {
@@ -10,10 +26,14 @@ typedef struct io_c
     size_t _fsize;
     char* _fbuf;
     size_t _fbuf_size;
+    char* _atomic_path; // io.fopen_atomic(): temp file path + '\0' + target path
+    size_t _dontneed_off; // IO_ATOMIC_DONTNEED: file data before this offset is dropped from cache
     const Allocator_i* _allocator;
     struct
     {
         u32 is_attached : 1;
+        u32 is_sync : 1;
+        u32 is_dontneed : 1;
 
     } _flags;
 } io_c;
@@ -24,9 +44,14 @@ struct __module__io
     // Autogenerated by CEX
     // clang-format off
 
+// NOTE: only defined with _GNU_SOURCE
+
 Exception
 (*fopen)(io_c* self, const char* filename, const char* mode, const Allocator_i* allocator);
 
+Exception
+(*fopen_atomic)(io_c* self, const char* filename, u32 flags, const Allocator_i* allocator);
+
 Exception
 (*fattach)(io_c* self, FILE* fh, const Allocator_i* allocator);
 
@@ -63,15 +88,27 @@ Exception
 Exception
 (*fprintf)(io_c* self, const char* format, ...);
 
+Exception
+(*fprintf_fmt)(io_c* self, const sbuf_fmt_s* fmt, ...);
+
 void
 (*printf)(const char* format, ...);
 
 Exception
 (*write)(io_c* self, void* obj_buffer, size_t obj_el_size, size_t obj_count);
 
+// written (optional) - bytes passed to file (also on failure), big payloads bypass stdio buffer
+// so they are already in fd on partial failure
+
+Exception
+(*writev)(io_c* self, str_c* parts, size_t n, size_t* written);
+
 void
 (*close)(io_c* self);
 
+Exception
+(*commit)(io_c* self);
+
     // clang-format on
 };
 extern const struct __module__io io; // CEX Autogen
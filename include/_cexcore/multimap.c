@@ -0,0 +1,346 @@
+#include "multimap.h"
+#include "_hashmap.h"
+#include "list.h"
+#include <time.h>
+
+/**
+ * @brief Creates new multimap() instance (use multimap$new() macro to pick hash/cmp by key field)
+ *
+ * @param self multimap() instance
+ * @param item_size size of item struct
+ * @param item_align item alignment (must not exceed alignof(size_t))
+ * @param item_key_offsetof offset of key field in item struct
+ * @param capacity initial capacity, 0 - default (16)
+ * @param hash_func key hash function (see dict.hashfunc)
+ * @param compare_func key compare function (see dict.hashfunc)
+ * @param allocator
+ * @return Error.argument on bad arguments, Error.memory on allocation failure
+ */
+Exception
+multimap_create(
+    multimap_c* self,
+    size_t item_size,
+    size_t item_align,
+    size_t item_key_offsetof,
+    size_t capacity,
+    dict_hash_func_f hash_func,
+    dict_compare_func_f compare_func,
+    const Allocator_i* allocator
+)
+{
+    if (self == NULL || allocator == NULL || hash_func == NULL || compare_func == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        uassert(allocator != NULL && "allocator invalid");
+        uassert(hash_func != NULL && "hash_func is NULL");
+        uassert(compare_func != NULL && "compare_func is NULL");
+        return Error.argument;
+    }
+
+    if (item_key_offsetof >= item_size) {
+        uassert(item_key_offsetof < item_size && "key offset is out of item bounds");
+        return Error.argument;
+    }
+
+    if (item_align > alignof(size_t)) {
+        uassert(item_align <= alignof(size_t) && "item alignment exceed regular pointer alignment");
+        return Error.argument;
+    }
+
+    time_t now = time(NULL);
+
+    self->hashmap = hashmap_new_with_allocator(
+        allocator->malloc,
+        allocator->realloc,
+        allocator->free,
+        item_size,
+        capacity,
+        now,                     // seed0
+        hm_int_hash_simple(now), // seed1
+        hash_func,
+        compare_func,
+        NULL,
+        NULL
+    );
+    if (self->hashmap == NULL) {
+        return Error.memory;
+    }
+    hashmap_set_key_offset(self->hashmap, item_key_offsetof);
+
+    return Error.ok;
+}
+
+/**
+ * @brief Add item to multimap (items with existing keys are not replaced)
+ *
+ * @param self multimap() instance
+ * @param item item key/value struct
+ * @return Error.memory on allocation failure
+ */
+Exception
+multimap_add(multimap_c* self, const void* item)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+
+    if (!hashmap_insert(self->hashmap, item)) {
+        return Error.memory;
+    }
+    return EOK;
+}
+
+/**
+ * @brief Add all items from list_c (list element type must match multimap item type)
+ *
+ * @param self multimap() instance
+ * @param listptr list_c or list$define() instance of items
+ * @return
+ */
+Exception
+multimap_extend(multimap_c* self, void* listptr)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+
+    if (listptr == NULL) {
+        return Error.argument;
+    }
+
+    struct hashmap* hm = self->hashmap;
+    list_c* lst = listptr;
+    if (lst->len == 0) {
+        return EOK;
+    }
+    list_head_s* head = (list_head_s*)((char*)lst->arr - _CEX_LIST_BUF);
+    uassert(head->header.magic == 0x1eed && "not a list / bad pointer");
+    if (head->header.elsize != hm->elsize) {
+        uassert(false && "list element size doesn't match with multimap item size");
+        return Error.argument;
+    }
+
+    if (!hashmap_reserve(hm, hm->count + lst->len)) {
+        return Error.memory;
+    }
+
+    char* item = lst->arr;
+    for (size_t i = 0; i < lst->len; i++, item += hm->elsize) {
+        if (!hashmap_insert(hm, item)) {
+            return Error.memory;
+        }
+    }
+    return EOK;
+}
+
+/**
+ * @brief Get first found item by key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ * @return item or NULL if not found
+ */
+void*
+multimap_get(multimap_c* self, const void* key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return (void*)hashmap_get(self->hashmap, key);
+}
+
+/**
+ * @brief Number of items with equal key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ */
+size_t
+multimap_count(multimap_c* self, const void* key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+
+    size_t cursor = 0;
+    size_t result = 0;
+    void* item = NULL;
+    while (hashmap_iter_key(self->hashmap, key, &cursor, &item)) {
+        result++;
+    }
+    return result;
+}
+
+/**
+ * @brief Delete all items with equal key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ * @return number of deleted items
+ */
+size_t
+multimap_del(multimap_c* self, const void* key)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+
+    size_t result = 0;
+    while (hashmap_delete(self->hashmap, key) != NULL) {
+        result++;
+    }
+    return result;
+}
+
+/**
+ * @brief Number of all items in multimap
+ *
+ * @param self multimap() instance
+ */
+size_t
+multimap_len(multimap_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    return hashmap_count(self->hashmap);
+}
+
+/**
+ * @brief Clear all items (allocated capacity unchanged)
+ *
+ * @param self multimap() instance
+ */
+void
+multimap_clear(multimap_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    hashmap_clear(self->hashmap, false);
+}
+
+/**
+ * @brief Free multimap() instance
+ *
+ * @param self multimap() instance
+ */
+void
+multimap_destroy(multimap_c* self)
+{
+    if (self != NULL) {
+        if (self->hashmap != NULL) {
+            hashmap_free(self->hashmap);
+            self->hashmap = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Iterates over all items with equal key, multimap must not be changed during iteration
+ *
+ * for$iter(my_item, it, multimap.iter_key(&mm, &key, &it.iterator))
+ */
+void*
+multimap_iter_key(multimap_c* self, const void* key, cex_iterator_s* iterator)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    uassert(iterator != NULL);
+
+    struct hashmap* hm = self->hashmap;
+
+    struct iter_ctx
+    {
+        size_t nbuckets;
+        size_t count;
+        size_t cursor;
+        size_t counter;
+    }* ctx = (struct iter_ctx*)iterator->_ctx;
+    _Static_assert(sizeof(*ctx) <= sizeof(iterator->_ctx), "ctx size overflow");
+    _Static_assert(alignof(struct iter_ctx) == alignof(size_t), "ctx alignment mismatch");
+
+    if (unlikely(iterator->val == NULL)) {
+        if (hm->count == 0) {
+            return NULL;
+        }
+        *ctx = (struct iter_ctx){
+            .count = hm->count,
+            .nbuckets = hm->nbuckets,
+        };
+    } else {
+        ctx->counter++;
+    }
+
+    if (unlikely(ctx->count != hm->count || ctx->nbuckets != hm->nbuckets)) {
+        uassert(ctx->count == hm->count && "multimap changed during iteration");
+        uassert(ctx->nbuckets == hm->nbuckets && "multimap changed during iteration");
+        return NULL;
+    }
+
+    if (hashmap_iter_key(hm, key, &ctx->cursor, &iterator->val)) {
+        iterator->idx.i = ctx->counter;
+        return iterator->val;
+    } else {
+        return NULL;
+    }
+}
+
+/**
+ * @brief Iterates over all multimap items (in arbitrary order), multimap must not be changed
+ * during iteration
+ *
+ * for$iter(my_item, it, multimap.iter(&mm, &it.iterator))
+ */
+void*
+multimap_iter(multimap_c* self, cex_iterator_s* iterator)
+{
+    uassert(self != NULL);
+    uassert(self->hashmap != NULL);
+    uassert(iterator != NULL);
+
+    struct hashmap* hm = self->hashmap;
+
+    struct iter_ctx
+    {
+        size_t nbuckets;
+        size_t count;
+        size_t cursor;
+        size_t counter;
+    }* ctx = (struct iter_ctx*)iterator->_ctx;
+    _Static_assert(sizeof(*ctx) <= sizeof(iterator->_ctx), "ctx size overflow");
+    _Static_assert(alignof(struct iter_ctx) == alignof(size_t), "ctx alignment mismatch");
+
+    if (unlikely(iterator->val == NULL)) {
+        if (hm->count == 0) {
+            return NULL;
+        }
+        *ctx = (struct iter_ctx){
+            .count = hm->count,
+            .nbuckets = hm->nbuckets,
+        };
+    } else {
+        ctx->counter++;
+    }
+
+    if (unlikely(ctx->count != hm->count || ctx->nbuckets != hm->nbuckets)) {
+        uassert(ctx->count == hm->count && "multimap changed during iteration");
+        uassert(ctx->nbuckets == hm->nbuckets && "multimap changed during iteration");
+        return NULL;
+    }
+
+    if (hashmap_iter(hm, &ctx->cursor, &iterator->val)) {
+        iterator->idx.i = ctx->counter;
+        return iterator->val;
+    } else {
+        return NULL;
+    }
+}
+const struct __module__multimap multimap = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = multimap_create,
+    .add = multimap_add,
+    .extend = multimap_extend,
+    .get = multimap_get,
+    .count = multimap_count,
+    .del = multimap_del,
+    .len = multimap_len,
+    .clear = multimap_clear,
+    .destroy = multimap_destroy,
+    .iter_key = multimap_iter_key,
+    .iter = multimap_iter,
+    // clang-format on
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include "cex.h"
+#include "dict.h"
+
+/**
+ * @brief Flat multimap, items with equal keys are stored inline in the hashmap buckets (in a
+ * contiguous bucket run), without per-key lists or extra allocations.
+ */
+typedef struct multimap_c
+{
+    void* hashmap; // any generic hashmap implementation
+} multimap_c;
+
+#define multimap$new(self, struct_type, key_field_name, allocator)                                 \
+    multimap.create(                                                                               \
+        self,                                                                                      \
+        sizeof(struct_type),                                                                       \
+        _Alignof(struct_type),                                                                     \
+        offsetof(struct_type, key_field_name),                                                     \
+        0, /* capacity = 0, default is 16 */                                                       \
+        _dict$hashfunc(struct_type, key_field_name),                                               \
+        _dict$cmpfunc(struct_type, key_field_name),                                                \
+        allocator                                                                                  \
+    )
+struct __module__multimap
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates new multimap() instance (use multimap$new() macro to pick hash/cmp by key field)
+ *
+ * @param self multimap() instance
+ * @param item_size size of item struct
+ * @param item_align item alignment (must not exceed alignof(size_t))
+ * @param item_key_offsetof offset of key field in item struct
+ * @param capacity initial capacity, 0 - default (16)
+ * @param hash_func key hash function (see dict.hashfunc)
+ * @param compare_func key compare function (see dict.hashfunc)
+ * @param allocator
+ * @return Error.argument on bad arguments, Error.memory on allocation failure
+ */
+Exception
+(*create)(multimap_c* self, size_t item_size, size_t item_align, size_t item_key_offsetof, size_t capacity, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator);
+
+/**
+ * @brief Add item to multimap (items with existing keys are not replaced)
+ *
+ * @param self multimap() instance
+ * @param item item key/value struct
+ * @return Error.memory on allocation failure
+ */
+Exception
+(*add)(multimap_c* self, const void* item);
+
+/**
+ * @brief Add all items from list_c (list element type must match multimap item type)
+ *
+ * @param self multimap() instance
+ * @param listptr list_c or list$define() instance of items
+ * @return
+ */
+Exception
+(*extend)(multimap_c* self, void* listptr);
+
+/**
+ * @brief Get first found item by key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ * @return item or NULL if not found
+ */
+void*
+(*get)(multimap_c* self, const void* key);
+
+/**
+ * @brief Number of items with equal key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ */
+size_t
+(*count)(multimap_c* self, const void* key);
+
+/**
+ * @brief Delete all items with equal key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ * @return number of deleted items
+ */
+size_t
+(*del)(multimap_c* self, const void* key);
+
+/**
+ * @brief Number of all items in multimap
+ *
+ * @param self multimap() instance
+ */
+size_t
+(*len)(multimap_c* self);
+
+/**
+ * @brief Clear all items (allocated capacity unchanged)
+ *
+ * @param self multimap() instance
+ */
+void
+(*clear)(multimap_c* self);
+
+/**
+ * @brief Free multimap() instance
+ *
+ * @param self multimap() instance
+ */
+void
+(*destroy)(multimap_c* self);
+
+/**
+ * @brief Iterates over all items with equal key, multimap must not be changed during iteration
+ *
+ * for$iter(my_item, it, multimap.iter_key(&mm, &key, &it.iterator))
+ */
+void*
+(*iter_key)(multimap_c* self, const void* key, cex_iterator_s* iterator);
+
+/**
+ * @brief Iterates over all multimap items (in arbitrary order), multimap must not be changed
+ * during iteration
+ *
+ * for$iter(my_item, it, multimap.iter(&mm, &it.iterator))
+ */
+void*
+(*iter)(multimap_c* self, cex_iterator_s* iterator);
+
+    // clang-format on
+};
+extern const struct __module__multimap multimap; // CEX Autogen
@@ -3,13 +3,28 @@
 #include "cex.h"
 #include <stdarg.h>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_mremap)
+#define SBUF__HAS_MREMAP 1
+#ifndef MREMAP_MAYMOVE
+#define MREMAP_MAYMOVE 1 // NOTE: only defined with _GNU_SOURCE
+#endif
+#else
+#define SBUF__HAS_MREMAP 0
+#endif
+
 struct _sbuf__sprintf_ctx
 {
     sbuf_head_s* head;
     char* buf;
     Exc err;
-    int count;
-    int length;
+    size_t count;
+    size_t length;
     char tmp[STB_SPRINTF_MIN];
 };
 
@@ -29,12 +44,12 @@ sbuf__head(sbuf_c self)
 static inline size_t
 sbuf__alloc_capacity(size_t capacity)
 {
-    uassert(capacity < INT32_MAX && "requested capacity exceeds 2gb, maybe overflow?");
+    uassert(capacity < PTRDIFF_MAX / 2 && "requested capacity is too big, maybe overflow?");
 
     capacity += sizeof(sbuf_head_s) + 1; // also +1 for nullterm
 
     if (capacity >= 512) {
-        return capacity * 1.2;
+        return capacity;
     } else {
         // Round up to closest pow*2 int
         u64 p = 4;
@@ -44,8 +59,62 @@ sbuf__alloc_capacity(size_t capacity)
         return p;
     }
 }
-static inline Exception
-sbuf__grow_buffer(sbuf_c* self, u32 length)
+
+#if SBUF__HAS_MREMAP
+static inline size_t
+sbuf__mmap_size(size_t size)
+{
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+static void*
+sbuf__mmap_malloc(size_t size)
+{
+    void* result = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (result == MAP_FAILED) ? NULL : result;
+}
+
+static void*
+sbuf__mmap_realloc(void* ptr, size_t new_size)
+{
+    // Page tables are moved by kernel, no data copy, old mapping is intact on failure
+    sbuf_head_s* head = ptr;
+    size_t old_size = head->capacity + sizeof(sbuf_head_s) + 1;
+    void* result = (void*)syscall(SYS_mremap, head, old_size, new_size, MREMAP_MAYMOVE);
+    return (result == MAP_FAILED) ? NULL : result;
+}
+
+static void
+sbuf__mmap_free(void* ptr)
+{
+    sbuf_head_s* head = ptr;
+    munmap(head, head->capacity + sizeof(sbuf_head_s) + 1);
+}
+
+// NOTE: allocator of sbuf_create_mmap() buffers, sizes must be page aligned
+static const Allocator_i sbuf__mmap_allocator = {
+    .malloc = sbuf__mmap_malloc,
+    .realloc = sbuf__mmap_realloc,
+    .free = sbuf__mmap_free,
+};
+#else
+static inline size_t
+sbuf__mmap_size(size_t size)
+{
+    return size;
+}
+
+// NOTE: no mremap() on this platform, sbuf_create_mmap() falls back to libc heap
+static const Allocator_i sbuf__mmap_allocator = {
+    .malloc = malloc,
+    .realloc = realloc,
+    .free = free,
+};
+#endif
+
+static Exception
+sbuf__resize_buffer(sbuf_c* self, size_t alloc_size)
 {
     sbuf_head_s* head = (sbuf_head_s*)(*self - sizeof(sbuf_head_s));
 
@@ -54,21 +123,39 @@ sbuf__grow_buffer(sbuf_c* self, u32 length)
         return Error.overflow;
     }
 
-    u32 new_capacity = sbuf__alloc_capacity(length);
-    head = head->allocator->realloc(head, new_capacity);
-    if (unlikely(head == NULL)) {
-        *self = NULL;
+    if (head->allocator == &sbuf__mmap_allocator) {
+        alloc_size = sbuf__mmap_size(alloc_size);
+    }
+
+    // NOTE: on failure realloc() keeps the old block, so the buffer stays valid and intact
+    void* result = head->allocator->realloc(head, alloc_size);
+    if (unlikely(result == NULL)) {
         return Error.memory;
     }
 
-    head->capacity = new_capacity - sizeof(sbuf_head_s) - 1,
+    head = result;
+    head->capacity = alloc_size - sizeof(sbuf_head_s) - 1,
     *self = (char*)head + sizeof(sbuf_head_s);
     (*self)[head->capacity] = '\0';
     return Error.ok;
 }
 
+static inline Exception
+sbuf__grow_buffer(sbuf_c* self, size_t length)
+{
+    sbuf_head_s* head = (sbuf_head_s*)(*self - sizeof(sbuf_head_s));
+    if (head->allocator != NULL && length <= head->capacity) {
+        // already fits (nullterm is out of capacity), don't grow
+        return Error.ok;
+    }
+    size_t alloc_size = sbuf__alloc_capacity(length);
+    size_t grow_size = SBUF_GROWTH(head->capacity + sizeof(sbuf_head_s) + 1, alloc_size);
+
+    return sbuf__resize_buffer(self, (grow_size > alloc_size) ? grow_size : alloc_size);
+}
+
 Exception
-sbuf_create(sbuf_c* self, u32 capacity, const Allocator_i* allocator)
+sbuf_create(sbuf_c* self, size_t capacity, const Allocator_i* allocator)
 {
     uassert(self != NULL);
     uassert(capacity != 0);
@@ -103,6 +190,18 @@ sbuf_create(sbuf_c* self, u32 capacity, const Allocator_i* allocator)
     return Error.ok;
 }
 
+Exception
+sbuf_create_mmap(sbuf_c* self, size_t capacity)
+{
+    // NOTE: opt-in for huge buffers, memory is mmap()-ed directly (bypassing Allocator_i)
+    // and grows via mremap() without copying data (Linux only, other platforms use libc heap)
+    return sbuf_create(
+        self,
+        sbuf__mmap_size(sbuf__alloc_capacity(capacity)),
+        &sbuf__mmap_allocator
+    );
+}
+
 Exception
 sbuf_create_static(sbuf_c* self, char* buf, size_t buf_size)
 {
@@ -143,7 +242,7 @@ sbuf_create_static(sbuf_c* self, char* buf, size_t buf_size)
 }
 
 Exception
-sbuf_grow(sbuf_c* self, u32 capacity)
+sbuf_grow(sbuf_c* self, size_t capacity)
 {
     sbuf_head_s* head = sbuf__head(*self);
     if (capacity <= head->capacity) {
@@ -153,6 +252,21 @@ sbuf_grow(sbuf_c* self, u32 capacity)
     return sbuf__grow_buffer(self, capacity);
 }
 
+Exception
+sbuf_reserve(sbuf_c* self, size_t additional)
+{
+    // NOTE: allocates exact capacity (unlike growth policy), to pre-size buffer for final output
+    uassert(self != NULL);
+    sbuf_head_s* head = sbuf__head(*self);
+    if (additional >= PTRDIFF_MAX / 2 - head->length) {
+        return Error.overflow;
+    }
+    if (head->length + additional <= head->capacity) {
+        return Error.ok;
+    }
+    return sbuf__resize_buffer(self, sbuf__alloc_capacity(head->length + additional));
+}
+
 void
 sbuf_update_len(sbuf_c* self)
 {
@@ -164,72 +278,170 @@ sbuf_update_len(sbuf_c* self)
     head->length = strlen(*self);
 }
 
-Exception
-sbuf_replace(sbuf_c* self, const str_c oldstr, const str_c newstr)
+typedef struct
 {
-    uassert(self != NULL);
-    uassert(oldstr.buf != newstr.buf && "old and new overlap");
-    uassert(*self != newstr.buf && "self and new overlap");
-    uassert(*self != oldstr.buf && "self and old overlap");
+    const str_c* pairs; // old/new pairs
+    u32 npairs;
+    u64 first[256]; // bitmask of patterns by their first byte (npairs > 1)
+} sbuf__replace_s;
 
-    sbuf_head_s* head = sbuf__head(*self);
+static inline ssize_t
+sbuf__replace_find(const sbuf__replace_s* ctx, const char* s, size_t len, size_t pos, u32* which)
+{
+    if (ctx->npairs == 1) {
+        const str_c old = ctx->pairs[0];
+        while (pos + old.len <= len) {
+            // memchr() is vectorized by libc, skips quickly to the next candidate
+            const char* f = memchr(&s[pos], old.buf[0], len - pos - old.len + 1);
+            if (f == NULL) {
+                return -1;
+            }
+            pos = f - s;
+            if (memcmp(f + 1, old.buf + 1, old.len - 1) == 0) {
+                *which = 0;
+                return pos;
+            }
+            pos++;
+        }
+        return -1;
+    }
 
-    if (unlikely(!str.is_valid(oldstr) || !str.is_valid(newstr) || oldstr.len == 0)) {
-        return Error.argument;
+    for (; pos < len; pos++) {
+        u64 mask = ctx->first[(u8)s[pos]];
+        while (mask) {
+            // lowest pattern index wins when several patterns match at the same position
+            u32 i = __builtin_ctzll(mask);
+            mask &= mask - 1;
+            const str_c old = ctx->pairs[i * 2];
+            if (old.len <= len - pos && memcmp(&s[pos], old.buf, old.len) == 0) {
+                *which = i;
+                return pos;
+            }
+        }
     }
+    return -1;
+}
 
-    str_c s = str.cbuf(*self, head->length);
+static Exception
+sbuf__replace(sbuf_c* self, sbuf__replace_s* ctx)
+{
+    sbuf_head_s* head = sbuf__head(*self);
+    size_t len = head->length;
 
-    if (unlikely(s.len == 0)) {
+    if (unlikely(len == 0)) {
         return Error.ok;
     }
 
-    u32 capacity = head->capacity;
+    if (ctx->npairs > 1) {
+        memset(ctx->first, 0, sizeof(ctx->first));
+        for (u32 i = 0; i < ctx->npairs; i++) {
+            ctx->first[(u8)ctx->pairs[i * 2].buf[0]] |= 1ULL << i;
+        }
+    }
 
-    ssize_t idx = -1;
-    while ((idx = str.find(s, oldstr, idx + 1, 0)) != -1) {
-        // pointer to start of the found `old`
+    // Pass 1: count matches, and find the maximum growth of any prefix of the result,
+    // this is how far the original text must be shifted to rebuild it in one forward pass
+    ptrdiff_t delta = 0;
+    ptrdiff_t max_delta = 0;
+    size_t count = 0;
+    size_t pos = 0;
+    ssize_t idx;
+    u32 which = 0;
+    while ((idx = sbuf__replace_find(ctx, *self, len, pos, &which)) != -1) {
+        const str_c* p = &ctx->pairs[which * 2];
+        delta += (ptrdiff_t)p[1].len - (ptrdiff_t)p[0].len;
+        if (delta > max_delta) {
+            max_delta = delta;
+        }
+        pos = idx + p[0].len;
+        count++;
+    }
 
-        char* f = &((*self)[idx]);
+    if (count == 0) {
+        return Error.ok;
+    }
 
-        if (oldstr.len == newstr.len) {
-            // Tokens exact match just replace
-            memcpy(f, newstr.buf, newstr.len);
-        } else if (newstr.len < oldstr.len) {
-            // Move remainder of a string to fill the gap
-            memcpy(f, newstr.buf, newstr.len);
-            memmove(f + newstr.len, f + oldstr.len, s.len - idx - oldstr.len);
-            s.len -= (oldstr.len - newstr.len);
-            if (newstr.len == 0) {
-                // NOTE: Edge case: replacing all by empty string, reset index again
-                idx--;
-            }
-        } else {
-            // Try resize
-            if (unlikely(s.len + (newstr.len - oldstr.len) > capacity - 1)) {
-                except_silent(err, sbuf__grow_buffer(self, s.len + (newstr.len - oldstr.len)))
-                {
-                    return err;
-                }
-                // re-fetch head in case of realloc
-                head = (sbuf_head_s*)(*self - sizeof(sbuf_head_s));
-                s.buf = *self;
-                f = &((*self)[idx]);
-            }
-            // Move exceeding string to avoid overwriting
-            memmove(f + newstr.len, f + oldstr.len, s.len - idx - oldstr.len + 1);
-            memcpy(f, newstr.buf, newstr.len);
-            s.len += (newstr.len - oldstr.len);
+    if (unlikely((size_t)max_delta >= PTRDIFF_MAX / 2 - len)) {
+        return Error.overflow;
+    }
+    if (len + max_delta > head->capacity) {
+        // grow at most once, before any byte is moved, failed resize keeps the old buffer intact
+        e$ret(sbuf__grow_buffer(self, len + max_delta));
+        head = sbuf__head(*self);
+    }
+
+    // Pass 2: rebuild, reading from the shifted original and writing from the start,
+    // the write position never passes the read position.
+    char* buf = *self;
+    char* src = buf + max_delta;
+    if (max_delta > 0) {
+        memmove(src, buf, len);
+    }
+
+    size_t w = 0;
+    pos = 0;
+    while ((idx = sbuf__replace_find(ctx, src, len, pos, &which)) != -1) {
+        const str_c* p = &ctx->pairs[which * 2];
+        size_t n = idx - pos;
+        if (buf + w != src + pos) {
+            memmove(buf + w, src + pos, n);
         }
+        w += n;
+        memcpy(buf + w, p[1].buf, p[1].len);
+        w += p[1].len;
+        pos = idx + p[0].len;
     }
+    memmove(buf + w, src + pos, len - pos);
+    w += len - pos;
 
-    head->length = s.len;
+    head->length = w;
     // always null terminate
-    (*self)[s.len] = '\0';
+    buf[w] = '\0';
 
     return Error.ok;
 }
 
+Exception
+sbuf_replace(sbuf_c* self, const str_c oldstr, const str_c newstr)
+{
+    uassert(self != NULL);
+    uassert(oldstr.buf != newstr.buf && "old and new overlap");
+    uassert(*self != newstr.buf && "self and new overlap");
+    uassert(*self != oldstr.buf && "self and old overlap");
+
+    if (unlikely(!str.is_valid(oldstr) || !str.is_valid(newstr) || oldstr.len == 0)) {
+        return Error.argument;
+    }
+
+    str_c pairs[2] = { oldstr, newstr };
+    sbuf__replace_s ctx = { .pairs = pairs, .npairs = 1 };
+    return sbuf__replace(self, &ctx);
+}
+
+Exception
+sbuf_replace_many(sbuf_c* self, const str_c* pairs, u32 pairs_len)
+{
+    uassert(self != NULL);
+    uassert(pairs != NULL);
+
+    if (unlikely(pairs == NULL || pairs_len == 0 || pairs_len % 2 != 0)) {
+        return Error.argument;
+    }
+    if (unlikely(pairs_len > SBUF_REPLACE_MAXPAIRS * 2)) {
+        return Error.argument;
+    }
+    for (u32 i = 0; i < pairs_len; i += 2) {
+        if (unlikely(!str.is_valid(pairs[i]) || !str.is_valid(pairs[i + 1]) || pairs[i].len == 0)) {
+            return Error.argument;
+        }
+        uassert(*self != pairs[i].buf && "self and old overlap");
+        uassert(*self != pairs[i + 1].buf && "self and new overlap");
+    }
+
+    sbuf__replace_s ctx = { .pairs = pairs, .npairs = pairs_len / 2 };
+    return sbuf__replace(self, &ctx);
+}
+
 Exception
 sbuf_append(sbuf_c* self, str_c s)
 {
@@ -269,6 +481,38 @@ sbuf_append(sbuf_c* self, str_c s)
     return Error.ok;
 }
 
+Exception
+sbuf_append_u64(sbuf_c* self, u64 value)
+{
+    // NOTE: bypasses format string parsing of sbuf.sprintf("%lu")
+    char buf[32];
+    u32 len = STB_SPRINTF_DECORATE(u64toa)(buf, value);
+    return sbuf_append(self, (str_c){ .buf = buf, .len = len });
+}
+
+Exception
+sbuf_append_i64(sbuf_c* self, i64 value)
+{
+    char buf[32];
+    u32 len = 0;
+    if (value < 0) {
+        buf[0] = '-';
+        len = 1 + STB_SPRINTF_DECORATE(u64toa)(buf + 1, -(u64)value);
+    } else {
+        len = STB_SPRINTF_DECORATE(u64toa)(buf, (u64)value);
+    }
+    return sbuf_append(self, (str_c){ .buf = buf, .len = len });
+}
+
+Exception
+sbuf_append_f64(sbuf_c* self, f64 value)
+{
+    // NOTE: shortest representation which parses back to the same value (str.to_f64() / strtod)
+    char buf[32];
+    u32 len = STB_SPRINTF_DECORATE(dtoa)(buf, value);
+    return sbuf_append(self, (str_c){ .buf = buf, .len = len });
+}
+
 void
 sbuf_clear(sbuf_c* self)
 {
@@ -278,7 +522,7 @@ sbuf_clear(sbuf_c* self)
     (*self)[head->length] = '\0';
 }
 
-u32
+size_t
 sbuf_len(const sbuf_c* self)
 {
     uassert(self != NULL);
@@ -286,7 +530,7 @@ sbuf_len(const sbuf_c* self)
     return head->length;
 }
 
-u32
+size_t
 sbuf_capacity(const sbuf_c* self)
 {
     uassert(self != NULL);
@@ -333,7 +577,7 @@ sbuf__sprintf_callback(const char* buf, void* user, int len)
     if (unlikely(ctx->length + len > ctx->count)) {
         bool buf_is_tmp = buf != ctx->buf;
 
-        if (len < 0 || ctx->length + len > INT32_MAX) {
+        if (len < 0) {
             ctx->err = Error.integrity;
             return ctx->tmp;
         }
@@ -377,8 +621,8 @@ sbuf__sprintf_callback(const char* buf, void* user, int len)
     return ((ctx->count - ctx->length) >= STB_SPRINTF_MIN) ? ctx->buf : ctx->tmp;
 }
 
-Exception
-sbuf_vsprintf(sbuf_c* self, const char* format, va_list va)
+static Exception
+sbuf__vsprintf(sbuf_c* self, const char* format, const sbuf_fmt_s* fmt, va_list va)
 {
     uassert(self != NULL);
     sbuf_head_s* head = sbuf__head(*self);
@@ -391,8 +635,13 @@ sbuf_vsprintf(sbuf_c* self, const char* format, va_list va)
         .count = head->capacity,
     };
 
-    STB_SPRINTF_DECORATE(vsprintfcb)
-    (sbuf__sprintf_callback, &ctx, sbuf__sprintf_callback(NULL, &ctx, 0), format, va);
+    if (fmt != NULL) {
+        STB_SPRINTF_DECORATE(vsprintfcb_fmt)
+        (sbuf__sprintf_callback, &ctx, sbuf__sprintf_callback(NULL, &ctx, 0), fmt, va);
+    } else {
+        STB_SPRINTF_DECORATE(vsprintfcb)
+        (sbuf__sprintf_callback, &ctx, sbuf__sprintf_callback(NULL, &ctx, 0), format, va);
+    }
 
     // re-fetch self in case of realloc in sbuf__sprintf_callback
     *self = ((char*)ctx.head + sizeof(sbuf_head_s));
@@ -404,6 +653,12 @@ sbuf_vsprintf(sbuf_c* self, const char* format, va_list va)
     return ctx.err;
 }
 
+Exception
+sbuf_vsprintf(sbuf_c* self, const char* format, va_list va)
+{
+    return sbuf__vsprintf(self, format, NULL, va);
+}
+
 Exception
 sbuf_sprintf(sbuf_c* self, const char* format, ...)
 {
@@ -415,6 +670,41 @@ sbuf_sprintf(sbuf_c* self, const char* format, ...)
     return result;
 }
 
+// Pre-parses format for sbuf.sprintf_fmt() / io.fprintf_fmt(), literals are not copied:
+// fmt keeps a pointer into format, so format must stay valid and unchanged while fmt is used
+// (string literals are fine, a stack or sbuf buffer is not if it is freed or rewritten earlier)
+Exception
+sbuf_fmt_compile(sbuf_fmt_s* fmt, const char* format)
+{
+    if (fmt == NULL || format == NULL) {
+        return Error.argument;
+    }
+    if (STB_SPRINTF_DECORATE(compile)(fmt, format) < 0) {
+        // more than SBUF_FMT_MAXOPS conversions, consider increasing it
+        memset(fmt, 0, sizeof(*fmt));
+        return Error.overflow;
+    }
+    return Error.ok;
+}
+
+Exception
+sbuf_vsprintf_fmt(sbuf_c* self, const sbuf_fmt_s* fmt, va_list va)
+{
+    uassert(fmt != NULL);
+    uassert(fmt->fmt != NULL && "not compiled");
+    return sbuf__vsprintf(self, NULL, fmt, va);
+}
+
+Exception
+sbuf_sprintf_fmt(sbuf_c* self, const sbuf_fmt_s* fmt, ...)
+{
+    va_list va;
+    va_start(va, fmt);
+    Exc result = sbuf_vsprintf_fmt(self, fmt, va);
+    va_end(va);
+    return result;
+}
+
 str_c
 sbuf_to_str(sbuf_c* self)
 {
@@ -553,17 +843,26 @@ const struct __module__sbuf sbuf = {
     // Autogenerated by CEX
     // clang-format off
     .create = sbuf_create,
+    .create_mmap = sbuf_create_mmap,
     .create_static = sbuf_create_static,
     .grow = sbuf_grow,
+    .reserve = sbuf_reserve,
     .update_len = sbuf_update_len,
     .replace = sbuf_replace,
+    .replace_many = sbuf_replace_many,
     .append = sbuf_append,
+    .append_u64 = sbuf_append_u64,
+    .append_i64 = sbuf_append_i64,
+    .append_f64 = sbuf_append_f64,
     .clear = sbuf_clear,
     .len = sbuf_len,
     .capacity = sbuf_capacity,
     .destroy = sbuf_destroy,
     .vsprintf = sbuf_vsprintf,
     .sprintf = sbuf_sprintf,
+    .fmt_compile = sbuf_fmt_compile,
+    .vsprintf_fmt = sbuf_vsprintf_fmt,
+    .sprintf_fmt = sbuf_sprintf_fmt,
     .to_str = sbuf_to_str,
     .isvalid = sbuf_isvalid,
     .iter_split = sbuf_iter_split,
@@ -12,14 +12,61 @@ typedef struct
         u32 elsize : 8;   // maybe multibyte strings in the future?
         u32 nullterm : 8; // always zero to prevent usage of direct buffer
     } header;
-    u32 length;
-    u32 capacity;
+    size_t length;
+    size_t capacity;
     const Allocator_i* allocator;
 } __attribute__((packed)) sbuf_head_s;
 
 _Static_assert(alignof(sbuf_head_s) == 1, "align");
 _Static_assert(alignof(sbuf_head_s) == alignof(char), "align");
 
+// Growth policy: returns new allocation size when growing from old_size to at least req_size,
+// define before including cex.h to override, e.g. sbuf_growth_x1_5(old_size, req_size)
+#ifndef SBUF_GROWTH
+#define SBUF_GROWTH(old_size, req_size) sbuf_growth_x2(old_size, req_size)
+#endif
+
+// max number of old/new pairs in sbuf.replace_many() (pattern set is a u64 bitmask)
+#define SBUF_REPLACE_MAXPAIRS 64
+
+static inline size_t
+sbuf_growth_x2(size_t old_size, size_t req_size)
+{
+    (void)req_size;
+    return old_size * 2;
+}
+
+static inline size_t
+sbuf_growth_x1_5(size_t old_size, size_t req_size)
+{
+    (void)req_size;
+    return old_size + old_size / 2;
+}
+
+// max number of conversions in format compiled by sbuf.fmt_compile()
+#ifndef SBUF_FMT_MAXOPS
+#define SBUF_FMT_MAXOPS 16
+#endif
+
+typedef struct
+{
+    u32 fl;       // stb_sprintf flags
+    i32 fw;       // field width
+    i32 pr;       // precision
+    u32 lit_off;  // literal text before conversion
+    u32 lit_len;  //
+    u32 conv_off; // conversion character offset, 0 - end of format
+} sbuf_fmt_op_s;
+
+// Pre-compiled format string, see sbuf.fmt_compile()
+// NOTE: literal text is referenced (not copied), the format string must outlive sbuf_fmt_s
+typedef struct sbuf_fmt_s
+{
+    const char* fmt; // borrowed format string, ops[] offsets point into it
+    u32 nops;
+    sbuf_fmt_op_s ops[SBUF_FMT_MAXOPS + 1]; // conversions + trailing literal text
+} sbuf_fmt_s;
+
 
 struct __module__sbuf
 {
@@ -27,13 +74,19 @@ struct __module__sbuf
     // clang-format off
 
 Exception
-(*create)(sbuf_c* self, u32 capacity, const Allocator_i* allocator);
+(*create)(sbuf_c* self, size_t capacity, const Allocator_i* allocator);
+
+Exception
+(*create_mmap)(sbuf_c* self, size_t capacity);
 
 Exception
 (*create_static)(sbuf_c* self, char* buf, size_t buf_size);
 
 Exception
-(*grow)(sbuf_c* self, u32 capacity);
+(*grow)(sbuf_c* self, size_t capacity);
+
+Exception
+(*reserve)(sbuf_c* self, size_t additional);
 
 void
 (*update_len)(sbuf_c* self);
@@ -41,16 +94,28 @@ void
 Exception
 (*replace)(sbuf_c* self, const str_c oldstr, const str_c newstr);
 
+Exception
+(*replace_many)(sbuf_c* self, const str_c* pairs, u32 pairs_len);
+
 Exception
 (*append)(sbuf_c* self, str_c s);
 
+Exception
+(*append_u64)(sbuf_c* self, u64 value);
+
+Exception
+(*append_i64)(sbuf_c* self, i64 value);
+
+Exception
+(*append_f64)(sbuf_c* self, f64 value);
+
 void
 (*clear)(sbuf_c* self);
 
-u32
+size_t
 (*len)(const sbuf_c* self);
 
-u32
+size_t
 (*capacity)(const sbuf_c* self);
 
 sbuf_c
@@ -62,6 +127,19 @@ Exception
 Exception
 (*sprintf)(sbuf_c* self, const char* format, ...);
 
+// Pre-parses format for sbuf.sprintf_fmt() / io.fprintf_fmt(), literals are not copied:
+// fmt keeps a pointer into format, so format must stay valid and unchanged while fmt is used
+// (string literals are fine, a stack or sbuf buffer is not if it is freed or rewritten earlier)
+
+Exception
+(*fmt_compile)(sbuf_fmt_s* fmt, const char* format);
+
+Exception
+(*vsprintf_fmt)(sbuf_c* self, const sbuf_fmt_s* fmt, va_list va);
+
+Exception
+(*sprintf_fmt)(sbuf_c* self, const sbuf_fmt_s* fmt, ...);
+
 str_c
 (*to_str)(sbuf_c* self);
 
@@ -135,6 +135,42 @@ Exception
 Exception
 (*to_u64)(str_c self, u64* num);
 
+/**
+ * @brief Parses array of str_c tokens (e.g. CSV column) into i64 array in one call
+ *
+ * @param items input tokens
+ * @param nitems number of tokens
+ * @param out output array (capacity >= nitems)
+ * @param err_idx index of the first failed token (optional, may be NULL)
+ * @return first error, all tokens before *err_idx are parsed
+ */
+Exception
+(*to_i64_batch)(const str_c* items, size_t nitems, i64* out, size_t* err_idx);
+
+/**
+ * @brief Parses array of str_c tokens (e.g. CSV column) into u64 array in one call
+ *
+ * @param items input tokens
+ * @param nitems number of tokens
+ * @param out output array (capacity >= nitems)
+ * @param err_idx index of the first failed token (optional, may be NULL)
+ * @return first error, all tokens before *err_idx are parsed
+ */
+Exception
+(*to_u64_batch)(const str_c* items, size_t nitems, u64* out, size_t* err_idx);
+
+/**
+ * @brief Parses array of str_c tokens (e.g. CSV column) into f64 array in one call
+ *
+ * @param items input tokens
+ * @param nitems number of tokens
+ * @param out output array (capacity >= nitems)
+ * @param err_idx index of the first failed token (optional, may be NULL)
+ * @return first error, all tokens before *err_idx are parsed
+ */
+Exception
+(*to_f64_batch)(const str_c* items, size_t nitems, f64* out, size_t* err_idx);
+
     // clang-format on
 };
 extern const struct __module__str str; // CEX Autogen
@@ -58,6 +58,7 @@ extern const struct _CEX_Error_struct
     Exc skip;
     Exc empty;
     Exc eof;
+    Exc timeout;
     Exc argsparse;
     Exc runtime;
     Exc assert;
@@ -1101,6 +1102,42 @@ Exception
 Exception
 (*to_u64)(str_c self, u64* num);
 
+/**
+ * @brief Parses array of str_c tokens (e.g. CSV column) into i64 array in one call
+ *
+ * @param items input tokens
+ * @param nitems number of tokens
+ * @param out output array (capacity >= nitems)
+ * @param err_idx index of the first failed token (optional, may be NULL)
+ * @return first error, all tokens before *err_idx are parsed
+ */
+Exception
+(*to_i64_batch)(const str_c* items, size_t nitems, i64* out, size_t* err_idx);
+
+/**
+ * @brief Parses array of str_c tokens (e.g. CSV column) into u64 array in one call
+ *
+ * @param items input tokens
+ * @param nitems number of tokens
+ * @param out output array (capacity >= nitems)
+ * @param err_idx index of the first failed token (optional, may be NULL)
+ * @return first error, all tokens before *err_idx are parsed
+ */
+Exception
+(*to_u64_batch)(const str_c* items, size_t nitems, u64* out, size_t* err_idx);
+
+/**
+ * @brief Parses array of str_c tokens (e.g. CSV column) into f64 array in one call
+ *
+ * @param items input tokens
+ * @param nitems number of tokens
+ * @param out output array (capacity >= nitems)
+ * @param err_idx index of the first failed token (optional, may be NULL)
+ * @return first error, all tokens before *err_idx are parsed
+ */
+Exception
+(*to_f64_batch)(const str_c* items, size_t nitems, f64* out, size_t* err_idx);
+
     // clang-format on
 };
 extern const struct __module__str str; // CEX Autogen
@@ -1119,14 +1156,61 @@ typedef struct
         u32 elsize : 8;   // maybe multibyte strings in the future?
         u32 nullterm : 8; // always zero to prevent usage of direct buffer
     } header;
-    u32 length;
-    u32 capacity;
+    size_t length;
+    size_t capacity;
     const Allocator_i* allocator;
 } __attribute__((packed)) sbuf_head_s;
 
 _Static_assert(alignof(sbuf_head_s) == 1, "align");
 _Static_assert(alignof(sbuf_head_s) == alignof(char), "align");
 
+// Growth policy: returns new allocation size when growing from old_size to at least req_size,
+// define before including cex.h to override, e.g. sbuf_growth_x1_5(old_size, req_size)
+#ifndef SBUF_GROWTH
+#define SBUF_GROWTH(old_size, req_size) sbuf_growth_x2(old_size, req_size)
+#endif
+
+// max number of old/new pairs in sbuf.replace_many() (pattern set is a u64 bitmask)
+#define SBUF_REPLACE_MAXPAIRS 64
+
+static inline size_t
+sbuf_growth_x2(size_t old_size, size_t req_size)
+{
+    (void)req_size;
+    return old_size * 2;
+}
+
+static inline size_t
+sbuf_growth_x1_5(size_t old_size, size_t req_size)
+{
+    (void)req_size;
+    return old_size + old_size / 2;
+}
+
+// max number of conversions in format compiled by sbuf.fmt_compile()
+#ifndef SBUF_FMT_MAXOPS
+#define SBUF_FMT_MAXOPS 16
+#endif
+
+typedef struct
+{
+    u32 fl;       // stb_sprintf flags
+    i32 fw;       // field width
+    i32 pr;       // precision
+    u32 lit_off;  // literal text before conversion
+    u32 lit_len;  //
+    u32 conv_off; // conversion character offset, 0 - end of format
+} sbuf_fmt_op_s;
+
+// Pre-compiled format string, see sbuf.fmt_compile()
+// NOTE: literal text is referenced (not copied), the format string must outlive sbuf_fmt_s
+typedef struct sbuf_fmt_s
+{
+    const char* fmt; // borrowed format string, ops[] offsets point into it
+    u32 nops;
+    sbuf_fmt_op_s ops[SBUF_FMT_MAXOPS + 1]; // conversions + trailing literal text
+} sbuf_fmt_s;
+
 
 struct __module__sbuf
 {
@@ -1134,13 +1218,19 @@ struct __module__sbuf
     // clang-format off
 
 Exception
-(*create)(sbuf_c* self, u32 capacity, const Allocator_i* allocator);
+(*create)(sbuf_c* self, size_t capacity, const Allocator_i* allocator);
+
+Exception
+(*create_mmap)(sbuf_c* self, size_t capacity);
 
 Exception
 (*create_static)(sbuf_c* self, char* buf, size_t buf_size);
 
 Exception
-(*grow)(sbuf_c* self, u32 capacity);
+(*grow)(sbuf_c* self, size_t capacity);
+
+Exception
+(*reserve)(sbuf_c* self, size_t additional);
 
 void
 (*update_len)(sbuf_c* self);
@@ -1148,16 +1238,28 @@ void
 Exception
 (*replace)(sbuf_c* self, const str_c oldstr, const str_c newstr);
 
+Exception
+(*replace_many)(sbuf_c* self, const str_c* pairs, u32 pairs_len);
+
 Exception
 (*append)(sbuf_c* self, str_c s);
 
+Exception
+(*append_u64)(sbuf_c* self, u64 value);
+
+Exception
+(*append_i64)(sbuf_c* self, i64 value);
+
+Exception
+(*append_f64)(sbuf_c* self, f64 value);
+
 void
 (*clear)(sbuf_c* self);
 
-u32
+size_t
 (*len)(const sbuf_c* self);
 
-u32
+size_t
 (*capacity)(const sbuf_c* self);
 
 sbuf_c
@@ -1169,6 +1271,19 @@ Exception
 Exception
 (*sprintf)(sbuf_c* self, const char* format, ...);
 
+// Pre-parses format for sbuf.sprintf_fmt() / io.fprintf_fmt(), literals are not copied:
+// fmt keeps a pointer into format, so format must stay valid and unchanged while fmt is used
+// (string literals are fine, a stack or sbuf buffer is not if it is freed or rewritten earlier)
+
+Exception
+(*fmt_compile)(sbuf_fmt_s* fmt, const char* format);
+
+Exception
+(*vsprintf_fmt)(sbuf_c* self, const sbuf_fmt_s* fmt, va_list va);
+
+Exception
+(*sprintf_fmt)(sbuf_c* self, const sbuf_fmt_s* fmt, ...);
+
 str_c
 (*to_str)(sbuf_c* self);
 
@@ -1297,7 +1412,9 @@ extern const struct __module__list list; // CEX Autogen
 
 typedef struct dict_c
 {
-    void* hashmap; // any generic hashmap implementation
+    void* hashmap;     // any generic hashmap implementation
+    void* _image;      // read-only mmapped image, see dict.load_image()
+    size_t _image_len; // mmapped image length
 } dict_c;
 
 typedef u64 (*dict_hash_func_f)(const void* item, u64 seed0, u64 seed1);
@@ -1308,11 +1425,23 @@ typedef void (*dict_elfree_func_f)(void* item);
 // Hack for getting hash/cmp functions by a type of key field
 // https://gustedt.wordpress.com/2015/05/11/the-controlling-expression-of-_generic/
 // FIX: this is not compatible with MSVC
+// NOTE: str_c keys store only a view, key bytes live outside the dict item (e.g. mmapped file or
+// interned string arena), and they must outlive the dict
 #define _dict$hashfunc_field(strucfield)                                                           \
-    _Generic(&(strucfield), u64 *: dict.hashfunc.u64_hash, char(*)[]: dict.hashfunc.str_hash)
+    _Generic(                                                                                      \
+        &(strucfield),                                                                             \
+        u64 *: dict.hashfunc.u64_hash,                                                             \
+        char(*)[]: dict.hashfunc.str_hash,                                                         \
+        str_c *: dict.hashfunc.cexstr_hash                                                         \
+    )
 
 #define _dict$cmpfunc_field(strucfield)                                                            \
-    _Generic(&(strucfield), u64 *: dict.hashfunc.u64_cmp, char(*)[]: dict.hashfunc.str_cmp)
+    _Generic(                                                                                      \
+        &(strucfield),                                                                             \
+        u64 *: dict.hashfunc.u64_cmp,                                                              \
+        char(*)[]: dict.hashfunc.str_cmp,                                                          \
+        str_c *: dict.hashfunc.cexstr_cmp                                                          \
+    )
 
 #define _dict$hashfunc(struct, field) _dict$hashfunc_field(((struct){ 0 }.field))
 
@@ -1335,6 +1464,19 @@ typedef void (*dict_elfree_func_f)(void* item);
     )
 
 
+// Loads read-only dict image made by dict.save_image(), struct_type/key_field_name must match
+// with saved dict()
+#define dict$load_image(self, struct_type, key_field_name, path, allocator)                        \
+    dict.load_image(                                                                               \
+        self,                                                                                      \
+        path,                                                                                      \
+        sizeof(struct_type),                                                                       \
+        offsetof(struct_type, key_field_name),                                                     \
+        _dict$hashfunc(struct_type, key_field_name),                                               \
+        _dict$cmpfunc(struct_type, key_field_name),                                                \
+        allocator                                                                                  \
+    )
+
 struct __module__dict
 {
     // Autogenerated by CEX
@@ -1376,7 +1518,7 @@ struct {  // sub-module .hashfunc >>>
     (*str_cmp)(const void* a, const void* b, void* udata);
 
     /**
-     * @brief Compares static char[] buffer keys **must be null terminated**
+     * @brief Hashes static char[] buffer keys **must be null terminated**
      *
      * @param item
      * @param seed0
@@ -1386,6 +1528,28 @@ struct {  // sub-module .hashfunc >>>
     u64
     (*str_hash)(const void* item, u64 seed0, u64 seed1);
 
+    /**
+     * @brief Compares str_c keys (length aware, no null terminator required)
+     *
+     * @param a  str_c*
+     * @param b  str_c*
+     * @param udata  (unused)
+     * @return compared int value
+     */
+    int
+    (*cexstr_cmp)(const void* a, const void* b, void* udata);
+
+    /**
+     * @brief Hashes str_c keys by length, without strlen() or copying into char[] buffer
+     *
+     * @param item str_c*
+     * @param seed0
+     * @param seed1
+     * @return
+     */
+    u64
+    (*cexstr_hash)(const void* item, u64 seed0, u64 seed1);
+
 } hashfunc;  // sub-module .hashfunc <<<
 Exception
 (*create)(dict_c* self, size_t item_size, size_t item_align, size_t item_key_offsetof, size_t capacity, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator, dict_elfree_func_f elfree, void* udata);
@@ -1409,6 +1573,15 @@ Exception
 void*
 (*geti)(dict_c* self, u64 key);
 
+/**
+ * @brief Get item by str_c key (for dicts with str_c key field)
+ *
+ * @param self dict() instance
+ * @param key str_c key
+ */
+void*
+(*gets)(dict_c* self, str_c key);
+
 /**
  * @brief Get item by generic key pointer (including strings)
  *
@@ -1453,6 +1626,15 @@ void
 void*
 (*deli)(dict_c* self, u64 key);
 
+/**
+ * @brief Delete item by str_c key (for dicts with str_c key field)
+ *
+ * @param self dict() instance
+ * @param key str_c key
+ */
+void*
+(*dels)(dict_c* self, str_c key);
+
 /**
  * @brief Delete item by generic key pointer (including strings)
  *
@@ -1468,15 +1650,319 @@ void*
 Exception
 (*tolist)(dict_c* self, void* listptr, const Allocator_i* allocator);
 
+/**
+ * @brief Saves dict() hash table into the file as is (pointer-free image), which can be loaded
+ * via dict.load_image() without any deserialization.
+ *
+ * NOTE: dict items must not contain pointers (str_c keys are not supported)
+ *
+ * @param self dict() instance
+ * @param path output file path
+ * @return
+ */
+Exception
+(*save_image)(dict_c* self, const char* path);
+
+/**
+ * @brief Loads read-only dict() from the image made by dict.save_image(), the file is mmapped
+ * (shared pages across processes), and queried in place. Use dict$load_image() macro.
+ *
+ * NOTE: dict.set() returns Error.integrity, and dict.del*() / dict.clear() are ignored.
+ * NOTE: every item is re-hashed on load to validate the image (O(n), but no copying)
+ *
+ * @param self dict() instance
+ * @param path image file path
+ * @param item_size must match with saved dict item_size
+ * @param item_key_offsetof must match with saved dict item_key_offsetof
+ * @param hash_func must be the same as saved dict hash_func
+ * @param compare_func
+ * @param allocator
+ * @return
+ */
+Exception
+(*load_image)(dict_c* self, const char* path, size_t item_size, size_t item_key_offsetof, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator);
+
     // clang-format on
 };
 extern const struct __module__dict dict; // CEX Autogen
 
+/*
+*                   hashset.h
+*/
+
+/**
+ * @brief Hash set (key only container), uses the same open addressing hashmap as dict_c
+ */
+typedef struct hashset_c
+{
+    void* hashmap; // any generic hashmap implementation
+} hashset_c;
+
+// NOTE: key_type can be u64, char[N] (null terminated), or str_c (key bytes must outlive the set)
+#define hashset$new(self, key_type, allocator)                                                     \
+    hashset.create(                                                                                \
+        self,                                                                                      \
+        sizeof(key_type),                                                                          \
+        _Alignof(key_type),                                                                        \
+        0, /* capacity = 0, default is 16 */                                                       \
+        _dict$hashfunc_field(((key_type){ 0 })),                                                   \
+        _dict$cmpfunc_field(((key_type){ 0 })),                                                    \
+        allocator                                                                                  \
+    )
+struct __module__hashset
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates new hashset() instance (use hashset$new() macro to pick hash/cmp by key type)
+ *
+ * @param self hashset() instance
+ * @param key_size size of key in bytes
+ * @param key_align key alignment (must not exceed alignof(size_t))
+ * @param capacity initial capacity, 0 - default (16)
+ * @param hash_func key hash function (see dict.hashfunc)
+ * @param compare_func key compare function (see dict.hashfunc)
+ * @param allocator
+ * @return Error.argument on bad arguments, Error.memory on allocation failure
+ */
+Exception
+(*create)(hashset_c* self, size_t key_size, size_t key_align, size_t capacity, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator);
+
+/**
+ * @brief Add key to the set (no-op if key already exists)
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ * @return Error.memory on allocation failure
+ */
+Exception
+(*add)(hashset_c* self, const void* key);
+
+/**
+ * @brief Add all keys from list_c (list element type must match set key type)
+ *
+ * @param self hashset() instance
+ * @param listptr list_c or list$define() instance of keys
+ * @return
+ */
+Exception
+(*extend)(hashset_c* self, void* listptr);
+
+/**
+ * @brief Check if key exists in the set
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ */
+bool
+(*has)(hashset_c* self, const void* key);
+
+/**
+ * @brief Delete key from the set
+ *
+ * @param self hashset() instance
+ * @param key pointer to key
+ * @return true if key existed
+ */
+bool
+(*del)(hashset_c* self, const void* key);
+
+/**
+ * @brief Number of keys in the set
+ *
+ * @param self hashset() instance
+ */
+size_t
+(*len)(hashset_c* self);
+
+/**
+ * @brief Clear all keys (allocated capacity unchanged)
+ *
+ * @param self hashset() instance
+ */
+void
+(*clear)(hashset_c* self);
+
+/**
+ * @brief Free hashset() instance
+ *
+ * @param self hashset() instance
+ */
+void
+(*destroy)(hashset_c* self);
+
+/**
+ * @brief Iterates over set keys (in arbitrary order), set must not be changed during iteration
+ *
+ * for$iter(u64, it, hashset.iter(&set, &it.iterator))
+ */
+void*
+(*iter)(hashset_c* self, cex_iterator_s* iterator);
+
+    // clang-format on
+};
+extern const struct __module__hashset hashset; // CEX Autogen
+
+/*
+*                   multimap.h
+*/
+
+/**
+ * @brief Flat multimap, items with equal keys are stored inline in the hashmap buckets (in a
+ * contiguous bucket run), without per-key lists or extra allocations.
+ */
+typedef struct multimap_c
+{
+    void* hashmap; // any generic hashmap implementation
+} multimap_c;
+
+#define multimap$new(self, struct_type, key_field_name, allocator)                                 \
+    multimap.create(                                                                               \
+        self,                                                                                      \
+        sizeof(struct_type),                                                                       \
+        _Alignof(struct_type),                                                                     \
+        offsetof(struct_type, key_field_name),                                                     \
+        0, /* capacity = 0, default is 16 */                                                       \
+        _dict$hashfunc(struct_type, key_field_name),                                               \
+        _dict$cmpfunc(struct_type, key_field_name),                                                \
+        allocator                                                                                  \
+    )
+struct __module__multimap
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates new multimap() instance (use multimap$new() macro to pick hash/cmp by key field)
+ *
+ * @param self multimap() instance
+ * @param item_size size of item struct
+ * @param item_align item alignment (must not exceed alignof(size_t))
+ * @param item_key_offsetof offset of key field in item struct
+ * @param capacity initial capacity, 0 - default (16)
+ * @param hash_func key hash function (see dict.hashfunc)
+ * @param compare_func key compare function (see dict.hashfunc)
+ * @param allocator
+ * @return Error.argument on bad arguments, Error.memory on allocation failure
+ */
+Exception
+(*create)(multimap_c* self, size_t item_size, size_t item_align, size_t item_key_offsetof, size_t capacity, dict_hash_func_f hash_func, dict_compare_func_f compare_func, const Allocator_i* allocator);
+
+/**
+ * @brief Add item to multimap (items with existing keys are not replaced)
+ *
+ * @param self multimap() instance
+ * @param item item key/value struct
+ * @return Error.memory on allocation failure
+ */
+Exception
+(*add)(multimap_c* self, const void* item);
+
+/**
+ * @brief Add all items from list_c (list element type must match multimap item type)
+ *
+ * @param self multimap() instance
+ * @param listptr list_c or list$define() instance of items
+ * @return
+ */
+Exception
+(*extend)(multimap_c* self, void* listptr);
+
+/**
+ * @brief Get first found item by key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ * @return item or NULL if not found
+ */
+void*
+(*get)(multimap_c* self, const void* key);
+
+/**
+ * @brief Number of items with equal key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ */
+size_t
+(*count)(multimap_c* self, const void* key);
+
+/**
+ * @brief Delete all items with equal key
+ *
+ * @param self multimap() instance
+ * @param key generic pointer key
+ * @return number of deleted items
+ */
+size_t
+(*del)(multimap_c* self, const void* key);
+
+/**
+ * @brief Number of all items in multimap
+ *
+ * @param self multimap() instance
+ */
+size_t
+(*len)(multimap_c* self);
+
+/**
+ * @brief Clear all items (allocated capacity unchanged)
+ *
+ * @param self multimap() instance
+ */
+void
+(*clear)(multimap_c* self);
+
+/**
+ * @brief Free multimap() instance
+ *
+ * @param self multimap() instance
+ */
+void
+(*destroy)(multimap_c* self);
+
+/**
+ * @brief Iterates over all items with equal key, multimap must not be changed during iteration
+ *
+ * for$iter(my_item, it, multimap.iter_key(&mm, &key, &it.iterator))
+ */
+void*
+(*iter_key)(multimap_c* self, const void* key, cex_iterator_s* iterator);
+
+/**
+ * @brief Iterates over all multimap items (in arbitrary order), multimap must not be changed
+ * during iteration
+ *
+ * for$iter(my_item, it, multimap.iter(&mm, &it.iterator))
+ */
+void*
+(*iter)(multimap_c* self, cex_iterator_s* iterator);
+
+    // clang-format on
+};
+extern const struct __module__multimap multimap; // CEX Autogen
+
 /*
 *                   io.h
 */
 #include <stdio.h>
 
+// io.writev() payloads smaller than this go through stdio buffer, bigger ones bypass it
+#ifndef IO_WRITEV_MIN_SIZE
+#define IO_WRITEV_MIN_SIZE 4096
+#endif
+
+// io.fopen_atomic() writes into a temp file in the same directory, io.commit() renames it over
+// the target file, io.close() without io.commit() removes it (target is untouched, e.g. on error)
+#define IO_ATOMIC_SYNC 0x1     // fdatasync() file before rename, and fsync() its directory after
+#define IO_ATOMIC_DONTNEED 0x2 // drop written pages from page cache while writing and on commit
+
+// IO_ATOMIC_DONTNEED: written data is synced and dropped from page cache every this many bytes,
+// so big outputs don't evict hot pages of other files long before io.commit()
+#ifndef IO_ATOMIC_DONTNEED_CHUNK
+#define IO_ATOMIC_DONTNEED_CHUNK (8 * 1024 * 1024)
+#endif
 
 typedef struct io_c
 {
@@ -1484,10 +1970,14 @@ typedef struct io_c
     size_t _fsize;
     char* _fbuf;
     size_t _fbuf_size;
+    char* _atomic_path; // io.fopen_atomic(): temp file path + '\0' + target path
+    size_t _dontneed_off; // IO_ATOMIC_DONTNEED: file data before this offset is dropped from cache
     const Allocator_i* _allocator;
     struct
     {
         u32 is_attached : 1;
+        u32 is_sync : 1;
+        u32 is_dontneed : 1;
 
     } _flags;
 } io_c;
@@ -1498,9 +1988,14 @@ struct __module__io
     // Autogenerated by CEX
     // clang-format off
 
+// NOTE: only defined with _GNU_SOURCE
+
 Exception
 (*fopen)(io_c* self, const char* filename, const char* mode, const Allocator_i* allocator);
 
+Exception
+(*fopen_atomic)(io_c* self, const char* filename, u32 flags, const Allocator_i* allocator);
+
 Exception
 (*fattach)(io_c* self, FILE* fh, const Allocator_i* allocator);
 
@@ -1537,15 +2032,27 @@ Exception
 Exception
 (*fprintf)(io_c* self, const char* format, ...);
 
+Exception
+(*fprintf_fmt)(io_c* self, const sbuf_fmt_s* fmt, ...);
+
 void
 (*printf)(const char* format, ...);
 
 Exception
 (*write)(io_c* self, void* obj_buffer, size_t obj_el_size, size_t obj_count);
 
+// written (optional) - bytes passed to file (also on failure), big payloads bypass stdio buffer
+// so they are already in fd on partial failure
+
+Exception
+(*writev)(io_c* self, str_c* parts, size_t n, size_t* written);
+
 void
 (*close)(io_c* self);
 
+Exception
+(*commit)(io_c* self);
+
     // clang-format on
 };
 extern const struct __module__io io; // CEX Autogen
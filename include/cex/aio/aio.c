@@ -0,0 +1,873 @@
+#include "aio.h"
+#include <cex.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define AIO__HAS_URING 1
+#endif
+#endif
+
+#ifndef AIO__HAS_URING
+#define AIO__HAS_URING 0
+#endif
+
+// res - bytes of the last transfer (not accounted in op->_done yet), or -errno
+static void
+aio__op_complete(aio_op_s* op, ssize_t res)
+{
+    if (res < 0) {
+        op->error = Error.io;
+        op->nbytes = op->_done;
+    } else {
+        op->error = EOK;
+        op->nbytes = op->_done + res;
+    }
+}
+
+static void
+aio__backlog_push(aio_c* self, aio_op_s* op)
+{
+    op->_next = NULL;
+    if (self->_backlog_tail == NULL) {
+        self->_backlog = op;
+    } else {
+        self->_backlog_tail->_next = op;
+    }
+    self->_backlog_tail = op;
+}
+
+/*
+ *                  THREAD-POOL BACKEND
+ */
+
+static void*
+aio__pool_worker(void* arg)
+{
+    aio__pool_s* pool = arg;
+
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop && pool->queue_head == NULL) {
+            pthread_cond_wait(&pool->has_work, &pool->lock);
+        }
+        if (pool->queue_head == NULL) {
+            // stopping, and queue is empty
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        aio_op_s* op = pool->queue_head;
+        pool->queue_head = op->_next;
+        if (pool->queue_head == NULL) {
+            pool->queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        ssize_t res = 0;
+        while (op->_done < op->len) {
+            char* buf = (char*)op->buf + op->_done;
+            size_t len = op->len - op->_done;
+            off_t offset = op->offset + op->_done;
+
+            res = (op->kind == AIO_OP_READ) ? pread(op->fd, buf, len, offset)
+                                            : pwrite(op->fd, buf, len, offset);
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            if (res <= 0) {
+                // error or end of file
+                break;
+            }
+            op->_done += res;
+            if (op->kind == AIO_OP_READ) {
+                // short read is returned as is, like read() does
+                break;
+            }
+        }
+        aio__op_complete(op, (res < 0) ? res : 0);
+
+        pthread_mutex_lock(&pool->lock);
+        op->_next = NULL;
+        if (pool->done_tail == NULL) {
+            pool->done_head = op;
+        } else {
+            pool->done_tail->_next = op;
+        }
+        pool->done_tail = op;
+        pthread_cond_signal(&pool->has_done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static Exception
+aio__pool_create(aio_c* self)
+{
+    aio__pool_s* pool = &self->_pool;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->has_work, NULL);
+    pthread_cond_init(&pool->has_done, NULL);
+
+    pool->threads = self->_allocator->calloc(AIO_THREADS, sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        // aio__pool_destroy() skips the pool without threads
+        pthread_cond_destroy(&pool->has_done);
+        pthread_cond_destroy(&pool->has_work);
+        pthread_mutex_destroy(&pool->lock);
+        return Error.memory;
+    }
+    for (u32 i = 0; i < AIO_THREADS; i++) {
+        if (pthread_create(&pool->threads[i], NULL, aio__pool_worker, pool) != 0) {
+            return Error.runtime;
+        }
+        pool->nthreads++;
+    }
+    return EOK;
+}
+
+static void
+aio__pool_destroy(aio_c* self)
+{
+    aio__pool_s* pool = &self->_pool;
+
+    if (pool->threads == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->has_work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (u32 i = 0; i < pool->nthreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    self->_allocator->free(pool->threads);
+
+    pthread_cond_destroy(&pool->has_done);
+    pthread_cond_destroy(&pool->has_work);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+static void
+aio__pool_queue(aio_c* self, aio_op_s* op)
+{
+    aio__pool_s* pool = &self->_pool;
+
+    pthread_mutex_lock(&pool->lock);
+    op->_next = NULL;
+    if (pool->queue_tail == NULL) {
+        pool->queue_head = op;
+    } else {
+        pool->queue_tail->_next = op;
+    }
+    pool->queue_tail = op;
+    pthread_cond_signal(&pool->has_work);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static aio_op_s*
+aio__pool_reap(aio_c* self, bool wait)
+{
+    aio__pool_s* pool = &self->_pool;
+
+    pthread_mutex_lock(&pool->lock);
+    while (wait && pool->done_head == NULL) {
+        pthread_cond_wait(&pool->has_done, &pool->lock);
+    }
+    aio_op_s* op = pool->done_head;
+    if (op != NULL) {
+        pool->done_head = op->_next;
+        if (pool->done_head == NULL) {
+            pool->done_tail = NULL;
+        }
+        op->_next = NULL;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return op;
+}
+
+/*
+ *                  IO_URING BACKEND
+ */
+#if AIO__HAS_URING
+
+// IORING_OP_READ/IORING_OP_WRITE need Linux 5.6+, older kernels fail them with -EINVAL
+static bool
+aio__uring_probe(int fd)
+{
+    union
+    {
+        struct io_uring_probe probe;
+        char buf[sizeof(struct io_uring_probe) + (IORING_OP_WRITE + 1) * sizeof(struct io_uring_probe_op)];
+    } p;
+    memset(&p, 0, sizeof(p));
+
+    // NOTE: IORING_REGISTER_PROBE also came with Linux 5.6, failure means old kernel
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, &p.probe, IORING_OP_WRITE + 1) < 0) {
+        return false;
+    }
+
+    u8 needed[] = { IORING_OP_READ, IORING_OP_WRITE };
+    for (u32 i = 0; i < arr$len(needed); i++) {
+        if (needed[i] > p.probe.last_op || !(p.probe.ops[needed[i]].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Exception
+aio__uring_create(aio_c* self, u32 queue_size)
+{
+    aio__uring_s* ring = &self->_uring;
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    int fd = syscall(__NR_io_uring_setup, queue_size, &p);
+    if (fd < 0) {
+        // not supported by kernel, or disabled by seccomp / sysctl
+        return Error.not_found;
+    }
+    ring->fd = fd;
+    if (!aio__uring_probe(fd)) {
+        // aio_create() falls back to thread-pool backend
+        return Error.not_found;
+    }
+    ring->sq_entries = p.sq_entries;
+    ring->cq_entries = p.cq_entries;
+
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(u32);
+    ring->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(
+        NULL,
+        ring->sq_ring_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd,
+        IORING_OFF_SQ_RING
+    );
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        return Error.memory;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(
+            NULL,
+            ring->cq_ring_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            fd,
+            IORING_OFF_CQ_RING
+        );
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = NULL;
+            return Error.memory;
+        }
+    }
+
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(
+        NULL,
+        ring->sqes_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        fd,
+        IORING_OFF_SQES
+    );
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        return Error.memory;
+    }
+
+    char* sq = ring->sq_ring;
+    ring->sq_head = (u32*)(sq + p.sq_off.head);
+    ring->sq_tail = (u32*)(sq + p.sq_off.tail);
+    ring->sq_mask = (u32*)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (u32*)(sq + p.sq_off.array);
+
+    char* cq = ring->cq_ring;
+    ring->cq_head = (u32*)(cq + p.cq_off.head);
+    ring->cq_tail = (u32*)(cq + p.cq_off.tail);
+    ring->cq_mask = (u32*)(cq + p.cq_off.ring_mask);
+    ring->cqes = cq + p.cq_off.cqes;
+
+    return EOK;
+}
+
+static void
+aio__uring_destroy(aio_c* self)
+{
+    aio__uring_s* ring = &self->_uring;
+
+    if (ring->sqes != NULL) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+}
+
+static Exception
+aio__uring_enter(aio_c* self, u32 min_complete)
+{
+    aio__uring_s* ring = &self->_uring;
+
+    while (true) {
+        int ret = syscall(
+            __NR_io_uring_enter,
+            ring->fd,
+            ring->to_submit,
+            min_complete,
+            (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0,
+            NULL,
+            0
+        );
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EBUSY) {
+                // kernel is out of resources / CQ is full, caller has to reap completions first
+                return EOK;
+            }
+            return Error.io;
+        }
+        uassert((u32)ret <= ring->to_submit);
+        ring->to_submit -= ret;
+        ring->inflight += ret;
+        return EOK;
+    }
+}
+
+static void
+aio__uring_fill(aio_c* self)
+{
+    aio__uring_s* ring = &self->_uring;
+    if (ring->failed) {
+        return;
+    }
+
+    // Move operations from backlog into SQ, inflight ops are limited by CQ size to avoid overflow
+    u32 tail = *ring->sq_tail;
+    u32 head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    while (self->_backlog != NULL && tail - head < ring->sq_entries &&
+           ring->inflight + ring->to_submit < ring->cq_entries) {
+        aio_op_s* op = self->_backlog;
+        self->_backlog = op->_next;
+        if (self->_backlog == NULL) {
+            self->_backlog_tail = NULL;
+        }
+        op->_next = NULL;
+
+        u32 idx = tail & *ring->sq_mask;
+        struct io_uring_sqe* sqe = &((struct io_uring_sqe*)ring->sqes)[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = (op->kind == AIO_OP_READ) ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = op->fd;
+        sqe->addr = (u64)(uintptr_t)((char*)op->buf + op->_done);
+        sqe->len = (op->len - op->_done > UINT32_MAX) ? UINT32_MAX : op->len - op->_done;
+        sqe->off = op->offset + op->_done;
+        sqe->user_data = (u64)(uintptr_t)op;
+        ring->sq_array[idx] = idx;
+
+        tail++;
+        ring->to_submit++;
+    }
+    __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+}
+
+static aio_op_s*
+aio__uring_reap_one(aio_c* self)
+{
+    aio__uring_s* ring = &self->_uring;
+
+    while (true) {
+        u32 head = *ring->cq_head;
+        if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+        struct io_uring_cqe* cqe = &((struct io_uring_cqe*)ring->cqes)[head & *ring->cq_mask];
+        aio_op_s* op = (aio_op_s*)(uintptr_t)cqe->user_data;
+        int res = cqe->res;
+        __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+        ring->inflight--;
+
+        if (res == -EINTR || res == -EAGAIN) {
+            // retry the same request
+            aio__backlog_push(self, op);
+            continue;
+        }
+        if (res > 0 && op->kind == AIO_OP_WRITE && op->_done + res < op->len) {
+            // partial write: queue the rest
+            op->_done += res;
+            aio__backlog_push(self, op);
+            continue;
+        }
+        aio__op_complete(op, res);
+        return op;
+    }
+}
+
+// Moves SQEs which were not submitted to kernel back to the head of backlog
+static void
+aio__uring_unqueue(aio_c* self)
+{
+    aio__uring_s* ring = &self->_uring;
+
+    u32 tail = *ring->sq_tail;
+    aio_op_s* head = NULL;
+    while (ring->to_submit > 0) {
+        tail--;
+        ring->to_submit--;
+        u32 idx = ring->sq_array[tail & *ring->sq_mask];
+        aio_op_s* op = (aio_op_s*)(uintptr_t)((struct io_uring_sqe*)ring->sqes)[idx].user_data;
+        op->_next = head;
+        head = op;
+        if (self->_backlog_tail == NULL) {
+            self->_backlog_tail = op;
+        }
+    }
+    __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+    if (head != NULL) {
+        aio_op_s* last = head;
+        while (last->_next != NULL) {
+            last = last->_next;
+        }
+        last->_next = self->_backlog;
+        self->_backlog = head;
+    }
+}
+
+// io_uring_enter() failed: ops not passed to kernel are completed with Error.io, inflight ops
+// still own their buffers, so they are waited by polling CQ (completions are posted by kernel)
+static aio_op_s*
+aio__uring_reap_failed(aio_c* self, bool wait)
+{
+    aio__uring_s* ring = &self->_uring;
+
+    while (true) {
+        aio_op_s* op = aio__uring_reap_one(self);
+        if (op != NULL) {
+            return op;
+        }
+        if (self->_backlog != NULL) {
+            op = self->_backlog;
+            self->_backlog = op->_next;
+            if (self->_backlog == NULL) {
+                self->_backlog_tail = NULL;
+            }
+            op->_next = NULL;
+            aio__op_complete(op, -EIO);
+            return op;
+        }
+        if (!wait || ring->inflight == 0) {
+            return NULL;
+        }
+        usleep(1000);
+    }
+}
+
+static aio_op_s*
+aio__uring_reap(aio_c* self, bool wait)
+{
+    aio__uring_s* ring = &self->_uring;
+
+    while (true) {
+        if (unlikely(ring->failed)) {
+            return aio__uring_reap_failed(self, wait);
+        }
+
+        // reaping frees CQ space, so more backlog operations can be passed to the kernel
+        aio_op_s* op = aio__uring_reap_one(self);
+        aio__uring_fill(self);
+
+        bool block = (op == NULL && wait && ring->inflight + ring->to_submit > 0);
+        if (ring->to_submit > 0 || block) {
+            if (unlikely(aio__uring_enter(self, block ? 1 : 0) != EOK)) {
+                ring->failed = true;
+                aio__uring_unqueue(self);
+                if (op != NULL) {
+                    return op;
+                }
+                continue;
+            }
+        }
+
+        if (op != NULL) {
+            return op;
+        }
+        if (!wait) {
+            return aio__uring_reap_one(self);
+        }
+        if (ring->inflight == 0 && ring->to_submit == 0 && self->_backlog == NULL) {
+            return NULL;
+        }
+    }
+}
+#endif
+
+/*
+ *                  PUBLIC API
+ */
+
+/**
+ * @brief Creates async I/O engine
+ *
+ * @param self aio_c instance
+ * @param queue_size submission queue size, 0 - use AIO_QUEUE_SIZE
+ * @param flags AIO_FLAG_* flags, i.e. AIO_FLAG_NO_URING to force thread-pool backend
+ * @param allocator allocator for internal data and aio.open()/aio.close()
+ * @return Error.memory, Error.runtime on failure
+ */
+Exception
+aio_create(aio_c* self, u32 queue_size, u32 flags, const Allocator_i* allocator)
+{
+    if (self == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        return Error.argument;
+    }
+    if (allocator == NULL) {
+        uassert(allocator != NULL && "allocator invalid");
+        return Error.argument;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->_allocator = allocator;
+    self->_uring.fd = -1;
+
+    Exc result = Error.runtime;
+    (void)queue_size;
+
+#if AIO__HAS_URING
+    if (!(flags & AIO_FLAG_NO_URING)) {
+        self->_backend = AIO_BACKEND_URING;
+        result = aio__uring_create(self, (queue_size > 0) ? queue_size : AIO_QUEUE_SIZE);
+        if (result == EOK) {
+            return EOK;
+        }
+        aio__uring_destroy(self);
+        memset(&self->_uring, 0, sizeof(self->_uring));
+        self->_uring.fd = -1;
+    }
+#else
+    (void)flags;
+#endif
+
+    self->_backend = AIO_BACKEND_THREADS;
+    e$goto(result = aio__pool_create(self), fail);
+    return EOK;
+
+fail:
+    aio.destroy(self);
+    return result;
+}
+
+/**
+ * @brief Returns backend of the engine (AIO_BACKEND_URING or AIO_BACKEND_THREADS)
+ *
+ * @param self aio_c instance
+ * @return
+ */
+aio_backend_e
+aio_backend(aio_c* self)
+{
+    uassert(self != NULL);
+    return self->_backend;
+}
+
+/**
+ * @brief Opens file descriptor for async I/O (accounted by engine allocator)
+ *
+ * NOTE: io_c handles can be used as well, via io.fileno() (make sure io.flush() was called)
+ *
+ * @param self aio_c instance
+ * @param path file path
+ * @param flags open() flags
+ * @param mode open() mode for new files
+ * @param out_fd opened file descriptor
+ * @return Error.not_found, Error.io on failure
+ */
+Exception
+aio_open(aio_c* self, const char* path, int flags, u32 mode, int* out_fd)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (path == NULL || out_fd == NULL) {
+        return Error.argument;
+    }
+
+    int fd = self->_allocator->open(path, flags, mode);
+    if (fd < 0) {
+        *out_fd = -1;
+        return (errno == ENOENT) ? Error.not_found : Error.io;
+    }
+    *out_fd = fd;
+    return EOK;
+}
+
+/**
+ * @brief Closes file descriptor opened by aio.open()
+ *
+ * @param self aio_c instance
+ * @param fd file descriptor
+ */
+void
+aio_close(aio_c* self, int fd)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (fd >= 0) {
+        self->_allocator->close(fd);
+    }
+}
+
+/**
+ * @brief Queues async operation (request fields of op must be filled)
+ *
+ * @param self aio_c instance
+ * @param op operation, must stay alive until it's returned by aio.poll()/aio.wait()
+ * @return Error.argument on bad op
+ */
+Exception
+aio_submit(aio_c* self, aio_op_s* op)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (op == NULL || op->fd < 0 || (op->buf == NULL && op->len > 0)) {
+        return Error.argument;
+    }
+    if (op->kind != AIO_OP_READ && op->kind != AIO_OP_WRITE) {
+        return Error.argument;
+    }
+
+    op->nbytes = 0;
+    op->error = EOK;
+    op->_done = 0;
+    op->_next = NULL;
+    self->_pending++;
+
+#if AIO__HAS_URING
+    if (self->_backend == AIO_BACKEND_URING) {
+        // submission is batched, kernel gets all queued ops at next aio.poll()/aio.wait()
+        aio__backlog_push(self, op);
+        aio__uring_fill(self);
+        return EOK;
+    }
+#endif
+    aio__pool_queue(self, op);
+    return EOK;
+}
+
+/**
+ * @brief Queues async read into buf
+ *
+ * @param self aio_c instance
+ * @param op operation storage, must stay alive until completion
+ * @param fd file descriptor
+ * @param buf destination buffer (caller or arena memory), must stay alive until completion
+ * @param len number of bytes to read
+ * @param offset file offset
+ * @return Error.argument on bad arguments
+ */
+Exception
+aio_read(aio_c* self, aio_op_s* op, int fd, void* buf, size_t len, u64 offset)
+{
+    if (op == NULL) {
+        return Error.argument;
+    }
+    void* user = op->user;
+    *op = (aio_op_s){
+        .fd = fd, .kind = AIO_OP_READ, .buf = buf, .len = len, .offset = offset, .user = user
+    };
+    return aio_submit(self, op);
+}
+
+/**
+ * @brief Queues async write of buf
+ *
+ * @param self aio_c instance
+ * @param op operation storage, must stay alive until completion
+ * @param fd file descriptor
+ * @param buf source buffer, must stay alive until completion
+ * @param len number of bytes to write (partial writes are resumed until all written)
+ * @param offset file offset
+ * @return Error.argument on bad arguments
+ */
+Exception
+aio_write(aio_c* self, aio_op_s* op, int fd, const void* buf, size_t len, u64 offset)
+{
+    if (op == NULL) {
+        return Error.argument;
+    }
+    void* user = op->user;
+    *op = (aio_op_s){
+        .fd = fd, .kind = AIO_OP_WRITE, .buf = (void*)buf, .len = len, .offset = offset, .user = user
+    };
+    return aio_submit(self, op);
+}
+
+/**
+ * @brief Number of queued operations which were not returned by aio.poll()/aio.wait() yet
+ *
+ * @param self aio_c instance
+ * @return
+ */
+u32
+aio_pending(aio_c* self)
+{
+    uassert(self != NULL);
+    return self->_pending;
+}
+
+/**
+ * @brief Returns next completed operation without blocking
+ *
+ * @param self aio_c instance
+ * @return completed operation (check op->error), or NULL if nothing completed yet
+ */
+aio_op_s*
+aio_poll(aio_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (self->_pending == 0) {
+        return NULL;
+    }
+
+    aio_op_s* op = NULL;
+#if AIO__HAS_URING
+    if (self->_backend == AIO_BACKEND_URING) {
+        op = aio__uring_reap(self, false);
+    } else
+#endif
+    {
+        op = aio__pool_reap(self, false);
+    }
+
+    if (op != NULL) {
+        self->_pending--;
+    }
+    return op;
+}
+
+/**
+ * @brief Waits for next completed operation
+ *
+ * @param self aio_c instance
+ * @return completed operation (check op->error), or NULL if there are no pending operations
+ */
+aio_op_s*
+aio_wait(aio_c* self)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (self->_pending == 0) {
+        return NULL;
+    }
+
+    aio_op_s* op = NULL;
+#if AIO__HAS_URING
+    if (self->_backend == AIO_BACKEND_URING) {
+        op = aio__uring_reap(self, true);
+    } else
+#endif
+    {
+        op = aio__pool_reap(self, true);
+    }
+
+    if (op != NULL) {
+        self->_pending--;
+    }
+    return op;
+}
+
+/**
+ * @brief Waits for all pending operations
+ *
+ * @param self aio_c instance
+ * @return first error of completed operations
+ */
+Exception
+aio_wait_all(aio_c* self)
+{
+    Exc result = EOK;
+    aio_op_s* op;
+    while ((op = aio_wait(self)) != NULL) {
+        if (op->error != EOK && result == EOK) {
+            result = op->error;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Waits for pending operations, and frees engine resources
+ *
+ * @param self aio_c instance
+ */
+void
+aio_destroy(aio_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+
+    // operation buffers are owned by caller, they must not be touched by kernel after destroy
+    // NOTE: errors are ignored here, they are still available in op->error
+    aio_op_s* op;
+    while ((op = aio_wait(self)) != NULL) {
+    }
+
+#if AIO__HAS_URING
+    if (self->_backend == AIO_BACKEND_URING) {
+        aio__uring_destroy(self);
+    }
+#endif
+    aio__pool_destroy(self);
+
+    memset(self, 0, sizeof(*self));
+}
+const struct __module__aio aio = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = aio_create,
+    .backend = aio_backend,
+    .open = aio_open,
+    .close = aio_close,
+    .submit = aio_submit,
+    .read = aio_read,
+    .write = aio_write,
+    .pending = aio_pending,
+    .poll = aio_poll,
+    .wait = aio_wait,
+    .wait_all = aio_wait_all,
+    .destroy = aio_destroy,
+    // clang-format on
+};
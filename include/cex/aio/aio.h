@@ -0,0 +1,238 @@
+#pragma once
+#include <cex.h>
+#include <pthread.h>
+
+// Default number of submission queue entries (more operations are queued into internal backlog)
+#define AIO_QUEUE_SIZE 256
+
+// Number of worker threads of thread-pool backend
+#ifndef AIO_THREADS
+#define AIO_THREADS 4
+#endif
+
+// aio.create() flags
+#define AIO_FLAG_NO_URING 0x1 // always use thread-pool backend
+
+typedef enum
+{
+    AIO_BACKEND_THREADS = 1,
+    AIO_BACKEND_URING = 2,
+} aio_backend_e;
+
+typedef enum
+{
+    AIO_OP_READ = 1,
+    AIO_OP_WRITE = 2,
+} aio_op_e;
+
+/**
+ * @brief Async operation, owned by caller and must stay alive (not moved) until it's completed
+ */
+typedef struct aio_op_s
+{
+    // request
+    int fd;
+    aio_op_e kind;
+    void* buf; // caller or arena buffer, must stay alive until completion
+    size_t len;
+    u64 offset;
+    void* user; // user data, not used by aio
+
+    // completion
+    size_t nbytes; // bytes transferred (read may be short at end of file)
+    Exc error;     // EOK or Error.io
+
+    // private
+    struct aio_op_s* _next;
+    size_t _done; // bytes written so far by partial writes
+} aio_op_s;
+
+typedef struct
+{
+    int fd;
+    u32 sq_entries;
+    u32 cq_entries;
+    u32* sq_head;
+    u32* sq_tail;
+    u32* sq_mask;
+    u32* sq_array;
+    u32* cq_head;
+    u32* cq_tail;
+    u32* cq_mask;
+    void* sqes; // struct io_uring_sqe[]
+    void* cqes; // struct io_uring_cqe[]
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    u32 to_submit; // SQEs queued, but not submitted by io_uring_enter() yet
+    u32 inflight;  // SQEs submitted to kernel, and not reaped
+    bool failed;   // io_uring_enter() failed, queued ops are completed with Error.io
+} aio__uring_s;
+
+typedef struct
+{
+    pthread_t* threads;
+    u32 nthreads;
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t has_work;
+    pthread_cond_t has_done;
+    aio_op_s* queue_head;
+    aio_op_s* queue_tail;
+    aio_op_s* done_head;
+    aio_op_s* done_tail;
+} aio__pool_s;
+
+/**
+ * @brief Asynchronous file I/O engine: io_uring where available (Linux 5.6+), thread-pool fallback otherwise
+ *
+ * aio_c is not thread safe, it's expected to be used by a single thread which queues operations
+ * and polls/waits for their completions.
+ */
+typedef struct
+{
+    aio_backend_e _backend;
+    u32 _pending;          // queued operations which were not returned by poll()/wait() yet
+    aio_op_s* _backlog;    // operations waiting for free submission queue slot (io_uring)
+    aio_op_s* _backlog_tail;
+    aio__uring_s _uring;
+    aio__pool_s _pool;
+    const Allocator_i* _allocator;
+} aio_c;
+struct __module__aio
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates async I/O engine
+ *
+ * @param self aio_c instance
+ * @param queue_size submission queue size, 0 - use AIO_QUEUE_SIZE
+ * @param flags AIO_FLAG_* flags, i.e. AIO_FLAG_NO_URING to force thread-pool backend
+ * @param allocator allocator for internal data and aio.open()/aio.close()
+ * @return Error.memory, Error.runtime on failure
+ */
+Exception
+(*create)(aio_c* self, u32 queue_size, u32 flags, const Allocator_i* allocator);
+
+/**
+ * @brief Returns backend of the engine (AIO_BACKEND_URING or AIO_BACKEND_THREADS)
+ *
+ * @param self aio_c instance
+ * @return
+ */
+aio_backend_e
+(*backend)(aio_c* self);
+
+/**
+ * @brief Opens file descriptor for async I/O (accounted by engine allocator)
+ *
+ * NOTE: io_c handles can be used as well, via io.fileno() (make sure io.flush() was called)
+ *
+ * @param self aio_c instance
+ * @param path file path
+ * @param flags open() flags
+ * @param mode open() mode for new files
+ * @param out_fd opened file descriptor
+ * @return Error.not_found, Error.io on failure
+ */
+Exception
+(*open)(aio_c* self, const char* path, int flags, u32 mode, int* out_fd);
+
+/**
+ * @brief Closes file descriptor opened by aio.open()
+ *
+ * @param self aio_c instance
+ * @param fd file descriptor
+ */
+void
+(*close)(aio_c* self, int fd);
+
+/**
+ * @brief Queues async operation (request fields of op must be filled)
+ *
+ * @param self aio_c instance
+ * @param op operation, must stay alive until it's returned by aio.poll()/aio.wait()
+ * @return Error.argument on bad op
+ */
+Exception
+(*submit)(aio_c* self, aio_op_s* op);
+
+/**
+ * @brief Queues async read into buf
+ *
+ * @param self aio_c instance
+ * @param op operation storage, must stay alive until completion
+ * @param fd file descriptor
+ * @param buf destination buffer (caller or arena memory), must stay alive until completion
+ * @param len number of bytes to read
+ * @param offset file offset
+ * @return Error.argument on bad arguments
+ */
+Exception
+(*read)(aio_c* self, aio_op_s* op, int fd, void* buf, size_t len, u64 offset);
+
+/**
+ * @brief Queues async write of buf
+ *
+ * @param self aio_c instance
+ * @param op operation storage, must stay alive until completion
+ * @param fd file descriptor
+ * @param buf source buffer, must stay alive until completion
+ * @param len number of bytes to write (partial writes are resumed until all written)
+ * @param offset file offset
+ * @return Error.argument on bad arguments
+ */
+Exception
+(*write)(aio_c* self, aio_op_s* op, int fd, const void* buf, size_t len, u64 offset);
+
+/**
+ * @brief Number of queued operations which were not returned by aio.poll()/aio.wait() yet
+ *
+ * @param self aio_c instance
+ * @return
+ */
+u32
+(*pending)(aio_c* self);
+
+/**
+ * @brief Returns next completed operation without blocking
+ *
+ * @param self aio_c instance
+ * @return completed operation (check op->error), or NULL if nothing completed yet
+ */
+aio_op_s*
+(*poll)(aio_c* self);
+
+/**
+ * @brief Waits for next completed operation
+ *
+ * @param self aio_c instance
+ * @return completed operation (check op->error), or NULL if there are no pending operations
+ */
+aio_op_s*
+(*wait)(aio_c* self);
+
+/**
+ * @brief Waits for all pending operations
+ *
+ * @param self aio_c instance
+ * @return first error of completed operations
+ */
+Exception
+(*wait_all)(aio_c* self);
+
+/**
+ * @brief Waits for pending operations, and frees engine resources
+ *
+ * @param self aio_c instance
+ */
+void
+(*destroy)(aio_c* self);
+
+    // clang-format on
+};
+extern const struct __module__aio aio; // CEX Autogen
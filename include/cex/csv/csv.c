@@ -0,0 +1,486 @@
+#include "csv.h"
+#include <cex.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// internal: row is incomplete, more data needed
+static const char* const csv__need_more = "csv: need more data";
+
+// Finds the first delimiter, quote or '\n' character, or returns end
+static inline const char*
+csv__scan(const char* p, const char* end, char delim, char quote)
+{
+#if defined(__SSE2__)
+    const __m128i vdelim = _mm_set1_epi8(delim);
+    const __m128i vquote = _mm_set1_epi8(quote);
+    const __m128i vnl = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, vdelim), _mm_cmpeq_epi8(v, vquote)),
+            _mm_cmpeq_epi8(v, vnl)
+        );
+        int mask = _mm_movemask_epi8(m);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; p++) {
+        if (*p == delim || *p == quote || *p == '\n') {
+            return p;
+        }
+    }
+    return end;
+}
+
+static Exception
+csv__fill(csv_c* self)
+{
+    uassert(self->_file != NULL && !self->_eof);
+
+    // move incomplete row to the buffer start, and read the rest
+    size_t tail = self->_len - self->_pos;
+    if (self->_pos > 0) {
+        memmove(self->_buf, self->_buf + self->_pos, tail);
+        self->_len = tail;
+        self->_pos = 0;
+    }
+
+    if (self->_len == self->_buf_cap) {
+        // row is longer than buffer
+        char* buf = self->_allocator->realloc(self->_buf, self->_buf_cap * 2);
+        if (buf == NULL) {
+            return Error.memory;
+        }
+        self->_buf = buf;
+        self->_buf_cap *= 2;
+        self->_data = buf;
+    }
+
+    size_t n = self->_buf_cap - self->_len;
+    Exc err = io.read(self->_file, self->_buf + self->_len, 1, &n);
+    if (err == Error.eof) {
+        self->_eof = true;
+        return EOK;
+    }
+    e$ret(err);
+    self->_len += n;
+    return EOK;
+}
+
+// Unescaped fields of the current row are views into scratch buffer, moves them when it is
+// reallocated
+static void
+csv__rebase_unescaped(csv_c* self, const char* old_base, size_t old_len)
+{
+    uintptr_t lo = (uintptr_t)old_base;
+    for (size_t i = 0; i < self->_fields.len; i++) {
+        str_c* f = &self->_fields.arr[i];
+        if ((uintptr_t)f->buf >= lo && (uintptr_t)f->buf - lo <= old_len) {
+            f->buf = self->_unquoted + ((uintptr_t)f->buf - lo);
+        }
+    }
+}
+
+static Exception
+csv__unescape(csv_c* self, str_c* field, bool* reserved)
+{
+    if (!*reserved) {
+        // unescaped field is never longer than the escaped one, scratch grows geometrically
+        // for the next fields of the row (not reserved for the whole input, i.e. mmap-ed file)
+        sbuf.clear(&self->_unquoted);
+        e$ret(sbuf.reserve(&self->_unquoted, field->len));
+        *reserved = true;
+    }
+
+    const char* base = self->_unquoted;
+    size_t offset = sbuf.len(&self->_unquoted);
+    size_t start = 0;
+    for (size_t i = 0; i < field->len; i++) {
+        if (field->buf[i] == self->_quote) {
+            // "" -> ", copy including the first quote, and skip the second
+            str_c part = { .buf = field->buf + start, .len = i + 1 - start };
+            e$ret(sbuf.append(&self->_unquoted, part));
+            start = ++i + 1;
+        }
+    }
+    str_c part = { .buf = field->buf + start, .len = field->len - start };
+    e$ret(sbuf.append(&self->_unquoted, part));
+
+    if (self->_unquoted != base) {
+        csv__rebase_unescaped(self, base, offset);
+    }
+    field->buf = self->_unquoted + offset;
+    field->len = sbuf.len(&self->_unquoted) - offset;
+    return EOK;
+}
+
+static Exception
+csv__parse_row(csv_c* self)
+{
+    const char* d = self->_data;
+    const size_t end = self->_len;
+    const char delim = self->_delim;
+    const char quote = self->_quote;
+
+    // skip blank lines
+    while (self->_pos < end) {
+        if (d[self->_pos] == '\n') {
+            self->_pos++;
+        } else if (d[self->_pos] == '\r' && self->_pos + 1 < end && d[self->_pos + 1] == '\n') {
+            self->_pos += 2;
+        } else if (d[self->_pos] == '\r' && self->_pos + 1 == end && !self->_eof) {
+            return csv__need_more;
+        } else {
+            break;
+        }
+    }
+    if (self->_pos == end) {
+        return self->_eof ? Error.eof : csv__need_more;
+    }
+
+    list.clear(&self->_fields);
+    bool reserved = false;
+    size_t pos = self->_pos;
+
+    while (true) {
+        str_c field;
+
+        if (pos == end) {
+            // delimiter was the last char of data, i.e. empty last field
+            if (!self->_eof) {
+                return csv__need_more;
+            }
+            field = (str_c){ .buf = (char*)&d[pos], .len = 0 };
+            e$ret(list.append(&self->_fields, &field));
+            break;
+        }
+
+        if (d[pos] == quote) {
+            size_t fstart = ++pos;
+            bool escaped = false;
+            while (true) {
+                const char* q = memchr(&d[pos], quote, end - pos);
+                if (q == NULL) {
+                    // unterminated quoted field
+                    return self->_eof ? Error.integrity : csv__need_more;
+                }
+                size_t qi = q - d;
+                if (qi + 1 == end && !self->_eof) {
+                    // can't tell closing quote from escaped "" yet
+                    return csv__need_more;
+                }
+                if (qi + 1 < end && d[qi + 1] == quote) {
+                    escaped = true;
+                    pos = qi + 2;
+                    continue;
+                }
+                field = (str_c){ .buf = (char*)&d[fstart], .len = qi - fstart };
+                pos = qi + 1;
+                break;
+            }
+            if (escaped) {
+                e$ret(csv__unescape(self, &field, &reserved));
+            }
+            e$ret(list.append(&self->_fields, &field));
+
+            if (pos == end) {
+                if (!self->_eof) {
+                    return csv__need_more;
+                }
+                break;
+            }
+            if (d[pos] == delim) {
+                pos++;
+            } else if (d[pos] == '\n') {
+                pos++;
+                break;
+            } else if (d[pos] == '\r' && pos + 1 < end && d[pos + 1] == '\n') {
+                pos += 2;
+                break;
+            } else if (d[pos] == '\r' && pos + 1 == end) {
+                if (!self->_eof) {
+                    return csv__need_more;
+                }
+                pos++;
+                break;
+            } else {
+                // garbage after closing quote
+                return Error.integrity;
+            }
+        } else {
+            size_t fstart = pos;
+            const char* s;
+            while (true) {
+                s = csv__scan(&d[pos], &d[end], delim, quote);
+                if (s < &d[end] && *s == quote) {
+                    // quote in the middle of unquoted field is a literal char
+                    pos = s - d + 1;
+                    continue;
+                }
+                break;
+            }
+            if (s == &d[end] && !self->_eof) {
+                return csv__need_more;
+            }
+            field = (str_c){ .buf = (char*)&d[fstart], .len = s - &d[fstart] };
+            pos = s - d;
+
+            if (pos < end && d[pos] == delim) {
+                e$ret(list.append(&self->_fields, &field));
+                pos++;
+                continue;
+            }
+
+            // end of row: '\n' or end of data
+            if (field.len > 0 && field.buf[field.len - 1] == '\r') {
+                field.len--;
+            }
+            e$ret(list.append(&self->_fields, &field));
+            if (pos < end) {
+                pos++;
+            }
+            break;
+        }
+    }
+
+    self->_pos = pos;
+    self->_row++;
+    return EOK;
+}
+
+static Exception
+csv__init(csv_c* self, char delimiter, const Allocator_i* allocator)
+{
+    memset(self, 0, sizeof(*self));
+    self->_allocator = allocator;
+    self->_delim = (delimiter != '\0') ? delimiter : ',';
+    self->_quote = '"';
+
+    e$ret(list$new(&self->_fields, 32, allocator));
+    e$ret(sbuf.create(&self->_unquoted, 256, allocator));
+    return EOK;
+}
+
+/**
+ * @brief Creates CSV parser streaming from a file
+ *
+ * @param self csv_c instance
+ * @param file opened file (must stay opened until csv.destroy())
+ * @param delimiter field delimiter, '\0' - use ','
+ * @param allocator
+ * @return
+ */
+Exception
+csv_create(csv_c* self, io_c* file, char delimiter, const Allocator_i* allocator)
+{
+    if (self == NULL || file == NULL || allocator == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        uassert(file != NULL && "file must not be NULL");
+        uassert(allocator != NULL && "allocator invalid");
+        return Error.argument;
+    }
+
+    Exc result = Error.runtime;
+    e$goto(result = csv__init(self, delimiter, allocator), fail);
+
+    self->_file = file;
+    self->_buf_cap = CSV_BUF_SIZE;
+    self->_buf = allocator->malloc(self->_buf_cap);
+    if (self->_buf == NULL) {
+        result = Error.memory;
+        goto fail;
+    }
+    self->_data = self->_buf;
+    return EOK;
+
+fail:
+    csv.destroy(self);
+    return result;
+}
+
+/**
+ * @brief Creates CSV parser over data in memory (e.g. mmap()-ed file, or io.readall() result)
+ *
+ * @param self csv_c instance
+ * @param data CSV data (must stay alive until csv.destroy())
+ * @param delimiter field delimiter, '\0' - use ','
+ * @param allocator
+ * @return
+ */
+Exception
+csv_create_buf(csv_c* self, str_c data, char delimiter, const Allocator_i* allocator)
+{
+    if (self == NULL || data.buf == NULL || allocator == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        uassert(allocator != NULL && "allocator invalid");
+        return Error.argument;
+    }
+
+    Exc result = Error.runtime;
+    e$goto(result = csv__init(self, delimiter, allocator), fail);
+
+    self->_data = data.buf;
+    self->_len = data.len;
+    self->_eof = true;
+    return EOK;
+
+fail:
+    csv.destroy(self);
+    return result;
+}
+
+/**
+ * @brief Parses next row (blank lines are skipped)
+ *
+ * @param self csv_c instance
+ * @param fields row fields (valid until the next call)
+ * @param nfields number of fields
+ * @return Error.eof at the end of data, Error.integrity on bad quoting
+ */
+Exception
+csv_next(csv_c* self, str_c** fields, u32* nfields)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+    uassert(fields != NULL);
+    uassert(nfields != NULL);
+
+    while (true) {
+        Exc err = csv__parse_row(self);
+        if (err == csv__need_more) {
+            e$ret(csv__fill(self));
+            continue;
+        }
+        if (err != EOK) {
+            *fields = NULL;
+            *nfields = 0;
+            return err;
+        }
+        *fields = self->_fields.arr;
+        *nfields = self->_fields.len;
+        return EOK;
+    }
+}
+
+/**
+ * @brief Number of rows parsed so far (i.e. current row number, 1-based)
+ *
+ * @param self csv_c instance
+ * @return
+ */
+size_t
+csv_row(csv_c* self)
+{
+    uassert(self != NULL);
+    return self->_row;
+}
+
+/**
+ * @brief Reads all remaining rows, and converts selected columns into typed lists
+ *
+ * Use csv.next() before to skip the header row.
+ *
+ * @param self csv_c instance
+ * @param columns column specs, column lists must be created with matching element type
+ * @param ncolumns number of columns
+ * @return Error.integrity if row has no such column, or conversion error of str.to_*()
+ *         (see csv.row() for the failed row number)
+ */
+Exception
+csv_read_columns(csv_c* self, csv_column_s* columns, u32 ncolumns)
+{
+    uassert(self != NULL);
+
+    if (columns == NULL || ncolumns == 0) {
+        return Error.argument;
+    }
+
+    str_c* fields = NULL;
+    u32 nfields = 0;
+    Exc err;
+    while ((err = csv_next(self, &fields, &nfields)) == EOK) {
+        for (u32 i = 0; i < ncolumns; i++) {
+            csv_column_s* col = &columns[i];
+            if (col->index >= nfields) {
+                return Error.integrity;
+            }
+            str_c f = fields[col->index];
+
+            union
+            {
+                i32 i32;
+                i64 i64;
+                u32 u32;
+                u64 u64;
+                f32 f32;
+                f64 f64;
+            } v;
+
+            switch (col->type) {
+                case CSV_COL_I32:
+                    e$ret(str.to_i32(f, &v.i32));
+                    break;
+                case CSV_COL_I64:
+                    e$ret(str.to_i64(f, &v.i64));
+                    break;
+                case CSV_COL_U32:
+                    e$ret(str.to_u32(f, &v.u32));
+                    break;
+                case CSV_COL_U64:
+                    e$ret(str.to_u64(f, &v.u64));
+                    break;
+                case CSV_COL_F32:
+                    e$ret(str.to_f32(f, &v.f32));
+                    break;
+                case CSV_COL_F64:
+                    e$ret(str.to_f64(f, &v.f64));
+                    break;
+                default:
+                    return Error.argument;
+            }
+            e$ret(list.append(col->list, &v));
+        }
+    }
+    return (err == Error.eof) ? EOK : err;
+}
+
+/**
+ * @brief Frees parser resources (file or user data is not closed/freed)
+ *
+ * @param self csv_c instance
+ */
+void
+csv_destroy(csv_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+
+    if (self->_fields.arr != NULL) {
+        list.destroy(&self->_fields);
+    }
+    if (self->_unquoted != NULL) {
+        sbuf.destroy(&self->_unquoted);
+    }
+    if (self->_buf != NULL) {
+        self->_allocator->free(self->_buf);
+    }
+
+    memset(self, 0, sizeof(*self));
+}
+const struct __module__csv csv = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = csv_create,
+    .create_buf = csv_create_buf,
+    .next = csv_next,
+    .row = csv_row,
+    .read_columns = csv_read_columns,
+    .destroy = csv_destroy,
+    // clang-format on
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include <cex.h>
+
+// Initial size of read buffer for streaming from io_c (grows if a row doesn't fit)
+#define CSV_BUF_SIZE (64 * 1024)
+
+typedef enum
+{
+    CSV_COL_I32 = 1,
+    CSV_COL_I64,
+    CSV_COL_U32,
+    CSV_COL_U64,
+    CSV_COL_F32,
+    CSV_COL_F64,
+} csv_coltype_e;
+
+/**
+ * @brief Typed column extraction target for csv.read_columns()
+ */
+typedef struct
+{
+    u32 index;          // column index in a row
+    csv_coltype_e type; // conversion type
+    void* list;         // list$define() of matching element type (i.e. i64 for CSV_COL_I64)
+} csv_column_s;
+
+/**
+ * @brief Streaming RFC 4180 CSV parser
+ *
+ * Fields are zero-copy str_c views into the read buffer (or user data), except quoted fields
+ * with escaped "" quotes, which are unescaped into scratch buffer. Fields are valid until the
+ * next call of csv.next().
+ */
+typedef struct
+{
+    io_c* _file;       // streaming source, or NULL if parsing user data
+    const char* _data; // data to parse (_buf or user data)
+    char* _buf;        // own read buffer (streaming mode)
+    size_t _buf_cap;
+    size_t _len; // data length
+    size_t _pos; // start of the next row
+    size_t _row; // number of rows parsed
+    bool _eof;
+    char _delim;
+    char _quote;
+    list$define(str_c) _fields;
+    sbuf_c _unquoted; // scratch for unescaped quoted fields of the current row
+    const Allocator_i* _allocator;
+} csv_c;
+struct __module__csv
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates CSV parser streaming from a file
+ *
+ * @param self csv_c instance
+ * @param file opened file (must stay opened until csv.destroy())
+ * @param delimiter field delimiter, '\0' - use ','
+ * @param allocator
+ * @return
+ */
+Exception
+(*create)(csv_c* self, io_c* file, char delimiter, const Allocator_i* allocator);
+
+/**
+ * @brief Creates CSV parser over data in memory (e.g. mmap()-ed file, or io.readall() result)
+ *
+ * @param self csv_c instance
+ * @param data CSV data (must stay alive until csv.destroy())
+ * @param delimiter field delimiter, '\0' - use ','
+ * @param allocator
+ * @return
+ */
+Exception
+(*create_buf)(csv_c* self, str_c data, char delimiter, const Allocator_i* allocator);
+
+/**
+ * @brief Parses next row (blank lines are skipped)
+ *
+ * @param self csv_c instance
+ * @param fields row fields (valid until the next call)
+ * @param nfields number of fields
+ * @return Error.eof at the end of data, Error.integrity on bad quoting
+ */
+Exception
+(*next)(csv_c* self, str_c** fields, u32* nfields);
+
+/**
+ * @brief Number of rows parsed so far (i.e. current row number, 1-based)
+ *
+ * @param self csv_c instance
+ * @return
+ */
+size_t
+(*row)(csv_c* self);
+
+/**
+ * @brief Reads all remaining rows, and converts selected columns into typed lists
+ *
+ * Use csv.next() before to skip the header row.
+ *
+ * @param self csv_c instance
+ * @param columns column specs, column lists must be created with matching element type
+ * @param ncolumns number of columns
+ * @return Error.integrity if row has no such column, or conversion error of str.to_*()
+ *         (see csv.row() for the failed row number)
+ */
+Exception
+(*read_columns)(csv_c* self, csv_column_s* columns, u32 ncolumns);
+
+/**
+ * @brief Frees parser resources (file or user data is not closed/freed)
+ *
+ * @param self csv_c instance
+ */
+void
+(*destroy)(csv_c* self);
+
+    // clang-format on
+};
+extern const struct __module__csv csv; // CEX Autogen
@@ -0,0 +1,910 @@
+#include "json.h"
+#include <cex.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// NOTE: quote literals are kept out of function bodies, they confuse `cex process` parser
+#define JSON__QUOTE '"'
+
+// Parser grammar states (i.e. what is expected by the next structural char)
+enum
+{
+    JSON__S_VALUE = 1,    // value (top-level, after ':', or after ',' in array)
+    JSON__S_VALUE_OR_END, // value or ']' (after '[')
+    JSON__S_KEY,          // key (after ',' in object)
+    JSON__S_KEY_OR_END,   // key or '}' (after '{')
+    JSON__S_COLON,        // ':' after key
+    JSON__S_NEXT,         // ',' or closing bracket after container item
+    JSON__S_DONE,         // top-level value is complete
+};
+
+// Char class bitmasks of 64-byte block (bit N is block[N])
+typedef struct
+{
+    u64 quote;
+    u64 bslash;
+    u64 open;  // '{' '['
+    u64 close; // '}' ']'
+    u64 sep;   // ':' ','
+    u64 ws;    // ' ' '\t' '\n' '\r'
+    u64 ctrl;  // < 0x20
+} json__masks_s;
+
+// Stage 1 state carried between blocks
+typedef struct
+{
+    u64 prev_odd;       // previous block ends with odd-length backslash run
+    u64 prev_in_string; // all ones if previous block ends inside string
+    u64 prev_scalar;    // 1 if the last char of previous block is scalar char
+} json__stage1_s;
+
+typedef struct
+{
+    json_c* json;
+    u32 state;
+    u32 depth;
+    u32 pending; // tape index + 1 of string/scalar, which end is not known yet
+    u32 stack[JSON_MAX_DEPTH];
+} json__parser_s;
+
+static inline void
+json__classify(const char* block, json__masks_s* m)
+{
+    memset(m, 0, sizeof(*m));
+#if defined(__SSE2__)
+    const __m128i vquote = _mm_set1_epi8(JSON__QUOTE);
+    const __m128i vbslash = _mm_set1_epi8('\\');
+    const __m128i vlower = _mm_set1_epi8(0x20);
+    const __m128i vopen = _mm_set1_epi8('{');  // '[' | 0x20 == '{'
+    const __m128i vclose = _mm_set1_epi8('}'); // ']' | 0x20 == '}'
+    const __m128i vcolon = _mm_set1_epi8(':');
+    const __m128i vcomma = _mm_set1_epi8(',');
+    const __m128i vspace = _mm_set1_epi8(' ');
+    const __m128i vtab = _mm_set1_epi8('\t');
+    const __m128i vnl = _mm_set1_epi8('\n');
+    const __m128i vcr = _mm_set1_epi8('\r');
+    const __m128i vctrl = _mm_set1_epi8(0x1F);
+
+    for (u32 i = 0; i < 64; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(block + i));
+        __m128i vl = _mm_or_si128(v, vlower);
+        m->quote |= (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vquote)) << i;
+        m->bslash |= (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vbslash)) << i;
+        m->open |= (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(vl, vopen)) << i;
+        m->close |= (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(vl, vclose)) << i;
+        m->sep |= (u64)(u16)_mm_movemask_epi8(
+                      _mm_or_si128(_mm_cmpeq_epi8(v, vcolon), _mm_cmpeq_epi8(v, vcomma))
+                  )
+               << i;
+        m->ws |= (u64)(u16)_mm_movemask_epi8(_mm_or_si128(
+                     _mm_or_si128(_mm_cmpeq_epi8(v, vspace), _mm_cmpeq_epi8(v, vtab)),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, vnl), _mm_cmpeq_epi8(v, vcr))
+                 ))
+              << i;
+        // unsigned v <= 0x1F  <=>  max(v, 0x1F) == 0x1F
+        m->ctrl |= (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, vctrl), vctrl)) << i;
+    }
+#else
+    for (u32 i = 0; i < 64; i++) {
+        u8 c = (u8)block[i];
+        u64 bit = 1ULL << i;
+        switch (c) {
+            case JSON__QUOTE:
+                m->quote |= bit;
+                break;
+            case '\\':
+                m->bslash |= bit;
+                break;
+            case '{':
+            case '[':
+                m->open |= bit;
+                break;
+            case '}':
+            case ']':
+                m->close |= bit;
+                break;
+            case ':':
+            case ',':
+                m->sep |= bit;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                m->ws |= bit;
+                break;
+            default:
+                break;
+        }
+        if (c < 0x20) {
+            m->ctrl |= bit;
+        }
+    }
+#endif
+}
+
+// Returns mask of chars escaped by odd-length backslash runs
+static inline u64
+json__escaped(u64 bslash, u64* prev_odd)
+{
+    const u64 even_bits = 0x5555555555555555ULL;
+    const u64 odd_bits = ~even_bits;
+
+    u64 start_edges = bslash & ~(bslash << 1);
+    // run which continues odd run of the previous block starts at "odd" position
+    u64 even_start_mask = even_bits ^ *prev_odd;
+    u64 even_starts = start_edges & even_start_mask;
+    u64 odd_starts = start_edges & ~even_start_mask;
+
+    u64 even_carries = bslash + even_starts;
+    u64 odd_carries;
+    bool ends_odd = __builtin_add_overflow(bslash, odd_starts, &odd_carries);
+    odd_carries |= *prev_odd;
+    *prev_odd = ends_odd ? 1 : 0;
+
+    u64 even_carry_ends = even_carries & ~bslash;
+    u64 odd_carry_ends = odd_carries & ~bslash;
+    return (even_carry_ends & odd_bits) | (odd_carry_ends & even_bits);
+}
+
+// Bit N is set if there is odd number of set bits in x[0..N]
+static inline u64
+json__prefix_xor(u64 x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Returns all structural positions of a block, and value starts (strings, scalars, containers)
+static inline Exception
+json__stage1(json__stage1_s* st, const char* block, u64* structurals, u64* values)
+{
+    json__masks_s m;
+    json__classify(block, &m);
+
+    u64 quote = m.quote & ~json__escaped(m.bslash, &st->prev_odd);
+    // includes opening quote, but not closing one
+    u64 in_string = json__prefix_xor(quote) ^ st->prev_in_string;
+    st->prev_in_string = (u64)((i64)in_string >> 63);
+    if (unlikely(m.ctrl & in_string)) {
+        return Error.integrity; // unescaped control char in string
+    }
+
+    u64 outside = ~in_string;
+    u64 open = m.open & outside;
+    u64 ops = (m.open | m.close | m.sep) & outside;
+    u64 scalar = ~(ops | m.ws | quote | in_string);
+    u64 scalar_start = scalar & ~((scalar << 1) | st->prev_scalar);
+    st->prev_scalar = scalar >> 63;
+
+    u64 strings = quote & in_string;
+    *values = strings | scalar_start | open;
+    *structurals = ops | strings | scalar_start;
+    return EOK;
+}
+
+static inline bool
+json__is_ws(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool
+json__is_number(const char* s, u32 len)
+{
+    u32 i = 0;
+    if (i < len && s[i] == '-') {
+        i++;
+    }
+    if (i == len) {
+        return false;
+    }
+    if (s[i] == '0') {
+        i++;
+    } else if (s[i] >= '1' && s[i] <= '9') {
+        while (i < len && s[i] >= '0' && s[i] <= '9') {
+            i++;
+        }
+    } else {
+        return false;
+    }
+    if (i < len && s[i] == '.') {
+        u32 start = ++i;
+        while (i < len && s[i] >= '0' && s[i] <= '9') {
+            i++;
+        }
+        if (i == start) {
+            return false;
+        }
+    }
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < len && (s[i] == '+' || s[i] == '-')) {
+            i++;
+        }
+        u32 start = i;
+        while (i < len && s[i] >= '0' && s[i] <= '9') {
+            i++;
+        }
+        if (i == start) {
+            return false;
+        }
+    }
+    return i == len;
+}
+
+static inline Exception
+json__push(json__parser_s* ps, json_type_e type, u32 offset, u32* idx)
+{
+    json_c* self = ps->json;
+    if (unlikely(self->_len == self->_cap)) {
+        return Error.overflow;
+    }
+    *idx = self->_len++;
+    self->_tape[*idx] = (json_tok_s){ .type = type, .offset = offset, .len = 0, .next = self->_len };
+    return EOK;
+}
+
+// Value is complete, it's accounted by parent container
+static inline void
+json__value_done(json__parser_s* ps)
+{
+    if (ps->depth == 0) {
+        ps->state = JSON__S_DONE;
+        return;
+    }
+    ps->json->_tape[ps->stack[ps->depth - 1]].len++;
+    ps->state = JSON__S_NEXT;
+}
+
+// Sets length of pending string/scalar, which ends before the next structural char at `end`
+static Exception
+json__finish_pending(json__parser_s* ps, u32 end)
+{
+    json_tok_s* t = &ps->json->_tape[ps->pending - 1];
+    const char* d = ps->json->_data.buf;
+    ps->pending = 0;
+
+    while (end > t->offset && json__is_ws(d[end - 1])) {
+        end--;
+    }
+
+    if (t->type == JSON_STRING) {
+        // non-whitespace after closing quote would be scalar start, i.e. structural
+        if (unlikely(end == t->offset || d[end - 1] != JSON__QUOTE)) {
+            return Error.integrity;
+        }
+        t->len = end - 1 - t->offset;
+        return EOK;
+    }
+
+    t->len = end - t->offset;
+    const char* s = d + t->offset;
+    if (json__is_number(s, t->len)) {
+        t->type = JSON_NUMBER;
+    } else if ((t->len == 4 && memcmp(s, "true", 4) == 0) ||
+               (t->len == 5 && memcmp(s, "false", 5) == 0)) {
+        t->type = JSON_BOOL;
+    } else if (t->len == 4 && memcmp(s, "null", 4) == 0) {
+        t->type = JSON_NULL;
+    } else {
+        return Error.integrity;
+    }
+    return EOK;
+}
+
+static Exception
+json__token(json__parser_s* ps, u32 pos)
+{
+    json_c* self = ps->json;
+    if (ps->pending) {
+        e$ret(json__finish_pending(ps, pos));
+    }
+
+    u32 idx;
+    char c = self->_data.buf[pos];
+    switch (c) {
+        case '{':
+        case '[':
+            if (unlikely(ps->state != JSON__S_VALUE && ps->state != JSON__S_VALUE_OR_END)) {
+                return Error.integrity;
+            }
+            if (unlikely(ps->depth == JSON_MAX_DEPTH)) {
+                return Error.overflow;
+            }
+            e$ret(json__push(ps, c == '{' ? JSON_OBJECT : JSON_ARRAY, pos, &idx));
+            ps->stack[ps->depth++] = idx;
+            ps->state = c == '{' ? JSON__S_KEY_OR_END : JSON__S_VALUE_OR_END;
+            return EOK;
+
+        case '}':
+        case ']': {
+            if (unlikely(ps->depth == 0)) {
+                return Error.integrity;
+            }
+            json_tok_s* t = &self->_tape[ps->stack[ps->depth - 1]];
+            bool ok = (c == '}') ? t->type == JSON_OBJECT &&
+                                       (ps->state == JSON__S_KEY_OR_END || ps->state == JSON__S_NEXT)
+                                 : t->type == JSON_ARRAY && (ps->state == JSON__S_VALUE_OR_END ||
+                                                             ps->state == JSON__S_NEXT);
+            if (unlikely(!ok)) {
+                return Error.integrity;
+            }
+            t->next = self->_len;
+            ps->depth--;
+            json__value_done(ps);
+            return EOK;
+        }
+
+        case ':':
+            if (unlikely(ps->state != JSON__S_COLON)) {
+                return Error.integrity;
+            }
+            ps->state = JSON__S_VALUE;
+            return EOK;
+
+        case ',':
+            if (unlikely(ps->state != JSON__S_NEXT)) {
+                return Error.integrity;
+            }
+            ps->state = self->_tape[ps->stack[ps->depth - 1]].type == JSON_OBJECT ? JSON__S_KEY
+                                                                                   : JSON__S_VALUE;
+            return EOK;
+
+        case JSON__QUOTE:
+            if (ps->state == JSON__S_KEY || ps->state == JSON__S_KEY_OR_END) {
+                e$ret(json__push(ps, JSON_STRING, pos + 1, &idx));
+                ps->pending = idx + 1;
+                ps->state = JSON__S_COLON;
+                return EOK;
+            }
+            if (unlikely(ps->state != JSON__S_VALUE && ps->state != JSON__S_VALUE_OR_END)) {
+                return Error.integrity;
+            }
+            e$ret(json__push(ps, JSON_STRING, pos + 1, &idx));
+            ps->pending = idx + 1;
+            json__value_done(ps);
+            return EOK;
+
+        default:
+            if (unlikely(ps->state != JSON__S_VALUE && ps->state != JSON__S_VALUE_OR_END)) {
+                return Error.integrity;
+            }
+            // scalar type is resolved when its end is known
+            e$ret(json__push(ps, JSON_NUMBER, pos, &idx));
+            ps->pending = idx + 1;
+            json__value_done(ps);
+            return EOK;
+    }
+}
+
+// Returns 64-byte block at base, the last partial block is copied into tail and padded by spaces
+static inline const char*
+json__block(str_c data, size_t base, char tail[64])
+{
+    if (data.len - base >= 64) {
+        return data.buf + base;
+    }
+    memset(tail, ' ', 64);
+    memcpy(tail, data.buf + base, data.len - base);
+    return tail;
+}
+
+static Exception
+json__parse(json_c* self)
+{
+    json__parser_s ps = { .json = self, .state = JSON__S_VALUE };
+    json__stage1_s st = { 0 };
+
+    char tail[64];
+
+    for (size_t base = 0; base < self->_data.len; base += 64) {
+        const char* block = json__block(self->_data, base, tail);
+        u64 structurals, values;
+        e$ret(json__stage1(&st, block, &structurals, &values));
+        while (structurals) {
+            e$ret(json__token(&ps, base + __builtin_ctzll(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+
+    if (st.prev_in_string) {
+        return Error.integrity; // unterminated string
+    }
+    if (ps.pending) {
+        e$ret(json__finish_pending(&ps, self->_data.len));
+    }
+    if (ps.state != JSON__S_DONE) {
+        return Error.integrity;
+    }
+    return EOK;
+}
+
+static Exception
+json__count_values(str_c data, u32* count)
+{
+    json__stage1_s st = { 0 };
+    u32 n = 0;
+
+    char tail[64];
+
+    for (size_t base = 0; base < data.len; base += 64) {
+        const char* block = json__block(data, base, tail);
+        u64 structurals, values;
+        e$ret(json__stage1(&st, block, &structurals, &values));
+        n += __builtin_popcountll(values);
+    }
+    *count = n;
+    return EOK;
+}
+
+static inline u32
+json__index(json_c* self, json_tok_s* tok)
+{
+    uassert(tok >= self->_tape && tok < self->_tape + self->_len && "token is not from this tape");
+    return tok - self->_tape;
+}
+
+static inline bool
+json__hex4(const char* p, const char* end, u32* out)
+{
+    if (end - p < 4) {
+        return false;
+    }
+    u32 v = 0;
+    for (u32 i = 0; i < 4; i++) {
+        char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') {
+            v |= c - '0';
+        } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            v |= (c | 0x20) - 'a' + 10;
+        } else {
+            return false;
+        }
+    }
+    *out = v;
+    return true;
+}
+
+static inline u32
+json__utf8(u32 cp, char* buf)
+{
+    if (cp < 0x80) {
+        buf[0] = cp;
+        return 1;
+    } else if (cp < 0x800) {
+        buf[0] = 0xC0 | (cp >> 6);
+        buf[1] = 0x80 | (cp & 0x3F);
+        return 2;
+    } else if (cp < 0x10000) {
+        buf[0] = 0xE0 | (cp >> 12);
+        buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[2] = 0x80 | (cp & 0x3F);
+        return 3;
+    } else {
+        buf[0] = 0xF0 | (cp >> 18);
+        buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+        buf[2] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[3] = 0x80 | (cp & 0x3F);
+        return 4;
+    }
+}
+
+/**
+ * @brief Parses JSON document into caller provided tape (no allocations)
+ *
+ * NOTE: instance parsed by json.parse_alloc() must be destroyed before reuse
+ *
+ * @param self json_c instance
+ * @param data JSON document (must stay alive while tokens are used)
+ * @param tape tokens storage (one token per value or key)
+ * @param tape_cap number of tokens in tape
+ * @return Error.integrity on invalid JSON, Error.overflow if tape is too small, or nesting
+ *         exceeds JSON_MAX_DEPTH
+ */
+Exception
+json_parse(json_c* self, str_c data, json_tok_s* tape, u32 tape_cap)
+{
+    uassert(self != NULL);
+    memset(self, 0, sizeof(*self));
+
+    if (data.buf == NULL || tape == NULL || tape_cap == 0) {
+        return Error.argument;
+    }
+    if (data.len >= UINT32_MAX) {
+        return Error.overflow;
+    }
+
+    self->_data = data;
+    self->_tape = tape;
+    self->_cap = tape_cap;
+
+    Exc err = json__parse(self);
+    if (err) {
+        self->_len = 0;
+    }
+    return err;
+}
+
+/**
+ * @brief Parses JSON document into tape allocated by allocator
+ *
+ * Tape size is counted by stage 1 pass before parsing, so it's a single allocation (arena
+ * allocators are fine).
+ *
+ * @param self json_c instance
+ * @param data JSON document (must stay alive while tokens are used)
+ * @param allocator tape allocator
+ * @return Error.integrity on invalid JSON, Error.overflow if nesting exceeds JSON_MAX_DEPTH
+ */
+Exception
+json_parse_alloc(json_c* self, str_c data, const Allocator_i* allocator)
+{
+    uassert(self != NULL);
+    uassert(allocator != NULL);
+    memset(self, 0, sizeof(*self));
+
+    if (data.buf == NULL) {
+        return Error.argument;
+    }
+    if (data.len >= UINT32_MAX) {
+        return Error.overflow;
+    }
+
+    Exc result = Error.runtime;
+    u32 count = 0;
+    e$goto(result = json__count_values(data, &count), fail);
+
+    self->_allocator = allocator;
+    self->_tape = allocator->malloc(sizeof(json_tok_s) * (count > 0 ? count : 1));
+    if (self->_tape == NULL) {
+        result = Error.memory;
+        goto fail;
+    }
+    self->_own_tape = true;
+    self->_data = data;
+    self->_cap = count;
+
+    e$goto(result = json__parse(self), fail);
+
+    return EOK;
+
+fail:
+    json.destroy(self);
+    return result;
+}
+
+/**
+ * @brief Returns top-level value
+ *
+ * @param self json_c instance
+ * @return root token, or NULL if nothing was parsed
+ */
+json_tok_s*
+json_root(json_c* self)
+{
+    uassert(self != NULL);
+    return self->_len > 0 ? &self->_tape[0] : NULL;
+}
+
+/**
+ * @brief Finds object value by key (keys are compared as raw JSON text, i.e. not unescaped)
+ *
+ * @param self json_c instance
+ * @param obj object token
+ * @param key
+ * @return value token, or NULL if not found (or obj is not an object)
+ */
+json_tok_s*
+json_get(json_c* self, json_tok_s* obj, str_c key)
+{
+    uassert(self != NULL);
+    if (obj == NULL || obj->type != JSON_OBJECT || key.buf == NULL) {
+        return NULL;
+    }
+
+    u32 i = json__index(self, obj) + 1;
+    while (i < obj->next) {
+        json_tok_s* k = &self->_tape[i];
+        json_tok_s* v = &self->_tape[i + 1];
+        if (k->len == key.len && memcmp(self->_data.buf + k->offset, key.buf, key.len) == 0) {
+            return v;
+        }
+        i = v->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns array item by index
+ *
+ * @param self json_c instance
+ * @param arr array token
+ * @param index item index
+ * @return item token, or NULL if out of range (or arr is not an array)
+ */
+json_tok_s*
+json_at(json_c* self, json_tok_s* arr, u32 index)
+{
+    uassert(self != NULL);
+    if (arr == NULL || arr->type != JSON_ARRAY || index >= arr->len) {
+        return NULL;
+    }
+
+    u32 i = json__index(self, arr) + 1;
+    while (index-- > 0) {
+        i = self->_tape[i].next;
+    }
+    return &self->_tape[i];
+}
+
+/**
+ * @brief Iterates over array items or object values (children are skipped via tape links)
+ *
+ * For objects, key token of the value is it.val - 1 (keys precede their values on the tape)
+ *
+ * for$iter(json_tok_s, it, json.iter(&js, arr, &it.iterator))
+ *
+ * @param self json_c instance
+ * @param container array or object token
+ * @param iterator
+ * @return item token, it.idx.i is item index
+ */
+json_tok_s*
+json_iter(json_c* self, json_tok_s* container, cex_iterator_s* iterator)
+{
+    uassert(self != NULL);
+    uassert(iterator != NULL && "null iterator");
+
+    // temporary struct based on _ctxbuffer
+    struct iter_ctx
+    {
+        u32 cursor;
+        u32 end;
+        bool is_object;
+    }* ctx = (struct iter_ctx*)iterator->_ctx;
+    _Static_assert(sizeof(*ctx) <= sizeof(iterator->_ctx), "ctx size overflow");
+    _Static_assert(alignof(struct iter_ctx) <= alignof(size_t), "cex_iterator_s _ctx misalign");
+
+    if (unlikely(iterator->val == NULL)) {
+        // First run handling
+        if (container == NULL ||
+            (container->type != JSON_OBJECT && container->type != JSON_ARRAY)) {
+            return NULL;
+        }
+        ctx->cursor = json__index(self, container) + 1;
+        ctx->end = container->next;
+        ctx->is_object = container->type == JSON_OBJECT;
+        iterator->idx.i = 0;
+    } else {
+        ctx->cursor = ((json_tok_s*)iterator->val)->next;
+        iterator->idx.i++;
+    }
+
+    if (ctx->cursor >= ctx->end) {
+        return NULL;
+    }
+    if (ctx->is_object) {
+        ctx->cursor++; // skip key
+    }
+    iterator->val = &self->_tape[ctx->cursor];
+    return iterator->val;
+}
+
+/**
+ * @brief Returns raw JSON text of string (without quotes, escaped), number or literal
+ *
+ * @param self json_c instance
+ * @param tok value token
+ * @return text view into source data, or (str_c){0} for containers and NULL tok
+ */
+str_c
+json_text(json_c* self, json_tok_s* tok)
+{
+    uassert(self != NULL);
+    if (tok == NULL || tok->type == JSON_OBJECT || tok->type == JSON_ARRAY) {
+        return (str_c){ 0 };
+    }
+    return (str_c){ .buf = self->_data.buf + tok->offset, .len = tok->len };
+}
+
+/**
+ * @brief Converts number token to i64 (via str.to_i64())
+ *
+ * @param self json_c instance
+ * @param tok number token
+ * @param out result
+ * @return Error.argument if tok is not a number, or str.to_i64() error
+ */
+Exception
+json_to_i64(json_c* self, json_tok_s* tok, i64* out)
+{
+    if (tok == NULL || tok->type != JSON_NUMBER) {
+        return Error.argument;
+    }
+    return str.to_i64(json_text(self, tok), out);
+}
+
+/**
+ * @brief Converts number token to u64 (via str.to_u64())
+ *
+ * @param self json_c instance
+ * @param tok number token
+ * @param out result
+ * @return Error.argument if tok is not a number, or str.to_u64() error
+ */
+Exception
+json_to_u64(json_c* self, json_tok_s* tok, u64* out)
+{
+    if (tok == NULL || tok->type != JSON_NUMBER) {
+        return Error.argument;
+    }
+    return str.to_u64(json_text(self, tok), out);
+}
+
+/**
+ * @brief Converts number token to f64 (via str.to_f64())
+ *
+ * @param self json_c instance
+ * @param tok number token
+ * @param out result
+ * @return Error.argument if tok is not a number, or str.to_f64() error
+ */
+Exception
+json_to_f64(json_c* self, json_tok_s* tok, f64* out)
+{
+    if (tok == NULL || tok->type != JSON_NUMBER) {
+        return Error.argument;
+    }
+    return str.to_f64(json_text(self, tok), out);
+}
+
+/**
+ * @brief Converts true/false token
+ *
+ * @param self json_c instance
+ * @param tok boolean token
+ * @param out result
+ * @return Error.argument if tok is not a boolean
+ */
+Exception
+json_to_bool(json_c* self, json_tok_s* tok, bool* out)
+{
+    uassert(self != NULL);
+    if (tok == NULL || tok->type != JSON_BOOL) {
+        return Error.argument;
+    }
+    *out = self->_data.buf[tok->offset] == 't';
+    return EOK;
+}
+
+/**
+ * @brief Appends unescaped string value to sbuf (\uXXXX escapes are converted to UTF-8)
+ *
+ * NOTE: unpaired surrogate escapes (e.g. "\udb43x") are replaced by U+FFFD, like most decoders do
+ *
+ * @param self json_c instance
+ * @param tok string token (value or key)
+ * @param out destination buffer
+ * @return Error.argument if tok is not a string, Error.integrity on bad escape sequence
+ */
+Exception
+json_unescape(json_c* self, json_tok_s* tok, sbuf_c* out)
+{
+    uassert(self != NULL);
+    uassert(out != NULL);
+    if (tok == NULL || tok->type != JSON_STRING) {
+        return Error.argument;
+    }
+
+    const char* p = self->_data.buf + tok->offset;
+    const char* end = p + tok->len;
+    while (p < end) {
+        const char* e = memchr(p, '\\', end - p);
+        if (e == NULL) {
+            e = end;
+        }
+        if (e > p) {
+            e$ret(sbuf.append(out, (str_c){ .buf = (char*)p, .len = e - p }));
+        }
+        if (e == end) {
+            break;
+        }
+
+        // NOTE: backslash can't be the last char, it would escape closing quote
+        char buf[4];
+        u32 n = 1;
+        p = e + 2;
+        switch (e[1]) {
+            case JSON__QUOTE:
+            case '\\':
+            case '/':
+                buf[0] = e[1];
+                break;
+            case 'b':
+                buf[0] = '\b';
+                break;
+            case 'f':
+                buf[0] = '\f';
+                break;
+            case 'n':
+                buf[0] = '\n';
+                break;
+            case 'r':
+                buf[0] = '\r';
+                break;
+            case 't':
+                buf[0] = '\t';
+                break;
+            case 'u': {
+                u32 cp;
+                if (!json__hex4(p, end, &cp)) {
+                    return Error.integrity;
+                }
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    // high surrogate is paired only with following \uDC00..\uDFFF
+                    u32 lo;
+                    if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && json__hex4(p + 2, end, &lo) &&
+                        lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        p += 6;
+                    } else {
+                        cp = 0xFFFD; // unpaired, next escape is decoded on its own
+                    }
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    cp = 0xFFFD; // unpaired low surrogate
+                }
+                n = json__utf8(cp, buf);
+                break;
+            }
+            default:
+                return Error.integrity;
+        }
+        e$ret(sbuf.append(out, (str_c){ .buf = buf, .len = n }));
+    }
+    return EOK;
+}
+
+/**
+ * @brief Frees tape allocated by json.parse_alloc() (caller tape and data are not freed)
+ *
+ * @param self json_c instance
+ */
+void
+json_destroy(json_c* self)
+{
+    if (self == NULL) {
+        return;
+    }
+    if (self->_own_tape && self->_tape != NULL) {
+        self->_allocator->free(self->_tape);
+    }
+    memset(self, 0, sizeof(*self));
+}
+const struct __module__json json = {
+    // Autogenerated by CEX
+    // clang-format off
+    .parse = json_parse,
+    .parse_alloc = json_parse_alloc,
+    .root = json_root,
+    .get = json_get,
+    .at = json_at,
+    .iter = json_iter,
+    .text = json_text,
+    .to_i64 = json_to_i64,
+    .to_u64 = json_to_u64,
+    .to_f64 = json_to_f64,
+    .to_bool = json_to_bool,
+    .unescape = json_unescape,
+    .destroy = json_destroy,
+    // clang-format on
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include <cex.h>
+
+// Max nesting level of objects/arrays
+#define JSON_MAX_DEPTH 256
+
+typedef enum
+{
+    JSON_OBJECT = 1,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_BOOL,
+    JSON_NULL,
+} json_type_e;
+
+/**
+ * @brief Tape token of parsed JSON value (object keys are JSON_STRING tokens followed by values)
+ */
+typedef struct
+{
+    json_type_e type;
+    u32 offset; // data offset: string contents (after the quote), scalar text, or opening bracket
+    u32 len;    // text length of string/number/literal, number of items/key-value pairs of container
+    u32 next;   // tape index of the next sibling (i.e. after all children of container)
+} json_tok_s;
+
+/**
+ * @brief On-demand JSON parser
+ *
+ * Parsing builds a flat tape of tokens which refer to the source data (zero-copy), values are
+ * converted only when requested by json.to_*() / json.unescape(). Source data and tape must stay
+ * alive while tokens are in use.
+ *
+ * Stage 1 classifies 64-byte blocks with SIMD into bitmasks of quotes, escapes and structural
+ * chars, stage 2 walks the set bits of a block and validates the grammar while building the tape.
+ */
+typedef struct
+{
+    str_c _data;
+    json_tok_s* _tape;
+    u32 _len; // number of tokens in the tape
+    u32 _cap;
+    bool _own_tape; // tape was allocated by json.parse_alloc()
+    const Allocator_i* _allocator;
+} json_c;
+struct __module__json
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Parses JSON document into caller provided tape (no allocations)
+ *
+ * NOTE: instance parsed by json.parse_alloc() must be destroyed before reuse
+ *
+ * @param self json_c instance
+ * @param data JSON document (must stay alive while tokens are used)
+ * @param tape tokens storage (one token per value or key)
+ * @param tape_cap number of tokens in tape
+ * @return Error.integrity on invalid JSON, Error.overflow if tape is too small, or nesting
+ *         exceeds JSON_MAX_DEPTH
+ */
+Exception
+(*parse)(json_c* self, str_c data, json_tok_s* tape, u32 tape_cap);
+
+/**
+ * @brief Parses JSON document into tape allocated by allocator
+ *
+ * Tape size is counted by stage 1 pass before parsing, so it's a single allocation (arena
+ * allocators are fine).
+ *
+ * @param self json_c instance
+ * @param data JSON document (must stay alive while tokens are used)
+ * @param allocator tape allocator
+ * @return Error.integrity on invalid JSON, Error.overflow if nesting exceeds JSON_MAX_DEPTH
+ */
+Exception
+(*parse_alloc)(json_c* self, str_c data, const Allocator_i* allocator);
+
+/**
+ * @brief Returns top-level value
+ *
+ * @param self json_c instance
+ * @return root token, or NULL if nothing was parsed
+ */
+json_tok_s*
+(*root)(json_c* self);
+
+/**
+ * @brief Finds object value by key (keys are compared as raw JSON text, i.e. not unescaped)
+ *
+ * @param self json_c instance
+ * @param obj object token
+ * @param key
+ * @return value token, or NULL if not found (or obj is not an object)
+ */
+json_tok_s*
+(*get)(json_c* self, json_tok_s* obj, str_c key);
+
+/**
+ * @brief Returns array item by index
+ *
+ * @param self json_c instance
+ * @param arr array token
+ * @param index item index
+ * @return item token, or NULL if out of range (or arr is not an array)
+ */
+json_tok_s*
+(*at)(json_c* self, json_tok_s* arr, u32 index);
+
+/**
+ * @brief Iterates over array items or object values (children are skipped via tape links)
+ *
+ * For objects, key token of the value is it.val - 1 (keys precede their values on the tape)
+ *
+ * for$iter(json_tok_s, it, json.iter(&js, arr, &it.iterator))
+ *
+ * @param self json_c instance
+ * @param container array or object token
+ * @param iterator
+ * @return item token, it.idx.i is item index
+ */
+json_tok_s*
+(*iter)(json_c* self, json_tok_s* container, cex_iterator_s* iterator);
+
+/**
+ * @brief Returns raw JSON text of string (without quotes, escaped), number or literal
+ *
+ * @param self json_c instance
+ * @param tok value token
+ * @return text view into source data, or (str_c){0} for containers and NULL tok
+ */
+str_c
+(*text)(json_c* self, json_tok_s* tok);
+
+/**
+ * @brief Converts number token to i64 (via str.to_i64())
+ *
+ * @param self json_c instance
+ * @param tok number token
+ * @param out result
+ * @return Error.argument if tok is not a number, or str.to_i64() error
+ */
+Exception
+(*to_i64)(json_c* self, json_tok_s* tok, i64* out);
+
+/**
+ * @brief Converts number token to u64 (via str.to_u64())
+ *
+ * @param self json_c instance
+ * @param tok number token
+ * @param out result
+ * @return Error.argument if tok is not a number, or str.to_u64() error
+ */
+Exception
+(*to_u64)(json_c* self, json_tok_s* tok, u64* out);
+
+/**
+ * @brief Converts number token to f64 (via str.to_f64())
+ *
+ * @param self json_c instance
+ * @param tok number token
+ * @param out result
+ * @return Error.argument if tok is not a number, or str.to_f64() error
+ */
+Exception
+(*to_f64)(json_c* self, json_tok_s* tok, f64* out);
+
+/**
+ * @brief Converts true/false token
+ *
+ * @param self json_c instance
+ * @param tok boolean token
+ * @param out result
+ * @return Error.argument if tok is not a boolean
+ */
+Exception
+(*to_bool)(json_c* self, json_tok_s* tok, bool* out);
+
+/**
+ * @brief Appends unescaped string value to sbuf (\uXXXX escapes are converted to UTF-8)
+ *
+ * NOTE: unpaired surrogate escapes (e.g. "\udb43x") are replaced by U+FFFD, like most decoders do
+ *
+ * @param self json_c instance
+ * @param tok string token (value or key)
+ * @param out destination buffer
+ * @return Error.argument if tok is not a string, Error.integrity on bad escape sequence
+ */
+Exception
+(*unescape)(json_c* self, json_tok_s* tok, sbuf_c* out);
+
+/**
+ * @brief Frees tape allocated by json.parse_alloc() (caller tape and data are not freed)
+ *
+ * @param self json_c instance
+ */
+void
+(*destroy)(json_c* self);
+
+    // clang-format on
+};
+extern const struct __module__json json; // CEX Autogen
@@ -0,0 +1,541 @@
+#include "jsonw.h"
+#include <cex.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define JSONW__OBJECT 0x1 // level is object (otherwise array)
+#define JSONW__ITEMS 0x2  // level has items (comma is needed before the next one)
+
+// NOTE: quote literals are kept out of function bodies, they confuse `cex process` parser
+#define JSONW__QUOTE '"'
+#define JSONW__QUOTE_S "\""
+
+// Finds the first char which must be escaped in JSON string: '"', '\\' or control char < 0x20
+static inline const char*
+jsonw__scan(const char* p, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i vquote = _mm_set1_epi8(JSONW__QUOTE);
+    const __m128i vslash = _mm_set1_epi8('\\');
+    const __m128i vctrl = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        // unsigned v <= 0x1F  <=>  max(v, 0x1F) == 0x1F
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, vquote), _mm_cmpeq_epi8(v, vslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, vctrl), vctrl)
+        );
+        int mask = _mm_movemask_epi8(m);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; p++) {
+        u8 c = *p;
+        if (c == JSONW__QUOTE || c == '\\' || c < 0x20) {
+            return p;
+        }
+    }
+    return end;
+}
+
+static Exception
+jsonw__flush(jsonw_c* self, bool force)
+{
+    if (self->_file == NULL) {
+        return EOK;
+    }
+    size_t len = sbuf.len(&self->_buf);
+    if (len == 0 || (!force && len < JSONW_FLUSH_SIZE)) {
+        return EOK;
+    }
+    e$ret(io.write(self->_file, self->_buf, 1, len));
+    sbuf.clear(&self->_buf);
+    return EOK;
+}
+
+static inline Exception
+jsonw__set_error(jsonw_c* self, Exc err)
+{
+    if (self->_err == EOK) {
+        self->_err = err;
+    }
+    return self->_err;
+}
+
+// Writes separator before a new value, and validates that value is allowed here
+static Exception
+jsonw__before_value(jsonw_c* self)
+{
+    if (self->_err) {
+        return self->_err;
+    }
+    if (self->_depth == 0) {
+        if (self->_has_top) {
+            e$ret(sbuf.append(self->_out, s$("\n")));
+        }
+        self->_has_top = true;
+        return EOK;
+    }
+
+    u8* level = &self->_stack[self->_depth - 1];
+    if (*level & JSONW__OBJECT) {
+        if (!self->_has_key) {
+            // object value without a key
+            return Error.integrity;
+        }
+        self->_has_key = false;
+    } else {
+        if (*level & JSONW__ITEMS) {
+            e$ret(sbuf.append(self->_out, s$(",")));
+        }
+    }
+    *level |= JSONW__ITEMS;
+    return EOK;
+}
+
+static Exception
+jsonw__write_str(jsonw_c* self, str_c s)
+{
+    static const char hex[] = "0123456789abcdef";
+    sbuf_c* out = self->_out;
+
+    // clean strings (the most common case) take exactly one allocation
+    e$ret(sbuf.reserve(out, s.len + 2));
+    e$ret(sbuf.append(out, s$(JSONW__QUOTE_S)));
+
+    const char* p = s.buf;
+    const char* end = s.buf + s.len;
+    while (p < end) {
+        const char* e = jsonw__scan(p, end);
+        if (e > p) {
+            // bulk copy of the clean run
+            e$ret(sbuf.append(out, (str_c){ .buf = (char*)p, .len = e - p }));
+        }
+        if (e == end) {
+            break;
+        }
+
+        char esc[6] = { '\\', 0 };
+        u32 esc_len = 2;
+        switch (*e) {
+            case JSONW__QUOTE:
+                esc[1] = JSONW__QUOTE;
+                break;
+            case '\\':
+                esc[1] = '\\';
+                break;
+            case '\n':
+                esc[1] = 'n';
+                break;
+            case '\r':
+                esc[1] = 'r';
+                break;
+            case '\t':
+                esc[1] = 't';
+                break;
+            case '\b':
+                esc[1] = 'b';
+                break;
+            case '\f':
+                esc[1] = 'f';
+                break;
+            default:
+                memcpy(esc, "\\u00", 4);
+                esc[4] = hex[(u8)*e >> 4];
+                esc[5] = hex[(u8)*e & 0xF];
+                esc_len = 6;
+                break;
+        }
+        e$ret(sbuf.append(out, (str_c){ .buf = esc, .len = esc_len }));
+        p = e + 1;
+    }
+
+    return sbuf.append(out, s$(JSONW__QUOTE_S));
+}
+
+static Exception
+jsonw__begin(jsonw_c* self, bool is_object)
+{
+    Exc err;
+    if ((err = jsonw__before_value(self))) {
+        return jsonw__set_error(self, err);
+    }
+    if (self->_depth >= JSONW_MAX_DEPTH) {
+        return jsonw__set_error(self, Error.overflow);
+    }
+    self->_stack[self->_depth++] = is_object ? JSONW__OBJECT : 0;
+    if ((err = sbuf.append(self->_out, is_object ? s$("{") : s$("[")))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+static Exception
+jsonw__end(jsonw_c* self, bool is_object)
+{
+    if (self->_err) {
+        return self->_err;
+    }
+    if (self->_depth == 0 || (bool)(self->_stack[self->_depth - 1] & JSONW__OBJECT) != is_object ||
+        self->_has_key) {
+        // unbalanced, or object key without a value
+        return jsonw__set_error(self, Error.integrity);
+    }
+    self->_depth--;
+
+    Exc err;
+    if ((err = sbuf.append(self->_out, is_object ? s$("}") : s$("]")))) {
+        return jsonw__set_error(self, err);
+    }
+    if ((err = jsonw__flush(self, false))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+static Exception
+jsonw__scalar(jsonw_c* self, str_c raw)
+{
+    Exc err;
+    if ((err = jsonw__before_value(self)) || (err = sbuf.append(self->_out, raw)) ||
+        (err = jsonw__flush(self, false))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+/**
+ * @brief Creates JSON writer, which appends into existing sbuf
+ *
+ * @param self jsonw_c instance
+ * @param out destination sbuf
+ * @return
+ */
+Exception
+jsonw_create(jsonw_c* self, sbuf_c* out)
+{
+    if (self == NULL || out == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        uassert(out != NULL && "out must not be NULL");
+        return Error.argument;
+    }
+    memset(self, 0, sizeof(*self));
+    self->_out = out;
+    return EOK;
+}
+
+/**
+ * @brief Creates JSON writer into file (data is buffered, and written by JSONW_FLUSH_SIZE blocks)
+ *
+ * @param self jsonw_c instance
+ * @param file destination file
+ * @param allocator allocator for internal buffer
+ * @return
+ */
+Exception
+jsonw_create_io(jsonw_c* self, io_c* file, const Allocator_i* allocator)
+{
+    if (self == NULL || file == NULL || allocator == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        uassert(file != NULL && "file must not be NULL");
+        uassert(allocator != NULL && "allocator invalid");
+        return Error.argument;
+    }
+    memset(self, 0, sizeof(*self));
+    e$ret(sbuf.create(&self->_buf, JSONW_FLUSH_SIZE + 1024, allocator));
+    self->_out = &self->_buf;
+    self->_file = file;
+    self->_allocator = allocator;
+    return EOK;
+}
+
+/**
+ * @brief Begins JSON object
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity on invalid structure, Error.overflow if JSONW_MAX_DEPTH exceeded
+ */
+Exception
+jsonw_obj_begin(jsonw_c* self)
+{
+    uassert(self != NULL);
+    return jsonw__begin(self, true);
+}
+
+/**
+ * @brief Ends JSON object
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity if there is no matching jsonw.obj_begin()
+ */
+Exception
+jsonw_obj_end(jsonw_c* self)
+{
+    uassert(self != NULL);
+    return jsonw__end(self, true);
+}
+
+/**
+ * @brief Begins JSON array
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity on invalid structure, Error.overflow if JSONW_MAX_DEPTH exceeded
+ */
+Exception
+jsonw_arr_begin(jsonw_c* self)
+{
+    uassert(self != NULL);
+    return jsonw__begin(self, false);
+}
+
+/**
+ * @brief Ends JSON array
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity if there is no matching jsonw.arr_begin()
+ */
+Exception
+jsonw_arr_end(jsonw_c* self)
+{
+    uassert(self != NULL);
+    return jsonw__end(self, false);
+}
+
+/**
+ * @brief Writes object key (escaped), the next call must write its value
+ *
+ * @param self jsonw_c instance
+ * @param key
+ * @return Error.integrity if not inside object, or previous key has no value
+ */
+Exception
+jsonw_key(jsonw_c* self, str_c key)
+{
+    uassert(self != NULL);
+
+    if (self->_err) {
+        return self->_err;
+    }
+    if (key.buf == NULL) {
+        return jsonw__set_error(self, Error.argument);
+    }
+    if (self->_depth == 0 || !(self->_stack[self->_depth - 1] & JSONW__OBJECT) || self->_has_key) {
+        return jsonw__set_error(self, Error.integrity);
+    }
+
+    u8* level = &self->_stack[self->_depth - 1];
+    Exc err;
+    if ((*level & JSONW__ITEMS) && (err = sbuf.append(self->_out, s$(",")))) {
+        return jsonw__set_error(self, err);
+    }
+    if ((err = jsonw__write_str(self, key)) || (err = sbuf.append(self->_out, s$(":")))) {
+        return jsonw__set_error(self, err);
+    }
+    *level |= JSONW__ITEMS;
+    self->_has_key = true;
+    return EOK;
+}
+
+/**
+ * @brief Writes string value (escaped)
+ *
+ * @param self jsonw_c instance
+ * @param value string (NULL string is written as null)
+ * @return
+ */
+Exception
+jsonw_str(jsonw_c* self, str_c value)
+{
+    uassert(self != NULL);
+
+    if (value.buf == NULL) {
+        return jsonw__scalar(self, s$("null"));
+    }
+
+    Exc err;
+    if ((err = jsonw__before_value(self)) || (err = jsonw__write_str(self, value)) ||
+        (err = jsonw__flush(self, false))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+/**
+ * @brief Writes integer value
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return
+ */
+Exception
+jsonw_i64(jsonw_c* self, i64 value)
+{
+    uassert(self != NULL);
+
+    Exc err;
+    if ((err = jsonw__before_value(self)) || (err = sbuf.append_i64(self->_out, value)) ||
+        (err = jsonw__flush(self, false))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+/**
+ * @brief Writes unsigned integer value
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return
+ */
+Exception
+jsonw_u64(jsonw_c* self, u64 value)
+{
+    uassert(self != NULL);
+
+    Exc err;
+    if ((err = jsonw__before_value(self)) || (err = sbuf.append_u64(self->_out, value)) ||
+        (err = jsonw__flush(self, false))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+/**
+ * @brief Writes floating point value (shortest round-trip representation)
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return Error.argument for NaN and infinity (not allowed in JSON)
+ */
+Exception
+jsonw_f64(jsonw_c* self, f64 value)
+{
+    uassert(self != NULL);
+
+    if (self->_err) {
+        return self->_err;
+    }
+    if (!isfinite(value)) {
+        return jsonw__set_error(self, Error.argument);
+    }
+
+    Exc err;
+    if ((err = jsonw__before_value(self)) || (err = sbuf.append_f64(self->_out, value)) ||
+        (err = jsonw__flush(self, false))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+/**
+ * @brief Writes boolean value
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return
+ */
+Exception
+jsonw_boolean(jsonw_c* self, bool value)
+{
+    uassert(self != NULL);
+    return jsonw__scalar(self, value ? s$("true") : s$("false"));
+}
+
+/**
+ * @brief Writes null value
+ *
+ * @param self jsonw_c instance
+ * @return
+ */
+Exception
+jsonw_null(jsonw_c* self)
+{
+    uassert(self != NULL);
+    return jsonw__scalar(self, s$("null"));
+}
+
+/**
+ * @brief Writes pre-formatted JSON value as is (not validated)
+ *
+ * @param self jsonw_c instance
+ * @param json valid JSON value
+ * @return
+ */
+Exception
+jsonw_raw(jsonw_c* self, str_c json)
+{
+    uassert(self != NULL);
+
+    if (json.buf == NULL || json.len == 0) {
+        return jsonw__set_error(self, Error.argument);
+    }
+    return jsonw__scalar(self, json);
+}
+
+/**
+ * @brief Checks that all objects/arrays are closed, and flushes buffered data to file
+ *
+ * @param self jsonw_c instance
+ * @return the first error of the writer, Error.integrity if structure is not complete
+ */
+Exception
+jsonw_finish(jsonw_c* self)
+{
+    uassert(self != NULL);
+
+    if (self->_err) {
+        return self->_err;
+    }
+    if (self->_depth != 0 || self->_has_key) {
+        return jsonw__set_error(self, Error.integrity);
+    }
+    Exc err;
+    if ((err = jsonw__flush(self, true))) {
+        return jsonw__set_error(self, err);
+    }
+    return EOK;
+}
+
+/**
+ * @brief Frees writer resources (destination sbuf/file is not freed/closed)
+ *
+ * @param self jsonw_c instance
+ */
+void
+jsonw_destroy(jsonw_c* self)
+{
+    if (self == NULL) {
+        return;
+    }
+    if (self->_buf != NULL) {
+        sbuf.destroy(&self->_buf);
+    }
+    memset(self, 0, sizeof(*self));
+}
+const struct __module__jsonw jsonw = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = jsonw_create,
+    .create_io = jsonw_create_io,
+    .obj_begin = jsonw_obj_begin,
+    .obj_end = jsonw_obj_end,
+    .arr_begin = jsonw_arr_begin,
+    .arr_end = jsonw_arr_end,
+    .key = jsonw_key,
+    .str = jsonw_str,
+    .i64 = jsonw_i64,
+    .u64 = jsonw_u64,
+    .f64 = jsonw_f64,
+    .boolean = jsonw_boolean,
+    .null = jsonw_null,
+    .raw = jsonw_raw,
+    .finish = jsonw_finish,
+    .destroy = jsonw_destroy,
+    // clang-format on
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <cex.h>
+
+// Max nesting level of objects/arrays
+#define JSONW_MAX_DEPTH 64
+
+// Buffered output size which triggers write to file (jsonw.create_io() mode)
+#define JSONW_FLUSH_SIZE (64 * 1024)
+
+/**
+ * @brief Streaming JSON writer into sbuf_c or io_c
+ *
+ * Takes care of commas, colons and string escaping, and validates structure (keys only in objects,
+ * balanced objects/arrays). The first error is sticky: all later calls return it as well,
+ * so a sequence of calls can be checked once by jsonw.finish(). Multiple top-level values are
+ * separated by new line (JSON lines).
+ */
+typedef struct
+{
+    sbuf_c* _out;  // destination buffer (user sbuf, or _buf in io mode)
+    sbuf_c _buf;   // own buffer (io mode)
+    io_c* _file;   // destination file (io mode)
+    Exc _err;      // sticky error
+    u32 _depth;
+    bool _has_key; // key was written, object value is expected
+    bool _has_top; // top-level value was written
+    u8 _stack[JSONW_MAX_DEPTH]; // JSONW__* flags of nesting levels
+    const Allocator_i* _allocator;
+} jsonw_c;
+struct __module__jsonw
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates JSON writer, which appends into existing sbuf
+ *
+ * @param self jsonw_c instance
+ * @param out destination sbuf
+ * @return
+ */
+Exception
+(*create)(jsonw_c* self, sbuf_c* out);
+
+/**
+ * @brief Creates JSON writer into file (data is buffered, and written by JSONW_FLUSH_SIZE blocks)
+ *
+ * @param self jsonw_c instance
+ * @param file destination file
+ * @param allocator allocator for internal buffer
+ * @return
+ */
+Exception
+(*create_io)(jsonw_c* self, io_c* file, const Allocator_i* allocator);
+
+/**
+ * @brief Begins JSON object
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity on invalid structure, Error.overflow if JSONW_MAX_DEPTH exceeded
+ */
+Exception
+(*obj_begin)(jsonw_c* self);
+
+/**
+ * @brief Ends JSON object
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity if there is no matching jsonw.obj_begin()
+ */
+Exception
+(*obj_end)(jsonw_c* self);
+
+/**
+ * @brief Begins JSON array
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity on invalid structure, Error.overflow if JSONW_MAX_DEPTH exceeded
+ */
+Exception
+(*arr_begin)(jsonw_c* self);
+
+/**
+ * @brief Ends JSON array
+ *
+ * @param self jsonw_c instance
+ * @return Error.integrity if there is no matching jsonw.arr_begin()
+ */
+Exception
+(*arr_end)(jsonw_c* self);
+
+/**
+ * @brief Writes object key (escaped), the next call must write its value
+ *
+ * @param self jsonw_c instance
+ * @param key
+ * @return Error.integrity if not inside object, or previous key has no value
+ */
+Exception
+(*key)(jsonw_c* self, str_c key);
+
+/**
+ * @brief Writes string value (escaped)
+ *
+ * @param self jsonw_c instance
+ * @param value string (NULL string is written as null)
+ * @return
+ */
+Exception
+(*str)(jsonw_c* self, str_c value);
+
+/**
+ * @brief Writes integer value
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return
+ */
+Exception
+(*i64)(jsonw_c* self, i64 value);
+
+/**
+ * @brief Writes unsigned integer value
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return
+ */
+Exception
+(*u64)(jsonw_c* self, u64 value);
+
+/**
+ * @brief Writes floating point value (shortest round-trip representation)
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return Error.argument for NaN and infinity (not allowed in JSON)
+ */
+Exception
+(*f64)(jsonw_c* self, f64 value);
+
+/**
+ * @brief Writes boolean value
+ *
+ * @param self jsonw_c instance
+ * @param value
+ * @return
+ */
+Exception
+(*boolean)(jsonw_c* self, bool value);
+
+/**
+ * @brief Writes null value
+ *
+ * @param self jsonw_c instance
+ * @return
+ */
+Exception
+(*null)(jsonw_c* self);
+
+/**
+ * @brief Writes pre-formatted JSON value as is (not validated)
+ *
+ * @param self jsonw_c instance
+ * @param json valid JSON value
+ * @return
+ */
+Exception
+(*raw)(jsonw_c* self, str_c json);
+
+/**
+ * @brief Checks that all objects/arrays are closed, and flushes buffered data to file
+ *
+ * @param self jsonw_c instance
+ * @return the first error of the writer, Error.integrity if structure is not complete
+ */
+Exception
+(*finish)(jsonw_c* self);
+
+/**
+ * @brief Frees writer resources (destination sbuf/file is not freed/closed)
+ *
+ * @param self jsonw_c instance
+ */
+void
+(*destroy)(jsonw_c* self);
+
+    // clang-format on
+};
+extern const struct __module__jsonw jsonw; // CEX Autogen
@@ -1,9 +1,21 @@
 #include "os.h"
 #include <cex.h>
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
 #include <linux/limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
 static Exception
@@ -118,3 +130,1618 @@ os__path__exists_(str_c path)
 
     return Error.ok;
 }
+
+struct os__dirent64
+{
+    u64 d_ino;
+    i64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+static inline long
+os__getdents64(int fd, char* buf, size_t size)
+{
+    return syscall(SYS_getdents64, fd, buf, size);
+}
+
+static inline bool
+os__is_dot_or_dotdot(const char* name)
+{
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+static inline os_ftype_e
+os__ftype(mode_t mode)
+{
+    return S_ISREG(mode)   ? OS_FTYPE_FILE
+         : S_ISDIR(mode) ? OS_FTYPE_DIR
+         : S_ISLNK(mode) ? OS_FTYPE_LINK
+                         : OS_FTYPE_OTHER;
+}
+
+static Exception
+os__walk_filter_create(
+    os__walk_filter_s* f,
+    const char* pattern,
+    u32 max_depth,
+    u32 flags,
+    const Allocator_i* allocator
+)
+{
+    memset(f, 0, sizeof(*f));
+    f->max_depth = max_depth;
+    f->flags = (flags & (OS_WALK_FILES | OS_WALK_DIRS)) ? flags
+                                                         : flags | OS_WALK_FILES | OS_WALK_DIRS;
+    if (pattern == NULL || pattern[0] == '\0') {
+        return EOK;
+    }
+
+    // patterns are '|' separated, split them in place of own copy
+    e$ret(sbuf.create(&f->pattern, strlen(pattern) + 1, allocator));
+    e$ret(sbuf.append(&f->pattern, s$(pattern)));
+    char* p = f->pattern;
+    while (true) {
+        if (f->npatterns == OS_WALK_MAX_PATTERNS) {
+            return Error.overflow;
+        }
+        f->patterns[f->npatterns++] = p;
+        p = strchr(p, '|');
+        if (p == NULL) {
+            break;
+        }
+        *p++ = '\0';
+    }
+    return EOK;
+}
+
+static void
+os__walk_filter_destroy(os__walk_filter_s* f)
+{
+    sbuf.destroy(&f->pattern);
+    memset(f, 0, sizeof(*f));
+}
+
+// Returns true if entry must be yielded, descend is set if it's a directory to walk into
+static inline bool
+os__walk_filter(
+    os__walk_filter_s* f,
+    int dirfd,
+    struct os__dirent64* d,
+    u32 depth,
+    os_ftype_e* type,
+    bool* descend
+)
+{
+    const char* name = d->d_name;
+    *descend = false;
+    if (name[0] == '.' && (os__is_dot_or_dotdot(name) || !(f->flags & OS_WALK_HIDDEN))) {
+        return false;
+    }
+
+    switch (d->d_type) {
+        case DT_REG:
+            *type = OS_FTYPE_FILE;
+            break;
+        case DT_DIR:
+            *type = OS_FTYPE_DIR;
+            break;
+        case DT_LNK:
+            *type = OS_FTYPE_LINK;
+            break;
+        case DT_UNKNOWN: {
+            // some filesystems don't fill d_type, only then stat is needed
+            struct stat st;
+            if (fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+                return false; // removed meanwhile
+            }
+            *type = os__ftype(st.st_mode);
+            break;
+        }
+        default:
+            *type = OS_FTYPE_OTHER;
+            break;
+    }
+
+    bool is_dir = *type == OS_FTYPE_DIR;
+    *descend = is_dir && (f->max_depth == 0 || depth + 1 < f->max_depth);
+    if (!(f->flags & (is_dir ? OS_WALK_DIRS : OS_WALK_FILES))) {
+        return false;
+    }
+    if (f->npatterns == 0) {
+        return true;
+    }
+    for (u32 i = 0; i < f->npatterns; i++) {
+        if (fnmatch(f->patterns[i], name, 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Opens directory, unreadable or removed subdirectories are skipped with *out_fd == -1
+// Symlinks are not followed for subdirectories, the root is resolved like opendir() does
+static Exception
+os__walk_open_dir(int dirfd, const char* path, bool is_root, int* out_fd)
+{
+    int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (is_root ? 0 : O_NOFOLLOW);
+    *out_fd = openat(dirfd, path, flags);
+    if (*out_fd != -1) {
+        return EOK;
+    }
+    if (!is_root && (errno == EACCES || errno == EPERM || errno == ENOENT)) {
+        return EOK;
+    }
+    switch (errno) {
+        case ENOENT:
+            return Error.not_found;
+        case ENOTDIR:
+        case ELOOP:
+            return Error.argument;
+        default:
+            return Error.io;
+    }
+}
+
+static Exception
+os__walk_push(os_walk_c* self, int dirfd, const char* name, u32 depth)
+{
+    int fd;
+    e$ret(os__walk_open_dir(dirfd, name, self->_nframes == 0, &fd));
+    if (fd == -1) {
+        return EOK;
+    }
+
+    if (self->_nframes == self->_frames_cap) {
+        u32 cap = self->_frames_cap > 0 ? self->_frames_cap * 2 : 16;
+        os__walk_frame_s* frames = (self->_frames == NULL)
+                                     ? self->_allocator->malloc(sizeof(os__walk_frame_s) * cap)
+                                     : self->_allocator->realloc(
+                                           self->_frames,
+                                           sizeof(os__walk_frame_s) * cap
+                                       );
+        if (frames == NULL) {
+            close(fd);
+            return Error.memory;
+        }
+        // dents buffers of popped frames are kept for reuse
+        memset(frames + self->_frames_cap, 0, sizeof(os__walk_frame_s) * (cap - self->_frames_cap));
+        self->_frames = frames;
+        self->_frames_cap = cap;
+    }
+
+    os__walk_frame_s* f = &self->_frames[self->_nframes];
+    if (f->dents == NULL) {
+        f->dents = self->_allocator->malloc(OS_WALK_BUF_SIZE);
+        if (f->dents == NULL) {
+            close(fd);
+            return Error.memory;
+        }
+    }
+    f->fd = fd;
+    f->depth = depth;
+    f->path_len = sbuf.len(&self->_path);
+    f->pos = 0;
+    f->len = 0;
+    self->_nframes++;
+    return EOK;
+}
+
+static Exception
+os__walk__open_(
+    os_walk_c* self,
+    str_c root,
+    const char* pattern,
+    u32 max_depth,
+    u32 flags,
+    const Allocator_i* allocator
+)
+{
+    uassert(self != NULL);
+    uassert(allocator != NULL);
+    memset(self, 0, sizeof(*self));
+
+    if (!str.is_valid(root) || root.len == 0) {
+        return Error.argument;
+    }
+
+    Exc result = Error.runtime;
+    self->_allocator = allocator;
+    e$goto(result = os__walk_filter_create(&self->_filter, pattern, max_depth, flags, allocator), fail);
+    e$goto(result = sbuf.create(&self->_path, PATH_MAX, allocator), fail);
+
+    // trailing separators are dropped, entry paths are <root>/<name>
+    while (root.len > 1 && root.buf[root.len - 1] == '/') {
+        root.len--;
+    }
+    e$goto(result = sbuf.append(&self->_path, root), fail);
+    e$goto(result = os__walk_push(self, AT_FDCWD, self->_path, 0), fail);
+
+    return EOK;
+
+fail:
+    os.walk.close(self);
+    return result;
+}
+
+static Exception
+os__walk__next_(os_walk_c* self, os_walk_entry_s** entry)
+{
+    uassert(self != NULL);
+    uassert(entry != NULL);
+    uassert(self->_allocator != NULL && "not opened");
+
+    while (self->_nframes > 0) {
+        os__walk_frame_s* f = &self->_frames[self->_nframes - 1];
+
+        if (self->_descend != NULL) {
+            // directory entry was returned by the previous call
+            const char* name = self->_descend;
+            self->_descend = NULL;
+            e$ret(os__walk_push(self, f->fd, name, f->depth + 1));
+            continue;
+        }
+
+        if (f->pos >= f->len) {
+            long n = os__getdents64(f->fd, f->dents, OS_WALK_BUF_SIZE);
+            if (n < 0) {
+                return Error.io;
+            }
+            if (n == 0) {
+                close(f->fd);
+                f->fd = -1;
+                self->_nframes--;
+                continue;
+            }
+            f->pos = 0;
+            f->len = n;
+        }
+
+        struct os__dirent64* d = (struct os__dirent64*)(f->dents + f->pos);
+        f->pos += d->d_reclen;
+
+        os_ftype_e type;
+        bool descend;
+        bool yield = os__walk_filter(&self->_filter, f->fd, d, f->depth, &type, &descend);
+        if (!yield && !descend) {
+            continue;
+        }
+
+        // <dir path>/<name>
+        self->_path[f->path_len] = '\0';
+        sbuf.update_len(&self->_path);
+        str_c name = str.cstr(d->d_name);
+        if (self->_path[f->path_len - 1] != '/') {
+            // root "/" has separator already
+            e$ret(sbuf.append(&self->_path, s$("/")));
+        }
+        e$ret(sbuf.append(&self->_path, name));
+
+        if (descend) {
+            // d_name stays valid, dents buffer is refilled only after all its entries are read
+            self->_descend = d->d_name;
+        }
+        if (!yield) {
+            continue;
+        }
+
+        size_t path_len = sbuf.len(&self->_path);
+        self->_entry = (os_walk_entry_s){
+            .path = { .buf = self->_path, .len = path_len },
+            .name = { .buf = self->_path + path_len - name.len, .len = name.len },
+            .depth = f->depth,
+            .type = type,
+        };
+        *entry = &self->_entry;
+        return EOK;
+    }
+
+    return Error.eof;
+}
+
+static void
+os__walk__skip_(os_walk_c* self)
+{
+    uassert(self != NULL);
+    self->_descend = NULL;
+}
+
+static void
+os__walk__close_(os_walk_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+    for (u32 i = 0; i < self->_frames_cap; i++) {
+        if (i < self->_nframes) {
+            close(self->_frames[i].fd);
+        }
+        if (self->_frames[i].dents != NULL) {
+            self->_allocator->free(self->_frames[i].dents);
+        }
+    }
+    if (self->_frames != NULL) {
+        self->_allocator->free(self->_frames);
+    }
+    sbuf.destroy(&self->_path);
+    os__walk_filter_destroy(&self->_filter);
+    memset(self, 0, sizeof(*self));
+}
+
+typedef struct os__walk_dir_s
+{
+    struct os__walk_dir_s* next;
+    u32 depth;
+    u32 path_len;
+    char path[];
+} os__walk_dir_s;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    os__walk_dir_s* queue; // directories to scan (LIFO)
+    u32 active;            // workers scanning directories
+    bool stop;
+    Exc error;
+    os__walk_filter_s filter;
+    os_walk_f fn;
+    void* ctx;
+    const Allocator_i* allocator;
+} os__walk_pool_s;
+
+typedef struct
+{
+    os__walk_pool_s* pool;
+    char* dents;
+    pthread_t thread;
+    bool spawned;
+} os__walk_worker_s;
+
+// NOTE: must be called with pool->lock held (allocator is not thread safe)
+static Exception
+os__walk_enqueue(os__walk_pool_s* pool, const char* path, u32 path_len, u32 depth)
+{
+    os__walk_dir_s* dir = pool->allocator->malloc(sizeof(os__walk_dir_s) + path_len + 1);
+    if (dir == NULL) {
+        return Error.memory;
+    }
+    dir->depth = depth;
+    dir->path_len = path_len;
+    memcpy(dir->path, path, path_len);
+    dir->path[path_len] = '\0';
+    dir->next = pool->queue;
+    pool->queue = dir;
+    return EOK;
+}
+
+static Exception
+os__walk_scan(os__walk_worker_s* w, os__walk_dir_s* dir)
+{
+    os__walk_pool_s* pool = w->pool;
+    char path[PATH_MAX];
+
+    int fd;
+    // root is the only directory at depth 0, it was checked before workers start
+    e$ret(os__walk_open_dir(AT_FDCWD, dir->path, dir->depth == 0, &fd));
+    if (fd == -1) {
+        return EOK;
+    }
+
+    Exc result = EOK;
+    u32 dir_len = dir->path_len;
+    memcpy(path, dir->path, dir_len);
+    if (dir_len > 0 && path[dir_len - 1] != '/') {
+        path[dir_len++] = '/';
+    }
+
+    while (!__atomic_load_n(&pool->stop, __ATOMIC_RELAXED)) {
+        long n = os__getdents64(fd, w->dents, OS_WALK_BUF_SIZE);
+        if (n <= 0) {
+            result = (n < 0) ? Error.io : EOK;
+            break;
+        }
+        for (long pos = 0; pos < n;) {
+            struct os__dirent64* d = (struct os__dirent64*)(w->dents + pos);
+            pos += d->d_reclen;
+
+            os_ftype_e type;
+            bool descend;
+            bool yield = os__walk_filter(&pool->filter, fd, d, dir->depth, &type, &descend);
+            if (!yield && !descend) {
+                continue;
+            }
+
+            size_t name_len = strlen(d->d_name);
+            if (dir_len + name_len >= sizeof(path)) {
+                result = Error.overflow;
+                goto end;
+            }
+            memcpy(path + dir_len, d->d_name, name_len + 1);
+
+            if (descend) {
+                pthread_mutex_lock(&pool->lock);
+                result = os__walk_enqueue(pool, path, dir_len + name_len, dir->depth + 1);
+                pthread_cond_signal(&pool->cond);
+                pthread_mutex_unlock(&pool->lock);
+                if (result != EOK) {
+                    goto end;
+                }
+            }
+            if (yield) {
+                os_walk_entry_s entry = {
+                    .path = { .buf = path, .len = dir_len + name_len },
+                    .name = { .buf = path + dir_len, .len = name_len },
+                    .depth = dir->depth,
+                    .type = type,
+                };
+                result = pool->fn(&entry, pool->ctx);
+                if (result != EOK) {
+                    goto end;
+                }
+            }
+        }
+    }
+
+end:
+    close(fd);
+    return result;
+}
+
+static void*
+os__walk_worker(void* arg)
+{
+    os__walk_worker_s* w = arg;
+    os__walk_pool_s* pool = w->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->queue == NULL && pool->active > 0 && !pool->stop) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+        if (pool->stop || pool->queue == NULL) {
+            break;
+        }
+        os__walk_dir_s* dir = pool->queue;
+        pool->queue = dir->next;
+        pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+
+        Exc err = os__walk_scan(w, dir);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->allocator->free(dir);
+        pool->active--;
+        if (err != EOK && pool->error == EOK) {
+            pool->error = err;
+            __atomic_store_n(&pool->stop, true, __ATOMIC_RELAXED);
+        }
+        if (pool->stop || (pool->active == 0 && pool->queue == NULL)) {
+            pthread_cond_broadcast(&pool->cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static Exception
+os__walk__parallel_(
+    str_c root,
+    const char* pattern,
+    u32 max_depth,
+    u32 flags,
+    u32 nthreads,
+    os_walk_f fn,
+    void* ctx,
+    const Allocator_i* allocator
+)
+{
+    uassert(fn != NULL);
+    uassert(allocator != NULL);
+
+    if (!str.is_valid(root) || root.len == 0) {
+        return Error.argument;
+    }
+    if (root.len >= PATH_MAX) {
+        return Error.overflow;
+    }
+    while (root.len > 1 && root.buf[root.len - 1] == '/') {
+        root.len--;
+    }
+    if (nthreads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n > 0 ? n : 1;
+    }
+
+    os__walk_pool_s pool = { .fn = fn, .ctx = ctx, .allocator = allocator };
+    os__walk_worker_s* workers = NULL;
+    Exc result = Error.runtime;
+
+    e$goto(result = os__walk_filter_create(&pool.filter, pattern, max_depth, flags, allocator), end);
+    e$goto(result = os__walk_enqueue(&pool, root.buf, root.len, 0), end);
+
+    // root errors are reported, unlike unreadable subdirectories
+    int fd;
+    e$goto(result = os__walk_open_dir(AT_FDCWD, pool.queue->path, true, &fd), end);
+    close(fd);
+
+    workers = allocator->calloc(nthreads, sizeof(os__walk_worker_s));
+    if (workers == NULL) {
+        result = Error.memory;
+        goto end;
+    }
+    for (u32 i = 0; i < nthreads; i++) {
+        workers[i].pool = &pool;
+        workers[i].dents = allocator->malloc(OS_WALK_BUF_SIZE);
+        if (workers[i].dents == NULL) {
+            result = Error.memory;
+            goto end;
+        }
+    }
+
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+
+    // the calling thread is the first worker
+    for (u32 i = 1; i < nthreads; i++) {
+        workers[i].spawned = pthread_create(&workers[i].thread, NULL, os__walk_worker, &workers[i]) ==
+                             0;
+    }
+    os__walk_worker(&workers[0]);
+    for (u32 i = 1; i < nthreads; i++) {
+        if (workers[i].spawned) {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.lock);
+    result = pool.error;
+
+end:
+    while (pool.queue != NULL) {
+        // left after error
+        os__walk_dir_s* dir = pool.queue;
+        pool.queue = dir->next;
+        allocator->free(dir);
+    }
+    if (workers != NULL) {
+        for (u32 i = 0; i < nthreads; i++) {
+            if (workers[i].dents != NULL) {
+                allocator->free(workers[i].dents);
+            }
+        }
+        allocator->free(workers);
+    }
+    os__walk_filter_destroy(&pool.filter);
+    return result;
+}
+
+// Doubles capacity of array of items (the first allocation is min_cap items)
+static Exception
+os__array_grow(const Allocator_i* allocator, void** arr, u32* cap, size_t item_size, u32 min_cap)
+{
+    u32 new_cap = *cap > 0 ? *cap * 2 : min_cap;
+    void* p = (*arr == NULL) ? allocator->malloc(item_size * new_cap)
+                             : allocator->realloc(*arr, item_size * new_cap);
+    if (p == NULL) {
+        return Error.memory;
+    }
+    *arr = p;
+    *cap = new_cap;
+    return EOK;
+}
+
+static Exception
+os__dir__read_(os_dir_c* self, str_c path, const Allocator_i* allocator)
+{
+    uassert(self != NULL);
+    uassert(allocator != NULL);
+    memset(self, 0, sizeof(*self));
+
+    if (!str.is_valid(path) || path.len == 0) {
+        return Error.argument;
+    }
+    char path_buf[PATH_MAX];
+    e$ret(str.copy(path, path_buf, sizeof(path_buf)));
+
+    int fd;
+    e$ret(os__walk_open_dir(AT_FDCWD, path_buf, true, &fd));
+
+    Exc result = Error.runtime;
+    char* dents = NULL;
+    self->_allocator = allocator;
+    e$goto(result = sbuf.create(&self->_names, 1024, allocator), fail);
+    dents = allocator->malloc(OS_WALK_BUF_SIZE);
+    if (dents == NULL) {
+        result = Error.memory;
+        goto fail;
+    }
+
+    while (true) {
+        long n = os__getdents64(fd, dents, OS_WALK_BUF_SIZE);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            result = Error.io;
+            goto fail;
+        }
+        for (long pos = 0; pos < n;) {
+            struct os__dirent64* d = (struct os__dirent64*)(dents + pos);
+            pos += d->d_reclen;
+            if (os__is_dot_or_dotdot(d->d_name)) {
+                continue;
+            }
+
+            // relative to dir fd, no path joins
+            struct stat st;
+            if (fstatat(fd, d->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+                if (errno == ENOENT) {
+                    continue; // removed meanwhile
+                }
+                result = Error.io;
+                goto fail;
+            }
+
+            if (self->len == self->_cap) {
+                e$goto(
+                    result = os__array_grow(
+                        allocator,
+                        (void**)&self->entries,
+                        &self->_cap,
+                        sizeof(os_dirent_s),
+                        64
+                    ),
+                    fail
+                );
+            }
+            // names arena may be reallocated, name.buf is an offset until all entries are read
+            str_c name = str.cstr(d->d_name);
+            self->entries[self->len++] = (os_dirent_s){
+                .name = { .buf = (char*)(uintptr_t)sbuf.len(&self->_names), .len = name.len },
+                .type = os__ftype(st.st_mode),
+                .size = st.st_size,
+                .mtime = st.st_mtim.tv_sec,
+                .mtime_ns = st.st_mtim.tv_nsec,
+            };
+            // including '\0' of d_name
+            e$goto(
+                result = sbuf.append(&self->_names, (str_c){ .buf = name.buf, .len = name.len + 1 }),
+                fail
+            );
+        }
+    }
+
+    for (u32 i = 0; i < self->len; i++) {
+        self->entries[i].name.buf = self->_names + (uintptr_t)self->entries[i].name.buf;
+    }
+    allocator->free(dents);
+    close(fd);
+    return EOK;
+
+fail:
+    if (dents != NULL) {
+        allocator->free(dents);
+    }
+    close(fd);
+    os.dir.destroy(self);
+    return result;
+}
+
+static void
+os__dir__destroy_(os_dir_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+    if (self->entries != NULL) {
+        self->_allocator->free(self->entries);
+    }
+    sbuf.destroy(&self->_names);
+    memset(self, 0, sizeof(*self));
+}
+
+#define OS__WATCH_BUF_SIZE (64 * 1024)
+
+#define OS__WATCH_MASK                                                                             \
+    (IN_CREATE | IN_MOVED_TO | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | \
+     IN_DELETE_SELF | IN_MOVE_SELF)
+
+static u64
+os__monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Returns index of watched directory by wd, or insert position (dirs are sorted by wd)
+static u32
+os__watch_find_dir(os_watch_c* self, int wd, bool* found)
+{
+    u32 lo = 0, hi = self->_ndirs;
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2;
+        if (self->_dirs[mid].wd < wd) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < self->_ndirs && self->_dirs[lo].wd == wd;
+    return lo;
+}
+
+// follow - path given by user is resolved like opendir() does, subdirectories found by walk or
+// events are never followed
+static Exception
+os__watch_add_dir(
+    os_watch_c* self,
+    const char* path,
+    bool all,
+    bool recursive,
+    bool follow,
+    int* out_wd
+)
+{
+    u32 mask = OS__WATCH_MASK | IN_ONLYDIR | (follow ? 0 : IN_DONT_FOLLOW);
+    int wd = inotify_add_watch(self->_fd, path, mask);
+    if (wd == -1) {
+        switch (errno) {
+            case ENOENT:
+                return Error.not_found;
+            case ENOTDIR:
+                return Error.argument;
+            case ENOSPC:
+                return Error.overflow; // fs.inotify.max_user_watches limit
+            default:
+                return Error.io;
+        }
+    }
+    *out_wd = wd;
+
+    bool found;
+    u32 idx = os__watch_find_dir(self, wd, &found);
+    if (found) {
+        // the same directory (inode) was added already
+        self->_dirs[idx].all |= all;
+        self->_dirs[idx].recursive |= recursive;
+        return EOK;
+    }
+
+    if (self->_ndirs == self->_dirs_cap) {
+        e$ret(os__array_grow(
+            self->_allocator,
+            (void**)&self->_dirs,
+            &self->_dirs_cap,
+            sizeof(os__watch_dir_s),
+            16
+        ));
+    }
+    u32 path_len = strlen(path);
+    char* p = self->_allocator->malloc(path_len + 1);
+    if (p == NULL) {
+        return Error.memory;
+    }
+    memcpy(p, path, path_len + 1);
+
+    memmove(&self->_dirs[idx + 1], &self->_dirs[idx], (self->_ndirs - idx) * sizeof(os__watch_dir_s));
+    self->_dirs[idx] = (os__watch_dir_s){
+        .wd = wd,
+        .path = p,
+        .path_len = path_len,
+        .all = all,
+        .recursive = recursive,
+    };
+    self->_ndirs++;
+    return EOK;
+}
+
+static void
+os__watch_remove_dir(os_watch_c* self, u32 idx)
+{
+    int wd = self->_dirs[idx].wd;
+    self->_allocator->free(self->_dirs[idx].path);
+    self->_ndirs--;
+    memmove(&self->_dirs[idx], &self->_dirs[idx + 1], (self->_ndirs - idx) * sizeof(os__watch_dir_s));
+
+    for (u32 i = 0; i < self->_nfiles;) {
+        if (self->_files[i].wd == wd) {
+            self->_allocator->free(self->_files[i].name);
+            self->_files[i] = self->_files[--self->_nfiles];
+        } else {
+            i++;
+        }
+    }
+}
+
+// Adds coalesced event of path (in the current burst)
+static Exception
+os__watch_push(os_watch_c* self, str_c dir, str_c name, u32 events, bool is_dir)
+{
+    char buf[PATH_MAX];
+    str_c path;
+    e$ret(os.path.join_buf(buf, sizeof(buf), &path, (str_c[]){ dir, name }, 2));
+
+    os__watch_index_s* item = dict.gets(&self->_index, path);
+    if (item != NULL) {
+        os__watch_pending_s* p = &self->_pending[item->idx];
+        u32 old = p->events;
+        if ((old & OS_WATCH_CREATE) && (events & OS_WATCH_DELETE)) {
+            events = 0; // temporary file
+        } else if ((old & OS_WATCH_DELETE) && (events & OS_WATCH_CREATE)) {
+            events = OS_WATCH_MODIFY; // replaced (e.g. by rename of temp file)
+        } else {
+            events |= old;
+        }
+        if (events & (OS_WATCH_CREATE | OS_WATCH_DELETE)) {
+            events &= ~OS_WATCH_MODIFY;
+        }
+        p->events = events;
+        p->is_dir = is_dir;
+        return EOK;
+    }
+
+    // paths are separated by '\0', so event path is a valid C string
+    u32 offset = sbuf.len(&self->_paths);
+    char* old_paths = self->_paths;
+    e$ret(sbuf.append(&self->_paths, (str_c){ .buf = buf, .len = path.len + 1 }));
+    if (self->_npending == self->_pending_cap) {
+        e$ret(os__array_grow(
+            self->_allocator,
+            (void**)&self->_pending,
+            &self->_pending_cap,
+            sizeof(os__watch_pending_s),
+            64
+        ));
+    }
+    self->_pending[self->_npending++] = (os__watch_pending_s){
+        .path_offset = offset,
+        .path_len = path.len,
+        .events = events,
+        .is_dir = is_dir,
+    };
+
+    // index keys are views into paths arena, they are rebuilt when arena is moved by realloc
+    Exc result = EOK;
+    u32 first = self->_npending - 1;
+    if (self->_paths != old_paths) {
+        dict.clear(&self->_index);
+        first = 0;
+    }
+    for (u32 i = first; i < self->_npending; i++) {
+        os__watch_pending_s* p = &self->_pending[i];
+        e$goto(
+            result = dict.set(
+                &self->_index,
+                &(os__watch_index_s){
+                    .key = { .buf = self->_paths + p->path_offset, .len = p->path_len },
+                    .idx = i,
+                }
+            ),
+            fail
+        );
+    }
+    return EOK;
+
+fail:
+    // event is dropped, not indexed entries are only not coalesced
+    self->_npending--;
+    return result;
+}
+
+// Watches directory with all subdirectories (hidden are skipped), entries are reported as
+// created if report is set (i.e. for new directory created before its watch was added)
+static Exception
+os__watch_add_tree(os_watch_c* self, const char* path, bool report)
+{
+    int wd;
+    e$ret(os__watch_add_dir(self, path, true, true, !report, &wd));
+
+    os_walk_c w;
+    os_walk_entry_s* e;
+    e$ret(os.walk.open(&w, str.cstr(path), NULL, 0, report ? 0 : OS_WALK_DIRS, self->_allocator));
+    Exc err;
+    while ((err = os.walk.next(&w, &e)) == EOK) {
+        if (report) {
+            err = os__watch_push(self, e->path, s$(""), OS_WATCH_CREATE, e->type == OS_FTYPE_DIR);
+            if (err != EOK) {
+                break;
+            }
+        }
+        if (e->type == OS_FTYPE_DIR) {
+            err = os__watch_add_dir(self, e->path.buf, true, true, false, &wd);
+            if (err != EOK && err != Error.not_found) {
+                break;
+            }
+        }
+    }
+    os.walk.close(&w);
+    return err == Error.eof ? EOK : err;
+}
+
+static Exception
+os__watch_handle(os_watch_c* self, struct inotify_event* ev)
+{
+    if (ev->mask & IN_Q_OVERFLOW) {
+        return os__watch_push(self, s$(""), s$(""), OS_WATCH_OVERFLOW, false);
+    }
+
+    bool found;
+    u32 idx = os__watch_find_dir(self, ev->wd, &found);
+    if (!found) {
+        return EOK; // removed meanwhile
+    }
+    os__watch_dir_s* dir = &self->_dirs[idx];
+    str_c dir_path = { .buf = dir->path, .len = dir->path_len };
+
+    if (ev->mask & IN_IGNORED) {
+        os__watch_remove_dir(self, idx);
+        return EOK;
+    }
+    if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        if (dir->all) {
+            e$ret(os__watch_push(self, dir_path, s$(""), OS_WATCH_DELETE, true));
+        }
+        if (ev->mask & IN_MOVE_SELF) {
+            // moved directory keeps its watch, but its path is not known anymore
+            inotify_rm_watch(self->_fd, ev->wd);
+        }
+        return EOK;
+    }
+
+    str_c name = str.cstr(ev->len > 0 ? ev->name : "");
+    if (!dir->all) {
+        // only added files of directory are reported
+        bool match = false;
+        for (u32 i = 0; i < self->_nfiles && !match; i++) {
+            match = self->_files[i].wd == ev->wd && strcmp(self->_files[i].name, name.buf) == 0;
+        }
+        if (!match) {
+            return EOK;
+        }
+    }
+
+    u32 events = 0;
+    if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+        events |= OS_WATCH_CREATE;
+    }
+    if (ev->mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB)) {
+        events |= OS_WATCH_MODIFY;
+    }
+    if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        events |= OS_WATCH_DELETE;
+    }
+    if (events == 0) {
+        return EOK;
+    }
+    bool is_dir = (ev->mask & IN_ISDIR) != 0;
+    e$ret(os__watch_push(self, dir_path, name, events, is_dir));
+
+    if (is_dir && (events & OS_WATCH_CREATE) && dir->recursive && name.buf[0] != '.') {
+        char path[PATH_MAX];
+        str_c p;
+        e$ret(os.path.join_buf(path, sizeof(path), &p, (str_c[]){ dir_path, name }, 2));
+        // NOTE: dir pointer is not valid after this call
+        Exc err = os__watch_add_tree(self, path, true);
+        if (err != EOK && err != Error.not_found && err != Error.argument) {
+            return err;
+        }
+    }
+    return EOK;
+}
+
+static Exception
+os__watch_read(os_watch_c* self)
+{
+    while (true) {
+        ssize_t n = read(self->_fd, self->_buf, OS__WATCH_BUF_SIZE);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN) ? EOK : Error.io;
+        }
+        for (ssize_t pos = 0; pos < n;) {
+            struct inotify_event* ev = (struct inotify_event*)(self->_buf + pos);
+            pos += sizeof(struct inotify_event) + ev->len;
+            e$ret(os__watch_handle(self, ev));
+        }
+    }
+}
+
+// Waits for inotify events, ready is false on timeout (UINT32_MAX - infinite)
+static Exception
+os__watch_wait(os_watch_c* self, u64 timeout_ms, bool* ready)
+{
+    struct pollfd pfd = { .fd = self->_fd, .events = POLLIN };
+    int ms = (timeout_ms == UINT32_MAX) ? -1 : (timeout_ms > INT32_MAX ? INT32_MAX : (int)timeout_ms);
+    while (true) {
+        int ret = poll(&pfd, 1, ms);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret == -1) {
+            return Error.io;
+        }
+        *ready = ret > 0;
+        return EOK;
+    }
+}
+
+// Collects the next burst of events into pending
+static Exception
+os__watch_fill(os_watch_c* self, u32 timeout_ms)
+{
+    u64 now = os__monotonic_ms();
+    u64 deadline = now + timeout_ms;
+    while (true) {
+        self->_npending = 0;
+        self->_pending_pos = 0;
+        sbuf.clear(&self->_paths);
+        dict.clear(&self->_index);
+
+        bool ready;
+        u64 wait = (timeout_ms == UINT32_MAX) ? UINT32_MAX : (deadline > now ? deadline - now : 0);
+        e$ret(os__watch_wait(self, wait, &ready));
+        if (!ready) {
+            return Error.empty;
+        }
+        e$ret(os__watch_read(self));
+
+        // coalesce burst, until there are no new events for settle time
+        u64 burst_end = os__monotonic_ms() + OS_WATCH_MAX_DELAY_MS;
+        while ((now = os__monotonic_ms()) < burst_end) {
+            u64 settle = burst_end - now < self->_settle_ms ? burst_end - now : self->_settle_ms;
+            e$ret(os__watch_wait(self, settle, &ready));
+            if (!ready) {
+                break;
+            }
+            e$ret(os__watch_read(self));
+        }
+
+        for (u32 i = 0; i < self->_npending; i++) {
+            if (self->_pending[i].events != 0) {
+                return EOK;
+            }
+        }
+        now = os__monotonic_ms();
+        if (timeout_ms != UINT32_MAX && now >= deadline) {
+            return Error.empty;
+        }
+    }
+}
+
+// Returns the next pending event of the current burst
+static bool
+os__watch_pop(os_watch_c* self, os_watch_event_s** event)
+{
+    while (self->_pending_pos < self->_npending) {
+        os__watch_pending_s* p = &self->_pending[self->_pending_pos++];
+        if (p->events == 0) {
+            continue;
+        }
+        self->_event = (os_watch_event_s){
+            .path = { .buf = self->_paths + p->path_offset, .len = p->path_len },
+            .events = p->events,
+            .is_dir = p->is_dir,
+        };
+        *event = &self->_event;
+        return true;
+    }
+    return false;
+}
+
+static Exception
+os__watch__create_(os_watch_c* self, u32 settle_ms, const Allocator_i* allocator)
+{
+    uassert(self != NULL);
+    uassert(allocator != NULL);
+    memset(self, 0, sizeof(*self));
+    self->_fd = -1;
+
+    Exc result = Error.runtime;
+    self->_allocator = allocator;
+    self->_settle_ms = settle_ms > 0 ? settle_ms : OS_WATCH_SETTLE_MS;
+    e$goto(result = sbuf.create(&self->_paths, 1024, allocator), fail);
+    e$goto(result = dict$new(&self->_index, os__watch_index_s, key, allocator), fail);
+    self->_buf = allocator->malloc(OS__WATCH_BUF_SIZE);
+    if (self->_buf == NULL) {
+        result = Error.memory;
+        goto fail;
+    }
+    self->_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (self->_fd == -1) {
+        result = Error.io;
+        goto fail;
+    }
+    return EOK;
+
+fail:
+    os.watch.destroy(self);
+    return result;
+}
+
+static Exception
+os__watch__add_(os_watch_c* self, str_c path, bool recursive)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not created");
+    if (!str.is_valid(path) || path.len == 0) {
+        return Error.argument;
+    }
+
+    char path_buf[PATH_MAX];
+    e$ret(str.copy(path, path_buf, sizeof(path_buf)));
+    size_t len = path.len;
+    while (len > 1 && path_buf[len - 1] == '/') {
+        path_buf[--len] = '\0';
+    }
+
+    struct stat st;
+    if (stat(path_buf, &st) == -1) {
+        return (errno == ENOENT) ? Error.not_found : Error.io;
+    }
+
+    int wd;
+    if (S_ISDIR(st.st_mode)) {
+        if (recursive) {
+            return os__watch_add_tree(self, path_buf, false);
+        }
+        return os__watch_add_dir(self, path_buf, true, false, true, &wd);
+    }
+
+    // files are watched via parent directory, so they are tracked when replaced by rename
+    str_c dir, name;
+    os.path.split(str.cbuf(path_buf, sizeof(path_buf)), &dir, &name);
+    char dir_buf[PATH_MAX];
+    e$ret(str.copy(dir.len > 0 ? dir : s$("."), dir_buf, sizeof(dir_buf)));
+    e$ret(os__watch_add_dir(self, dir_buf, false, false, true, &wd));
+
+    for (u32 i = 0; i < self->_nfiles; i++) {
+        if (self->_files[i].wd == wd && strcmp(self->_files[i].name, name.buf) == 0) {
+            return EOK;
+        }
+    }
+    if (self->_nfiles == self->_files_cap) {
+        e$ret(os__array_grow(
+            self->_allocator,
+            (void**)&self->_files,
+            &self->_files_cap,
+            sizeof(os__watch_file_s),
+            16
+        ));
+    }
+    char* n = self->_allocator->malloc(name.len + 1);
+    if (n == NULL) {
+        return Error.memory;
+    }
+    memcpy(n, name.buf, name.len + 1);
+    self->_files[self->_nfiles++] = (os__watch_file_s){ .wd = wd, .name = n };
+    return EOK;
+}
+
+static Exception
+os__watch__next_(os_watch_c* self, u32 timeout_ms, os_watch_event_s** event)
+{
+    uassert(self != NULL);
+    uassert(event != NULL);
+    uassert(self->_allocator != NULL && "not created");
+
+    if (os__watch_pop(self, event)) {
+        return EOK;
+    }
+    Exc err = os__watch_fill(self, timeout_ms);
+    if (err != EOK) {
+        return err;
+    }
+    if (!os__watch_pop(self, event)) {
+        return Error.empty;
+    }
+    return EOK;
+}
+
+static Exception
+os__watch__poll_(os_watch_c* self, u32 timeout_ms, os_watch_f fn, void* ctx)
+{
+    uassert(fn != NULL);
+    os_watch_event_s* event;
+    Exc err = os__watch__next_(self, timeout_ms, &event);
+    if (err != EOK) {
+        return err;
+    }
+    do {
+        e$ret(fn(event, ctx));
+    } while (os__watch_pop(self, &event));
+    return EOK;
+}
+
+static void
+os__watch__destroy_(os_watch_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+    if (self->_fd != -1) {
+        close(self->_fd); // removes all watches
+    }
+    for (u32 i = 0; i < self->_ndirs; i++) {
+        self->_allocator->free(self->_dirs[i].path);
+    }
+    for (u32 i = 0; i < self->_nfiles; i++) {
+        self->_allocator->free(self->_files[i].name);
+    }
+    if (self->_dirs != NULL) {
+        self->_allocator->free(self->_dirs);
+    }
+    if (self->_files != NULL) {
+        self->_allocator->free(self->_files);
+    }
+    if (self->_pending != NULL) {
+        self->_allocator->free(self->_pending);
+    }
+    if (self->_buf != NULL) {
+        self->_allocator->free(self->_buf);
+    }
+    sbuf.destroy(&self->_paths);
+    dict.destroy(&self->_index);
+    memset(self, 0, sizeof(*self));
+}
+
+extern char** environ;
+
+// Read size of process output pipes
+#define OS__PROC_BUF_SIZE (64 * 1024)
+
+// Poll interval for processes which closed their output, but not exited yet
+#define OS__PROC_REAP_MS 10
+
+// pipe2(O_CLOEXEC) - pipe ends are not leaked into processes spawned by other threads
+static inline int
+os__pipe_cloexec(int fds[2])
+{
+    return syscall(SYS_pipe2, fds, O_CLOEXEC);
+}
+
+static Exception
+os__proc__spawn_(os_proc_c* self, const char* const argv[], os_proc_opt_s* opt)
+{
+    uassert(self != NULL);
+    memset(self, 0, sizeof(*self));
+    self->_fds[0] = self->_fds[1] = -1;
+    self->_exited = true; // nothing to wait on failure
+    if (argv == NULL || argv[0] == NULL) {
+        return Error.argument;
+    }
+    if (opt != NULL) {
+        self->_opt = *opt;
+    }
+
+    int pipes[2][2] = { { -1, -1 }, { -1, -1 } };
+    bool capture[2] = {
+        self->_opt.out != NULL || self->_opt.out_io != NULL,
+        self->_opt.err != NULL || self->_opt.err_io != NULL,
+    };
+
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawnattr_init(&attr);
+
+    Exc result = EOK;
+    int rc = posix_spawn_file_actions_addopen(&fa, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    if (rc != 0) {
+        result = (rc == ENOMEM) ? Error.memory : Error.io;
+        goto end;
+    }
+    for (u32 k = 0; k < 2; k++) {
+        if (!capture[k]) {
+            continue;
+        }
+        if (os__pipe_cloexec(pipes[k]) == -1) {
+            result = Error.io;
+            goto end;
+        }
+        // dup2() clears O_CLOEXEC of child stdout / stderr
+        rc = posix_spawn_file_actions_adddup2(&fa, pipes[k][1], STDOUT_FILENO + k);
+        if (rc != 0) {
+            result = (rc == ENOMEM) ? Error.memory : Error.io;
+            goto end;
+        }
+    }
+
+    // child must not inherit ignored SIGPIPE or blocked signals of parent
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    posix_spawnattr_setsigmask(&attr, &sigs);
+    sigaddset(&sigs, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &sigs);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    char* const* env = (self->_opt.env != NULL) ? (char* const*)self->_opt.env : environ;
+    rc = posix_spawnp(&self->pid, argv[0], &fa, &attr, (char* const*)argv, env);
+    if (rc != 0) {
+        result = (rc == ENOENT) ? Error.not_found : Error.io;
+        goto end;
+    }
+
+    self->_exited = false;
+    for (u32 k = 0; k < 2; k++) {
+        if (capture[k]) {
+            self->_fds[k] = pipes[k][0];
+            pipes[k][0] = -1;
+            fcntl(self->_fds[k], F_SETFL, fcntl(self->_fds[k], F_GETFL) | O_NONBLOCK);
+        }
+    }
+    if (self->_opt.timeout_ms > 0) {
+        self->_deadline = os__monotonic_ms() + self->_opt.timeout_ms;
+    }
+
+end:
+    for (u32 k = 0; k < 2; k++) {
+        for (u32 i = 0; i < 2; i++) {
+            if (pipes[k][i] != -1) {
+                close(pipes[k][i]);
+            }
+        }
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&fa);
+    return result;
+}
+
+static inline bool
+os__proc_finished(os_proc_c* self)
+{
+    return self->_exited && self->_fds[0] == -1 && self->_fds[1] == -1;
+}
+
+static inline Exc
+os__proc_result(os_proc_c* self)
+{
+    return self->_timed_out ? Error.timeout : self->_error;
+}
+
+static void
+os__proc_close(os_proc_c* self, u32 k)
+{
+    if (self->_fds[k] != -1) {
+        close(self->_fds[k]);
+        self->_fds[k] = -1;
+    }
+}
+
+static void
+os__proc_reap(os_proc_c* self, bool block)
+{
+    int status;
+    pid_t ret;
+    do {
+        ret = waitpid(self->pid, &status, block ? 0 : WNOHANG);
+    } while (ret == -1 && errno == EINTR);
+
+    if (ret == 0) {
+        return; // still running
+    }
+    self->_exited = true;
+    if (ret == -1) {
+        self->exit_code = -1;
+        if (self->_error == EOK) {
+            self->_error = Error.io;
+        }
+    } else if (WIFEXITED(status)) {
+        self->exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        self->exit_code = 128 + WTERMSIG(status);
+    }
+}
+
+// Kills and reaps the process, closes its pipes (used on errors of poll loop)
+static void
+os__proc_abort(os_proc_c* self, Exc error)
+{
+    if (!self->_exited) {
+        kill(self->pid, SIGKILL);
+    }
+    os__proc_close(self, 0);
+    os__proc_close(self, 1);
+    if (!self->_exited) {
+        os__proc_reap(self, true);
+    }
+    if (self->_error == EOK) {
+        self->_error = error;
+    }
+}
+
+// Reads all available output of pipe k into sbuf / io_c
+static void
+os__proc_drain(os_proc_c* self, u32 k)
+{
+    char buf[OS__PROC_BUF_SIZE];
+    sbuf_c* out = (k == 0) ? self->_opt.out : self->_opt.err;
+    io_c* out_io = (k == 0) ? self->_opt.out_io : self->_opt.err_io;
+
+    while (self->_fds[k] != -1) {
+        ssize_t n = read(self->_fds[k], buf, sizeof(buf));
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1 && errno == EAGAIN) {
+            return;
+        }
+        if (n <= 0) {
+            os__proc_close(self, k);
+            return;
+        }
+        if (self->_error != EOK) {
+            continue; // output is discarded after write error, child must not block
+        }
+        Exc err = (out != NULL) ? sbuf.append(out, (str_c){ .buf = buf, .len = n })
+                                : io.write(out_io, buf, 1, n);
+        if (err != EOK) {
+            self->_error = err;
+        }
+    }
+}
+
+// Single poll round over output pipes of running processes
+static Exception
+os__proc_step(os_proc_c* procs, u32 nprocs)
+{
+    struct pollfd pfds[OS_PROC_MAX_PARALLEL * 2];
+    u32 owners[OS_PROC_MAX_PARALLEL * 2];
+    u32 nfds = 0;
+    int timeout = -1;
+    u64 now = os__monotonic_ms();
+
+    for (u32 i = 0; i < nprocs; i++) {
+        os_proc_c* p = &procs[i];
+        if (os__proc_finished(p)) {
+            continue;
+        }
+        u64 wait_ms = 0; // 0 - wait for fds without timeout
+        if (p->_deadline > 0 && !p->_timed_out) {
+            if (now >= p->_deadline) {
+                kill(p->pid, SIGKILL);
+                p->_timed_out = true;
+                // output of orphaned grandchildren is not waited for
+                os__proc_close(p, 0);
+                os__proc_close(p, 1);
+            } else {
+                wait_ms = p->_deadline - now;
+            }
+        }
+        if (p->_fds[0] == -1 && p->_fds[1] == -1) {
+            if (nprocs == 1 && (p->_deadline == 0 || p->_timed_out)) {
+                os__proc_reap(p, true);
+                continue;
+            }
+            os__proc_reap(p, false);
+            if (p->_exited) {
+                continue; // don't sleep until deadline of finished process
+            }
+            if (wait_ms == 0 || wait_ms > OS__PROC_REAP_MS) {
+                wait_ms = OS__PROC_REAP_MS;
+            }
+        } else {
+            for (u32 k = 0; k < 2; k++) {
+                if (p->_fds[k] != -1) {
+                    pfds[nfds] = (struct pollfd){ .fd = p->_fds[k], .events = POLLIN };
+                    owners[nfds] = i * 2 + k;
+                    nfds++;
+                }
+            }
+        }
+        if (wait_ms > 0) {
+            // poll() takes int milliseconds, far deadlines are re-checked on the next step
+            if (wait_ms > INT_MAX) {
+                wait_ms = INT_MAX;
+            }
+            if (timeout == -1 || wait_ms < (u64)timeout) {
+                timeout = (int)wait_ms;
+            }
+        }
+    }
+    if (nfds == 0 && timeout == -1) {
+        return EOK;
+    }
+
+    int ret = poll(pfds, nfds, timeout);
+    if (ret == -1) {
+        return (errno == EINTR) ? EOK : Error.io;
+    }
+    for (u32 i = 0; i < nfds && ret > 0; i++) {
+        if (pfds[i].revents != 0) {
+            os__proc_drain(&procs[owners[i] / 2], owners[i] % 2);
+            ret--;
+        }
+    }
+    return EOK;
+}
+
+static Exception
+os__proc__wait_(os_proc_c* self)
+{
+    uassert(self != NULL);
+    Exc result = EOK;
+    while (!os__proc_finished(self)) {
+        e$goto(result = os__proc_step(self, 1), fail);
+    }
+    return os__proc_result(self);
+
+fail:
+    os__proc_abort(self, result);
+    return result;
+}
+
+static Exception
+os__proc__run_(const char* const argv[], os_proc_opt_s* opt, int* exit_code)
+{
+    os_proc_c proc;
+    if (exit_code != NULL) {
+        *exit_code = -1;
+    }
+    e$ret(os__proc__spawn_(&proc, argv, opt));
+    Exc result = os__proc__wait_(&proc);
+    if (exit_code != NULL) {
+        *exit_code = proc.exit_code;
+    }
+    return result;
+}
+
+static Exception
+os__proc__run_all_(os_proc_cmd_s* cmds, u32 ncmds, u32 max_parallel)
+{
+    uassert(cmds != NULL || ncmds == 0);
+    if (max_parallel == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        max_parallel = n > 0 ? n : 1;
+    }
+    if (max_parallel > OS_PROC_MAX_PARALLEL) {
+        max_parallel = OS_PROC_MAX_PARALLEL;
+    }
+
+    os_proc_c procs[OS_PROC_MAX_PARALLEL];
+    os_proc_cmd_s* running[OS_PROC_MAX_PARALLEL];
+    u32 nrunning = 0;
+    u32 next = 0;
+    Exc result = EOK;
+
+    while (next < ncmds || nrunning > 0) {
+        while (nrunning < max_parallel && next < ncmds) {
+            os_proc_cmd_s* cmd = &cmds[next++];
+            cmd->exit_code = -1;
+            cmd->error = os__proc__spawn_(&procs[nrunning], cmd->argv, &cmd->opt);
+            if (cmd->error == EOK) {
+                running[nrunning++] = cmd;
+            }
+        }
+
+        Exc err = os__proc_step(procs, nrunning);
+        if (err != EOK) {
+            // poll loop is broken, running processes are killed, not queued ones are still run
+            for (u32 i = 0; i < nrunning; i++) {
+                os__proc_abort(&procs[i], err);
+            }
+        }
+
+        for (u32 i = 0; i < nrunning;) {
+            if (!os__proc_finished(&procs[i])) {
+                i++;
+                continue;
+            }
+            running[i]->exit_code = procs[i].exit_code;
+            running[i]->error = os__proc_result(&procs[i]);
+            nrunning--;
+            procs[i] = procs[nrunning];
+            running[i] = running[nrunning];
+        }
+    }
+
+    for (u32 i = 0; i < ncmds && result == EOK; i++) {
+        result = cmds[i].error;
+    }
+    return result;
+}
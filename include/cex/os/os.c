@@ -100,6 +100,612 @@ os__path__splitext(str_c path, bool return_ext)
     }
 }
 
+static inline bool
+os__path_is_sep(char c)
+{
+    return c == '/' || c == os$PATH_SEP;
+}
+
+// Returns next non-empty path component starting at *pos ("." components are skipped)
+static bool
+os__path_next(str_c path, size_t* pos, str_c* comp)
+{
+    size_t i = *pos;
+    while (i < path.len) {
+        while (i < path.len && os__path_is_sep(path.buf[i])) {
+            i++;
+        }
+        size_t start = i;
+        while (i < path.len && !os__path_is_sep(path.buf[i])) {
+            i++;
+        }
+        size_t len = i - start;
+        if (len == 0 || (len == 1 && path.buf[start] == '.')) {
+            continue;
+        }
+        *pos = i;
+        *comp = (str_c){ .buf = path.buf + start, .len = len };
+        return true;
+    }
+    *pos = i;
+    return false;
+}
+
+static inline bool
+os__path_is_dotdot(str_c comp)
+{
+    return comp.len == 2 && comp.buf[0] == '.' && comp.buf[1] == '.';
+}
+
+// Appends component with separator (if needed), keeps buf null terminated
+static Exception
+os__path_append(char* buf, size_t buf_size, size_t* len, str_c comp)
+{
+    bool need_sep = *len > 0 && !os__path_is_sep(buf[*len - 1]);
+    if (*len + need_sep + comp.len + 1 > buf_size) {
+        return Error.overflow;
+    }
+    if (need_sep) {
+        buf[(*len)++] = os$PATH_SEP;
+    }
+    memcpy(buf + *len, comp.buf, comp.len);
+    *len += comp.len;
+    buf[*len] = '\0';
+    return EOK;
+}
+
+/**
+ * @brief Splits path into head (directory) and tail (last component), same as python
+ * os.path.split(), i.e. "a/b/" -> ("a/b", ""), "/a" -> ("/", "a"), "a" -> ("", "a")
+ *
+ * @param path
+ * @param head directory part (view of path, trailing separators are stripped unless path is root)
+ * @param tail last component (view of path)
+ */
+void
+os__path__split(str_c path, str_c* head, str_c* tail)
+{
+    uassert(head != NULL);
+    uassert(tail != NULL);
+    if (!str.is_valid(path)) {
+        *head = s$("");
+        *tail = s$("");
+        return;
+    }
+
+    size_t i = path.len;
+    while (i > 0 && !os__path_is_sep(path.buf[i - 1])) {
+        i--;
+    }
+    *tail = (str_c){ .buf = path.buf + i, .len = path.len - i };
+
+    size_t head_len = i;
+    while (head_len > 0 && os__path_is_sep(path.buf[head_len - 1])) {
+        head_len--;
+    }
+    if (head_len == 0) {
+        // only separators (root), or no separators at all
+        head_len = i;
+    }
+    *head = (str_c){ .buf = path.buf, .len = head_len };
+}
+
+/**
+ * @brief Returns directory part of path, see os.path.split()
+ *
+ * @param path
+ * @return view of path
+ */
+str_c
+os__path__dirname(str_c path)
+{
+    str_c head, tail;
+    os__path__split(path, &head, &tail);
+    return head;
+}
+
+/**
+ * @brief Returns last component of path, see os.path.split() ("a/b/" -> "")
+ *
+ * @param path
+ * @return view of path
+ */
+str_c
+os__path__basename(str_c path)
+{
+    str_c head, tail;
+    os__path__split(path, &head, &tail);
+    return tail;
+}
+
+/**
+ * @brief Joins path parts into caller buffer (no allocations). Separator is added between
+ * parts, empty parts are skipped, absolute part discards all previous parts (like python
+ * os.path.join())
+ *
+ * char buf[PATH_MAX];
+ * str_c p;
+ * e$ret(os.path.join_buf(buf, sizeof(buf), &p, (str_c[]){ dir, s$("file.txt") }, 2));
+ *
+ * @param buf destination buffer (result is null terminated)
+ * @param buf_size size of buf
+ * @param out result (view of buf)
+ * @param parts array of parts
+ * @param nparts number of parts
+ * @return Error.overflow if buf is too small, Error.argument on invalid part
+ */
+Exception
+os__path__join_buf(char* buf, size_t buf_size, str_c* out, const str_c* parts, u32 nparts)
+{
+    uassert(out != NULL);
+    if (buf == NULL || buf_size == 0) {
+        return Error.argument;
+    }
+    size_t len = 0;
+    buf[0] = '\0';
+    *out = (str_c){ .buf = buf, .len = 0 };
+
+    for (u32 i = 0; i < nparts; i++) {
+        if (!str.is_valid(parts[i])) {
+            return Error.argument;
+        }
+        if (parts[i].len == 0) {
+            continue;
+        }
+        if (os__path_is_sep(parts[i].buf[0])) {
+            len = 0;
+        }
+        e$ret(os__path_append(buf, buf_size, &len, parts[i]));
+    }
+    *out = (str_c){ .buf = buf, .len = len };
+    return EOK;
+}
+
+/**
+ * @brief Normalizes path into caller buffer (no allocations, file system is not accessed):
+ * collapses repeated separators, removes "." components and resolves ".." lexically
+ * (e.g. "a/./b/../c//" -> "a/c", "/../a" -> "/a", "" -> ".")
+ *
+ * @param path
+ * @param buf destination buffer (result is null terminated)
+ * @param buf_size size of buf
+ * @param out result (view of buf)
+ * @return Error.overflow if buf is too small, Error.argument on invalid path
+ */
+Exception
+os__path__normalize(str_c path, char* buf, size_t buf_size, str_c* out)
+{
+    uassert(out != NULL);
+    if (!str.is_valid(path) || buf == NULL) {
+        return Error.argument;
+    }
+    if (buf_size < 2) {
+        return Error.overflow;
+    }
+
+    size_t len = 0;
+    size_t root = 0;
+    if (path.len > 0 && os__path_is_sep(path.buf[0])) {
+        buf[len++] = os$PATH_SEP;
+        root = 1;
+    }
+    buf[len] = '\0';
+
+    size_t pos = 0;
+    str_c comp;
+    while (os__path_next(path, &pos, &comp)) {
+        if (os__path_is_dotdot(comp)) {
+            bool last_is_dotdot = len - root >= 2 && buf[len - 1] == '.' && buf[len - 2] == '.' &&
+                                  (len - 2 == root || os__path_is_sep(buf[len - 3]));
+            if (len > root && !last_is_dotdot) {
+                // drop the last component
+                while (len > root && !os__path_is_sep(buf[len - 1])) {
+                    len--;
+                }
+                if (len > root) {
+                    len--;
+                }
+                buf[len] = '\0';
+                continue;
+            }
+            if (root > 0) {
+                continue; // "/.." is "/"
+            }
+        }
+        e$ret(os__path_append(buf, buf_size, &len, comp));
+    }
+
+    if (len == 0) {
+        buf[len++] = '.';
+        buf[len] = '\0';
+    }
+    *out = (str_c){ .buf = buf, .len = len };
+    return EOK;
+}
+
+/**
+ * @brief Returns relative path from start directory to path, lexically (file system and
+ * current directory are not accessed, e.g. "a/b/c", "a/d" -> "../b/c")
+ *
+ * @param path
+ * @param start directory
+ * @param buf destination buffer (result is null terminated)
+ * @param buf_size size of buf
+ * @param out result (view of buf), "." if paths are the same
+ * @return Error.argument if one path is absolute and other is not, or start goes above
+ *         path by ".." (requires current directory), Error.overflow
+ */
+Exception
+os__path__relpath(str_c path, str_c start, char* buf, size_t buf_size, str_c* out)
+{
+    uassert(out != NULL);
+    if (buf == NULL || buf_size < 2) {
+        return Error.argument;
+    }
+
+    char path_buf[PATH_MAX];
+    char start_buf[PATH_MAX];
+    str_c p, s;
+    e$ret(os__path__normalize(path, path_buf, sizeof(path_buf), &p));
+    e$ret(os__path__normalize(start, start_buf, sizeof(start_buf), &s));
+    if (os__path_is_sep(p.buf[0]) != os__path_is_sep(s.buf[0])) {
+        return Error.argument;
+    }
+
+    // skip common components
+    size_t ppos = 0, spos = 0;
+    str_c pc = { 0 }, sc = { 0 };
+    bool has_p = os__path_next(p, &ppos, &pc);
+    bool has_s = os__path_next(s, &spos, &sc);
+    while (has_p && has_s && str.cmp(pc, sc) == 0) {
+        has_p = os__path_next(p, &ppos, &pc);
+        has_s = os__path_next(s, &spos, &sc);
+    }
+
+    size_t len = 0;
+    buf[0] = '\0';
+    for (; has_s; has_s = os__path_next(s, &spos, &sc)) {
+        if (os__path_is_dotdot(sc)) {
+            return Error.argument;
+        }
+        e$ret(os__path_append(buf, buf_size, &len, s$("..")));
+    }
+    for (; has_p; has_p = os__path_next(p, &ppos, &pc)) {
+        e$ret(os__path_append(buf, buf_size, &len, pc));
+    }
+
+    if (len == 0) {
+        buf[len++] = '.';
+        buf[len] = '\0';
+    }
+    *out = (str_c){ .buf = buf, .len = len };
+    return EOK;
+}
+
+/**
+ * @brief Iterates over path components (views of path), empty and "." components are
+ * skipped, absolute path starts with root separator component ("/a//./b" -> "/", "a", "b")
+ *
+ * for$iter(str_c, it, os.path.iter(path, &it.iterator))
+ *
+ * @param path
+ * @param iterator
+ * @return component, it.idx.i is component index
+ */
+str_c*
+os__path__iter(str_c path, cex_iterator_s* iterator)
+{
+    uassert(iterator != NULL && "null iterator");
+
+    // temporary struct based on _ctxbuffer
+    struct iter_ctx
+    {
+        size_t cursor;
+        str_c comp;
+    }* ctx = (struct iter_ctx*)iterator->_ctx;
+    _Static_assert(sizeof(*ctx) <= sizeof(iterator->_ctx), "ctx size overflow");
+    _Static_assert(alignof(struct iter_ctx) <= alignof(size_t), "cex_iterator_s _ctx misalign");
+
+    if (unlikely(iterator->val == NULL)) {
+        // First run handling
+        if (!str.is_valid(path) || path.len == 0) {
+            return NULL;
+        }
+        ctx->cursor = 0;
+        iterator->idx.i = 0;
+        if (os__path_is_sep(path.buf[0])) {
+            ctx->comp = (str_c){ .buf = path.buf, .len = 1 };
+            iterator->val = &ctx->comp;
+            return iterator->val;
+        }
+    } else {
+        iterator->idx.i++;
+    }
+
+    if (!os__path_next(path, &ctx->cursor, &ctx->comp)) {
+        return NULL;
+    }
+    iterator->val = &ctx->comp;
+    return iterator->val;
+}
+
+/**
+ * @brief Opens recursive directory iterator (depth-first, directory goes before its entries)
+ *
+ * Uses getdents64() with d_type hint, stat is called only for filesystems without d_type.
+ * Symlinks are not followed, unreadable subdirectories are skipped.
+ *
+ * Exc err;
+ * os_walk_entry_s* e;
+ * while ((err = os.walk.next(&w, &e)) == EOK) { ... }
+ *
+ * @param self os_walk_c instance
+ * @param root root directory (symlink to directory is followed)
+ * @param pattern glob of entry names, '|' separated (e.g. "*.c|*.h"), NULL - all entries
+ *        (doesn't limit traversal, only yielded entries)
+ * @param max_depth max directory levels to scan, 0 - unlimited (1 - only entries of root)
+ * @param flags OS_WALK_* flags, 0 - files and directories
+ * @param allocator
+ * @return Error.not_found, Error.argument if root is not a directory, Error.io
+ */
+Exception
+os__walk__open(
+    os_walk_c* self,
+    str_c root,
+    const char* pattern,
+    u32 max_depth,
+    u32 flags,
+    const Allocator_i* allocator
+)
+{
+    return os__walk__open_(self, root, pattern, max_depth, flags, allocator);
+}
+
+/**
+ * @brief Returns next entry
+ *
+ * @param self os_walk_c instance
+ * @param entry next entry (valid until the next call)
+ * @return Error.eof when all entries were returned
+ */
+Exception
+os__walk__next(os_walk_c* self, os_walk_entry_s** entry)
+{
+    return os__walk__next_(self, entry);
+}
+
+/**
+ * @brief Don't descend into directory entry returned by the last os.walk.next() call
+ *
+ * @param self os_walk_c instance
+ */
+void
+os__walk__skip(os_walk_c* self)
+{
+    os__walk__skip_(self);
+}
+
+/**
+ * @brief Closes directory iterator (NULL-safe, can be called multiple times)
+ *
+ * @param self os_walk_c instance
+ */
+void
+os__walk__close(os_walk_c* self)
+{
+    os__walk__close_(self);
+}
+
+/**
+ * @brief Walks directory tree by multiple threads, for trees with lots of files/directories
+ *
+ * Directories are scanned concurrently, and fn is called from different threads (the calling
+ * thread is one of workers), entries order is not defined. Error returned by fn stops the walk.
+ *
+ * @param root root directory (symlink to directory is followed)
+ * @param pattern glob of entry names, '|' separated, NULL - all entries
+ * @param max_depth max directory levels to scan, 0 - unlimited
+ * @param flags OS_WALK_* flags, 0 - files and directories
+ * @param nthreads number of threads, 0 - number of CPUs
+ * @param fn entry callback (must be thread safe), entry is valid only during the call
+ * @param ctx callback context
+ * @param allocator
+ * @return first error of fn, Error.not_found, Error.argument, Error.overflow if path exceeds
+ *         PATH_MAX
+ */
+Exception
+os__walk__parallel(
+    str_c root,
+    const char* pattern,
+    u32 max_depth,
+    u32 flags,
+    u32 nthreads,
+    os_walk_f fn,
+    void* ctx,
+    const Allocator_i* allocator
+)
+{
+    return os__walk__parallel_(root, pattern, max_depth, flags, nthreads, fn, ctx, allocator);
+}
+
+/**
+ * @brief Reads directory entries with type, size and mtime in one pass (instead of os.listdir()
+ * and stat() call per path)
+ *
+ * Entries are stat-ed relative to directory fd, names are stored in a single arena. Symlink
+ * entries are not followed (path itself may be a symlink to directory, like in os.listdir()).
+ * Entries order is not defined.
+ *
+ * for (u32 i = 0; i < dir.len; i++) { dir.entries[i].name ... }
+ *
+ * NOTE: instance must be destroyed before reuse
+ *
+ * @param self os_dir_c instance
+ * @param path directory path
+ * @param allocator
+ * @return Error.not_found, Error.argument if path is not a directory, Error.io
+ */
+Exception
+os__dir__read(os_dir_c* self, str_c path, const Allocator_i* allocator)
+{
+    return os__dir__read_(self, path, allocator);
+}
+
+/**
+ * @brief Frees directory entries (NULL-safe, can be called multiple times)
+ *
+ * @param self os_dir_c instance
+ */
+void
+os__dir__destroy(os_dir_c* self)
+{
+    os__dir__destroy_(self);
+}
+
+/**
+ * @brief Creates file change watcher (inotify), events are coalesced into bursts: all events
+ * are collected until there are no new events for settle_ms, and every path is reported once
+ * per burst with combined event mask (e.g. created and then deleted temporary file is not
+ * reported at all, deleted and created again file is reported as modified).
+ *
+ * os_watch_event_s* e;
+ * while (os.watch.next(&w, 1000, &e) == EOK) { reload(e->path); }
+ *
+ * @param self os_watch_c instance
+ * @param settle_ms quiet time which ends burst of events, 0 - OS_WATCH_SETTLE_MS
+ * @param allocator
+ * @return Error.io if inotify is not available
+ */
+Exception
+os__watch__create(os_watch_c* self, u32 settle_ms, const Allocator_i* allocator)
+{
+    return os__watch__create_(self, settle_ms, allocator);
+}
+
+/**
+ * @brief Adds file or directory to watch list
+ *
+ * Files are watched via their parent directory, so they are still tracked after replace by
+ * rename (atomic save of editors). For directories all direct entries are reported, if
+ * recursive - all subdirectories too (including created later, hidden are skipped).
+ *
+ * @param self os_watch_c instance
+ * @param path file or directory path (symlink to directory is followed, symlinked
+ *        subdirectories are not)
+ * @param recursive watch all subdirectories of directory
+ * @return Error.not_found, Error.overflow if inotify watch limit is reached, Error.io
+ */
+Exception
+os__watch__add(os_watch_c* self, str_c path, bool recursive)
+{
+    return os__watch__add_(self, path, recursive);
+}
+
+/**
+ * @brief Returns the next coalesced event, waits for the next burst of events if needed
+ *
+ * @param self os_watch_c instance
+ * @param timeout_ms max time to wait for the first event of burst, 0 - no wait, UINT32_MAX -
+ *        infinite
+ * @param event result (path is valid until the next burst)
+ * @return Error.empty on timeout, Error.io
+ */
+Exception
+os__watch__next(os_watch_c* self, u32 timeout_ms, os_watch_event_s** event)
+{
+    return os__watch__next_(self, timeout_ms, event);
+}
+
+/**
+ * @brief Waits for the next burst of events, and calls fn for all its events
+ *
+ * @param self os_watch_c instance
+ * @param timeout_ms max time to wait for the first event, 0 - no wait, UINT32_MAX - infinite
+ * @param fn event callback, error stops processing (the rest of events are returned by the next
+ *        calls)
+ * @param ctx callback context
+ * @return Error.empty on timeout, Error.io, or fn error
+ */
+Exception
+os__watch__poll(os_watch_c* self, u32 timeout_ms, os_watch_f fn, void* ctx)
+{
+    return os__watch__poll_(self, timeout_ms, fn, ctx);
+}
+
+/**
+ * @brief Removes all watches and frees resources (NULL-safe, can be called multiple times)
+ *
+ * @param self os_watch_c instance
+ */
+void
+os__watch__destroy(os_watch_c* self)
+{
+    os__watch__destroy_(self);
+}
+
+/**
+ * @brief Starts child process by posix_spawnp(), its output is captured / streamed by
+ * os.proc.wait()
+ *
+ * NOTE: started process must be waited by os.proc.wait()
+ *
+ * @param self os_proc_c instance
+ * @param argv NULL terminated arguments, argv[0] is searched in PATH
+ * @param opt output capture and timeout options, NULL - inherit stdout / stderr, no timeout
+ * @return Error.not_found if program is not found, Error.argument, Error.io
+ */
+Exception
+os__proc__spawn(os_proc_c* self, const char* const argv[], os_proc_opt_s* opt)
+{
+    return os__proc__spawn_(self, argv, opt);
+}
+
+/**
+ * @brief Waits for process exit, while capturing its stdout / stderr by non-blocking reads
+ *
+ * @param self os_proc_c instance
+ * @return Error.timeout if process was killed by timeout, or output write error, non-zero exit
+ *         code is not an error (see self->exit_code). On poll() error the process is killed.
+ */
+Exception
+os__proc__wait(os_proc_c* self)
+{
+    return os__proc__wait_(self);
+}
+
+/**
+ * @brief Runs command and waits for its exit (os.proc.spawn() + os.proc.wait())
+ *
+ * sbuf_c out = ...;
+ * int code;
+ * e$ret(os.proc.run((const char*[]){ "git", "status", NULL }, &(os_proc_opt_s){ .out = &out }, &code));
+ *
+ * @param argv NULL terminated arguments, argv[0] is searched in PATH
+ * @param opt output capture and timeout options, NULL - inherit stdout / stderr, no timeout
+ * @param exit_code exit status, or 128 + signal number, -1 if not started (optional)
+ * @return Error.not_found, Error.timeout, Error.io, or output write error
+ */
+Exception
+os__proc__run(const char* const argv[], os_proc_opt_s* opt, int* exit_code)
+{
+    return os__proc__run_(argv, opt, exit_code);
+}
+
+/**
+ * @brief Runs many commands concurrently (at most max_parallel at once), all outputs are
+ * handled by single poll() loop of the calling thread
+ *
+ * @param cmds commands, exit_code and error of every command are set
+ * @param ncmds number of commands
+ * @param max_parallel max number of running processes, 0 - number of CPUs (capped by
+ *        OS_PROC_MAX_PARALLEL)
+ * @return the first command error (in commands order), all commands are run anyway
+ */
+Exception
+os__proc__run_all(os_proc_cmd_s* cmds, u32 ncmds, u32 max_parallel)
+{
+    return os__proc__run_all_(cmds, ncmds, max_parallel);
+}
 
 const struct __module__os os = {
     // Autogenerated by CEX
@@ -114,6 +720,41 @@ const struct __module__os os = {
         .exists = os__path__exists,
         .join = os__path__join,
         .splitext = os__path__splitext,
+        .split = os__path__split,
+        .dirname = os__path__dirname,
+        .basename = os__path__basename,
+        .join_buf = os__path__join_buf,
+        .normalize = os__path__normalize,
+        .relpath = os__path__relpath,
+        .iter = os__path__iter,
     },  // sub-module .path <<<
+
+    .walk = {  // sub-module .walk >>>
+        .open = os__walk__open,
+        .next = os__walk__next,
+        .skip = os__walk__skip,
+        .close = os__walk__close,
+        .parallel = os__walk__parallel,
+    },  // sub-module .walk <<<
+
+    .dir = {  // sub-module .dir >>>
+        .read = os__dir__read,
+        .destroy = os__dir__destroy,
+    },  // sub-module .dir <<<
+
+    .watch = {  // sub-module .watch >>>
+        .create = os__watch__create,
+        .add = os__watch__add,
+        .next = os__watch__next,
+        .poll = os__watch__poll,
+        .destroy = os__watch__destroy,
+    },  // sub-module .watch <<<
+
+    .proc = {  // sub-module .proc >>>
+        .spawn = os__proc__spawn,
+        .wait = os__proc__wait,
+        .run = os__proc__run,
+        .run_all = os__proc__run_all,
+    },  // sub-module .proc <<<
     // clang-format on
 };
@@ -1,5 +1,211 @@
 #pragma once
 #include <cex.h>
+#include <sys/types.h>
+
+// os.walk.open() / os.walk.parallel() flags (0 - files and directories)
+#define OS_WALK_FILES 0x1  // yield non-directory entries
+#define OS_WALK_DIRS 0x2   // yield directories
+#define OS_WALK_HIDDEN 0x4 // include (and descend into) entries which names start with '.'
+
+// Max number of '|' separated glob patterns of os.walk
+#define OS_WALK_MAX_PATTERNS 16
+
+// Size of getdents64() buffer per opened directory
+#define OS_WALK_BUF_SIZE (32 * 1024)
+
+typedef enum
+{
+    OS_FTYPE_FILE = 1,
+    OS_FTYPE_DIR,
+    OS_FTYPE_LINK, // symlinks are never followed
+    OS_FTYPE_OTHER,
+} os_ftype_e;
+
+typedef struct
+{
+    str_c path; // root path + relative path of entry (valid until the next entry)
+    str_c name; // base name (view of path)
+    u32 depth;  // 0 - entries of root directory
+    os_ftype_e type;
+} os_walk_entry_s;
+
+typedef Exception (*os_walk_f)(os_walk_entry_s* entry, void* ctx);
+
+typedef struct
+{
+    sbuf_c pattern; // '\0' separated glob patterns
+    const char* patterns[OS_WALK_MAX_PATTERNS];
+    u32 npatterns;
+    u32 max_depth;
+    u32 flags;
+} os__walk_filter_s;
+
+typedef struct
+{
+    int fd;
+    u32 depth;
+    u32 path_len; // length of directory path in os_walk_c._path
+    u32 pos;      // position of the next entry in dents
+    u32 len;
+    char* dents; // getdents64() buffer
+} os__walk_frame_s;
+
+/**
+ * @brief Recursive directory iterator (see os.walk.open())
+ */
+typedef struct
+{
+    os_walk_entry_s _entry;
+    os__walk_filter_s _filter;
+    sbuf_c _path;
+    os__walk_frame_s* _frames;
+    u32 _nframes;
+    u32 _frames_cap;
+    const char* _descend; // name of directory to descend into by the next call
+    const Allocator_i* _allocator;
+} os_walk_c;
+
+typedef struct
+{
+    str_c name; // view into names arena of os_dir_c (null terminated)
+    os_ftype_e type;
+    u64 size;     // file size in bytes (of link itself for symlinks)
+    i64 mtime;    // modification time, seconds since epoch
+    u32 mtime_ns; // nanoseconds part of modification time
+} os_dirent_s;
+
+/**
+ * @brief Directory entries with metadata (see os.dir.read())
+ */
+typedef struct
+{
+    os_dirent_s* entries;
+    u32 len;
+
+    // private
+    u32 _cap;
+    sbuf_c _names; // all entry names, '\0' separated
+    const Allocator_i* _allocator;
+} os_dir_c;
+
+// os.watch event types (bit mask of os_watch_event_s.events)
+#define OS_WATCH_CREATE 0x1   // created or moved in
+#define OS_WATCH_MODIFY 0x2   // content or attributes changed, or replaced by rename
+#define OS_WATCH_DELETE 0x4   // deleted or moved out
+#define OS_WATCH_OVERFLOW 0x8 // kernel queue overflow, events were lost (full rescan needed)
+
+// Burst of events is collected until there is no new events for this time
+#define OS_WATCH_SETTLE_MS 50
+
+// Max time of collecting single burst of events (for continuously changing files)
+#define OS_WATCH_MAX_DELAY_MS 1000
+
+typedef struct
+{
+    str_c path;  // watched directory path + name (valid until the next burst of events)
+    u32 events;  // OS_WATCH_* mask of coalesced events
+    bool is_dir; // entry is directory
+} os_watch_event_s;
+
+typedef Exception (*os_watch_f)(os_watch_event_s* event, void* ctx);
+
+typedef struct
+{
+    int wd;     // inotify watch descriptor
+    char* path; // watched directory path
+    u32 path_len;
+    bool all;       // all entries are reported (directory was added, not only its files)
+    bool recursive; // new subdirectories are watched too
+} os__watch_dir_s;
+
+typedef struct
+{
+    int wd;
+    char* name; // file name in watched directory
+} os__watch_file_s;
+
+typedef struct
+{
+    u32 path_offset; // path offset in os_watch_c._paths
+    u32 path_len;
+    u32 events; // 0 - events canceled each other (e.g. created and deleted)
+    bool is_dir;
+} os__watch_pending_s;
+
+typedef struct
+{
+    str_c key; // view into os_watch_c._paths
+    u32 idx;   // index in os_watch_c._pending
+} os__watch_index_s;
+
+/**
+ * @brief Files and directory trees change watcher (see os.watch.create())
+ */
+typedef struct
+{
+    int _fd; // inotify instance
+    u32 _settle_ms;
+    os__watch_dir_s* _dirs;
+    u32 _ndirs;
+    u32 _dirs_cap;
+    os__watch_file_s* _files;
+    u32 _nfiles;
+    u32 _files_cap;
+    os__watch_pending_s* _pending; // coalesced events of the last burst
+    u32 _npending;
+    u32 _pending_cap;
+    u32 _pending_pos; // next event to return
+    sbuf_c _paths;    // '\0' separated paths of pending events
+    dict_c _index;    // path -> os__watch_index_s, for coalescing events of the burst
+    char* _buf;       // inotify read buffer
+    os_watch_event_s _event;
+    const Allocator_i* _allocator;
+} os_watch_c;
+
+// Max number of processes running concurrently by os.proc.run_all()
+#define OS_PROC_MAX_PARALLEL 64
+
+/**
+ * @brief Process options, output streams which are not captured are inherited from parent,
+ * stdin is /dev/null
+ */
+typedef struct
+{
+    sbuf_c* out;            // stdout is appended to sbuf (if set)
+    sbuf_c* err;            // stderr is appended to sbuf (if set)
+    io_c* out_io;           // stdout is written to io_c (if set, and out is not set)
+    io_c* err_io;           // stderr is written to io_c (if set, and err is not set)
+    const char* const* env; // NULL terminated environment, NULL - inherit
+    u32 timeout_ms;         // process is killed after timeout, 0 - no timeout
+} os_proc_opt_s;
+
+/**
+ * @brief Child process (see os.proc.spawn())
+ */
+typedef struct
+{
+    pid_t pid;
+    int exit_code; // exit status, or 128 + signal number if killed (valid after wait)
+
+    // private
+    int _fds[2]; // stdout / stderr pipes, -1 if not captured or closed
+    os_proc_opt_s _opt;
+    u64 _deadline; // monotonic ms, 0 - no timeout
+    bool _timed_out;
+    bool _exited;
+    Exc _error; // output write error
+} os_proc_c;
+
+/**
+ * @brief Command of os.proc.run_all()
+ */
+typedef struct
+{
+    const char* const* argv; // NULL terminated arguments, argv[0] is searched in PATH
+    os_proc_opt_s opt;
+    int exit_code; // result
+    Exc error;     // result of spawn / wait
+} os_proc_cmd_s;
 
 
 struct __module__os
@@ -33,7 +239,323 @@ struct {  // sub-module .path >>>
     str_c
     (*splitext)(str_c path, bool return_ext);
 
+    /**
+     * @brief Splits path into head (directory) and tail (last component), same as python
+     * os.path.split(), i.e. "a/b/" -> ("a/b", ""), "/a" -> ("/", "a"), "a" -> ("", "a")
+     *
+     * @param path
+     * @param head directory part (view of path, trailing separators are stripped unless path is root)
+     * @param tail last component (view of path)
+     */
+    void
+    (*split)(str_c path, str_c* head, str_c* tail);
+
+    /**
+     * @brief Returns directory part of path, see os.path.split()
+     *
+     * @param path
+     * @return view of path
+     */
+    str_c
+    (*dirname)(str_c path);
+
+    /**
+     * @brief Returns last component of path, see os.path.split() ("a/b/" -> "")
+     *
+     * @param path
+     * @return view of path
+     */
+    str_c
+    (*basename)(str_c path);
+
+    /**
+     * @brief Joins path parts into caller buffer (no allocations). Separator is added between
+     * parts, empty parts are skipped, absolute part discards all previous parts (like python
+     * os.path.join())
+     *
+     * char buf[PATH_MAX];
+     * str_c p;
+     * e$ret(os.path.join_buf(buf, sizeof(buf), &p, (str_c[]){ dir, s$("file.txt") }, 2));
+     *
+     * @param buf destination buffer (result is null terminated)
+     * @param buf_size size of buf
+     * @param out result (view of buf)
+     * @param parts array of parts
+     * @param nparts number of parts
+     * @return Error.overflow if buf is too small, Error.argument on invalid part
+     */
+    Exception
+    (*join_buf)(char* buf, size_t buf_size, str_c* out, const str_c* parts, u32 nparts);
+
+    /**
+     * @brief Normalizes path into caller buffer (no allocations, file system is not accessed):
+     * collapses repeated separators, removes "." components and resolves ".." lexically
+     * (e.g. "a/./b/../c//" -> "a/c", "/../a" -> "/a", "" -> ".")
+     *
+     * @param path
+     * @param buf destination buffer (result is null terminated)
+     * @param buf_size size of buf
+     * @param out result (view of buf)
+     * @return Error.overflow if buf is too small, Error.argument on invalid path
+     */
+    Exception
+    (*normalize)(str_c path, char* buf, size_t buf_size, str_c* out);
+
+    /**
+     * @brief Returns relative path from start directory to path, lexically (file system and
+     * current directory are not accessed, e.g. "a/b/c", "a/d" -> "../b/c")
+     *
+     * @param path
+     * @param start directory
+     * @param buf destination buffer (result is null terminated)
+     * @param buf_size size of buf
+     * @param out result (view of buf), "." if paths are the same
+     * @return Error.argument if one path is absolute and other is not, or start goes above
+     *         path by ".." (requires current directory), Error.overflow
+     */
+    Exception
+    (*relpath)(str_c path, str_c start, char* buf, size_t buf_size, str_c* out);
+
+    /**
+     * @brief Iterates over path components (views of path), empty and "." components are
+     * skipped, absolute path starts with root separator component ("/a//./b" -> "/", "a", "b")
+     *
+     * for$iter(str_c, it, os.path.iter(path, &it.iterator))
+     *
+     * @param path
+     * @param iterator
+     * @return component, it.idx.i is component index
+     */
+    str_c*
+    (*iter)(str_c path, cex_iterator_s* iterator);
+
 } path;  // sub-module .path <<<
+
+struct {  // sub-module .walk >>>
+    /**
+     * @brief Opens recursive directory iterator (depth-first, directory goes before its entries)
+     *
+     * Uses getdents64() with d_type hint, stat is called only for filesystems without d_type.
+     * Symlinks are not followed, unreadable subdirectories are skipped.
+     *
+     * Exc err;
+     * os_walk_entry_s* e;
+     * while ((err = os.walk.next(&w, &e)) == EOK) { ... }
+     *
+     * @param self os_walk_c instance
+     * @param root root directory (symlink to directory is followed)
+     * @param pattern glob of entry names, '|' separated (e.g. "*.c|*.h"), NULL - all entries
+     *        (doesn't limit traversal, only yielded entries)
+     * @param max_depth max directory levels to scan, 0 - unlimited (1 - only entries of root)
+     * @param flags OS_WALK_* flags, 0 - files and directories
+     * @param allocator
+     * @return Error.not_found, Error.argument if root is not a directory, Error.io
+     */
+    Exception
+    (*open)(os_walk_c* self, str_c root, const char* pattern, u32 max_depth, u32 flags, const Allocator_i* allocator);
+
+    /**
+     * @brief Returns next entry
+     *
+     * @param self os_walk_c instance
+     * @param entry next entry (valid until the next call)
+     * @return Error.eof when all entries were returned
+     */
+    Exception
+    (*next)(os_walk_c* self, os_walk_entry_s** entry);
+
+    /**
+     * @brief Don't descend into directory entry returned by the last os.walk.next() call
+     *
+     * @param self os_walk_c instance
+     */
+    void
+    (*skip)(os_walk_c* self);
+
+    /**
+     * @brief Closes directory iterator (NULL-safe, can be called multiple times)
+     *
+     * @param self os_walk_c instance
+     */
+    void
+    (*close)(os_walk_c* self);
+
+    /**
+     * @brief Walks directory tree by multiple threads, for trees with lots of files/directories
+     *
+     * Directories are scanned concurrently, and fn is called from different threads (the calling
+     * thread is one of workers), entries order is not defined. Error returned by fn stops the walk.
+     *
+     * @param root root directory (symlink to directory is followed)
+     * @param pattern glob of entry names, '|' separated, NULL - all entries
+     * @param max_depth max directory levels to scan, 0 - unlimited
+     * @param flags OS_WALK_* flags, 0 - files and directories
+     * @param nthreads number of threads, 0 - number of CPUs
+     * @param fn entry callback (must be thread safe), entry is valid only during the call
+     * @param ctx callback context
+     * @param allocator
+     * @return first error of fn, Error.not_found, Error.argument, Error.overflow if path exceeds
+     *         PATH_MAX
+     */
+    Exception
+    (*parallel)(str_c root, const char* pattern, u32 max_depth, u32 flags, u32 nthreads, os_walk_f fn, void* ctx, const Allocator_i* allocator);
+
+} walk;  // sub-module .walk <<<
+
+struct {  // sub-module .dir >>>
+    /**
+     * @brief Reads directory entries with type, size and mtime in one pass (instead of os.listdir()
+     * and stat() call per path)
+     *
+     * Entries are stat-ed relative to directory fd, names are stored in a single arena. Symlink
+     * entries are not followed (path itself may be a symlink to directory, like in os.listdir()).
+     * Entries order is not defined.
+     *
+     * for (u32 i = 0; i < dir.len; i++) { dir.entries[i].name ... }
+     *
+     * NOTE: instance must be destroyed before reuse
+     *
+     * @param self os_dir_c instance
+     * @param path directory path
+     * @param allocator
+     * @return Error.not_found, Error.argument if path is not a directory, Error.io
+     */
+    Exception
+    (*read)(os_dir_c* self, str_c path, const Allocator_i* allocator);
+
+    /**
+     * @brief Frees directory entries (NULL-safe, can be called multiple times)
+     *
+     * @param self os_dir_c instance
+     */
+    void
+    (*destroy)(os_dir_c* self);
+
+} dir;  // sub-module .dir <<<
+
+struct {  // sub-module .watch >>>
+    /**
+     * @brief Creates file change watcher (inotify), events are coalesced into bursts: all events
+     * are collected until there are no new events for settle_ms, and every path is reported once
+     * per burst with combined event mask (e.g. created and then deleted temporary file is not
+     * reported at all, deleted and created again file is reported as modified).
+     *
+     * os_watch_event_s* e;
+     * while (os.watch.next(&w, 1000, &e) == EOK) { reload(e->path); }
+     *
+     * @param self os_watch_c instance
+     * @param settle_ms quiet time which ends burst of events, 0 - OS_WATCH_SETTLE_MS
+     * @param allocator
+     * @return Error.io if inotify is not available
+     */
+    Exception
+    (*create)(os_watch_c* self, u32 settle_ms, const Allocator_i* allocator);
+
+    /**
+     * @brief Adds file or directory to watch list
+     *
+     * Files are watched via their parent directory, so they are still tracked after replace by
+     * rename (atomic save of editors). For directories all direct entries are reported, if
+     * recursive - all subdirectories too (including created later, hidden are skipped).
+     *
+     * @param self os_watch_c instance
+     * @param path file or directory path (symlink to directory is followed, symlinked
+     *        subdirectories are not)
+     * @param recursive watch all subdirectories of directory
+     * @return Error.not_found, Error.overflow if inotify watch limit is reached, Error.io
+     */
+    Exception
+    (*add)(os_watch_c* self, str_c path, bool recursive);
+
+    /**
+     * @brief Returns the next coalesced event, waits for the next burst of events if needed
+     *
+     * @param self os_watch_c instance
+     * @param timeout_ms max time to wait for the first event of burst, 0 - no wait, UINT32_MAX -
+     *        infinite
+     * @param event result (path is valid until the next burst)
+     * @return Error.empty on timeout, Error.io
+     */
+    Exception
+    (*next)(os_watch_c* self, u32 timeout_ms, os_watch_event_s** event);
+
+    /**
+     * @brief Waits for the next burst of events, and calls fn for all its events
+     *
+     * @param self os_watch_c instance
+     * @param timeout_ms max time to wait for the first event, 0 - no wait, UINT32_MAX - infinite
+     * @param fn event callback, error stops processing (the rest of events are returned by the next
+     *        calls)
+     * @param ctx callback context
+     * @return Error.empty on timeout, Error.io, or fn error
+     */
+    Exception
+    (*poll)(os_watch_c* self, u32 timeout_ms, os_watch_f fn, void* ctx);
+
+    /**
+     * @brief Removes all watches and frees resources (NULL-safe, can be called multiple times)
+     *
+     * @param self os_watch_c instance
+     */
+    void
+    (*destroy)(os_watch_c* self);
+
+} watch;  // sub-module .watch <<<
+
+struct {  // sub-module .proc >>>
+    /**
+     * @brief Starts child process by posix_spawnp(), its output is captured / streamed by
+     * os.proc.wait()
+     *
+     * NOTE: started process must be waited by os.proc.wait()
+     *
+     * @param self os_proc_c instance
+     * @param argv NULL terminated arguments, argv[0] is searched in PATH
+     * @param opt output capture and timeout options, NULL - inherit stdout / stderr, no timeout
+     * @return Error.not_found if program is not found, Error.argument, Error.io
+     */
+    Exception
+    (*spawn)(os_proc_c* self, const char* const argv[], os_proc_opt_s* opt);
+
+    /**
+     * @brief Waits for process exit, while capturing its stdout / stderr by non-blocking reads
+     *
+     * @param self os_proc_c instance
+     * @return Error.timeout if process was killed by timeout, or output write error, non-zero exit
+     *         code is not an error (see self->exit_code). On poll() error the process is killed.
+     */
+    Exception
+    (*wait)(os_proc_c* self);
+
+    /**
+     * @brief Runs command and waits for its exit (os.proc.spawn() + os.proc.wait())
+     *
+     * sbuf_c out = ...;
+     * int code;
+     * e$ret(os.proc.run((const char*[]){ "git", "status", NULL }, &(os_proc_opt_s){ .out = &out }, &code));
+     *
+     * @param argv NULL terminated arguments, argv[0] is searched in PATH
+     * @param opt output capture and timeout options, NULL - inherit stdout / stderr, no timeout
+     * @param exit_code exit status, or 128 + signal number, -1 if not started (optional)
+     * @return Error.not_found, Error.timeout, Error.io, or output write error
+     */
+    Exception
+    (*run)(const char* const argv[], os_proc_opt_s* opt, int* exit_code);
+
+    /**
+     * @brief Runs many commands concurrently (at most max_parallel at once), all outputs are
+     * handled by single poll() loop of the calling thread
+     *
+     * @param cmds commands, exit_code and error of every command are set
+     * @param ncmds number of commands
+     * @param max_parallel max number of running processes, 0 - number of CPUs (capped by
+     *        OS_PROC_MAX_PARALLEL)
+     * @return the first command error (in commands order), all commands are run anyway
+     */
+    Exception
+    (*run_all)(os_proc_cmd_s* cmds, u32 ncmds, u32 max_parallel);
+
+} proc;  // sub-module .proc <<<
     // clang-format on
 };
 extern const struct __module__os os; // CEX Autogen
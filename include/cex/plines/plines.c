@@ -0,0 +1,229 @@
+#include "plines.h"
+#include <cex.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void*
+plines__thread(void* arg)
+{
+    plines_chunk_s* chunk = arg;
+    chunk->error = chunk->_worker(chunk);
+    return NULL;
+}
+
+static u32
+plines__ncpu(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (u32)n : 1;
+}
+
+/**
+ * @brief Processes lines of data in parallel: data is split into byte ranges realigned to new
+ * lines, each range is handled by worker in its own thread, then results are merged in order
+ *
+ * Worker of the first chunk runs on the calling thread. Use plines.iter() to iterate chunk lines.
+ *
+ * @param data input text (e.g. mmap()-ed file or io.readall() result)
+ * @param nworkers max number of parallel workers, 0 - number of CPUs (capped by
+ *        PLINES_MAX_WORKERS, and input size / PLINES_MIN_CHUNK)
+ * @param worker chunk processing function, it's called concurrently for different chunks
+ * @param merge optional function called on calling thread for each chunk in order, after all
+ *        workers succeeded
+ * @param ctx user context, available as chunk->ctx
+ * @return the first worker error (in chunk order), or merge error
+ */
+Exception
+plines_process(str_c data, u32 nworkers, plines_worker_f worker, plines_worker_f merge, void* ctx)
+{
+    uassert(worker != NULL);
+    if (data.buf == NULL) {
+        return Error.argument;
+    }
+
+    if (nworkers == 0) {
+        nworkers = plines__ncpu();
+    }
+    if (nworkers > PLINES_MAX_WORKERS) {
+        nworkers = PLINES_MAX_WORKERS;
+    }
+    size_t nchunks = data.len / PLINES_MIN_CHUNK + 1;
+    if (nchunks > nworkers) {
+        nchunks = nworkers;
+    }
+
+    plines_chunk_s chunks[PLINES_MAX_WORKERS];
+    pthread_t threads[PLINES_MAX_WORKERS];
+
+    size_t start = 0;
+    for (u32 i = 0; i < nchunks; i++) {
+        size_t end = data.len;
+        if (i < nchunks - 1) {
+            end = data.len / nchunks * (i + 1);
+            if (end <= start) {
+                // previous chunk took a long line
+                end = start;
+            } else {
+                // move end after the next '\n' (or keep it, if it's already a line start)
+                const char* nl = memchr(data.buf + end - 1, '\n', data.len - end + 1);
+                end = (nl != NULL) ? (size_t)(nl - data.buf) + 1 : data.len;
+            }
+        }
+        chunks[i] = (plines_chunk_s){
+            .data = { .buf = data.buf + start, .len = end - start },
+            .offset = start,
+            .index = i,
+            .ctx = ctx,
+            ._worker = worker,
+        };
+        start = end;
+    }
+
+    for (u32 i = 1; i < nchunks; i++) {
+        chunks[i]._spawned = pthread_create(&threads[i], NULL, plines__thread, &chunks[i]) == 0;
+    }
+    plines__thread(&chunks[0]);
+    for (u32 i = 1; i < nchunks; i++) {
+        if (chunks[i]._spawned) {
+            pthread_join(threads[i], NULL);
+        } else {
+            // out of threads, process on the calling thread
+            plines__thread(&chunks[i]);
+        }
+    }
+
+    for (u32 i = 0; i < nchunks; i++) {
+        if (chunks[i].error != EOK) {
+            return chunks[i].error;
+        }
+    }
+    if (merge != NULL) {
+        for (u32 i = 0; i < nchunks; i++) {
+            e$ret(merge(&chunks[i]));
+        }
+    }
+    return EOK;
+}
+
+/**
+ * @brief Processes lines of file in parallel (file is mmap()-ed, see plines.process())
+ *
+ * @param path regular file path
+ * @param nworkers max number of parallel workers, 0 - number of CPUs
+ * @param worker chunk processing function, it's called concurrently for different chunks
+ * @param merge optional function called on calling thread for each chunk in order
+ * @param ctx user context, available as chunk->ctx
+ * @return Error.not_found, Error.io, Error.argument if not a regular file, or plines.process()
+ *         error
+ */
+Exception
+plines_process_file(
+    const char* path,
+    u32 nworkers,
+    plines_worker_f worker,
+    plines_worker_f merge,
+    void* ctx
+)
+{
+    uassert(worker != NULL);
+    if (path == NULL) {
+        return Error.argument;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return (errno == ENOENT) ? Error.not_found : Error.io;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return Error.io;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        close(fd);
+        return Error.argument;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return plines_process((str_c){ .buf = "", .len = 0 }, nworkers, worker, merge, ctx);
+    }
+
+    size_t size = st.st_size;
+    void* mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping stays valid
+    if (mem == MAP_FAILED) {
+        return Error.io;
+    }
+    // every worker reads its range sequentially
+    madvise(mem, size, MADV_SEQUENTIAL);
+
+    Exc result = plines_process((str_c){ .buf = mem, .len = size }, nworkers, worker, merge, ctx);
+
+    munmap(mem, size);
+    return result;
+}
+
+/**
+ * @brief Iterates over lines of chunk data (new line chars are excluded, \r\n is supported)
+ *
+ * for$iter(str_c, it, plines.iter(chunk->data, &it.iterator))
+ *
+ * @param data chunk data
+ * @param iterator
+ * @return line, it.idx.i is line index in the chunk
+ */
+str_c*
+plines_iter(str_c data, cex_iterator_s* iterator)
+{
+    uassert(iterator != NULL && "null iterator");
+
+    // temporary struct based on _ctxbuffer
+    struct iter_ctx
+    {
+        size_t cursor;
+        str_c line;
+    }* ctx = (struct iter_ctx*)iterator->_ctx;
+    _Static_assert(sizeof(*ctx) <= sizeof(iterator->_ctx), "ctx size overflow");
+    _Static_assert(alignof(struct iter_ctx) <= alignof(size_t), "cex_iterator_s _ctx misalign");
+
+    if (unlikely(iterator->val == NULL)) {
+        // First run handling
+        if (data.buf == NULL) {
+            return NULL;
+        }
+        ctx->cursor = 0;
+        iterator->idx.i = 0;
+    } else {
+        iterator->idx.i++;
+    }
+
+    if (ctx->cursor >= data.len) {
+        return NULL;
+    }
+
+    char* p = data.buf + ctx->cursor;
+    size_t rem = data.len - ctx->cursor;
+    const char* nl = memchr(p, '\n', rem);
+    size_t len = (nl != NULL) ? (size_t)(nl - p) : rem;
+    ctx->cursor += (nl != NULL) ? len + 1 : len;
+    if (len > 0 && p[len - 1] == '\r') {
+        len--;
+    }
+
+    ctx->line = (str_c){ .buf = p, .len = len };
+    iterator->val = &ctx->line;
+    return iterator->val;
+}
+const struct __module__plines plines = {
+    // Autogenerated by CEX
+    // clang-format off
+    .process = plines_process,
+    .process_file = plines_process_file,
+    .iter = plines_iter,
+    // clang-format on
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <cex.h>
+
+// Max number of parallel workers (chunks)
+#define PLINES_MAX_WORKERS 64
+
+// Min chunk size, smaller inputs are split into fewer chunks (threads are not worth it)
+#define PLINES_MIN_CHUNK (256 * 1024)
+
+struct plines_chunk_s;
+typedef Exception (*plines_worker_f)(struct plines_chunk_s* chunk);
+
+/**
+ * @brief Byte range of input with whole lines, processed by a single worker
+ */
+typedef struct plines_chunk_s
+{
+    str_c data;    // whole lines (the last chunk may end without '\n'), may be empty
+    size_t offset; // offset of data in the input
+    u32 index;     // chunk index, chunks are ordered by offset
+    void* ctx;     // user context of plines.process()
+    void* result;  // free slot for worker result, i.e. for merge callback
+    Exc error;     // worker result
+
+    // private
+    plines_worker_f _worker;
+    bool _spawned;
+} plines_chunk_s;
+struct __module__plines
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Processes lines of data in parallel: data is split into byte ranges realigned to new
+ * lines, each range is handled by worker in its own thread, then results are merged in order
+ *
+ * Worker of the first chunk runs on the calling thread. Use plines.iter() to iterate chunk lines.
+ *
+ * @param data input text (e.g. mmap()-ed file or io.readall() result)
+ * @param nworkers max number of parallel workers, 0 - number of CPUs (capped by
+ *        PLINES_MAX_WORKERS, and input size / PLINES_MIN_CHUNK)
+ * @param worker chunk processing function, it's called concurrently for different chunks
+ * @param merge optional function called on calling thread for each chunk in order, after all
+ *        workers succeeded
+ * @param ctx user context, available as chunk->ctx
+ * @return the first worker error (in chunk order), or merge error
+ */
+Exception
+(*process)(str_c data, u32 nworkers, plines_worker_f worker, plines_worker_f merge, void* ctx);
+
+/**
+ * @brief Processes lines of file in parallel (file is mmap()-ed, see plines.process())
+ *
+ * @param path regular file path
+ * @param nworkers max number of parallel workers, 0 - number of CPUs
+ * @param worker chunk processing function, it's called concurrently for different chunks
+ * @param merge optional function called on calling thread for each chunk in order
+ * @param ctx user context, available as chunk->ctx
+ * @return Error.not_found, Error.io, Error.argument if not a regular file, or plines.process()
+ *         error
+ */
+Exception
+(*process_file)(const char* path, u32 nworkers, plines_worker_f worker, plines_worker_f merge, void* ctx);
+
+/**
+ * @brief Iterates over lines of chunk data (new line chars are excluded, \r\n is supported)
+ *
+ * for$iter(str_c, it, plines.iter(chunk->data, &it.iterator))
+ *
+ * @param data chunk data
+ * @param iterator
+ * @return line, it.idx.i is line index in the chunk
+ */
+str_c*
+(*iter)(str_c data, cex_iterator_s* iterator);
+
+    // clang-format on
+};
+extern const struct __module__plines plines; // CEX Autogen
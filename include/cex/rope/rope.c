@@ -0,0 +1,282 @@
+#include "rope.h"
+#include <cex.h>
+#include <limits.h>
+#include <stdarg.h>
+
+static rope__chunk_s*
+rope__new_chunk(rope_c* self, size_t capacity)
+{
+    rope__chunk_s* chunk = self->_allocator->malloc(sizeof(rope__chunk_s) + capacity);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->len = 0;
+    chunk->capacity = capacity;
+
+    if (self->_tail == NULL) {
+        self->_head = chunk;
+    } else {
+        self->_tail->next = chunk;
+    }
+    self->_tail = chunk;
+    self->_nchunks++;
+    return chunk;
+}
+
+/**
+ * @brief Creates new rope
+ *
+ * @param self rope_c instance
+ * @param chunk_size size of chunk, 0 - use ROPE_CHUNK_SIZE
+ * @param allocator
+ * @return
+ */
+Exception
+rope_create(rope_c* self, size_t chunk_size, const Allocator_i* allocator)
+{
+    if (self == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        return Error.argument;
+    }
+    if (allocator == NULL) {
+        uassert(allocator != NULL && "allocator invalid");
+        return Error.argument;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->_chunk_size = (chunk_size > 0) ? chunk_size : ROPE_CHUNK_SIZE;
+    self->_allocator = allocator;
+
+    return EOK;
+}
+
+/**
+ * @brief Appends string to the rope (data is copied into chunks)
+ *
+ * @param self rope_c instance
+ * @param s string
+ * @return Error.argument on bad string, Error.memory on allocation failure
+ */
+Exception
+rope_append(rope_c* self, str_c s)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (s.buf == NULL) {
+        return Error.argument;
+    }
+
+    while (s.len > 0) {
+        rope__chunk_s* chunk = self->_tail;
+        if (chunk == NULL || chunk->len == chunk->capacity) {
+            chunk = rope__new_chunk(self, self->_chunk_size);
+            if (chunk == NULL) {
+                return Error.memory;
+            }
+        }
+        size_t n = chunk->capacity - chunk->len;
+        if (n > s.len) {
+            n = s.len;
+        }
+        memcpy(&chunk->buf[chunk->len], s.buf, n);
+        chunk->len += n;
+        self->_len += n;
+        s.buf += n;
+        s.len -= n;
+    }
+
+    return EOK;
+}
+
+/**
+ * @brief Appends formatted string to the rope
+ *
+ * @param self rope_c instance
+ * @param format
+ * @param va
+ * @return Error.memory on allocation failure
+ */
+Exception
+rope_vsprintf(rope_c* self, const char* format, va_list va)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    rope__chunk_s* chunk = self->_tail;
+    size_t avail = (chunk != NULL) ? chunk->capacity - chunk->len : 0;
+
+    // Try to format straight into the current chunk, sprintf reserves 1 byte for nullterm
+    if (avail > 1) {
+        int count = (avail > INT_MAX) ? INT_MAX : (int)avail;
+        va_list va2;
+        va_copy(va2, va);
+        str_c out = str.vsprintf(&chunk->buf[chunk->len], count, format, va2);
+        va_end(va2);
+
+        // NOTE: out.len == count if result was truncated
+        if (out.len < (size_t)count) {
+            chunk->len += out.len;
+            self->_len += out.len;
+            return EOK;
+        }
+    }
+
+    // Doesn't fit: format into reusable scratch buffer, and split it into chunks
+    if (self->_fmtbuf == NULL) {
+        e$ret(sbuf.create(&self->_fmtbuf, 256, self->_allocator));
+    } else {
+        sbuf.clear(&self->_fmtbuf);
+    }
+    e$ret(sbuf.vsprintf(&self->_fmtbuf, format, va));
+
+    return rope_append(self, sbuf.to_str(&self->_fmtbuf));
+}
+
+/**
+ * @brief Appends formatted string to the rope
+ *
+ * @param self rope_c instance
+ * @param format
+ * @return Error.memory on allocation failure
+ */
+Exception
+rope_sprintf(rope_c* self, const char* format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    Exc result = rope_vsprintf(self, format, va);
+    va_end(va);
+    return result;
+}
+
+/**
+ * @brief Total length of rope data
+ *
+ * @param self rope_c instance
+ * @return
+ */
+size_t
+rope_len(rope_c* self)
+{
+    uassert(self != NULL);
+    return self->_len;
+}
+
+/**
+ * @brief Appends whole rope data into sbuf, with a single allocation and gather copy
+ *
+ * @param self rope_c instance
+ * @param dest sbuf_c to append into
+ * @return Error.memory/Error.overflow if sbuf can't grow
+ */
+Exception
+rope_to_sbuf(rope_c* self, sbuf_c* dest)
+{
+    uassert(self != NULL);
+    uassert(dest != NULL);
+
+    e$ret(sbuf.reserve(dest, self->_len));
+
+    for (rope__chunk_s* chunk = self->_head; chunk != NULL; chunk = chunk->next) {
+        e$ret(sbuf.append(dest, (str_c){ .buf = chunk->buf, .len = chunk->len }));
+    }
+    return EOK;
+}
+
+/**
+ * @brief Writes whole rope data into file, chunks are passed to io.writev() without copying
+ *
+ * @param self rope_c instance
+ * @param out opened file
+ * @return Error.io on write failure
+ */
+Exception
+rope_write(rope_c* self, io_c* out)
+{
+    uassert(self != NULL);
+    uassert(out != NULL);
+
+    str_c parts[64];
+    size_t n = 0;
+
+    for (rope__chunk_s* chunk = self->_head; chunk != NULL; chunk = chunk->next) {
+        parts[n++] = (str_c){ .buf = chunk->buf, .len = chunk->len };
+        if (n == arr$len(parts)) {
+            e$ret(io.writev(out, parts, n, NULL));
+            n = 0;
+        }
+    }
+    if (n > 0) {
+        e$ret(io.writev(out, parts, n, NULL));
+    }
+    return EOK;
+}
+
+/**
+ * @brief Removes all data from the rope, keeps the first chunk for reuse
+ *
+ * @param self rope_c instance
+ */
+void
+rope_clear(rope_c* self)
+{
+    uassert(self != NULL);
+
+    if (self->_head == NULL) {
+        return;
+    }
+
+    rope__chunk_s* chunk = self->_head->next;
+    while (chunk != NULL) {
+        rope__chunk_s* next = chunk->next;
+        self->_allocator->free(chunk);
+        chunk = next;
+    }
+
+    self->_head->next = NULL;
+    self->_head->len = 0;
+    self->_tail = self->_head;
+    self->_nchunks = 1;
+    self->_len = 0;
+}
+
+/**
+ * @brief Frees rope and all its chunks
+ *
+ * @param self rope_c instance
+ */
+void
+rope_destroy(rope_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+
+    rope__chunk_s* chunk = self->_head;
+    while (chunk != NULL) {
+        rope__chunk_s* next = chunk->next;
+        self->_allocator->free(chunk);
+        chunk = next;
+    }
+    if (self->_fmtbuf != NULL) {
+        sbuf.destroy(&self->_fmtbuf);
+    }
+
+    memset(self, 0, sizeof(*self));
+}
+const struct __module__rope rope = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = rope_create,
+    .append = rope_append,
+    .vsprintf = rope_vsprintf,
+    .sprintf = rope_sprintf,
+    .len = rope_len,
+    .to_sbuf = rope_to_sbuf,
+    .write = rope_write,
+    .clear = rope_clear,
+    .destroy = rope_destroy,
+    // clang-format on
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <cex.h>
+
+// Default size of rope chunk
+#define ROPE_CHUNK_SIZE (64 * 1024)
+
+typedef struct rope__chunk_s
+{
+    struct rope__chunk_s* next;
+    size_t len;
+    size_t capacity;
+    char buf[];
+} rope__chunk_s;
+
+/**
+ * @brief Chunked string builder for very large outputs
+ *
+ * Appends go into a linked list of fixed-size chunks, so growing never reallocates or copies
+ * the data written so far. The result is finalized by a single gather copy into sbuf_c
+ * (rope.to_sbuf()), or written straight to a file by vectored write (rope.write()).
+ */
+typedef struct
+{
+    rope__chunk_s* _head; // first chunk
+    rope__chunk_s* _tail; // current chunk for appending
+    size_t _len;          // total number of bytes in all chunks
+    size_t _nchunks;
+    size_t _chunk_size;
+    sbuf_c _fmtbuf; // scratch for sprintf() results not fitting into the current chunk
+    const Allocator_i* _allocator;
+} rope_c;
+struct __module__rope
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates new rope
+ *
+ * @param self rope_c instance
+ * @param chunk_size size of chunk, 0 - use ROPE_CHUNK_SIZE
+ * @param allocator
+ * @return
+ */
+Exception
+(*create)(rope_c* self, size_t chunk_size, const Allocator_i* allocator);
+
+/**
+ * @brief Appends string to the rope (data is copied into chunks)
+ *
+ * @param self rope_c instance
+ * @param s string
+ * @return Error.argument on bad string, Error.memory on allocation failure
+ */
+Exception
+(*append)(rope_c* self, str_c s);
+
+/**
+ * @brief Appends formatted string to the rope
+ *
+ * @param self rope_c instance
+ * @param format
+ * @param va
+ * @return Error.memory on allocation failure
+ */
+Exception
+(*vsprintf)(rope_c* self, const char* format, va_list va);
+
+/**
+ * @brief Appends formatted string to the rope
+ *
+ * @param self rope_c instance
+ * @param format
+ * @return Error.memory on allocation failure
+ */
+Exception
+(*sprintf)(rope_c* self, const char* format, ...);
+
+/**
+ * @brief Total length of rope data
+ *
+ * @param self rope_c instance
+ * @return
+ */
+size_t
+(*len)(rope_c* self);
+
+/**
+ * @brief Appends whole rope data into sbuf, with a single allocation and gather copy
+ *
+ * @param self rope_c instance
+ * @param dest sbuf_c to append into
+ * @return Error.memory/Error.overflow if sbuf can't grow
+ */
+Exception
+(*to_sbuf)(rope_c* self, sbuf_c* dest);
+
+/**
+ * @brief Writes whole rope data into file, chunks are passed to io.writev() without copying
+ *
+ * @param self rope_c instance
+ * @param out opened file
+ * @return Error.io on write failure
+ */
+Exception
+(*write)(rope_c* self, io_c* out);
+
+/**
+ * @brief Removes all data from the rope, keeps the first chunk for reuse
+ *
+ * @param self rope_c instance
+ */
+void
+(*clear)(rope_c* self);
+
+/**
+ * @brief Frees rope and all its chunks
+ *
+ * @param self rope_c instance
+ */
+void
+(*destroy)(rope_c* self);
+
+    // clang-format on
+};
+extern const struct __module__rope rope; // CEX Autogen
@@ -0,0 +1,245 @@
+#include "strintern.h"
+#include <cex.h>
+
+static char*
+strintern__alloc_bytes(strintern_c* self, size_t nbytes)
+{
+    strintern__chunk_s* chunk = self->_chunks;
+
+    if (chunk == NULL || chunk->capacity - chunk->len < nbytes) {
+        size_t capacity = (nbytes > self->_chunk_size) ? nbytes : self->_chunk_size;
+        strintern__chunk_s* new_chunk = self->_allocator->malloc(
+            sizeof(strintern__chunk_s) + capacity
+        );
+        if (new_chunk == NULL) {
+            return NULL;
+        }
+        new_chunk->len = 0;
+        new_chunk->capacity = capacity;
+
+        if (chunk != NULL && capacity > self->_chunk_size) {
+            // Oversized string chunk is always full, keep appending to the current chunk
+            new_chunk->next = chunk->next;
+            chunk->next = new_chunk;
+        } else {
+            new_chunk->next = chunk;
+            self->_chunks = new_chunk;
+        }
+        chunk = new_chunk;
+    }
+
+    char* result = &chunk->buf[chunk->len];
+    chunk->len += nbytes;
+    return result;
+}
+
+/**
+ * @brief Creates new string interning pool
+ *
+ * @param self strintern_c instance
+ * @param chunk_size arena chunk size for string bytes, 0 - use STRINTERN_CHUNK_SIZE
+ * @param allocator
+ * @return
+ */
+Exception
+strintern_create(strintern_c* self, size_t chunk_size, const Allocator_i* allocator)
+{
+    if (self == NULL) {
+        uassert(self != NULL && "must not be NULL");
+        return Error.argument;
+    }
+    if (allocator == NULL) {
+        uassert(allocator != NULL && "allocator invalid");
+        return Error.argument;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->_chunk_size = (chunk_size > 0) ? chunk_size : STRINTERN_CHUNK_SIZE;
+    self->_allocator = allocator;
+
+    Exc result = Error.runtime;
+
+    e$goto(result = dict$new(&self->_index, strintern__item_s, key, allocator), fail);
+    e$goto(result = list$new(&self->_strings, 64, allocator), fail);
+
+    // id = 0 is reserved as invalid/not found
+    str_c invalid = { 0 };
+    e$goto(result = list.append(&self->_strings, &invalid), fail);
+
+    return EOK;
+
+fail:
+    strintern.destroy(self);
+    return result;
+}
+
+/**
+ * @brief Interns a string and returns its unique id (ids start from 1)
+ *
+ * @param self strintern_c instance
+ * @param s string to intern (bytes are copied into pool arena, if not interned yet)
+ * @param out_id unique id of interned string (optional, may be NULL)
+ * @return Error.argument on bad string, Error.memory on allocation failure
+ */
+Exception
+strintern_add(strintern_c* self, str_c s, u32* out_id)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (s.buf == NULL) {
+        return Error.argument;
+    }
+
+    strintern__item_s* item = dict.gets(&self->_index, s);
+    if (item != NULL) {
+        if (out_id) {
+            *out_id = item->id;
+        }
+        return EOK;
+    }
+
+    if (self->_strings.len >= UINT32_MAX) {
+        return Error.overflow;
+    }
+
+    char* buf = strintern__alloc_bytes(self, s.len + 1);
+    if (buf == NULL) {
+        return Error.memory;
+    }
+    memcpy(buf, s.buf, s.len);
+    buf[s.len] = '\0';
+
+    strintern__item_s rec = {
+        .key = (str_c){ .buf = buf, .len = s.len },
+        .id = self->_strings.len,
+    };
+
+    // NOTE: buf memory is not reclaimed on failure, it stays in arena until destroy()
+    e$ret(list.append(&self->_strings, &rec.key));
+    Exc err = dict.set(&self->_index, &rec);
+    if (err != EOK) {
+        // ids and index must stay in sync, rec.id is the last element
+        if (list.del(&self->_strings, rec.id) != EOK) {
+            uassert(false && "deleting the last element never fails");
+        }
+        return err;
+    }
+
+    if (out_id) {
+        *out_id = rec.id;
+    }
+    return EOK;
+}
+
+/**
+ * @brief Interns a string and returns stable pool-owned view of it
+ *
+ * @param self strintern_c instance
+ * @param s string to intern
+ * @return interned string (null-terminated), or (str_c){.buf = NULL} on error
+ */
+str_c
+strintern_intern(strintern_c* self, str_c s)
+{
+    u32 id = 0;
+    if (strintern.add(self, s, &id)) {
+        return (str_c){ 0 };
+    }
+    return self->_strings.arr[id];
+}
+
+/**
+ * @brief Finds id of already interned string, without interning it
+ *
+ * @param self strintern_c instance
+ * @param s string
+ * @return id or 0 if string is not interned
+ */
+u32
+strintern_find(strintern_c* self, str_c s)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (s.buf == NULL) {
+        return 0;
+    }
+    strintern__item_s* item = dict.gets(&self->_index, s);
+    return (item != NULL) ? item->id : 0;
+}
+
+/**
+ * @brief Returns interned string by id
+ *
+ * @param self strintern_c instance
+ * @param id string id
+ * @return interned string, or (str_c){.buf = NULL} if id is invalid
+ */
+str_c
+strintern_get(strintern_c* self, u32 id)
+{
+    uassert(self != NULL);
+    uassert(self->_allocator != NULL && "not initialized");
+
+    if (id == 0 || id >= self->_strings.len) {
+        return (str_c){ 0 };
+    }
+    return self->_strings.arr[id];
+}
+
+/**
+ * @brief Number of interned strings
+ *
+ * @param self strintern_c instance
+ * @return
+ */
+size_t
+strintern_len(strintern_c* self)
+{
+    uassert(self != NULL);
+    return (self->_strings.len > 0) ? self->_strings.len - 1 : 0;
+}
+
+/**
+ * @brief Frees interning pool and all interned strings
+ *
+ * @param self strintern_c instance
+ */
+void
+strintern_destroy(strintern_c* self)
+{
+    if (self == NULL || self->_allocator == NULL) {
+        return;
+    }
+
+    if (self->_index.hashmap != NULL) {
+        dict.destroy(&self->_index);
+    }
+    if (self->_strings.arr != NULL) {
+        list.destroy(&self->_strings);
+    }
+
+    strintern__chunk_s* chunk = self->_chunks;
+    while (chunk != NULL) {
+        strintern__chunk_s* next = chunk->next;
+        self->_allocator->free(chunk);
+        chunk = next;
+    }
+
+    memset(self, 0, sizeof(*self));
+}
+
+
+const struct __module__strintern strintern = {
+    // Autogenerated by CEX
+    // clang-format off
+    .create = strintern_create,
+    .add = strintern_add,
+    .intern = strintern_intern,
+    .find = strintern_find,
+    .get = strintern_get,
+    .len = strintern_len,
+    .destroy = strintern_destroy,
+    // clang-format on
+};
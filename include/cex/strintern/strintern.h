@@ -0,0 +1,111 @@
+#pragma once
+#include <cex.h>
+
+// Default size of arena chunk for interned string bytes (larger strings get a dedicated chunk)
+#define STRINTERN_CHUNK_SIZE 4096
+
+typedef struct strintern__chunk_s
+{
+    struct strintern__chunk_s* next;
+    size_t len;
+    size_t capacity;
+    char buf[];
+} strintern__chunk_s;
+
+typedef struct
+{
+    str_c key; // view into strintern arena chunk
+    u32 id;
+} strintern__item_s;
+
+/**
+ * @brief String interning pool, maps any str_c to a unique stable str_c (or u32 id)
+ *
+ * Interned strings are null-terminated, and never move or get freed until strintern.destroy(),
+ * so two interned strings are equal only if their .buf pointers (or ids) are equal.
+ */
+typedef struct
+{
+    dict_c _index;                 // str_c key -> strintern__item_s
+    list$define(str_c) _strings;   // id -> str_c, _strings.arr[0] is reserved for invalid id
+    strintern__chunk_s* _chunks;   // head is the current chunk for appending
+    size_t _chunk_size;
+    const Allocator_i* _allocator;
+} strintern_c;
+struct __module__strintern
+{
+    // Autogenerated by CEX
+    // clang-format off
+
+/**
+ * @brief Creates new string interning pool
+ *
+ * @param self strintern_c instance
+ * @param chunk_size arena chunk size for string bytes, 0 - use STRINTERN_CHUNK_SIZE
+ * @param allocator
+ * @return
+ */
+Exception
+(*create)(strintern_c* self, size_t chunk_size, const Allocator_i* allocator);
+
+/**
+ * @brief Interns a string and returns its unique id (ids start from 1)
+ *
+ * @param self strintern_c instance
+ * @param s string to intern (bytes are copied into pool arena, if not interned yet)
+ * @param out_id unique id of interned string (optional, may be NULL)
+ * @return Error.argument on bad string, Error.memory on allocation failure
+ */
+Exception
+(*add)(strintern_c* self, str_c s, u32* out_id);
+
+/**
+ * @brief Interns a string and returns stable pool-owned view of it
+ *
+ * @param self strintern_c instance
+ * @param s string to intern
+ * @return interned string (null-terminated), or (str_c){.buf = NULL} on error
+ */
+str_c
+(*intern)(strintern_c* self, str_c s);
+
+/**
+ * @brief Finds id of already interned string, without interning it
+ *
+ * @param self strintern_c instance
+ * @param s string
+ * @return id or 0 if string is not interned
+ */
+u32
+(*find)(strintern_c* self, str_c s);
+
+/**
+ * @brief Returns interned string by id
+ *
+ * @param self strintern_c instance
+ * @param id string id
+ * @return interned string, or (str_c){.buf = NULL} if id is invalid
+ */
+str_c
+(*get)(strintern_c* self, u32 id);
+
+/**
+ * @brief Number of interned strings
+ *
+ * @param self strintern_c instance
+ * @return
+ */
+size_t
+(*len)(strintern_c* self);
+
+/**
+ * @brief Frees interning pool and all interned strings
+ *
+ * @param self strintern_c instance
+ */
+void
+(*destroy)(strintern_c* self);
+
+    // clang-format on
+};
+extern const struct __module__strintern strintern; // CEX Autogen
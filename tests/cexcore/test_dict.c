@@ -52,10 +52,11 @@ test$case(test_dict_generic_auto_cmp_hash)
     tassert(_dict$hashfunc(typeof(rec), key) == dict.hashfunc.str_hash);
     tassert(_dict$cmpfunc(typeof(rec), key_u64) == dict.hashfunc.u64_cmp);
     tassert(_dict$cmpfunc(typeof(rec), key) == dict.hashfunc.str_cmp);
+    tassert(_dict$hashfunc(typeof(rec), cexstr) == dict.hashfunc.cexstr_hash);
+    tassert(_dict$cmpfunc(typeof(rec), cexstr) == dict.hashfunc.cexstr_cmp);
 
     // NOTE: these are intentionally unsupported (because we store copy of data, and passing
     // but passing pointers may leave them dangling, or use-after-free)
-    // tassert(_dict$hashfunc(typeof(rec), cexstr) == NULL);
     // tassert(_dict$hashfunc(typeof(rec), key_ptr) == NULL);
     return EOK;
 }
@@ -183,9 +184,19 @@ test$case(test_dict_create_generic)
     } rec;
 
     dict_c hm;
-    // WARNING: default dict_c forces keys to be at the beginning of the struct,
-    //  if such key passed -> Error.integrity
-    tassert_eqs(Error.integrity, dict$new(&hm, typeof(rec), another_key, allocator));
+    // NOTE: keys can be at any place of the struct
+    tassert_eqs(EOK, dict$new(&hm, typeof(rec), another_key, allocator));
+    tassert_eqs(dict.set(&hm, &(struct s){ .another_key = 10, .val = 'a' }), EOK);
+    tassert_eqs(dict.set(&hm, &(struct s){ .another_key = 20, .val = 'b' }), EOK);
+    tassert_eqs(dict.set(&hm, &(struct s){ .another_key = 10, .val = 'c' }), EOK);
+    tassert_eqi(dict.len(&hm), 2);
+    const struct s* iresult = dict.geti(&hm, 10);
+    tassert(iresult != NULL);
+    tassert_eqi(iresult->another_key, 10);
+    tassert_eqi(iresult->val, 'c');
+    tassert(dict.deli(&hm, 20) != NULL);
+    tassert(dict.geti(&hm, 20) == NULL);
+    dict.destroy(&hm);
 
     tassert_eqs(EOK, dict$new(&hm, typeof(rec), struct_first_key, allocator));
 
@@ -310,11 +321,270 @@ test$case(test_dict_tolist)
 
     return EOK;
 }
+test$case(test_dict_cexstr_keys)
+{
+    struct s
+    {
+        str_c key;
+        char val;
+    };
+
+    char buf1[] = "abcd";
+    char buf2[] = "abcdef";
+
+    // Same contents but different buffers have the same hash
+    str_c k1 = { .buf = buf1, .len = 4 };
+    str_c k2 = { .buf = buf2, .len = 4 };
+    str_c k3 = { .buf = buf2, .len = 6 };
+    tassert_eql(dict.hashfunc.cexstr_hash(&k1, 1, 2), dict.hashfunc.cexstr_hash(&k2, 1, 2));
+    tassert(dict.hashfunc.cexstr_hash(&k1, 1, 2) != dict.hashfunc.cexstr_hash(&k3, 1, 2));
+    tassert(dict.hashfunc.cexstr_hash(&k1, 1, 2) != dict.hashfunc.cexstr_hash(&k1, 3, 2));
+    // char[] and str_c keys share the same hash family
+    tassert_eql(dict.hashfunc.cexstr_hash(&k1, 1, 2), dict.hashfunc.str_hash("abcd", 1, 2));
+
+    tassert_eqi(dict.hashfunc.cexstr_cmp(&k1, &k2, NULL), 0);
+    tassert(dict.hashfunc.cexstr_cmp(&k1, &k3, NULL) < 0);
+    tassert(dict.hashfunc.cexstr_cmp(&k3, &k1, NULL) > 0);
+
+    dict_c hm;
+    tassert_eqs(
+        EOK,
+        dict.create(
+            &hm,
+            sizeof(struct s),
+            alignof(struct s),
+            0,
+            0,
+            dict.hashfunc.cexstr_hash,
+            dict.hashfunc.cexstr_cmp,
+            allocator,
+            NULL,
+            NULL
+        )
+    );
+
+    tassert_eqs(dict.set(&hm, &(struct s){ .key = k1, .val = 'a' }), EOK);
+    tassert_eqs(dict.set(&hm, &(struct s){ .key = k3, .val = 'b' }), EOK);
+    tassert_eqs(dict.set(&hm, &(struct s){ .key = k2, .val = 'c' }), EOK);
+    tassert_eqi(dict.len(&hm), 2);
+
+    struct s* res = dict.get(&hm, &(str_c){ .buf = "abcd", .len = 4 });
+    tassert(res != NULL);
+    tassert_eqi(res->val, 'c');
+
+    res = dict.get(&hm, &k3);
+    tassert(res != NULL);
+    tassert_eqi(res->val, 'b');
+
+    tassert(dict.get(&hm, &(str_c){ .buf = "abc", .len = 3 }) == NULL);
+    tassert(dict.del(&hm, &k2) != NULL);
+    tassert(dict.get(&hm, &k1) == NULL);
+    tassert_eqi(dict.len(&hm), 1);
+
+    dict.destroy(&hm);
+    return EOK;
+}
+
+test$case(test_dict_cexstr_external_keys)
+{
+    struct s
+    {
+        u64 val;
+        str_c key; // NOTE: not the first field
+    };
+
+    // Keys live in external buffer, only views stored in the dict
+    char contents[] = "foo,bar,baz,foo";
+
+    dict_c hm;
+    tassert_eqs(EOK, dict$new(&hm, struct s, key, allocator));
+
+    for (u32 i = 0; i < 4; i++) {
+        str_c k = { .buf = contents + i * 4, .len = 3 };
+        tassert_eqs(dict.set(&hm, &(struct s){ .key = k, .val = i }), EOK);
+    }
+    tassert_eqi(dict.len(&hm), 3);
+
+    struct s* res = dict.gets(&hm, (str_c){ .buf = "foo", .len = 3 });
+    tassert(res != NULL);
+    tassert_eqi(res->val, 3);
+    tassert(res->key.buf == contents + 12);
+
+    res = dict.gets(&hm, (str_c){ .buf = "bar, not null term", .len = 3 });
+    tassert(res != NULL);
+    tassert_eqi(res->val, 1);
+
+    res = dict.get(&hm, &(str_c){ .buf = "baz", .len = 3 });
+    tassert(res != NULL);
+    tassert_eqi(res->val, 2);
+
+    tassert(dict.gets(&hm, (str_c){ .buf = "fo", .len = 2 }) == NULL);
+    tassert(dict.gets(&hm, (str_c){ .buf = "", .len = 0 }) == NULL);
+
+    u32 nit = 0;
+    for$iter(struct s, it, dict.iter(&hm, &it.iterator))
+    {
+        tassert(dict.gets(&hm, it.val->key) == it.val);
+        nit++;
+    }
+    tassert_eqi(nit, 3);
+
+    tassert(dict.dels(&hm, (str_c){ .buf = "bar", .len = 3 }) != NULL);
+    tassert(dict.dels(&hm, (str_c){ .buf = "bar", .len = 3 }) == NULL);
+    tassert(dict.gets(&hm, (str_c){ .buf = "bar", .len = 3 }) == NULL);
+    tassert_eqi(dict.len(&hm), 2);
+
+    dict.destroy(&hm);
+    return EOK;
+}
+
 /*
  *
  * MAIN (AUTO GENERATED)
  *
  */
+test$case(test_dict_save_load_image)
+{
+    struct s
+    {
+        u64 val;
+        u64 key;
+        char name[16];
+    };
+    const char* img_path = "tests/build/test_dict_image.bin";
+
+    dict_c hm;
+    tassert_eqe(EOK, dict$new(&hm, struct s, key, allocator));
+    for (u64 i = 0; i < 1000; i++) {
+        struct s rec = { .key = i * 7, .val = i };
+        snprintf(rec.name, sizeof(rec.name), "rec_%lu", i);
+        tassert_eqe(EOK, dict.set(&hm, &rec));
+    }
+    tassert_eqe(EOK, dict.save_image(&hm, img_path));
+    tassert_eqe(Error.argument, dict.save_image(&hm, NULL));
+    tassert_eqe(Error.io, dict.save_image(&hm, "tests/build/not_existing_dir/img.bin"));
+    dict.destroy(&hm);
+
+    dict_c img;
+    tassert_eqe(EOK, dict$load_image(&img, struct s, key, img_path, allocator));
+    tassert(img._image != NULL);
+    tassert_eqi(dict.len(&img), 1000);
+
+    char name[16];
+    for (u64 i = 0; i < 1000; i++) {
+        struct s* rec = dict.geti(&img, i * 7);
+        tassert(rec != NULL);
+        tassert_eqi(rec->key, i * 7);
+        tassert_eqi(rec->val, i);
+        snprintf(name, sizeof(name), "rec_%lu", i);
+        tassert_eqs(rec->name, name);
+    }
+    tassert(dict.geti(&img, 1) == NULL);
+
+    u64 nit = 0;
+    for$iter(struct s, it, dict.iter(&img, &it.iterator))
+    {
+        tassert_eqi(it.val->key % 7, 0);
+        nit++;
+    }
+    tassert_eqi(nit, 1000);
+
+    // image is read-only
+    uassert_disable();
+    tassert_eqe(Error.integrity, dict.set(&img, &(struct s){ .key = 1 }));
+    tassert(dict.deli(&img, 7) == NULL);
+    dict.clear(&img);
+    tassert_eqi(dict.len(&img), 1000);
+    tassert(dict.geti(&img, 7) != NULL);
+    dict.destroy(&img);
+    tassert(img._image == NULL);
+    tassert(img.hashmap == NULL);
+
+    // struct mismatch
+    struct s2
+    {
+        u64 key;
+        u64 val;
+        char name[16];
+    };
+    tassert_eqe(Error.argument, dict$load_image(&img, struct s2, key, img_path, allocator));
+    tassert(img.hashmap == NULL);
+    tassert_eqe(Error.not_found, dict$load_image(&img, struct s, key, "tests/build/nofile", allocator));
+    tassert_eqe(
+        Error.integrity,
+        dict$load_image(&img, struct s, key, "tests/data/text_file_50b.txt", allocator)
+    );
+
+    // different hash function
+    tassert_eqe(
+        Error.integrity,
+        dict.load_image(
+            &img,
+            img_path,
+            sizeof(struct s),
+            offsetof(struct s, key),
+            dict.hashfunc.str_hash,
+            dict.hashfunc.str_cmp,
+            allocator
+        )
+    );
+    tassert(img.hashmap == NULL);
+
+    // corrupted buckets beyond the first occupied one
+    FILE* fh = fopen(img_path, "rb");
+    tassert(fh != NULL);
+    static char orig[256 * 1024];
+    static char bad[sizeof(orig)];
+    size_t img_len = fread(orig, 1, sizeof(orig), fh);
+    fclose(fh);
+    tassert(img_len > 0 && img_len < sizeof(orig));
+
+    dict__image_header_s* h = (dict__image_header_s*)bad;
+    const char* bad_path = "tests/build/test_dict_image_bad.bin";
+    for (u32 mode = 0; mode < 3; mode++) {
+        memcpy(bad, orig, img_len);
+        struct bucket* last = NULL;
+        for (u64 i = 0; i < h->nbuckets; i++) {
+            struct bucket* b = bucket_at0(bad + h->header_size, h->bucketsz, i);
+            if (b->dib) {
+                last = b;
+            }
+        }
+        tassert(last != NULL);
+        switch (mode) {
+            case 0:
+                ((struct s*)bucket_item(last))->key += 1; // stored hash mismatch
+                break;
+            case 1:
+                last->dib += 1; // wrong distance from home bucket
+                break;
+            case 2:
+                h->count += 1; // occupied buckets != count
+                break;
+        }
+        fh = fopen(bad_path, "wb");
+        tassert(fh != NULL);
+        tassert_eqi(fwrite(bad, 1, img_len, fh), img_len);
+        fclose(fh);
+        tassert_eqe(Error.integrity, dict$load_image(&img, struct s, key, bad_path, allocator));
+        tassert(img.hashmap == NULL);
+    }
+    tassert_eqe(EOK, dict$load_image(&img, struct s, key, img_path, allocator));
+    dict.destroy(&img);
+
+    // str_c keys are pointers
+    struct s3
+    {
+        str_c key;
+    };
+    tassert_eqe(EOK, dict$new(&hm, struct s3, key, allocator));
+    tassert_eqe(Error.argument, dict.save_image(&hm, img_path));
+    tassert_eqe(Error.argument, dict$load_image(&img, struct s3, key, img_path, allocator));
+    dict.destroy(&hm);
+
+    return EOK;
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -327,6 +597,9 @@ main(int argc, char* argv[])
     test$run(test_dict_create_generic);
     test$run(test_dict_iter);
     test$run(test_dict_tolist);
+    test$run(test_dict_cexstr_keys);
+    test$run(test_dict_cexstr_external_keys);
+    test$run(test_dict_save_load_image);
     
     test$print_footer();  // ^^^^^ all tests runs are above
     return test$exit_code();
@@ -0,0 +1,163 @@
+#include <_cexcore/_stb_sprintf.c>
+#include <_cexcore/cex.c>
+#include <_cexcore/allocators.c>
+#include <_cexcore/dict.c>
+#include <_cexcore/hashset.c>
+#include <_cexcore/list.c>
+#include <_cexcore/str.c>
+#include <_cexcore/cextest.h>
+#include <stdio.h>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+test$case(test_hashset_u64)
+{
+    hashset_c hs;
+    tassert_eqe(EOK, hashset$new(&hs, u64, allocator));
+    tassert_eqi(hashset.len(&hs), 0);
+
+    u64 k = 1;
+    tassert(!hashset.has(&hs, &k));
+    tassert_eqe(EOK, hashset.add(&hs, &k));
+    tassert_eqe(EOK, hashset.add(&hs, &k));
+    tassert_eqi(hashset.len(&hs), 1);
+    tassert(hashset.has(&hs, &k));
+
+    for (u64 i = 0; i < 100; i++) {
+        tassert_eqe(EOK, hashset.add(&hs, &i));
+    }
+    tassert_eqi(hashset.len(&hs), 100);
+
+    u64 nit = 0;
+    u64 sum = 0;
+    for$iter(u64, it, hashset.iter(&hs, &it.iterator))
+    {
+        tassert_eqi(it.idx.i, nit);
+        sum += *it.val;
+        nit++;
+    }
+    tassert_eqi(nit, 100);
+    tassert_eqi(sum, 99 * 100 / 2);
+
+    k = 50;
+    tassert(hashset.del(&hs, &k));
+    tassert(!hashset.del(&hs, &k));
+    tassert(!hashset.has(&hs, &k));
+    tassert_eqi(hashset.len(&hs), 99);
+
+    hashset.clear(&hs);
+    tassert_eqi(hashset.len(&hs), 0);
+    nit = 0;
+    for$iter(u64, it, hashset.iter(&hs, &it.iterator))
+    {
+        nit++;
+    }
+    tassert_eqi(nit, 0);
+
+    hashset.destroy(&hs);
+    tassert(hs.hashmap == NULL);
+    hashset.destroy(&hs);
+    return EOK;
+}
+
+test$case(test_hashset_str_keys)
+{
+    hashset_c hs;
+    tassert_eqe(EOK, hashset$new(&hs, char[8], allocator));
+
+    char key[8] = "foo";
+    tassert_eqe(EOK, hashset.add(&hs, key));
+    tassert_eqe(EOK, hashset.add(&hs, "bar\0\0\0\0"));
+    tassert(hashset.has(&hs, "foo"));
+    tassert(hashset.has(&hs, "bar"));
+    tassert(!hashset.has(&hs, "baz"));
+    hashset.destroy(&hs);
+
+    tassert_eqe(EOK, hashset$new(&hs, str_c, allocator));
+    char buf[] = "foo,bar,foo";
+    str_c k1 = str.sub(s$(buf), 0, 3);
+    str_c k2 = str.sub(s$(buf), 4, 7);
+    str_c k3 = str.sub(s$(buf), 8, 0);
+    tassert_eqe(EOK, hashset.add(&hs, &k1));
+    tassert_eqe(EOK, hashset.add(&hs, &k2));
+    tassert_eqe(EOK, hashset.add(&hs, &k3));
+    tassert_eqi(hashset.len(&hs), 2);
+    str_c foo = s$("foo");
+    str_c bar = s$("bar");
+    str_c fo = s$("fo");
+    tassert(hashset.has(&hs, &foo));
+    tassert(hashset.has(&hs, &bar));
+    tassert(!hashset.has(&hs, &fo));
+    tassert(hashset.del(&hs, &foo));
+    tassert_eqi(hashset.len(&hs), 1);
+
+    for$iter(str_c, it, hashset.iter(&hs, &it.iterator))
+    {
+        tassert_eqi(str.cmp(*it.val, s$("bar")), 0);
+    }
+    hashset.destroy(&hs);
+    return EOK;
+}
+
+test$case(test_hashset_extend)
+{
+    hashset_c hs;
+    tassert_eqe(EOK, hashset$new(&hs, u64, allocator));
+
+    list$define(u64) keys;
+    tassert_eqe(EOK, list$new(&keys, 16, allocator));
+
+    // empty list is ok
+    tassert_eqe(EOK, hashset.extend(&hs, &keys));
+    tassert_eqi(hashset.len(&hs), 0);
+
+    for (u64 i = 0; i < 1000; i++) {
+        u64 k = i % 500;
+        tassert_eqe(EOK, list.append(&keys, &k));
+    }
+    tassert_eqe(EOK, hashset.extend(&hs, &keys));
+    tassert_eqi(hashset.len(&hs), 500);
+    for (u64 i = 0; i < 500; i++) {
+        tassert(hashset.has(&hs, &i));
+    }
+    tassert_eqe(Error.argument, hashset.extend(&hs, NULL));
+
+    list$define(u32) bad_keys;
+    tassert_eqe(EOK, list$new(&bad_keys, 16, allocator));
+    u32 bk = 1;
+    tassert_eqe(EOK, list.append(&bad_keys, &bk));
+    uassert_disable();
+    tassert_eqe(Error.argument, hashset.extend(&hs, &bad_keys));
+
+    list.destroy(&bad_keys);
+    list.destroy(&keys);
+    hashset.destroy(&hs);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_hashset_u64);
+    test$run(test_hashset_str_keys);
+    test$run(test_hashset_extend);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -4,8 +4,13 @@
 #include <_cexcore/cextest.h>
 #include <_cexcore/io.c>
 #include <_cexcore/io.h>
+#include <_cexcore/sbuf.c>
 #include <_cexcore/str.c>
+#include <dirent.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 const Allocator_i* allocator;
 /*
@@ -458,6 +463,33 @@ test$case(test_fprintf_to_file)
     return EOK;
 }
 
+test$case(test_fprintf_fmt_to_file)
+{
+    io_c file = { 0 };
+    tassert_eqs(Error.ok, io.fopen(&file, "tests/build/text_file_fprintf_fmt.txt", "w+", allocator));
+
+    sbuf_fmt_s fmt;
+    tassert_eqs(EOK, sbuf.fmt_compile(&fmt, "\"%s\": \"%S\", %d\n"));
+
+    char buf[4] = { "1234" };
+    str_c s1 = str.cbuf(buf, 4);
+    for (u32 i = 0; i < 3; i++) {
+        tassert_eqs(EOK, io.fprintf_fmt(&file, &fmt, "key", s1, i));
+    }
+
+    str_c content;
+    io.rewind(&file);
+
+    tassert_eqs(EOK, io.readall(&file, &content));
+    tassert_eqi(
+        0,
+        str.cmp(content, s$("\"key\": \"1234\", 0\n\"key\": \"1234\", 1\n\"key\": \"1234\", 2\n"))
+    );
+
+    io.close(&file);
+    return EOK;
+}
+
 test$case(test_write)
 {
     io_c file = { 0 };
@@ -475,6 +507,274 @@ test$case(test_write)
     io.close(&file);
     return EOK;
 }
+test$case(test_writev)
+{
+    io_c file = { 0 };
+    tassert_eqs(Error.ok, io.fopen(&file, "tests/build/text_file_writev.txt", "w+", allocator));
+
+    str_c small[] = { s$("12"), s$(""), s$("34") };
+    size_t written = 0;
+    tassert_eqs(EOK, io.writev(&file, small, arr$len(small), &written));
+    tassert_eqi(written, 4);
+    tassert_eqs(EOK, io.writev(&file, small, 0, NULL));
+
+    char big[IO_WRITEV_MIN_SIZE * 2];
+    memset(big, 'x', sizeof(big));
+    str_c parts[200];
+    for (u32 i = 0; i < arr$len(parts); i++) {
+        // big payload: 200 parts (more than one iovec batch), bypassing stdio buffer
+        parts[i] = (i % 2 == 0) ? str.cbuf(big, sizeof(big)) : s$("|");
+    }
+    tassert_eqs(EOK, io.writev(&file, parts, arr$len(parts), &written));
+    tassert_eqi(written, 100 * (sizeof(big) + 1));
+    tassert_eqs(EOK, io.fprintf(&file, "%s", "end"));
+
+    str_c content;
+    io.rewind(&file);
+    tassert_eqs(EOK, io.readall(&file, &content));
+    tassert_eqi(content.len, 4 + 100 * (sizeof(big) + 1) + 3);
+    tassert(memcmp(content.buf, "1234xxx", 7) == 0);
+    tassert(content.buf[4 + sizeof(big)] == '|');
+    tassert(memcmp(content.buf + content.len - 4, "|end", 4) == 0);
+
+    str_c bad[] = { s$("12"), { .buf = NULL, .len = 2 } };
+    tassert_eqs(Error.argument, io.writev(&file, bad, arr$len(bad), NULL));
+    tassert_eqs(Error.argument, io.writev(&file, NULL, 1, NULL));
+
+    io.close(&file);
+    return EOK;
+}
+
+test$case(test_writev_pipe_partial)
+{
+    // pipe buffer is smaller than payload, writev() returns partial writes until reader drains it
+    int fds[2];
+    tassert_eqi(0, pipe(fds));
+
+    static char big[1024 * 1024];
+    for (u32 i = 0; i < sizeof(big); i++) {
+        big[i] = 'a' + i % 26;
+    }
+
+    pid_t pid = fork();
+    tassert(pid >= 0);
+    if (pid == 0) {
+        close(fds[1]);
+        static char rbuf[sizeof(big)];
+        size_t total = 0;
+        ssize_t n;
+        while ((n = read(fds[0], rbuf + total, sizeof(rbuf) - total)) > 0) {
+            total += n;
+        }
+        _exit((total == sizeof(big) && memcmp(rbuf, big, sizeof(big)) == 0) ? 0 : 1);
+    }
+    close(fds[0]);
+
+    io_c file = { 0 };
+    FILE* fh = fdopen(fds[1], "w");
+    tassert(fh != NULL);
+    tassert_eqs(EOK, io.fattach(&file, fh, allocator));
+
+    str_c parts[] = {
+        str.cbuf(big, 1000),
+        str.cbuf(big + 1000, sizeof(big) / 2 - 1000),
+        str.cbuf(big + sizeof(big) / 2, sizeof(big) / 2),
+    };
+    size_t written = 0;
+    tassert_eqs(EOK, io.writev(&file, parts, arr$len(parts), &written));
+    tassert_eqi(written, sizeof(big));
+    io.close(&file);
+    fclose(fh);
+
+    int status = 0;
+    tassert_eqi(pid, waitpid(pid, &status, 0));
+    tassert(WIFEXITED(status));
+    tassert_eqi(WEXITSTATUS(status), 0);
+    return EOK;
+}
+test$case(test_writev_partial_failure)
+{
+    // non-blocking pipe without reader: the first writev() fills pipe buffer, the next one fails
+    int fds[2];
+    tassert_eqi(0, pipe(fds));
+    tassert(fcntl(fds[1], F_SETFL, O_NONBLOCK) == 0);
+
+    static char big[1024 * 1024];
+    memset(big, 'x', sizeof(big));
+
+    io_c file = { 0 };
+    FILE* fh = fdopen(fds[1], "w");
+    tassert(fh != NULL);
+    tassert_eqs(EOK, io.fattach(&file, fh, allocator));
+
+    str_c parts[] = {
+        str.cbuf(big, sizeof(big) / 2),
+        str.cbuf(big + sizeof(big) / 2, sizeof(big) / 2),
+    };
+    size_t written = 0;
+    tassert_eqs(Error.io, io.writev(&file, parts, arr$len(parts), &written));
+    tassert(written > 0);
+    tassert(written < sizeof(big));
+
+    // exactly written bytes are in the pipe
+    tassert(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+    size_t total = 0;
+    ssize_t n;
+    while ((n = read(fds[0], big, sizeof(big))) > 0) {
+        total += n;
+    }
+    tassert_eqi(total, written);
+
+    io.close(&file);
+    fclose(fh);
+    close(fds[0]);
+    return EOK;
+}
+
+static u32
+count_atomic_tmp(const char* dir, const char* prefix)
+{
+    u32 n = 0;
+    DIR* d = opendir(dir);
+    if (d == NULL) {
+        return 0;
+    }
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        if (strncmp(e->d_name, prefix, strlen(prefix)) == 0) {
+            n++;
+        }
+    }
+    closedir(d);
+    return n;
+}
+
+test$case(test_fopen_atomic)
+{
+    const char* target = "tests/build/test_io_atomic.txt";
+    io_c file = { 0 };
+    tassert_eqs(Error.ok, io.fopen(&file, target, "w", allocator));
+    tassert_eqs(EOK, io.fprintf(&file, "%s", "old"));
+    io.close(&file);
+    tassert_eqi(0, chmod(target, 0600));
+
+    // target is untouched until commit
+    tassert_eqs(Error.ok, io.fopen_atomic(&file, target, 0, allocator));
+    tassert_eqs(EOK, io.fprintf(&file, "%s", "new content"));
+    tassert_eqi(1, count_atomic_tmp("tests/build", ".test_io_atomic.txt."));
+
+    io_c check = { 0 };
+    str_c content;
+    tassert_eqs(Error.ok, io.fopen(&check, target, "r", allocator));
+    tassert_eqs(EOK, io.readall(&check, &content));
+    tassert_eqi(0, strcmp(content.buf, "old"));
+    io.close(&check);
+
+    tassert_eqs(EOK, io.commit(&file));
+    tassert(file._fh == NULL);
+    tassert_eqi(0, count_atomic_tmp("tests/build", ".test_io_atomic.txt."));
+
+    tassert_eqs(Error.ok, io.fopen(&check, target, "r", allocator));
+    tassert_eqs(EOK, io.readall(&check, &content));
+    tassert_eqi(0, strcmp(content.buf, "new content"));
+    io.close(&check);
+
+    // replaced file keeps its permissions
+    struct stat st;
+    tassert_eqi(0, stat(target, &st));
+    tassert_eqi(st.st_mode & 07777, 0600);
+
+    // close without commit discards temp file
+    tassert_eqs(Error.ok, io.fopen_atomic(&file, target, IO_ATOMIC_SYNC, allocator));
+    tassert_eqs(EOK, io.fprintf(&file, "%s", "discarded"));
+    io.close(&file);
+    tassert_eqi(0, count_atomic_tmp("tests/build", ".test_io_atomic.txt."));
+
+    tassert_eqs(Error.ok, io.fopen(&check, target, "r", allocator));
+    tassert_eqs(EOK, io.readall(&check, &content));
+    tassert_eqi(0, strcmp(content.buf, "new content"));
+    io.close(&check);
+
+    // new file, all flags
+    unlink("tests/build/test_io_atomic_new.txt");
+    tassert_eqs(
+        Error.ok,
+        io.fopen_atomic(
+            &file,
+            "tests/build/test_io_atomic_new.txt",
+            IO_ATOMIC_SYNC | IO_ATOMIC_DONTNEED,
+            allocator
+        )
+    );
+    tassert_eqs(EOK, io.fprintf(&file, "%s", "synced"));
+    tassert_eqs(EOK, io.commit(&file));
+    tassert_eqs(Error.ok, io.fopen(&check, "tests/build/test_io_atomic_new.txt", "r", allocator));
+    tassert_eqs(EOK, io.readall(&check, &content));
+    tassert_eqi(0, strcmp(content.buf, "synced"));
+    io.close(&check);
+
+    return EOK;
+}
+
+test$case(test_fopen_atomic_dontneed_chunks)
+{
+    io_c file = { 0 };
+    tassert_eqs(
+        EOK,
+        io.fopen_atomic(&file, "tests/build/test_io_atomic_big.bin", IO_ATOMIC_DONTNEED, allocator)
+    );
+
+    static char buf[64 * 1024];
+    memset(buf, 'x', sizeof(buf));
+    size_t total = 0;
+    while (total < IO_ATOMIC_DONTNEED_CHUNK) {
+        tassert_eqs(EOK, io.write(&file, buf, 1, sizeof(buf)));
+        total += sizeof(buf);
+    }
+    // pages are dropped while writing, not only on commit
+    tassert_eqi(file._dontneed_off, total);
+
+    str_c parts[] = { (str_c){ .buf = buf, .len = sizeof(buf) }, s$("tail") };
+    while (total < 2 * IO_ATOMIC_DONTNEED_CHUNK) {
+        tassert_eqs(EOK, io.writev(&file, parts, arr$len(parts), NULL));
+        total += sizeof(buf) + 4;
+    }
+    tassert_eqi(file._dontneed_off, total);
+    tassert_eqs(EOK, io.fprintf(&file, "%s", "end"));
+    tassert_eqi(file._dontneed_off, total);
+    total += 3;
+
+    tassert_eqs(EOK, io.commit(&file));
+
+    io_c check = { 0 };
+    tassert_eqs(Error.ok, io.fopen(&check, "tests/build/test_io_atomic_big.bin", "r", allocator));
+    tassert_eqi(io.size(&check), total);
+    io.close(&check);
+
+    return EOK;
+}
+
+test$case(test_fopen_atomic_errors)
+{
+    io_c file = { 0 };
+    tassert_eqs(Error.argument, io.fopen_atomic(&file, "tests/build/", 0, allocator));
+    tassert_eqs(
+        Error.not_found,
+        io.fopen_atomic(&file, "tests/build/not_exists/file.txt", 0, allocator)
+    );
+    tassert(file._fh == NULL);
+
+    uassert_disable();
+    tassert_eqs(Error.argument, io.fopen_atomic(&file, "", 0, allocator));
+    tassert_eqs(Error.argument, io.fopen_atomic(&file, NULL, 0, allocator));
+
+    // commit is only for io.fopen_atomic() files
+    tassert_eqs(Error.ok, io.fopen(&file, "tests/build/test_io_atomic.txt", "r", allocator));
+    tassert_eqs(Error.argument, io.commit(&file));
+    tassert(file._fh != NULL);
+    io.close(&file);
+    return EOK;
+}
 /*
  *
  * MAIN (AUTO GENERATED)
@@ -503,7 +803,14 @@ main(int argc, char* argv[])
     test$run(test_read_not_all);
     test$run(test_fprintf);
     test$run(test_fprintf_to_file);
+    test$run(test_fprintf_fmt_to_file);
     test$run(test_write);
+    test$run(test_writev);
+    test$run(test_writev_pipe_partial);
+    test$run(test_writev_partial_failure);
+    test$run(test_fopen_atomic);
+    test$run(test_fopen_atomic_dontneed_chunks);
+    test$run(test_fopen_atomic_errors);
     
     test$print_footer();  // ^^^^^ all tests runs are above
     return test$exit_code();
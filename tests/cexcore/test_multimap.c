@@ -0,0 +1,192 @@
+#include <_cexcore/_stb_sprintf.c>
+#include <_cexcore/cex.c>
+#include <_cexcore/allocators.c>
+#include <_cexcore/dict.c>
+#include <_cexcore/multimap.c>
+#include <_cexcore/list.c>
+#include <_cexcore/str.c>
+#include <_cexcore/cextest.h>
+#include <stdio.h>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+struct mm_rec
+{
+    u64 val;
+    u64 key;
+};
+
+test$case(test_multimap_add_get)
+{
+    multimap_c mm;
+    tassert_eqe(EOK, multimap$new(&mm, struct mm_rec, key, allocator));
+    tassert_eqi(multimap.len(&mm), 0);
+
+    u64 key = 1;
+    tassert(multimap.get(&mm, &key) == NULL);
+    tassert_eqi(multimap.count(&mm, &key), 0);
+
+    tassert_eqe(EOK, multimap.add(&mm, &(struct mm_rec){ .key = 1, .val = 10 }));
+    tassert_eqe(EOK, multimap.add(&mm, &(struct mm_rec){ .key = 2, .val = 20 }));
+    tassert_eqe(EOK, multimap.add(&mm, &(struct mm_rec){ .key = 1, .val = 11 }));
+    tassert_eqe(EOK, multimap.add(&mm, &(struct mm_rec){ .key = 1, .val = 12 }));
+    tassert_eqi(multimap.len(&mm), 4);
+
+    struct mm_rec* r = multimap.get(&mm, &key);
+    tassert(r != NULL);
+    tassert_eqi(r->key, 1);
+    tassert_eqi(multimap.count(&mm, &key), 3);
+
+    u64 nit = 0;
+    u64 sum = 0;
+    for$iter(struct mm_rec, it, multimap.iter_key(&mm, &key, &it.iterator))
+    {
+        tassert_eqi(it.idx.i, nit);
+        tassert_eqi(it.val->key, 1);
+        sum += it.val->val;
+        nit++;
+    }
+    tassert_eqi(nit, 3);
+    tassert_eqi(sum, 10 + 11 + 12);
+
+    key = 3;
+    nit = 0;
+    for$iter(struct mm_rec, it, multimap.iter_key(&mm, &key, &it.iterator))
+    {
+        nit++;
+    }
+    tassert_eqi(nit, 0);
+
+    nit = 0;
+    for$iter(struct mm_rec, it, multimap.iter(&mm, &it.iterator))
+    {
+        nit++;
+    }
+    tassert_eqi(nit, 4);
+
+    key = 1;
+    tassert_eqi(multimap.del(&mm, &key), 3);
+    tassert_eqi(multimap.del(&mm, &key), 0);
+    tassert_eqi(multimap.len(&mm), 1);
+    key = 2;
+    tassert_eqi(multimap.count(&mm, &key), 1);
+
+    multimap.clear(&mm);
+    tassert_eqi(multimap.len(&mm), 0);
+    tassert_eqi(multimap.count(&mm, &key), 0);
+
+    multimap.destroy(&mm);
+    tassert(mm.hashmap == NULL);
+    multimap.destroy(&mm);
+    return EOK;
+}
+
+test$case(test_multimap_str_keys)
+{
+    struct tag_rec
+    {
+        u32 line;
+        str_c tag;
+    };
+    multimap_c mm;
+    tassert_eqe(EOK, multimap$new(&mm, struct tag_rec, tag, allocator));
+
+    char contents[] = "foo,bar,foo,baz,foo";
+    u32 line = 0;
+    for$iter(str_c, it, str.iter_split(s$(contents), ",", &it.iterator))
+    {
+        tassert_eqe(EOK, multimap.add(&mm, &(struct tag_rec){ .line = line++, .tag = *it.val }));
+    }
+    tassert_eqi(multimap.len(&mm), 5);
+
+    str_c key = s$("foo");
+    tassert_eqi(multimap.count(&mm, &key), 3);
+    u32 lines_sum = 0;
+    for$iter(struct tag_rec, it, multimap.iter_key(&mm, &key, &it.iterator))
+    {
+        tassert_eqi(str.cmp(it.val->tag, s$("foo")), 0);
+        lines_sum += it.val->line;
+    }
+    tassert_eqi(lines_sum, 0 + 2 + 4);
+
+    key = s$("baz");
+    tassert_eqi(multimap.count(&mm, &key), 1);
+    key = s$("fo");
+    tassert_eqi(multimap.count(&mm, &key), 0);
+
+    multimap.destroy(&mm);
+    return EOK;
+}
+
+test$case(test_multimap_many_duplicates)
+{
+    multimap_c mm;
+    tassert_eqe(EOK, multimap$new(&mm, struct mm_rec, key, allocator));
+
+    list$define(struct mm_rec) items;
+    tassert_eqe(EOK, list$new(&items, 16, allocator));
+
+    // key k has (k % 7 + 1) duplicates
+    u64 nkeys = 1000;
+    u64 total = 0;
+    for (u64 k = 0; k < nkeys; k++) {
+        for (u64 d = 0; d < k % 7 + 1; d++) {
+            struct mm_rec r = { .key = k, .val = d };
+            if (k % 2 == 0) {
+                tassert_eqe(EOK, multimap.add(&mm, &r));
+            } else {
+                tassert_eqe(EOK, list.append(&items, &r));
+            }
+            total++;
+        }
+    }
+    tassert_eqe(EOK, multimap.extend(&mm, &items));
+    tassert_eqi(multimap.len(&mm), total);
+
+    // NOTE: iter_key stops at the first non-equal bucket, so this also validates that duplicates
+    // are stored contiguously after multiple resizes
+    for (u64 k = 0; k < nkeys; k++) {
+        tassert_eqi(multimap.count(&mm, &k), k % 7 + 1);
+    }
+
+    // deletion with backshift must keep remaining keys contiguous
+    for (u64 k = 0; k < nkeys; k += 3) {
+        tassert_eqi(multimap.del(&mm, &k), k % 7 + 1);
+        total -= k % 7 + 1;
+    }
+    tassert_eqi(multimap.len(&mm), total);
+    for (u64 k = 0; k < nkeys; k++) {
+        tassert_eqi(multimap.count(&mm, &k), (k % 3 == 0) ? 0 : k % 7 + 1);
+    }
+
+    list.destroy(&items);
+    multimap.destroy(&mm);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_multimap_add_get);
+    test$run(test_multimap_str_keys);
+    test$run(test_multimap_many_duplicates);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -124,18 +124,18 @@ test$case(test_sbuf_append_char_grow)
     sbuf_c s;
 
     tassert_eqs(EOK, sbuf.create(&s, 5, allocator));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     // wipe all nullterm
     memset(s, 0xff, sbuf.capacity(&s));
 
     tassert_eqe(append_to_cap(&s), EOK);
 
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
     tassert_eqi(sbuf.len(&s), sbuf.capacity(&s));
 
     tassert_eqs(EOK, sbuf.append(&s, s$("B")));
-    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 128 - sizeof(sbuf_head_s) - 1);
 
     // check null term
     tassert_eqi(s[sbuf.len(&s)], 0);
@@ -152,17 +152,17 @@ test$case(test_sbuf_append_str_grow)
     sbuf_c s;
 
     tassert_eqs(EOK, sbuf.create(&s, 5, allocator));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     // wipe all nullterm
     memset(s, 0xff, sbuf.capacity(&s));
 
     tassert_eqe(append_to_cap(&s), EOK);
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
     tassert_eqi(sbuf.len(&s), sbuf.capacity(&s));
 
     tassert_eqs(EOK, sbuf.append(&s, str.cstr("B")));
-    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 128 - sizeof(sbuf_head_s) - 1);
 
     // check null term
     tassert_eqi(s[sbuf.len(&s)], 0);
@@ -275,18 +275,18 @@ test$case(test_sbuf_replace_resize)
     sbuf_c s;
 
     tassert_eqs(EOK, sbuf.create(&s, 5, allocator));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     // wipe all nullterm
     memset(s, 0xff, sbuf.capacity(&s));
 
     tassert_eqe(append_to_cap(&s), EOK);
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
     tassert_eqi(sbuf.len(&s), sbuf.capacity(&s));
 
     size_t prev_len = sbuf.len(&s);
     tassert_eqs(EOK, sbuf.replace(&s, str.cstr("A"), str.cstr("AB")));
-    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 128 - sizeof(sbuf_head_s) - 1);
     tassert_eqi(sbuf.len(&s), prev_len+1);
 
 
@@ -299,7 +299,7 @@ test$case(test_sbuf_replace_error_checks)
     sbuf_c s;
 
     tassert_eqs(EOK, sbuf.create(&s, 5, allocator));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     // wipe all nullterm
     memset(s, 0xff, sbuf.capacity(&s));
@@ -320,12 +320,120 @@ test$case(test_sbuf_replace_error_checks)
     return EOK;
 }
 
+test$case(test_sbuf_replace_many_tokens)
+{
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create(&s, 16, allocator));
+
+    for (u32 i = 0; i < 1000; i++) {
+        tassert_eqs(EOK, sbuf.append(&s, s$("ab-")));
+    }
+    tassert_eqi(sbuf.len(&s), 3000);
+
+    tassert_eqs(EOK, sbuf.replace(&s, s$("-"), s$("<->")));
+    tassert_eqi(sbuf.len(&s), 5000);
+    tassert(memcmp(s, "ab<->ab<->", 10) == 0);
+    tassert(memcmp(s + 4990, "ab<->ab<->", 10) == 0);
+    tassert_eqi(s[sbuf.len(&s)], 0);
+
+    tassert_eqs(EOK, sbuf.replace(&s, s$("<->"), s$("")));
+    tassert_eqi(sbuf.len(&s), 2000);
+    tassert(memcmp(s, "ababab", 6) == 0);
+    tassert_eqi(s[sbuf.len(&s)], 0);
+
+    // non-overlapping, left to right, replacement is not rescanned
+    sbuf.clear(&s);
+    tassert_eqs(EOK, sbuf.append(&s, s$("aaaaa")));
+    tassert_eqs(EOK, sbuf.replace(&s, s$("aa"), s$("a")));
+    tassert_eqs(s, "aaa");
+    tassert_eqs(EOK, sbuf.replace(&s, s$("a"), s$("aa")));
+    tassert_eqs(s, "aaaaaa");
+    tassert_eqs(EOK, sbuf.replace(&s, s$("x"), s$("yyy")));
+    tassert_eqs(s, "aaaaaa");
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_sbuf_replace_static_overflow_intact)
+{
+    sbuf_c s;
+    char buf[64];
+
+    tassert_eqs(EOK, sbuf.create_static(&s, buf, arr$len(buf)));
+    tassert_eqs(EOK, sbuf.append(&s, s$("a,b,c,d")));
+    tassert_eqs(Error.overflow, sbuf.replace(&s, s$(","), s$("__________,")));
+    // buffer is not modified on failure
+    tassert_eqs(s, "a,b,c,d");
+    tassert_eqi(sbuf.len(&s), 7);
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_sbuf_replace_many)
+{
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create(&s, 16, allocator));
+
+    str_c html[] = {
+        s$("&"), s$("&amp;"),
+        s$("<"), s$("&lt;"),
+        s$(">"), s$("&gt;"),
+        s$("\""), s$(""),
+    };
+    tassert_eqs(EOK, sbuf.append(&s, s$("<a href=\"x\">1 & 2</a>")));
+    tassert_eqs(EOK, sbuf.replace_many(&s, html, arr$len(html)));
+    tassert_eqs(s, "&lt;a href=x&gt;1 &amp; 2&lt;/a&gt;");
+    tassert_eqi(sbuf.len(&s), strlen(s));
+
+    // mixed grow and shrink: prefix grows before the tail shrinks
+    str_c mixed[] = {
+        s$("a"), s$("AAAA"),
+        s$("bbbbbbbb"), s$("B"),
+    };
+    sbuf.clear(&s);
+    tassert_eqs(EOK, sbuf.append(&s, s$("aaabbbbbbbbbbbbbbbbaaa")));
+    tassert_eqs(EOK, sbuf.replace_many(&s, mixed, arr$len(mixed)));
+    tassert_eqs(s, "AAAAAAAAAAAABBAAAAAAAAAAAA");
+
+    // first pattern in the list wins at the same position
+    str_c prio[] = {
+        s$("ab"), s$("1"),
+        s$("abc"), s$("2"),
+        s$("c"), s$("3"),
+    };
+    sbuf.clear(&s);
+    tassert_eqs(EOK, sbuf.append(&s, s$("abcabc")));
+    tassert_eqs(EOK, sbuf.replace_many(&s, prio, arr$len(prio)));
+    tassert_eqs(s, "1313");
+
+    // replacements are not rescanned (no swap chains)
+    str_c swap[] = {
+        s$("x"), s$("y"),
+        s$("y"), s$("x"),
+    };
+    sbuf.clear(&s);
+    tassert_eqs(EOK, sbuf.append(&s, s$("xxyy")));
+    tassert_eqs(EOK, sbuf.replace_many(&s, swap, arr$len(swap)));
+    tassert_eqs(s, "yyxx");
+
+    tassert_eqs(Error.argument, sbuf.replace_many(&s, swap, 3));
+    tassert_eqs(Error.argument, sbuf.replace_many(&s, swap, 0));
+    str_c bad[] = { s$(""), s$("x") };
+    tassert_eqs(Error.argument, sbuf.replace_many(&s, bad, arr$len(bad)));
+    tassert_eqs(s, "yyxx");
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
 test$case(test_sbuf_sprintf)
 {
     sbuf_c s;
 
     tassert_eqs(EOK, sbuf.create(&s, 5, allocator));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     // wipe all nullterm
     memset(s, 0xff, sbuf.capacity(&s)+1);
@@ -337,30 +445,30 @@ test$case(test_sbuf_sprintf)
     tassert_eqi(sbuf.len(&s), 3);
     tassert_eqi(s[sbuf.len(&s)], '\0');
     tassert_eqi(s[sbuf.capacity(&s)], '\0');
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     tassert_eqs(EOK, sbuf.sprintf(&s, "%s", "456"));
     tassert_eqs("123456", s);
     tassert_eqi(sbuf.len(&s), 6);
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     tassert_eqs(EOK, sbuf.sprintf(&s, "%s", "7890A"));
     tassert_eqs("1234567890A", s);
     tassert_eqi(sbuf.len(&s), 11);
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     sbuf.clear(&s);
     size_t prev_cap = sbuf.capacity(&s);
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
     tassert_eqe(EOK, append_to_cap(&s));
     tassert_eqs(EOK, sbuf.sprintf(&s, "%s", "B"));
     tassert_eqi(sbuf.len(&s), prev_cap+1);
     tassert_eqi(s[prev_cap], 'B');
-    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 128 - sizeof(sbuf_head_s) - 1);
 
     tassert_eqs(EOK, sbuf.sprintf(&s, "%s", "CDE"));
     tassert_eqi(sbuf.len(&s), prev_cap + 4);
-    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 128 - sizeof(sbuf_head_s) - 1);
     tassert_eqi(s[sbuf.len(&s)], '\0');
     tassert_eqi(s[sbuf.capacity(&s)], '\0');
 
@@ -373,7 +481,7 @@ test$case(test_sbuf_sprintf_long_growth)
     sbuf_c s;
 
     tassert_eqs(EOK, sbuf.create(&s, 5, allocator));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     char buf[16];
     char svbuf[16];
@@ -444,10 +552,10 @@ test$case(test_sbuf_sprintf_long_growth_prebuild_buffer)
 test$case(test_sbuf_sprintf_static)
 {
     sbuf_c s;
-    char buf[32];
+    char buf[64];
 
     tassert_eqs(EOK, sbuf.create_static(&s, buf, arr$len(buf)));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     // wipe all nullterm
     memset(s, 0xff, sbuf.capacity(&s)+1);
@@ -460,23 +568,23 @@ test$case(test_sbuf_sprintf_static)
     tassert_eqi(sbuf.len(&s), 3);
     tassert_eqi(s[sbuf.len(&s)], '\0');
     tassert_eqi(s[sbuf.capacity(&s)], '\0');
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     tassert_eqs(EOK, sbuf.sprintf(&s, "%s", "456"));
     tassert_eqs("123456", s);
     tassert_eqi(sbuf.len(&s), 6);
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
 
     tassert_eqe(EOK, sprintf_to_cap(&s));
     tassert_eqi(s[sbuf.len(&s)], '\0');
     tassert_eqi(s[sbuf.capacity(&s)], '\0');
     tassert_eqi(sbuf.len(&s), sbuf.capacity(&s));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
     tassert_eqs(Error.overflow, sbuf.sprintf(&s, "%s", "7"));
     tassert_eqi(sbuf.len(&s), sbuf.capacity(&s));
-    tassert_eqi(sbuf.capacity(&s), 32 - sizeof(sbuf_head_s) - 1);
+    tassert_eqi(sbuf.capacity(&s), 64 - sizeof(sbuf_head_s) - 1);
 
 
     sbuf.destroy(&s);
@@ -637,6 +745,286 @@ test$case(test_sbuf__is_valid__len_gt_cap)
 
 }
 
+test$case(test_sbuf_append_numbers)
+{
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create(&s, 4, allocator));
+
+    tassert_eqs(EOK, sbuf.append_i64(&s, 0));
+    tassert_eqs(EOK, sbuf.append(&s, s$(",")));
+    tassert_eqs(EOK, sbuf.append_i64(&s, INT64_MIN));
+    tassert_eqs(EOK, sbuf.append(&s, s$(",")));
+    tassert_eqs(EOK, sbuf.append_i64(&s, INT64_MAX));
+    tassert_eqs(EOK, sbuf.append(&s, s$(",")));
+    tassert_eqs(EOK, sbuf.append_u64(&s, UINT64_MAX));
+    tassert_eqs(s, "0,-9223372036854775808,9223372036854775807,18446744073709551615");
+
+    sbuf.clear(&s);
+    f64 values[] = { 0.1, -0.0, 100, 1e21, 123.456, 0.1 + 0.2, 5e-300, 1e-5, 1.5e300 };
+    for (u32 i = 0; i < arr$len(values); i++) {
+        if (i > 0) {
+            tassert_eqs(EOK, sbuf.append(&s, s$(" ")));
+        }
+        tassert_eqs(EOK, sbuf.append_f64(&s, values[i]));
+    }
+    tassert_eqs(s, "0.1 -0 100 1e+21 123.456 0.30000000000000004 5e-300 1e-05 1.5e+300");
+
+    for$iter(str_c, it, sbuf.iter_split(&s, " ", &it.iterator))
+    {
+        f64 v = 0;
+        tassert_eqs(EOK, str.to_f64(*it.val, &v));
+        tassert(memcmp(&v, &values[it.idx.i], sizeof(v)) == 0);
+    }
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_sbuf_reserve)
+{
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create(&s, 4, allocator));
+    tassert_eqs(EOK, sbuf.append(&s, s$("hello")));
+
+    tassert_eqs(EOK, sbuf.reserve(&s, 1000));
+    tassert_eqi(sbuf.capacity(&s), 1005);
+    tassert_eqs(s, "hello");
+
+    // enough room, no realloc
+    char* prev = s;
+    tassert_eqs(EOK, sbuf.reserve(&s, 500));
+    tassert(prev == s);
+    for (u32 i = 0; i < 100; i++) {
+        tassert_eqs(EOK, sbuf.append(&s, s$("0123456789")));
+    }
+    tassert(prev == s);
+    tassert_eqi(sbuf.len(&s), 1005);
+    tassert_eqi(s[sbuf.len(&s)], 0);
+
+    // growth policy after reserve is geometric
+    tassert_eqs(EOK, sbuf.append(&s, s$("!")));
+    tassert_eqi(sbuf.capacity(&s), (1005 + sizeof(sbuf_head_s) + 1) * 2 - sizeof(sbuf_head_s) - 1);
+
+    tassert_eqs(Error.overflow, sbuf.reserve(&s, SIZE_MAX));
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+static bool fail_alloc = false;
+
+static void*
+failing_realloc(void* ptr, size_t new_size)
+{
+    return fail_alloc ? NULL : allocator->realloc(ptr, new_size);
+}
+
+test$case(test_sbuf_grow_failure_intact)
+{
+    Allocator_i failing = *allocator;
+    failing.realloc = failing_realloc;
+
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 4, &failing));
+    tassert_eqe(EOK, sbuf.append(&s, s$("hello")));
+    char* prev = s;
+    u32 cap = sbuf.capacity(&s);
+
+    fail_alloc = true;
+    tassert_eqe(Error.memory, sbuf.reserve(&s, 1000));
+    tassert_eqe(Error.memory, sbuf.append(&s, s$(" some long string beyond capacity")));
+    tassert_eqe(Error.memory, sbuf.sprintf(&s, " %s", "some long string beyond capacity"));
+    fail_alloc = false;
+
+    // old buffer is still owned by sbuf and unchanged
+    tassert(s == prev);
+    tassert_eqs(s, "hello");
+    tassert_eqi(sbuf.len(&s), 5);
+    tassert_eqi(sbuf.capacity(&s), cap);
+    tassert(sbuf.isvalid(&s));
+
+    tassert_eqe(EOK, sbuf.append(&s, s$(" world")));
+    tassert_eqs(s, "hello world");
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_sbuf_replace_failure_intact)
+{
+    Allocator_i failing = *allocator;
+    failing.realloc = failing_realloc;
+
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 4, &failing));
+    tassert_eqe(EOK, sbuf.append(&s, s$("a-b-a-b-a")));
+    char* prev = s;
+    u32 cap = sbuf.capacity(&s);
+
+    fail_alloc = true;
+    tassert_eqe(Error.memory, sbuf.replace(&s, s$("a"), s$("long replacement")));
+    str_c pairs[] = { s$("a"), s$("long replacement"), s$("-"), s$("") };
+    tassert_eqe(Error.memory, sbuf.replace_many(&s, pairs, arr$len(pairs)));
+    fail_alloc = false;
+
+    // nothing replaced or shifted
+    tassert(s == prev);
+    tassert_eqs(s, "a-b-a-b-a");
+    tassert_eqi(sbuf.len(&s), 9);
+    tassert_eqi(sbuf.capacity(&s), cap);
+    tassert(sbuf.isvalid(&s));
+
+    tassert_eqe(EOK, sbuf.replace(&s, s$("a"), s$("long replacement")));
+    tassert_eqs(s, "long replacement-b-long replacement-b-long replacement");
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_sbuf_grow_mremap)
+{
+#if SBUF__HAS_MREMAP
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create_mmap(&s, 4));
+    sbuf_head_s* head = sbuf__head(s);
+    tassert(head->allocator == &sbuf__mmap_allocator);
+    tassert_eqi((sbuf.capacity(&s) + sizeof(sbuf_head_s) + 1) % sysconf(_SC_PAGESIZE), 0);
+    tassert_eqs(EOK, sbuf.append(&s, s$("hello")));
+
+    tassert_eqs(EOK, sbuf.reserve(&s, 64 * 1024 * 1024));
+    head = sbuf__head(s);
+    tassert(head->allocator == &sbuf__mmap_allocator);
+    tassert(sbuf.capacity(&s) >= 64 * 1024 * 1024 + 5);
+    tassert_eqi((sbuf.capacity(&s) + sizeof(sbuf_head_s) + 1) % sysconf(_SC_PAGESIZE), 0);
+    tassert_eqs(s, "hello");
+
+    // writes at the end of the mapping
+    u32 cap = sbuf.capacity(&s);
+    memset(s + 6, 'x', cap - 6);
+    sbuf.update_len(&s);
+    tassert_eqi(sbuf.len(&s), 5);
+
+    tassert_eqs(EOK, sbuf.grow(&s, cap * 2));
+    tassert(sbuf.capacity(&s) >= cap * 2);
+    tassert_eqs(s, "hello");
+    tassert_eqi(s[5], 0);
+    tassert_eqi(s[6], 'x');
+    tassert_eqi(s[cap - 1], 'x');
+    tassert_eqi(s[sbuf.capacity(&s)], 0);
+
+    tassert_eqs(EOK, sbuf.sprintf(&s, " %s", "world"));
+    tassert_eqs(s, "hello world");
+
+    sbuf.destroy(&s);
+#endif
+    return EOK;
+}
+
+test$case(test_sbuf_large_4gb)
+{
+#if SBUF__HAS_MREMAP
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create_mmap(&s, 4));
+    size_t big_len = (size_t)UINT32_MAX + 100;
+
+    // NOTE: anonymous mapping is lazy, untouched pages don't consume memory
+    Exc err = sbuf.reserve(&s, big_len + 4096);
+    if (err == Error.memory) {
+        // not enough address space / overcommit disabled, buffer is still valid
+        sbuf.destroy(&s);
+    return EOK;
+    }
+    tassert_eqs(EOK, err);
+    tassert(sbuf.capacity(&s) >= big_len + 4096);
+
+    // tokens crossing and beyond the 4 GiB offset
+    size_t boundary = (size_t)UINT32_MAX + 1;
+    memcpy(&s[boundary - 3], "world", 5);
+    s[boundary + 10] = ',';
+
+    sbuf_head_s* head = sbuf__head(s);
+    head->length = big_len;
+
+    tassert_eqs(EOK, sbuf.append(&s, s$("hello")));
+    tassert_eqs(EOK, sbuf.sprintf(&s, " %s %d", "world", 4));
+    tassert_eqi(sbuf.len(&s), big_len + 13);
+    tassert(memcmp(&s[big_len], "hello world 4", 14) == 0);
+
+    str_c tail = str.sub(sbuf.to_str(&s), -13, 0);
+    tassert_eqi(str.cmp(tail, s$("hello world 4")), 0);
+
+    // same length replacement, nothing is shifted, only matches are rewritten
+    tassert_eqs(EOK, sbuf.replace(&s, s$("world"), s$("WORLD")));
+    tassert_eqi(sbuf.len(&s), big_len + 13);
+    tassert(memcmp(&s[boundary - 3], "WORLD", 5) == 0);
+    tassert(memcmp(&s[big_len], "hello WORLD 4", 14) == 0);
+
+    u32 nit = 0;
+    for$iter(str_c, it, str.iter_split(sbuf.to_str(&s), ",", &it.iterator))
+    {
+        switch (nit) {
+            case 0:
+                tassert(it.val->buf == s);
+                tassert_eqi(it.val->len, boundary + 10);
+                break;
+            case 1:
+                tassert(it.val->buf == &s[boundary + 11]);
+                tassert_eqi(it.val->len, big_len + 13 - boundary - 11);
+                tassert_eqi(str.cmp(str.sub(*it.val, -13, 0), s$("hello WORLD 4")), 0);
+                break;
+            default:
+                tassert(false && "unexpected token");
+        }
+        nit++;
+    }
+    tassert_eqi(nit, 2);
+
+    sbuf.destroy(&s);
+#endif
+    return EOK;
+}
+
+test$case(test_sbuf_sprintf_fmt)
+{
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create(&s, 4, allocator));
+
+    sbuf_fmt_s fmt;
+    tassert_eqs(EOK, sbuf.fmt_compile(&fmt, "\"%s\": \"%S\", "));
+    tassert_eqi(fmt.nops, 3);
+
+    sbuf_c expected;
+    tassert_eqs(EOK, sbuf.create(&expected, 4, allocator));
+
+    str_c value = s$("some value");
+    for (u32 i = 0; i < 1000; i++) {
+        tassert_eqs(EOK, sbuf.sprintf_fmt(&s, &fmt, "key", value));
+        tassert_eqs(EOK, sbuf.sprintf(&expected, "\"%s\": \"%S\", ", "key", value));
+    }
+    tassert_eqi(sbuf.len(&s), sbuf.len(&expected));
+    tassert_eqs(s, expected);
+
+    // no conversions at all, and too many conversions
+    tassert_eqs(EOK, sbuf.fmt_compile(&fmt, ""));
+    tassert_eqi(fmt.nops, 1);
+    sbuf.clear(&s);
+    tassert_eqs(EOK, sbuf.sprintf_fmt(&s, &fmt));
+    tassert_eqs(s, "");
+    tassert_eqs(Error.overflow, sbuf.fmt_compile(&fmt, "%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d"));
+
+    // SBUF_FMT_MAXOPS conversions fit, trailing literal text is not counted
+    tassert_eqs(EOK, sbuf.fmt_compile(&fmt, "%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d end"));
+    tassert_eqi(fmt.nops, SBUF_FMT_MAXOPS + 1);
+    sbuf.clear(&s);
+    tassert_eqs(EOK, sbuf.sprintf_fmt(&s, &fmt, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6));
+    tassert_eqs(s, "1234567890123456 end");
+    tassert_eqs(Error.argument, sbuf.fmt_compile(&fmt, NULL));
+
+    sbuf.destroy(&s);
+    sbuf.destroy(&expected);
+    return EOK;
+}
+
 test$case(test_sbuf__is_valid__zero_cap)
 {
     sbuf_c s;
@@ -708,6 +1096,9 @@ int main(int argc, char *argv[])
     test$run(test_sbuf_replace);
     test$run(test_sbuf_replace_resize);
     test$run(test_sbuf_replace_error_checks);
+    test$run(test_sbuf_replace_many_tokens);
+    test$run(test_sbuf_replace_static_overflow_intact);
+    test$run(test_sbuf_replace_many);
     test$run(test_sbuf_sprintf);
     test$run(test_sbuf_sprintf_long_growth);
     test$run(test_sbuf_sprintf_long_growth_prebuild_buffer);
@@ -715,6 +1106,13 @@ int main(int argc, char *argv[])
     test$run(test_iter_split);
     test$run(test_sbuf__is_valid__no_null_term);
     test$run(test_sbuf__is_valid__len_gt_cap);
+    test$run(test_sbuf_append_numbers);
+    test$run(test_sbuf_reserve);
+    test$run(test_sbuf_grow_failure_intact);
+    test$run(test_sbuf_replace_failure_intact);
+    test$run(test_sbuf_grow_mremap);
+    test$run(test_sbuf_large_4gb);
+    test$run(test_sbuf_sprintf_fmt);
     test$run(test_sbuf__is_valid__zero_cap);
     test$run(test_sbuf__is_valid__bad_magic);
     test$run(test_sbuf__is_valid__null_pointer);
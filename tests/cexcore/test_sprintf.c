@@ -5,6 +5,8 @@
 #include <_cexcore/sbuf.h>
 #include <_cexcore/str.c>
 #include <_cexcore/cextest.h>
+#include <float.h>
+#include <math.h>
 
 #define USE_STB 1
 
@@ -261,6 +263,244 @@ test$case(stb_sprintf_orig)
     return EOK;
 }
 
+static u64
+test__rand_u64(u64* state)
+{
+    // xorshift64
+    u64 x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+test$case(stb_sprintf_integers_vs_libc)
+{
+    char buf[64];
+    char expected[64];
+    u64 rnd = 0x9E3779B97F4A7C15ULL;
+
+    u64 cases[] = { 0, 1, 9, 10, 99, 100, 99999999, 100000000, 4294967295ULL, 4294967296ULL,
+                    999999999999999999ULL, 1000000000000000000ULL, INT64_MAX, UINT64_MAX };
+    for (u32 i = 0; i < arr$len(cases); i++) {
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long)cases[i]);
+        stbsp_snprintf(buf, sizeof(buf), "%llu", (unsigned long long)cases[i]);
+        tassert_eqs(buf, expected);
+    }
+    snprintf(expected, sizeof(expected), "%lld", (long long)INT64_MIN);
+    stbsp_snprintf(buf, sizeof(buf), "%lld", (long long)INT64_MIN);
+    tassert_eqs(buf, expected);
+
+    for (u32 i = 0; i < 100000; i++) {
+        u64 v = test__rand_u64(&rnd) >> (i % 64);
+        snprintf(expected, sizeof(expected), "%llu|%lld|%d", (unsigned long long)v, (long long)v, (i32)v);
+        stbsp_snprintf(buf, sizeof(buf), "%llu|%lld|%d", (unsigned long long)v, (long long)v, (i32)v);
+        tassert_eqs(buf, expected);
+
+        tassert_eqi(stbsp_u64toa(buf, v), strlen(buf));
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long)v);
+        tassert_eqs(buf, expected);
+    }
+    return EOK;
+}
+
+test$case(stb_sprintf_g_shortest_vs_libc)
+{
+    char buf[64];
+    char expected[64];
+    char src[64];
+    u64 rnd = 0x2545F4914F6CDD1DULL;
+    stbsp_set_separators(',', '.'); // NOTE: stb_sprintf_orig changes them
+
+    CHECK2("0.1", "%g", 0.1);
+    CHECK2("1e+100", "%g", 1e100);
+    CHECK2("4.94066e-324", "%g", 5e-324);
+    CHECK2("0.3", "%.15g", 0.1 + 0.2);
+    CHECK2("123456", "%g", 123456.0);
+    CHECK2("1.23457e+06", "%g", 1234567.0);
+    CHECK3("-inf nan", "%g %g", -INFINITY, NAN);
+
+    for (u32 i = 0; i < 100000; i++) {
+        // short decimals, i.e. values which take %g shortest digits path
+        u32 ndigits = 1 + test__rand_u64(&rnd) % 15;
+        u64 pow10 = 1;
+        for (u32 j = 0; j < ndigits; j++) {
+            pow10 *= 10;
+        }
+        u64 mantissa = test__rand_u64(&rnd) % pow10;
+        i32 exp = (i32)(test__rand_u64(&rnd) % 600) - 300;
+        snprintf(src, sizeof(src), "%llue%d", (unsigned long long)mantissa, exp);
+        double v = strtod(src, NULL);
+        if (isinf(v) || (v != 0 && fabs(v) < DBL_MIN)) {
+            continue; // out of shortest %g path range
+        }
+        if (i % 2) {
+            v = -v;
+        }
+        u32 prec = ndigits + test__rand_u64(&rnd) % (16 - ndigits);
+
+        snprintf(expected, sizeof(expected), "%.*g", prec, v);
+        stbsp_snprintf(buf, sizeof(buf), "%.*g", prec, v);
+        tassertf(strcmp(buf, expected) == 0, "src: %s prec: %d, %s != %s", src, prec, buf, expected);
+    }
+
+    return EOK;
+}
+
+test$case(stb_dtoa_shortest_roundtrip)
+{
+    char buf[64];
+    char expected[64];
+    u64 rnd = 0xDEADBEEFCAFEBABEULL;
+
+    tassert_eqi(stbsp_dtoa(buf, 0.0), 1);
+    tassert_eqs(buf, "0");
+    tassert_eqi(stbsp_dtoa(buf, -0.0), 2);
+    tassert_eqs(buf, "-0");
+    stbsp_dtoa(buf, 5e-324);
+    tassert_eqs(buf, "5e-324");
+    stbsp_dtoa(buf, 1.7976931348623157e308);
+    tassert_eqs(buf, "1.7976931348623157e+308");
+    stbsp_dtoa(buf, 0.1 + 0.2);
+    tassert_eqs(buf, "0.30000000000000004");
+    stbsp_dtoa(buf, 9007199254740992.0);
+    tassert_eqs(buf, "9007199254740992");
+    stbsp_dtoa(buf, 1e17);
+    tassert_eqs(buf, "1e+17");
+    stbsp_dtoa(buf, 0.0001);
+    tassert_eqs(buf, "0.0001");
+    stbsp_dtoa(buf, 0.00001234);
+    tassert_eqs(buf, "1.234e-05");
+    stbsp_dtoa(buf, 123.456);
+    tassert_eqs(buf, "123.456");
+    stbsp_dtoa(buf, -INFINITY);
+    tassert_eqs(buf, "-inf");
+
+    for (u32 i = 0; i < 200000; i++) {
+        u64 bits;
+        if (i < 2000) {
+            bits = i + 1; // denormals
+        } else if (i < 4000) {
+            bits = (u64)(i - 2000) << 52; // powers of 2, irregular spacing
+        } else {
+            bits = test__rand_u64(&rnd);
+        }
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        if (isnan(v) || isinf(v)) {
+            continue;
+        }
+
+        int len = stbsp_dtoa(buf, v);
+        tassert_eqi(len, strlen(buf));
+        double back = strtod(buf, NULL);
+        tassertf(memcmp(&back, &v, sizeof(v)) == 0, "roundtrip failed: %s", buf);
+
+        // the shortest correctly rounded representation which round-trips
+        int prec = 1;
+        for (; prec < 17; prec++) {
+            snprintf(expected, sizeof(expected), "%.*e", prec - 1, v);
+            if (strtod(expected, NULL) == v) {
+                break;
+            }
+        }
+        snprintf(expected, sizeof(expected), "%.*e", prec - 1, v);
+
+        // compare significant digits only
+        char d1[32] = { 0 };
+        char d2[32] = { 0 };
+        u32 n1 = 0, n2 = 0;
+        for (char* c = buf; *c && *c != 'e'; c++) {
+            if (*c >= '0' && *c <= '9' && (n1 > 0 || *c != '0')) {
+                d1[n1++] = *c;
+            }
+        }
+        for (char* c = expected; *c && *c != 'e'; c++) {
+            if (*c >= '0' && *c <= '9' && (n2 > 0 || *c != '0')) {
+                d2[n2++] = *c;
+            }
+        }
+        while (n1 > 1 && d1[n1 - 1] == '0') {
+            d1[--n1] = '\0';
+        }
+        while (n2 > 1 && d2[n2 - 1] == '0') {
+            d2[--n2] = '\0';
+        }
+        if (bits & ((1ULL << 52) - 1)) {
+            tassertf(strcmp(d1, d2) == 0, "value %s expected %s", buf, expected);
+        } else {
+            // power of 2: rounding interval is asymmetric, the closest may be not the shortest
+            tassertf(n1 <= n2, "value %s expected %s", buf, expected);
+        }
+    }
+    return EOK;
+}
+
+static int
+test__sprintf_fmt(char* buf, const sbuf_fmt_s* fmt, ...)
+{
+    va_list va;
+    va_start(va, fmt);
+    int result = stbsp_vsprintfcb_fmt(NULL, NULL, buf, fmt, va);
+    va_end(va);
+    return result;
+}
+
+static int
+test__sprintf_plain(char* buf, const char* format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    int result = stbsp_vsprintf(buf, format, va);
+    va_end(va);
+    return result;
+}
+
+test$case(stb_sprintf_compiled_format)
+{
+    char buf[STB_SPRINTF_MIN * 4];
+    char expected[STB_SPRINTF_MIN * 4];
+    sbuf_fmt_s fmt;
+    stbsp_set_separators(',', '.');
+
+#define CHECK_FMT(format, ...)                                                                     \
+    {                                                                                              \
+        tassert(stbsp_compile(&fmt, format) > 0);                                                  \
+        int ret = test__sprintf_fmt(buf, &fmt, __VA_ARGS__);                                       \
+        int ret2 = test__sprintf_plain(expected, format, __VA_ARGS__);                             \
+        tassertf(strcmp(buf, expected) == 0, "format: %s", format);                                \
+        tassert_eqi(ret, ret2);                                                                    \
+    }
+
+    CHECK_FMT("%d", 1);
+    CHECK_FMT("a b %s     %d tail", "b", -100006789);
+    CHECK_FMT("%-8.3s|%+2d|% 3i|%-4d|%10.5d", "abcdefgh", 5, 6, -7, 3);
+    CHECK_FMT("%u %04u %o %x %X %#x", 20u, 20u, 10u, 30u, 60u, 30u);
+    CHECK_FMT("%hi %ld %llu %zu %%", (short)33, 555l, 9888777666llu, (size_t)77);
+    CHECK_FMT("%*d|%-*.*f|%.*s", 8, 12, 10, 3, 3.14159, 2, "xyz");
+    CHECK_FMT("%f %.10f %e %g %.3g", -3.0, -8.88888888, 1e100, 0.1, 1234567.0);
+    CHECK_FMT("%c%c %p", 'a', 'b', (void*)buf);
+    CHECK_FMT("\"%s\": \"%S\", ", "key", s$("str_c value"));
+    CHECK_FMT("%'d %'.2f", 1200000, 12345.678);
+
+    // literal longer than callback buffer
+    char long_fmt[STB_SPRINTF_MIN * 2 + 8];
+    memset(long_fmt, 'x', sizeof(long_fmt));
+    memcpy(long_fmt + STB_SPRINTF_MIN, "%d", 2);
+    long_fmt[sizeof(long_fmt) - 1] = '\0';
+    tassert(stbsp_compile(&fmt, long_fmt) > 0);
+    sbuf_c s;
+    tassert_eqs(EOK, sbuf.create(&s, 4, allocator));
+    tassert_eqs(EOK, sbuf.sprintf_fmt(&s, &fmt, 12345));
+    test__sprintf_plain(expected, long_fmt, 12345);
+    tassert(strcmp(s, expected) == 0);
+    sbuf.destroy(&s);
+
+#undef CHECK_FMT
+    return EOK;
+}
+
 /*
  *
  * MAIN (AUTO GENERATED)
@@ -274,6 +514,10 @@ main(int argc, char* argv[])
     
     test$run(stb_sprintf_str);
     test$run(stb_sprintf_orig);
+    test$run(stb_sprintf_integers_vs_libc);
+    test$run(stb_sprintf_g_shortest_vs_libc);
+    test$run(stb_dtoa_shortest_roundtrip);
+    test$run(stb_sprintf_compiled_format);
     
     test$print_footer();  // ^^^^^ all tests runs are above
     return test$exit_code();
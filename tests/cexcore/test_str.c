@@ -1646,6 +1646,279 @@ test$case(test_str_to_f64)
     return EOK;
 }
 
+static u64
+test__rand_u64(u64* state)
+{
+    // xorshift64*, deterministic corpus for reproducibility
+    u64 x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+static u32
+test__rand_decimal(u64* state, char* buf, u32 buf_len)
+{
+    u32 n = 0;
+    if (test__rand_u64(state) % 2) {
+        buf[n++] = '-';
+    }
+    u32 ndigits = 1 + test__rand_u64(state) % 25;
+    u32 dot = test__rand_u64(state) % (ndigits + 1);
+    for (u32 i = 0; i < ndigits; i++) {
+        if (i == dot) {
+            buf[n++] = '.';
+        }
+        buf[n++] = '0' + test__rand_u64(state) % 10;
+    }
+    int exp = (int)(test__rand_u64(state) % 600) - 300;
+    n += snprintf(buf + n, buf_len - n, "e%d", exp);
+    return n;
+}
+
+test$case(test_str_to_f64_random_corpus)
+{
+    char buf[128];
+    u64 state = 0x1234567;
+    f64 num = 0;
+
+    for (u32 i = 0; i < 200000; i++) {
+        u32 len = 0;
+        if (i % 2 == 0) {
+            len = test__rand_decimal(&state, buf, sizeof(buf));
+        } else {
+            // random bit patterns printed with random precision
+            u64 bits = test__rand_u64(&state);
+            f64 v;
+            memcpy(&v, &bits, sizeof(v));
+            if (!isfinite(v)) {
+                continue;
+            }
+            len = snprintf(buf, sizeof(buf), "%.*g", (int)(1 + test__rand_u64(&state) % 25), v);
+        }
+        f64 expected = strtod(buf, NULL);
+        Exc r = str__to_double(str.cbuf(buf, len), &num, -400, 400);
+        if (isinf(expected)) {
+            tassert_eqe(Error.overflow, r);
+            continue;
+        }
+        if (r != EOK || memcmp(&num, &expected, sizeof(num)) != 0) {
+            tassertf(false, "mismatch %s: %a != %a (%s)", buf, num, expected, r);
+        }
+    }
+    return EOK;
+}
+
+test$case(test_str_to_f32_random_corpus)
+{
+    char buf[128];
+    u64 state = 0x7654321;
+    f32 num = 0;
+
+    for (u32 i = 0; i < 200000; i++) {
+        u32 len = 0;
+        if (i % 2 == 0) {
+            len = test__rand_decimal(&state, buf, sizeof(buf));
+        } else {
+            u32 bits = (u32)test__rand_u64(&state);
+            f32 v;
+            memcpy(&v, &bits, sizeof(v));
+            if (!isfinite(v)) {
+                continue;
+            }
+            len = snprintf(buf, sizeof(buf), "%.*g", (int)(1 + test__rand_u64(&state) % 15), v);
+        }
+        f32 expected = strtof(buf, NULL);
+        Exc r = str__to_float(str.cbuf(buf, len), &num, -400, 400);
+        if (isinf(expected)) {
+            tassert_eqe(Error.overflow, r);
+            continue;
+        }
+        if (r != EOK || memcmp(&num, &expected, sizeof(num)) != 0) {
+            tassertf(false, "mismatch %s: %a != %a (%s)", buf, num, expected, r);
+        }
+    }
+    return EOK;
+}
+
+test$case(test_str_to_f64_hard_cases)
+{
+    const char* cases[] = {
+        "2.2250738585072011e-308",
+        "2.2250738585072012e-308",
+        "2.2250738585072014e-308",
+        "4.9406564584124654e-324",
+        "2.4703282292062327e-324",
+        "2.4703282292062328e-324",
+        "1.7976931348623157e308",
+        "1.7976931348623158e308",
+        "9007199254740993",
+        "9007199254740993.0000000000000000001",
+        "9007199254740992.9999999999999999999",
+        "9007199254740995",
+        "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124",
+        "1.00000000000000011102230246251565404236316680908203126",
+        "7.038531e-26",
+        "0.1",
+        "0.3",
+        "123456789012345678901234567890",
+        "0.000000000000000000000000000000000000000000000000000000000000000000000000000001",
+        "3.14159265358979323846264338327950288419716939937510582097494459",
+        "1e23",
+        "8.98846567431158e307",
+    };
+    f64 num = 0;
+    for (u32 i = 0; i < arr$len(cases); i++) {
+        f64 expected = strtod(cases[i], NULL);
+        tassert_eqe(EOK, str__to_double(str.cstr(cases[i]), &num, -400, 400));
+        if (memcmp(&num, &expected, sizeof(num)) != 0) {
+            tassertf(false, "mismatch %s: %a != %a", cases[i], num, expected);
+        }
+    }
+    tassert_eqe(Error.overflow, str__to_double(s$("1.7976931348623159e308"), &num, -400, 400));
+    tassert_eqe(Error.overflow, str__to_double(s$("-1.7976931348623159e308"), &num, -400, 400));
+    tassert_eqe(EOK, str__to_double(s$("1e-400"), &num, -400, 400));
+    tassert_eqf(num, 0.0);
+
+    // exponent must have digits
+    tassert_eqe(Error.argument, str__to_double(s$("1e-"), &num, -400, 400));
+    tassert_eqe(Error.argument, str__to_double(s$("1e+"), &num, -400, 400));
+    tassert_eqe(Error.argument, str__to_double(s$("1e+ "), &num, -400, 400));
+    tassert_eqe(Error.argument, str__to_double(s$("1.2.3"), &num, -400, 400));
+
+#if LDBL_MANT_DIG >= 64
+    // Exact halfway points between adjacent doubles (up to 767 significant digits), these hit
+    // the big number fallback, because 19 digits are not enough to decide the rounding
+    char buf[1024];
+    u64 state = 0xabcdef;
+    for (u32 i = 0; i < 2000; i++) {
+        u64 bits = test__rand_u64(&state) & ~(UINT64_C(1) << 63);
+        f64 v, v_next;
+        memcpy(&v, &bits, sizeof(v));
+        bits++;
+        memcpy(&v_next, &bits, sizeof(v_next));
+        if (!isfinite(v) || !isfinite(v_next)) {
+            continue;
+        }
+        long double halfway = ((long double)v + (long double)v_next) / 2;
+        int len = snprintf(buf, sizeof(buf) - 2, "%.800Le", halfway);
+        tassert(len > 0 && len < (int)sizeof(buf) - 2);
+
+        // exact tie, above tie (extra digit in mantissa before exponent)
+        for (u32 j = 0; j < 2; j++) {
+            char* e = strchr(buf, 'e');
+            if (j == 1) {
+                memmove(e + 1, e, strlen(e) + 1);
+                *e = '1';
+            }
+            f64 expected = strtod(buf, NULL);
+            Exc r = str__to_double(str.cstr(buf), &num, -2000, 2000);
+            if (isinf(expected)) {
+                tassert_eqe(Error.overflow, r);
+                continue;
+            }
+            if (r != EOK || memcmp(&num, &expected, sizeof(num)) != 0) {
+                tassertf(false, "mismatch %.60s...: %a != %a (%s)", buf, num, expected, r);
+            }
+        }
+    }
+#endif
+    return EOK;
+}
+
+test$case(test_str_to_i64_u64_swar)
+{
+    char buf[64];
+    u64 state = 0x5eed;
+    i64 inum = 0;
+    u64 unum = 0;
+
+    for (u32 i = 0; i < 100000; i++) {
+        u64 v = test__rand_u64(&state) >> (test__rand_u64(&state) % 64);
+        u32 nzeros = test__rand_u64(&state) % 12;
+        int len = snprintf(buf, sizeof(buf), "%0*lu", (int)(nzeros + 1), v);
+        tassert_eqe(EOK, str.to_u64(str.cbuf(buf, len), &unum));
+        tassert_eql(unum, v);
+
+        len = snprintf(buf, sizeof(buf), "  %s%0*lu  ", (i % 2) ? "-" : "+", (int)nzeros + 1, v);
+        errno = 0;
+        i64 expected = strtoll(buf, NULL, 10);
+        Exc r = str.to_i64(str.cbuf(buf, len), &inum);
+        if (errno == ERANGE || expected == INT64_MIN) {
+            tassert_eqe(Error.overflow, r);
+        } else {
+            tassert_eqe(EOK, r);
+            tassert_eql(inum, expected);
+        }
+    }
+
+    tassert_eqe(EOK, str.to_i64(s$("9223372036854775807"), &inum));
+    tassert_eql(inum, INT64_MAX);
+    tassert_eqe(EOK, str.to_i64(s$("-9223372036854775807"), &inum));
+    tassert_eql(inum, -INT64_MAX);
+    tassert_eqe(Error.overflow, str.to_i64(s$("9223372036854775808"), &inum));
+    tassert_eqe(Error.overflow, str.to_i64(s$("99999999999999999999"), &inum));
+    tassert_eqe(EOK, str.to_i64(s$("0000000000000000000000000000000000000001"), &inum));
+    tassert_eql(inum, 1);
+    tassert_eqe(EOK, str.to_u64(s$("18446744073709551615"), &unum));
+    tassert(unum == UINT64_MAX);
+    tassert_eqe(Error.overflow, str.to_u64(s$("18446744073709551616"), &unum));
+
+    // non digit chars inside of 8 byte chunk
+    tassert_eqe(Error.argument, str.to_i64(s$("1234567a90"), &inum));
+    tassert_eqe(Error.argument, str.to_i64(s$("12345678/0"), &inum));
+    tassert_eqe(Error.argument, str.to_i64(s$("12345678:0"), &inum));
+    tassert_eqe(Error.argument, str.to_u64(s$("1234 5678"), &unum));
+    tassert_eqe(EOK, str.to_u64(s$("12345678 "), &unum));
+    tassert_eql(unum, 12345678);
+
+    i32 i32num = 0;
+    tassert_eqe(EOK, str.to_i32(s$("00000000002147483647"), &i32num));
+    tassert_eqi(i32num, INT32_MAX);
+    tassert_eqe(Error.overflow, str.to_i32(s$("00000000002147483648"), &i32num));
+    u32 u32num = 0;
+    tassert_eqe(EOK, str.to_u32(s$("4294967295"), &u32num));
+    tassert(u32num == UINT32_MAX);
+    tassert_eqe(Error.overflow, str.to_u32(s$("4294967296"), &u32num));
+    return EOK;
+}
+
+test$case(test_str_to_batch)
+{
+    str_c items[] = { s$("1"), s$("-2"), s$("  300000000000 "), s$("0x10") };
+    i64 inums[arr$len(items)] = { 0 };
+    size_t err_idx = 100;
+    tassert_eqe(EOK, str.to_i64_batch(items, arr$len(items), inums, &err_idx));
+    tassert_eqi(err_idx, 100);
+    tassert_eql(inums[0], 1);
+    tassert_eql(inums[1], -2);
+    tassert_eql(inums[2], 300000000000);
+    tassert_eql(inums[3], 16);
+
+    u64 unums[arr$len(items)] = { 0 };
+    tassert_eqe(Error.argument, str.to_u64_batch(items, arr$len(items), unums, &err_idx));
+    tassert_eqi(err_idx, 1);
+    tassert_eql(unums[0], 1);
+    tassert_eqe(Error.argument, str.to_u64_batch(items, arr$len(items), unums, NULL));
+    tassert_eqe(EOK, str.to_u64_batch(items, 1, unums, NULL));
+    tassert_eqe(EOK, str.to_u64_batch(items, 0, unums, NULL));
+    tassert_eqe(Error.argument, str.to_u64_batch(NULL, 0, unums, NULL));
+    tassert_eqe(Error.argument, str.to_u64_batch(items, 0, NULL, NULL));
+
+    str_c fitems[] = { s$("1.5"), s$("-2e3"), s$("nan"), s$("1e309"), s$("2") };
+    f64 fnums[arr$len(fitems)] = { 0 };
+    tassert_eqe(Error.overflow, str.to_f64_batch(fitems, arr$len(fitems), fnums, &err_idx));
+    tassert_eqi(err_idx, 3);
+    tassert_eqf(fnums[0], 1.5);
+    tassert_eqf(fnums[1], -2000);
+    tassert(isnan(fnums[2]));
+    tassert_eqe(EOK, str.to_f64_batch(fitems, 3, fnums, &err_idx));
+    return EOK;
+}
+
 test$case(test_str_sprintf)
 {
     char buffer[10] = {0};
@@ -1737,6 +2010,11 @@ main(int argc, char* argv[])
     test$run(str_to__double);
     test$run(test_str_to_f32);
     test$run(test_str_to_f64);
+    test$run(test_str_to_f64_random_corpus);
+    test$run(test_str_to_f32_random_corpus);
+    test$run(test_str_to_f64_hard_cases);
+    test$run(test_str_to_i64_u64_swar);
+    test$run(test_str_to_batch);
     test$run(test_str_sprintf);
     
     test$print_footer();  // ^^^^^ all tests runs are above
@@ -0,0 +1,248 @@
+#include <cex.c>
+#include <cex/aio/aio.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+static Exception
+aio_write_read_files(u32 flags, u32 queue_size)
+{
+    aio_c a;
+    tassert_eqe(EOK, aio.create(&a, queue_size, flags, allocator));
+    if (flags & AIO_FLAG_NO_URING) {
+        tassert_eqi(aio.backend(&a), AIO_BACKEND_THREADS);
+    }
+
+    enum { NFILES = 20, NCHUNKS = 10, CHUNK = 4096 };
+    static char wbuf[NFILES][NCHUNKS * CHUNK];
+    static char rbuf[NFILES][NCHUNKS * CHUNK];
+    static char tbuf[NFILES][100];
+    static aio_op_s ops[NFILES][NCHUNKS];
+    int fds[NFILES];
+
+    for (u32 f = 0; f < NFILES; f++) {
+        char path[64];
+        str.sprintf(path, sizeof(path), "tests/build/test_aio_%02d.bin", f);
+        tassert_eqe(EOK, aio.open(&a, path, O_RDWR | O_CREAT | O_TRUNC, 0644, &fds[f]));
+
+        for (u32 i = 0; i < sizeof(wbuf[f]); i++) {
+            wbuf[f][i] = (char)(f * 31 + i * 7);
+        }
+        // chunks are queued in reverse order, offsets make file contents sequential
+        for (u32 c = NCHUNKS; c-- > 0;) {
+            ops[f][c].user = &fds[f];
+            tassert_eqe(
+                EOK,
+                aio.write(&a, &ops[f][c], fds[f], &wbuf[f][c * CHUNK], CHUNK, c * CHUNK)
+            );
+        }
+    }
+    tassert_eqi(aio.pending(&a), NFILES * NCHUNKS);
+
+    u32 ncompleted = 0;
+    aio_op_s* op;
+    while ((op = aio.wait(&a)) != NULL) {
+        tassert_eqe(EOK, op->error);
+        tassert_eqi(op->nbytes, CHUNK);
+        tassert(op->user != NULL);
+        ncompleted++;
+    }
+    tassert_eqi(ncompleted, NFILES * NCHUNKS);
+    tassert_eqi(aio.pending(&a), 0);
+    tassert(aio.poll(&a) == NULL);
+    tassert(aio.wait(&a) == NULL);
+
+    for (u32 f = 0; f < NFILES; f++) {
+        memset(rbuf[f], 0, sizeof(rbuf[f]));
+        // the whole file + beyond EOF (completion order is not defined, so separate buffers)
+        tassert_eqe(EOK, aio.read(&a, &ops[f][0], fds[f], rbuf[f], sizeof(rbuf[f]), 0));
+        tassert_eqe(EOK, aio.read(&a, &ops[f][1], fds[f], tbuf[f], 100, sizeof(rbuf[f]) - 10));
+    }
+
+    ncompleted = 0;
+    while (aio.pending(&a) > 0) {
+        op = aio.poll(&a);
+        if (op == NULL) {
+            continue;
+        }
+        tassert_eqe(EOK, op->error);
+        ncompleted++;
+    }
+    tassert_eqi(ncompleted, NFILES * 2);
+
+    for (u32 f = 0; f < NFILES; f++) {
+        tassert_eqi(ops[f][0].nbytes, sizeof(rbuf[f]));
+        // short read at the end of file
+        tassert_eqi(ops[f][1].nbytes, 10);
+        tassert(memcmp(rbuf[f], wbuf[f], sizeof(rbuf[f])) == 0);
+        tassert(memcmp(tbuf[f], wbuf[f] + sizeof(wbuf[f]) - 10, 10) == 0);
+        aio.close(&a, fds[f]);
+    }
+
+    // bad fd
+    char buf[16];
+    tassert_eqe(EOK, aio.read(&a, &ops[0][0], fds[0], buf, sizeof(buf), 0));
+    tassert_eqe(Error.io, aio.wait_all(&a));
+    tassert_eqe(Error.io, ops[0][0].error);
+
+    aio.destroy(&a);
+    return EOK;
+}
+
+test$case(test_aio_default_backend)
+{
+    tassert_eqe(EOK, aio_write_read_files(0, 0));
+    return EOK;
+}
+
+test$case(test_aio_uring_probe)
+{
+#if AIO__HAS_URING
+    aio_c a;
+    tassert_eqe(EOK, aio.create(&a, 0, 0, allocator));
+    if (aio.backend(&a) == AIO_BACKEND_URING) {
+        // ring is only used when kernel supports IORING_OP_READ/IORING_OP_WRITE (Linux 5.6+)
+        tassert(aio__uring_probe(a._uring.fd));
+    } else {
+        tassert_eqi(a._uring.fd, -1);
+    }
+    aio.destroy(&a);
+#endif
+    return EOK;
+}
+
+test$case(test_aio_small_queue_backlog)
+{
+    // 200 operations through 8 entries queue
+    tassert_eqe(EOK, aio_write_read_files(0, 8));
+    return EOK;
+}
+
+test$case(test_aio_threads_backend)
+{
+    tassert_eqe(EOK, aio_write_read_files(AIO_FLAG_NO_URING, 0));
+    return EOK;
+}
+
+test$case(test_aio_io_c_handle)
+{
+    aio_c a;
+    tassert_eqe(EOK, aio.create(&a, 0, 0, allocator));
+
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_aio_io_c.txt", "w+", allocator));
+    tassert_eqe(EOK, io.fprintf(&file, "hello "));
+    tassert_eqe(EOK, io.flush(&file));
+
+    aio_op_s op = { 0 };
+    tassert_eqe(EOK, aio.write(&a, &op, io.fileno(&file), "world", 5, 6));
+    tassert(aio.wait(&a) == &op);
+    tassert_eqe(EOK, op.error);
+    tassert_eqi(op.nbytes, 5);
+
+    char buf[32] = { 0 };
+    tassert_eqe(EOK, aio.read(&a, &op, io.fileno(&file), buf, sizeof(buf), 0));
+    tassert_eqe(EOK, aio.wait_all(&a));
+    tassert_eqi(op.nbytes, 11);
+    tassert_eqs(buf, "hello world");
+
+    io.close(&file);
+    aio.destroy(&a);
+    return EOK;
+}
+
+test$case(test_aio_errors)
+{
+    aio_c a;
+    tassert_eqe(EOK, aio.create(&a, 0, 0, allocator));
+
+    int fd = 0;
+    tassert_eqe(Error.not_found, aio.open(&a, "tests/build/not_exists/file.txt", O_RDONLY, 0, &fd));
+    tassert_eqi(fd, -1);
+
+    aio_op_s op = { 0 };
+    char buf[16];
+    tassert_eqe(Error.argument, aio.read(&a, &op, -1, buf, sizeof(buf), 0));
+    tassert_eqe(Error.argument, aio.read(&a, &op, 0, NULL, sizeof(buf), 0));
+    tassert_eqe(Error.argument, aio.submit(&a, &op));
+    tassert_eqi(aio.pending(&a), 0);
+
+    aio.destroy(&a);
+    tassert(a._allocator == NULL);
+    // double destroy is allowed
+    aio.destroy(&a);
+    return EOK;
+}
+
+test$case(test_aio_uring_enter_failure)
+{
+    aio_c a;
+    tassert_eqe(EOK, aio.create(&a, 8, 0, allocator));
+    if (aio.backend(&a) != AIO_BACKEND_URING) {
+        aio.destroy(&a);
+    return EOK;
+    }
+
+    // more ops than SQ entries, some of them stay in backlog
+    aio_op_s ops[20] = { 0 };
+    int fd;
+    tassert_eqe(EOK, aio.open(&a, "tests/build/test_aio_00.bin", O_RDWR | O_CREAT, 0644, &fd));
+    char buf[16] = { 0 };
+    tassert_eqe(EOK, aio.write(&a, &ops[0], fd, "hello", 5, 0));
+    tassert_eqe(EOK, aio.wait_all(&a));
+
+    // queued ops (SQ and backlog) are completed with error, nothing is left pending
+    int ring_fd = a._uring.fd;
+    a._uring.fd = -1;
+    for (u32 i = 0; i < arr$len(ops); i++) {
+        tassert_eqe(EOK, aio.read(&a, &ops[i], fd, buf, sizeof(buf), 0));
+    }
+    tassert_eqi(aio.pending(&a), arr$len(ops));
+    tassert_eqe(Error.io, aio.wait_all(&a));
+    tassert_eqi(aio.pending(&a), 0);
+    for (u32 i = 0; i < arr$len(ops); i++) {
+        tassert_eqe(Error.io, ops[i].error);
+        tassert_eqi(ops[i].nbytes, 0);
+    }
+
+    // later ops fail too
+    tassert_eqe(EOK, aio.read(&a, &ops[0], fd, buf, sizeof(buf), 0));
+    tassert(aio.poll(&a) == &ops[0]);
+    tassert_eqe(Error.io, ops[0].error);
+    tassert_eqi(aio.pending(&a), 0);
+
+    a._uring.fd = ring_fd;
+    aio.close(&a, fd);
+    aio.destroy(&a);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_aio_default_backend);
+    test$run(test_aio_uring_probe);
+    test$run(test_aio_small_queue_backlog);
+    test$run(test_aio_threads_backend);
+    test$run(test_aio_io_c_handle);
+    test$run(test_aio_errors);
+    test$run(test_aio_uring_enter_failure);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -0,0 +1,274 @@
+#include <cex.c>
+#include <cex/csv/csv.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+test$case(test_csv_basic)
+{
+    csv_c c;
+    str_c data = s$("name,value,comment\n"
+                    "foo,1,some long comment text for simd scanner\r\n"
+                    "\n"
+                    "bar,,\n"
+                    "baz,3");
+    tassert_eqe(EOK, csv.create_buf(&c, data, 0, allocator));
+
+    str_c* f;
+    u32 n;
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 3);
+    tassert_eqi(csv.row(&c), 1);
+    tassert_eqi(0, str.cmp(f[0], s$("name")));
+    tassert_eqi(0, str.cmp(f[2], s$("comment")));
+
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 3);
+    tassert_eqi(0, str.cmp(f[0], s$("foo")));
+    tassert_eqi(0, str.cmp(f[1], s$("1")));
+    tassert_eqi(0, str.cmp(f[2], s$("some long comment text for simd scanner")));
+    // zero-copy
+    tassert(f[0].buf >= data.buf && f[0].buf < data.buf + data.len);
+
+    // blank line skipped, empty fields
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 3);
+    tassert_eqi(0, str.cmp(f[0], s$("bar")));
+    tassert_eqi(f[1].len, 0);
+    tassert_eqi(f[2].len, 0);
+
+    // no trailing new line
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 2);
+    tassert_eqi(0, str.cmp(f[1], s$("3")));
+    tassert_eqi(csv.row(&c), 4);
+
+    tassert_eqe(Error.eof, csv.next(&c, &f, &n));
+    tassert_eqi(n, 0);
+    tassert_eqe(Error.eof, csv.next(&c, &f, &n));
+
+    csv.destroy(&c);
+    // double destroy is allowed
+    csv.destroy(&c);
+    return EOK;
+}
+
+test$case(test_csv_quoting)
+{
+    csv_c c;
+    str_c data = s$("\"a,b\";\"multi\nline\";\"say \"\"hi\"\"\";\"\"\r\n"
+                    "x\"y;\"\"\"\"\"\";\"end\"\n"
+                    "\"last\";");
+    tassert_eqe(EOK, csv.create_buf(&c, data, ';', allocator));
+
+    str_c* f;
+    u32 n;
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 4);
+    tassert_eqi(0, str.cmp(f[0], s$("a,b")));
+    tassert_eqi(0, str.cmp(f[1], s$("multi\nline")));
+    tassert_eqi(0, str.cmp(f[2], s$("say \"hi\"")));
+    tassert_eqi(f[3].len, 0);
+
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 3);
+    // quote inside unquoted field is literal
+    tassert_eqi(0, str.cmp(f[0], s$("x\"y")));
+    tassert_eqi(0, str.cmp(f[1], s$("\"\"")));
+    tassert_eqi(0, str.cmp(f[2], s$("end")));
+
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 2);
+    tassert_eqi(0, str.cmp(f[0], s$("last")));
+    tassert_eqi(f[1].len, 0);
+
+    tassert_eqe(Error.eof, csv.next(&c, &f, &n));
+    csv.destroy(&c);
+
+    tassert_eqe(EOK, csv.create_buf(&c, s$("\"unterminated,1\n2,3\n"), 0, allocator));
+    tassert_eqe(Error.integrity, csv.next(&c, &f, &n));
+    csv.destroy(&c);
+
+    tassert_eqe(EOK, csv.create_buf(&c, s$("\"garbage\"x,1\n"), 0, allocator));
+    tassert_eqe(Error.integrity, csv.next(&c, &f, &n));
+    csv.destroy(&c);
+    return EOK;
+}
+
+test$case(test_csv_unescape_scratch)
+{
+    sbuf_c data;
+    tassert_eqe(EOK, sbuf.create(&data, 1024, allocator));
+    // many escaped fields in one row, scratch buffer is reallocated while parsing it
+    for (u32 i = 0; i < 200; i++) {
+        tassert_eqe(EOK, sbuf.sprintf(&data, "%s\"f\"\"%u\"\"\"", i > 0 ? "," : "", i));
+    }
+    tassert_eqe(EOK, sbuf.append(&data, s$("\n")));
+    // big rest of input is not reserved for the first escaped field
+    for (u32 i = 0; i < 100000; i++) {
+        tassert_eqe(EOK, sbuf.append(&data, s$("plain,row\n")));
+    }
+
+    csv_c c;
+    str_c* f;
+    u32 n;
+    tassert_eqe(EOK, csv.create_buf(&c, str.cbuf(data, sbuf.len(&data)), 0, allocator));
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(n, 200);
+    char buf[32];
+    for (u32 i = 0; i < n; i++) {
+        str.sprintf(buf, sizeof(buf), "f\"%u\"", i);
+        tassert_eqi(0, str.cmp(f[i], str.cstr(buf)));
+    }
+    tassert(sbuf.capacity(&c._unquoted) < 64 * 1024);
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqi(0, str.cmp(f[1], s$("row")));
+
+    csv.destroy(&c);
+    sbuf.destroy(&data);
+    return EOK;
+}
+
+test$case(test_csv_streaming_vs_buf)
+{
+    sbuf_c data;
+    tassert_eqe(EOK, sbuf.create(&data, 1024 * 1024, allocator));
+    for (u32 i = 0; i < 20000; i++) {
+        if (i == 777) {
+            // row longer than streaming buffer
+            tassert_eqe(EOK, sbuf.append(&data, s$("\"")));
+            for (u32 j = 0; j < CSV_BUF_SIZE / 8; j++) {
+                tassert_eqe(EOK, sbuf.append(&data, s$("ab\"\"cd,\n")));
+            }
+            tassert_eqe(EOK, sbuf.append(&data, s$("\",long\n")));
+            continue;
+        }
+        tassert_eqe(
+            EOK,
+            sbuf.sprintf(&data, "%d,\"q%d,\"\"x\"\"\",%d.5,text text text %d\r\n", i, i, i, i)
+        );
+    }
+
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_csv_stream.csv", "w+", allocator));
+    tassert_eqe(EOK, io.write(&file, data, 1, sbuf.len(&data)));
+    io.rewind(&file);
+
+    csv_c cb;
+    csv_c cs;
+    tassert_eqe(EOK, csv.create_buf(&cb, sbuf.to_str(&data), 0, allocator));
+    tassert_eqe(EOK, csv.create(&cs, &file, 0, allocator));
+
+    str_c* fb;
+    str_c* fs;
+    u32 nb, ns;
+    u32 nrows = 0;
+    while (true) {
+        Exc eb = csv.next(&cb, &fb, &nb);
+        Exc es = csv.next(&cs, &fs, &ns);
+        tassert_eqe(eb, es);
+        if (eb != EOK) {
+            tassert_eqe(Error.eof, eb);
+            break;
+        }
+        tassert_eqi(nb, ns);
+        for (u32 i = 0; i < nb; i++) {
+            tassert_eqi(0, str.cmp(fb[i], fs[i]));
+        }
+        if (nrows == 777) {
+            tassert_eqi(ns, 2);
+            tassert_eqi(fs[0].len, CSV_BUF_SIZE / 8 * 7);
+        } else {
+            tassert_eqi(ns, 4);
+        }
+        nrows++;
+    }
+    tassert_eqi(nrows, 20000);
+
+    csv.destroy(&cb);
+    csv.destroy(&cs);
+    io.close(&file);
+    sbuf.destroy(&data);
+    return EOK;
+}
+
+test$case(test_csv_read_columns)
+{
+    csv_c c;
+    str_c data = s$("id,price,qty\n"
+                    "1,10.5,100\n"
+                    "2,-3.25,200\n"
+                    "3,0,4000000000\n");
+    tassert_eqe(EOK, csv.create_buf(&c, data, 0, allocator));
+
+    list$define(i64) ids;
+    list$define(f64) prices;
+    list$define(u32) qty;
+    tassert_eqe(EOK, list$new(&ids, 16, allocator));
+    tassert_eqe(EOK, list$new(&prices, 16, allocator));
+    tassert_eqe(EOK, list$new(&qty, 16, allocator));
+
+    csv_column_s cols[] = {
+        { .index = 0, .type = CSV_COL_I64, .list = &ids },
+        { .index = 1, .type = CSV_COL_F64, .list = &prices },
+        { .index = 2, .type = CSV_COL_U32, .list = &qty },
+    };
+
+    str_c* f;
+    u32 n;
+    // skip header
+    tassert_eqe(EOK, csv.next(&c, &f, &n));
+    tassert_eqe(EOK, csv.read_columns(&c, cols, arr$len(cols)));
+    tassert_eqi(ids.len, 3);
+    tassert_eqi(prices.len, 3);
+    tassert_eqi(qty.len, 3);
+    tassert_eqi(ids.arr[2], 3);
+    tassert_eqf(prices.arr[0], 10.5);
+    tassert_eqf(prices.arr[1], -3.25);
+    tassert_eqi(qty.arr[2], 4000000000u);
+    csv.destroy(&c);
+
+    // conversion error reports row number
+    tassert_eqe(EOK, csv.create_buf(&c, s$("1,2,3\n4,x,6\n"), 0, allocator));
+    list.clear(&ids);
+    tassert(csv.read_columns(&c, cols, arr$len(cols)) != EOK);
+    tassert_eqi(csv.row(&c), 2);
+    csv.destroy(&c);
+
+    tassert_eqe(EOK, csv.create_buf(&c, s$("1,2\n"), 0, allocator));
+    tassert_eqe(Error.integrity, csv.read_columns(&c, cols, arr$len(cols)));
+    csv.destroy(&c);
+
+    list.destroy(&ids);
+    list.destroy(&prices);
+    list.destroy(&qty);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_csv_basic);
+    test$run(test_csv_quoting);
+    test$run(test_csv_unescape_scratch);
+    test$run(test_csv_streaming_vs_buf);
+    test$run(test_csv_read_columns);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -0,0 +1,339 @@
+#include <cex.c>
+#include <cex/json/json.c>
+#include <cex/jsonw/jsonw.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+test$case(test_json_navigate)
+{
+    str_c doc = s$(" { \"name\" : \"cex\", \"ver\": [1, -2.5e3, 18446744073709551615],\n"
+                   "\t\"ok\":true, \"no\": false, \"nil\":null, \"empty\": {}, \"arr\": [],\r\n"
+                   "\"nested\": {\"a\": [{\"b\": \"deep\"}], \"c\": 0.5} }  ");
+    json_tok_s tape[32];
+    json_c js;
+    tassert_eqe(EOK, json.parse(&js, doc, tape, arr$len(tape)));
+
+    json_tok_s* root = json.root(&js);
+    tassert(root != NULL);
+    tassert_eqi(root->type, JSON_OBJECT);
+    tassert_eqi(root->len, 8);
+    tassert_eqi(root->next, js._len);
+
+    json_tok_s* t = json.get(&js, root, s$("name"));
+    tassert_eqi(t->type, JSON_STRING);
+    tassert_eqi(0, str.cmp(json.text(&js, t), s$("cex")));
+    tassert(json.get(&js, root, s$("missing")) == NULL);
+    tassert(json.get(&js, t, s$("name")) == NULL);
+
+    json_tok_s* ver = json.get(&js, root, s$("ver"));
+    tassert_eqi(ver->type, JSON_ARRAY);
+    tassert_eqi(ver->len, 3);
+    i64 i;
+    u64 u;
+    f64 f;
+    tassert_eqe(EOK, json.to_i64(&js, json.at(&js, ver, 0), &i));
+    tassert_eql(i, 1);
+    tassert_eqe(EOK, json.to_f64(&js, json.at(&js, ver, 1), &f));
+    tassert_eqf(f, -2500.0);
+    tassert_eqe(EOK, json.to_u64(&js, json.at(&js, ver, 2), &u));
+    tassert(u == UINT64_MAX);
+    tassert(json.at(&js, ver, 3) == NULL);
+    tassert_eqe(Error.argument, json.to_i64(&js, ver, &i));
+    tassert_eqe(Error.argument, json.to_i64(&js, json.get(&js, root, s$("name")), &i));
+
+    bool b = false;
+    tassert_eqe(EOK, json.to_bool(&js, json.get(&js, root, s$("ok")), &b));
+    tassert(b == true);
+    tassert_eqe(EOK, json.to_bool(&js, json.get(&js, root, s$("no")), &b));
+    tassert(b == false);
+    tassert_eqi(json.get(&js, root, s$("nil"))->type, JSON_NULL);
+    tassert_eqi(0, str.cmp(json.text(&js, json.get(&js, root, s$("nil"))), s$("null")));
+    tassert_eqi(json.get(&js, root, s$("empty"))->len, 0);
+    tassert_eqi(json.get(&js, root, s$("arr"))->len, 0);
+
+    // nested values are skipped via tape links
+    json_tok_s* nested = json.get(&js, root, s$("nested"));
+    json_tok_s* a = json.get(&js, nested, s$("a"));
+    json_tok_s* deep = json.get(&js, json.at(&js, a, 0), s$("b"));
+    tassert_eqi(0, str.cmp(json.text(&js, deep), s$("deep")));
+    tassert_eqe(EOK, json.to_f64(&js, json.get(&js, nested, s$("c")), &f));
+    tassert_eqf(f, 0.5);
+
+    // iteration over object values, key precedes its value
+    const char* keys[] = { "name", "ver", "ok", "no", "nil", "empty", "arr", "nested" };
+    u32 n = 0;
+    for$iter(json_tok_s, it, json.iter(&js, root, &it.iterator))
+    {
+        tassert_eqi(it.idx.i, n);
+        tassert_eqi(0, str.cmp(json.text(&js, it.val - 1), s$(keys[n])));
+        n++;
+    }
+    tassert_eqi(n, arr$len(keys));
+
+    n = 0;
+    for$iter(json_tok_s, it, json.iter(&js, ver, &it.iterator))
+    {
+        tassert_eqi(it.val->type, JSON_NUMBER);
+        n++;
+    }
+    tassert_eqi(n, 3);
+
+    for$iter(json_tok_s, it, json.iter(&js, json.get(&js, root, s$("arr")), &it.iterator))
+    {
+        tassert(false && "empty array");
+    }
+
+    // scalar top-level values
+    tassert_eqe(EOK, json.parse(&js, s$("  42 "), tape, arr$len(tape)));
+    tassert_eqi(json.root(&js)->type, JSON_NUMBER);
+    tassert_eqi(0, str.cmp(json.text(&js, json.root(&js)), s$("42")));
+    tassert_eqe(EOK, json.parse(&js, s$("\"s\""), tape, arr$len(tape)));
+    tassert_eqi(0, str.cmp(json.text(&js, json.root(&js)), s$("s")));
+
+    json.destroy(&js);
+    return EOK;
+}
+
+test$case(test_json_invalid)
+{
+    json_tok_s tape[64];
+    json_c js;
+
+    const char* bad[] = {
+        "",
+        "   ",
+        "{",
+        "}",
+        "[1,]",
+        "[,1]",
+        "[1 2]",
+        "{\"a\"}",
+        "{\"a\":}",
+        "{\"a\":1,}",
+        "{\"a\" 1}",
+        "{1:2}",
+        "{\"a\":1]",
+        "[1}",
+        "[1]]",
+        "{}{}",
+        "1 2",
+        "\"abc",
+        "\"a\"x",
+        "\"a\nb\"",
+        "01",
+        "1.",
+        "-",
+        ".5",
+        "1e",
+        "+1",
+        "tru",
+        "nulll",
+        "[true false]",
+        "[\"a\\\"]",
+    };
+    for (u32 i = 0; i < arr$len(bad); i++) {
+        Exc err = json.parse(&js, s$(bad[i]), tape, arr$len(tape));
+        if (err != Error.integrity) {
+            tassertf(false, "expected Error.integrity for: %s", bad[i]);
+        }
+        tassert(json.root(&js) == NULL);
+    }
+
+    // not enough tape
+    tassert_eqe(Error.overflow, json.parse(&js, s$("[1,2,3]"), tape, 3));
+    tassert_eqe(EOK, json.parse(&js, s$("[1,2,3]"), tape, 4));
+
+    // too deep
+    char deep[JSON_MAX_DEPTH + 2];
+    memset(deep, '[', sizeof(deep));
+    tassert_eqe(Error.overflow, json.parse_alloc(&js, str.cbuf(deep, sizeof(deep)), allocator));
+    tassert_eqe(
+        Error.integrity,
+        json.parse_alloc(&js, str.cbuf(deep, JSON_MAX_DEPTH), allocator)
+    );
+
+    // bad escapes are detected on unescape
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 64, allocator));
+    const char* bad_esc[] = { "\"\\x\"", "\"\\u12\"", "\"\\ud800\\u12\"" };
+    for (u32 i = 0; i < arr$len(bad_esc); i++) {
+        tassert_eqe(EOK, json.parse(&js, s$(bad_esc[i]), tape, arr$len(tape)));
+        tassert_eqe(Error.integrity, json.unescape(&js, json.root(&js), &s));
+    }
+    tassert_eqe(Error.argument, json.unescape(&js, NULL, &s));
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_json_unescape)
+{
+    json_tok_s tape[8];
+    json_c js;
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 64, allocator));
+
+    tassert_eqe(
+        EOK,
+        json.parse(
+            &js,
+            s$("[\"q\\\"s\\\\\\/\\b\\f\\n\\r\\t\", \"\\u0041\\u00e9\\u20AC\\ud83d\\ude00 end\"]"),
+            tape,
+            arr$len(tape)
+        )
+    );
+    json_tok_s* root = json.root(&js);
+    tassert_eqe(EOK, json.unescape(&js, json.at(&js, root, 0), &s));
+    tassert_eqs(s, "q\"s\\/\b\f\n\r\t");
+    sbuf.clear(&s);
+    tassert_eqe(EOK, json.unescape(&js, json.at(&js, root, 1), &s));
+    tassert_eqs(s, "Aé€😀 end");
+
+    // unpaired surrogates become U+FFFD, following escape is still decoded
+    struct
+    {
+        const char* json;
+        const char* expected;
+    } lone[] = {
+        { "\"\\udb43x\"", "\xEF\xBF\xBDx" },
+        { "\"\\ud800\"", "\xEF\xBF\xBD" },
+        { "\"\\udc00\\ud83d\"", "\xEF\xBF\xBD\xEF\xBF\xBD" },
+        { "\"\\ud800\\u0041\"", "\xEF\xBF\xBD" "A" },
+        { "\"\\ud800\\ud83d\\ude00\"", "\xEF\xBF\xBD" "😀" },
+    };
+    for (u32 i = 0; i < arr$len(lone); i++) {
+        sbuf.clear(&s);
+        tassert_eqe(EOK, json.parse(&js, s$(lone[i].json), tape, arr$len(tape)));
+        tassert_eqe(EOK, json.unescape(&js, json.root(&js), &s));
+        tassert_eqs(s, lone[i].expected);
+    }
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_json_jsonw_roundtrip)
+{
+    // random strings with quotes, backslash runs, and control chars at every block position
+    sbuf_c doc;
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&doc, 1024, allocator));
+    tassert_eqe(EOK, sbuf.create(&s, 64, allocator));
+
+    const char alphabet[] = "ab\\\\\\\"\"\n\x01 :,{}[]\x7f";
+    char strings[200][40];
+    u32 lens[200];
+    u32 seed = 12345;
+
+    jsonw_c w;
+    tassert_eqe(EOK, jsonw.create(&w, &doc));
+    tassert_eqe(EOK, jsonw.arr_begin(&w));
+    for (u32 i = 0; i < arr$len(strings); i++) {
+        seed = seed * 1103515245 + 12345;
+        lens[i] = (seed >> 16) % sizeof(strings[i]);
+        for (u32 k = 0; k < lens[i]; k++) {
+            seed = seed * 1103515245 + 12345;
+            strings[i][k] = alphabet[(seed >> 16) % (sizeof(alphabet) - 1)];
+        }
+        tassert_eqe(EOK, jsonw.str(&w, str.cbuf(strings[i], lens[i])));
+        tassert_eqe(EOK, jsonw.i64(&w, (i64)i * 1000003 - 77777));
+    }
+    tassert_eqe(EOK, jsonw.arr_end(&w));
+    tassert_eqe(EOK, jsonw.finish(&w));
+
+    json_c js;
+    tassert_eqe(EOK, json.parse_alloc(&js, str.cbuf(doc, sbuf.len(&doc)), allocator));
+    json_tok_s* root = json.root(&js);
+    tassert_eqi(root->len, arr$len(strings) * 2);
+
+    u32 i = 0;
+    for$iter(json_tok_s, it, json.iter(&js, root, &it.iterator))
+    {
+        if (it.idx.i % 2 == 0) {
+            sbuf.clear(&s);
+            tassert_eqe(EOK, json.unescape(&js, it.val, &s));
+            tassert_eqi(sbuf.len(&s), lens[i]);
+            tassert(memcmp(s, strings[i], lens[i]) == 0);
+        } else {
+            i64 v;
+            tassert_eqe(EOK, json.to_i64(&js, it.val, &v));
+            tassert_eql(v, (i64)i * 1000003 - 77777);
+            i++;
+        }
+    }
+    tassert_eqi(i, arr$len(strings));
+    // tape is sized exactly by the counting pass
+    tassert_eqi(js._len, js._cap);
+
+    json.destroy(&js);
+    json.destroy(&js);
+    jsonw.destroy(&w);
+    sbuf.destroy(&s);
+    sbuf.destroy(&doc);
+    return EOK;
+}
+
+test$case(test_json_block_boundaries)
+{
+    // values and whitespace runs crossing 64-byte block boundaries at every offset
+    sbuf_c doc;
+    tassert_eqe(EOK, sbuf.create(&doc, 1024, allocator));
+    json_c js;
+
+    for (u32 pad = 0; pad < 70; pad++) {
+        sbuf.clear(&doc);
+        tassert_eqe(EOK, sbuf.append(&doc, s$("[")));
+        for (u32 k = 0; k < pad; k++) {
+            tassert_eqe(EOK, sbuf.append(&doc, s$(" ")));
+        }
+        tassert_eqe(
+            EOK,
+            sbuf.append(&doc, s$("123456789012, \"\\\\\\\\\\\"quoted\\\\\", -0.000001e-5 , true,null"))
+        );
+        tassert_eqe(EOK, sbuf.append(&doc, s$("]")));
+
+        tassert_eqe(EOK, json.parse_alloc(&js, str.cbuf(doc, sbuf.len(&doc)), allocator));
+        json_tok_s* root = json.root(&js);
+        tassert_eqi(root->len, 5);
+        i64 i;
+        tassert_eqe(EOK, json.to_i64(&js, json.at(&js, root, 0), &i));
+        tassert_eql(i, 123456789012);
+        tassert_eqi(0, str.cmp(json.text(&js, json.at(&js, root, 1)), s$("\\\\\\\\\\\"quoted\\\\")));
+        tassert_eqi(0, str.cmp(json.text(&js, json.at(&js, root, 2)), s$("-0.000001e-5")));
+        tassert_eqi(json.at(&js, root, 3)->type, JSON_BOOL);
+        tassert_eqi(json.at(&js, root, 4)->type, JSON_NULL);
+        json.destroy(&js);
+    }
+
+    sbuf.destroy(&doc);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_json_navigate);
+    test$run(test_json_invalid);
+    test$run(test_json_unescape);
+    test$run(test_json_jsonw_roundtrip);
+    test$run(test_json_block_boundaries);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -0,0 +1,228 @@
+#include <cex.c>
+#include <cex/jsonw/jsonw.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+test$case(test_jsonw_structure)
+{
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 64, allocator));
+
+    jsonw_c w;
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.obj_begin(&w));
+    tassert_eqe(EOK, jsonw.key(&w, s$("name")));
+    tassert_eqe(EOK, jsonw.str(&w, s$("cex")));
+    tassert_eqe(EOK, jsonw.key(&w, s$("list")));
+    tassert_eqe(EOK, jsonw.arr_begin(&w));
+    tassert_eqe(EOK, jsonw.i64(&w, -1));
+    tassert_eqe(EOK, jsonw.u64(&w, UINT64_MAX));
+    tassert_eqe(EOK, jsonw.f64(&w, 0.1));
+    tassert_eqe(EOK, jsonw.boolean(&w, true));
+    tassert_eqe(EOK, jsonw.boolean(&w, false));
+    tassert_eqe(EOK, jsonw.null(&w));
+    tassert_eqe(EOK, jsonw.str(&w, str.cstr(NULL)));
+    tassert_eqe(EOK, jsonw.arr_begin(&w));
+    tassert_eqe(EOK, jsonw.arr_end(&w));
+    tassert_eqe(EOK, jsonw.obj_begin(&w));
+    tassert_eqe(EOK, jsonw.obj_end(&w));
+    tassert_eqe(EOK, jsonw.arr_end(&w));
+    tassert_eqe(EOK, jsonw.key(&w, s$("raw")));
+    tassert_eqe(EOK, jsonw.raw(&w, s$("{\"a\":1}")));
+    tassert_eqe(EOK, jsonw.obj_end(&w));
+    tassert_eqe(EOK, jsonw.finish(&w));
+
+    tassert_eqs(
+        s,
+        "{\"name\":\"cex\",\"list\":[-1,18446744073709551615,0.1,true,false,null,null,[],{}],"
+        "\"raw\":{\"a\":1}}"
+    );
+
+    // top-level values are separated by new line
+    sbuf.clear(&s);
+    tassert_eqe(EOK, jsonw.i64(&w, 1));
+    tassert_eqe(EOK, jsonw.obj_begin(&w));
+    tassert_eqe(EOK, jsonw.obj_end(&w));
+    tassert_eqe(EOK, jsonw.finish(&w));
+    tassert_eqs(s, "\n1\n{}");
+
+    jsonw.destroy(&w);
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_jsonw_escape)
+{
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 64, allocator));
+
+    jsonw_c w;
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.str(&w, s$("q\"b\\n\nr\rt\tb\bf\f\x01\x1f\x7f ok")));
+    tassert_eqs(s, "\"q\\\"b\\\\n\\nr\\rt\\tb\\bf\\f\\u0001\\u001f\x7f ok\"");
+
+    // UTF-8 is passed as is
+    sbuf.clear(&s);
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.str(&w, s$("привіт, світ! long enough for simd")));
+    tassert_eqs(s, "\"привіт, світ! long enough for simd\"");
+
+    // special char at every position of a long string (simd blocks + tail)
+    char buf[100];
+    char expected[256];
+    for (u32 i = 0; i < sizeof(buf); i++) {
+        for (u32 k = 0; k < 3; k++) {
+            const char sc[] = { '"', '\n', '\x80' };
+            const char* se[] = { "\\\"", "\\n", "\x80" };
+            memset(buf, 'a', sizeof(buf));
+            buf[i] = sc[k];
+
+            u32 elen = 0;
+            expected[elen++] = '"';
+            memset(expected + elen, 'a', i);
+            elen += i;
+            memcpy(expected + elen, se[k], strlen(se[k]));
+            elen += strlen(se[k]);
+            memset(expected + elen, 'a', sizeof(buf) - i - 1);
+            elen += sizeof(buf) - i - 1;
+            expected[elen++] = '"';
+
+            sbuf.clear(&s);
+            tassert_eqe(EOK, jsonw.create(&w, &s));
+            tassert_eqe(EOK, jsonw.str(&w, str.cbuf(buf, sizeof(buf))));
+            tassert_eqi(sbuf.len(&s), elen);
+            tassert(memcmp(s, expected, elen) == 0);
+        }
+    }
+
+    jsonw.destroy(&w);
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_jsonw_errors)
+{
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 64, allocator));
+    jsonw_c w;
+
+    // value without key
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.obj_begin(&w));
+    tassert_eqe(Error.integrity, jsonw.i64(&w, 1));
+    // sticky
+    tassert_eqe(Error.integrity, jsonw.obj_end(&w));
+    tassert_eqe(Error.integrity, jsonw.finish(&w));
+
+    // key in array
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.arr_begin(&w));
+    tassert_eqe(Error.integrity, jsonw.key(&w, s$("a")));
+
+    // key without value
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.obj_begin(&w));
+    tassert_eqe(EOK, jsonw.key(&w, s$("a")));
+    tassert_eqe(Error.integrity, jsonw.obj_end(&w));
+
+    // unbalanced
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.obj_begin(&w));
+    tassert_eqe(Error.integrity, jsonw.arr_end(&w));
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(EOK, jsonw.arr_begin(&w));
+    tassert_eqe(Error.integrity, jsonw.finish(&w));
+
+    // nan / inf
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(Error.argument, jsonw.f64(&w, NAN));
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    tassert_eqe(Error.argument, jsonw.f64(&w, -INFINITY));
+
+    // too deep
+    tassert_eqe(EOK, jsonw.create(&w, &s));
+    for (u32 i = 0; i < JSONW_MAX_DEPTH; i++) {
+        tassert_eqe(EOK, jsonw.arr_begin(&w));
+    }
+    tassert_eqe(Error.overflow, jsonw.arr_begin(&w));
+
+    jsonw.destroy(&w);
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_jsonw_io)
+{
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_jsonw.json", "w+", allocator));
+
+    sbuf_c expected;
+    tassert_eqe(EOK, sbuf.create(&expected, 1024, allocator));
+    tassert_eqe(EOK, sbuf.append(&expected, s$("[")));
+
+    jsonw_c w;
+    tassert_eqe(EOK, jsonw.create_io(&w, &file, allocator));
+    tassert_eqe(EOK, jsonw.arr_begin(&w));
+    for (u32 i = 0; i < 10000; i++) {
+        tassert_eqe(EOK, jsonw.obj_begin(&w));
+        tassert_eqe(EOK, jsonw.key(&w, s$("id")));
+        tassert_eqe(EOK, jsonw.u64(&w, i));
+        tassert_eqe(EOK, jsonw.key(&w, s$("text")));
+        tassert_eqe(EOK, jsonw.str(&w, s$("line\n\"quoted\"")));
+        tassert_eqe(EOK, jsonw.obj_end(&w));
+        tassert_eqe(
+            EOK,
+            sbuf.sprintf(
+                &expected,
+                "%s{\"id\":%d,\"text\":\"line\\n\\\"quoted\\\"\"}",
+                (i > 0) ? "," : "",
+                i
+            )
+        );
+    }
+    tassert_eqe(EOK, jsonw.arr_end(&w));
+    tassert_eqe(EOK, sbuf.append(&expected, s$("]")));
+    // data is flushed by blocks
+    tassert(sbuf.len(&w._buf) < JSONW_FLUSH_SIZE);
+    tassert_eqe(EOK, jsonw.finish(&w));
+    tassert_eqi(sbuf.len(&w._buf), 0);
+    jsonw.destroy(&w);
+
+    str_c content;
+    io.rewind(&file);
+    tassert_eqe(EOK, io.readall(&file, &content));
+    tassert_eqi(content.len, sbuf.len(&expected));
+    tassert(memcmp(content.buf, expected, content.len) == 0);
+
+    io.close(&file);
+    sbuf.destroy(&expected);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_jsonw_structure);
+    test$run(test_jsonw_escape);
+    test$run(test_jsonw_errors);
+    test$run(test_jsonw_io);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -190,6 +190,826 @@ test$case(test_os_path_splitext)
     return EOK;
 }
 
+test$case(test_os_path_split)
+{
+    struct
+    {
+        const char* path;
+        const char* head;
+        const char* tail;
+    } cases[] = {
+        { "a/b/c", "a/b", "c" }, { "a/b/", "a/b", "" }, { "a", "", "a" },
+        { "/a", "/", "a" },      { "/", "/", "" },      { "//a", "//", "a" },
+        { "a//b", "a", "b" },    { "", "", "" },        { "/a/b.txt", "/a", "b.txt" },
+    };
+    for (u32 i = 0; i < arr$len(cases); i++) {
+        str_c head, tail;
+        os.path.split(s$(cases[i].path), &head, &tail);
+        tassert_eqi(0, str.cmp(head, s$(cases[i].head)));
+        tassert_eqi(0, str.cmp(tail, s$(cases[i].tail)));
+        tassert_eqi(0, str.cmp(os.path.dirname(s$(cases[i].path)), s$(cases[i].head)));
+        tassert_eqi(0, str.cmp(os.path.basename(s$(cases[i].path)), s$(cases[i].tail)));
+    }
+    tassert_eqi(0, str.cmp(os.path.dirname(str.cstr(NULL)), s$("")));
+    tassert_eqi(0, str.cmp(os.path.basename(str.cstr(NULL)), s$("")));
+    return EOK;
+}
+
+test$case(test_os_path_normalize)
+{
+    struct
+    {
+        const char* path;
+        const char* expected;
+    } cases[] = {
+        { "a/b/c", "a/b/c" },    { "a/./b/../c//", "a/c" }, { "", "." },
+        { ".", "." },            { "./", "." },             { "/", "/" },
+        { "//a///b", "/a/b" },   { "/../a", "/a" },         { "/..", "/" },
+        { "..", ".." },          { "../../a", "../../a" },  { "a/../..", ".." },
+        { "a/b/../../..", ".." }, { "a/..", "." },          { "../a/../b", "../b" },
+        { "a/../../b/..", ".." }, { "..a/b", "..a/b" },     { "a/.b/c", "a/.b/c" },
+    };
+    char buf[PATH_MAX];
+    for (u32 i = 0; i < arr$len(cases); i++) {
+        str_c out;
+        tassert_eqe(EOK, os.path.normalize(s$(cases[i].path), buf, sizeof(buf), &out));
+        if (str.cmp(out, s$(cases[i].expected)) != 0) {
+            io.printf("normalize('%s') -> '%S'\n", cases[i].path, out);
+        }
+        tassert_eqi(0, str.cmp(out, s$(cases[i].expected)));
+        tassert_eqi(out.buf[out.len], '\0');
+    }
+
+    str_c out;
+    char small[4];
+    tassert_eqe(EOK, os.path.normalize(s$("a//b"), small, sizeof(small), &out));
+    tassert(strcmp(small, "a/b") == 0);
+    tassert_eqe(Error.overflow, os.path.normalize(s$("ab/c"), small, sizeof(small), &out));
+    tassert_eqe(Error.argument, os.path.normalize(str.cstr(NULL), buf, sizeof(buf), &out));
+    return EOK;
+}
+
+test$case(test_os_path_relpath)
+{
+    struct
+    {
+        const char* path;
+        const char* start;
+        const char* expected;
+    } cases[] = {
+        { "a/b/c", "a", "b/c" },       { "a/b/c", "a/d", "../b/c" }, { "a", "a", "." },
+        { "a", "a/b/c", "../.." },     { "/x/y", "/", "x/y" },       { "/x/y", "/z/", "../x/y" },
+        { "a/./b/", "a/c/..", "b" },   { "../a", "..", "a" },        { "../a", "b", "../../a" },
+        { "", "a", ".." },
+    };
+    char buf[PATH_MAX];
+    for (u32 i = 0; i < arr$len(cases); i++) {
+        str_c out;
+        tassert_eqe(EOK, os.path.relpath(s$(cases[i].path), s$(cases[i].start), buf, sizeof(buf), &out));
+        if (str.cmp(out, s$(cases[i].expected)) != 0) {
+            io.printf("relpath('%s', '%s') -> '%S'\n", cases[i].path, cases[i].start, out);
+        }
+        tassert_eqi(0, str.cmp(out, s$(cases[i].expected)));
+    }
+
+    str_c out;
+    tassert_eqe(Error.argument, os.path.relpath(s$("/a"), s$("a"), buf, sizeof(buf), &out));
+    tassert_eqe(Error.argument, os.path.relpath(s$("a"), s$("../b"), buf, sizeof(buf), &out));
+    char small[4];
+    tassert_eqe(Error.overflow, os.path.relpath(s$("a/b/c"), s$("x"), small, sizeof(small), &out));
+    return EOK;
+}
+
+test$case(test_os_path_join_buf)
+{
+    char buf[PATH_MAX];
+    str_c out;
+    tassert_eqe(EOK, os.path.join_buf(buf, sizeof(buf), &out, (str_c[]){ s$("a"), s$("b"), s$("c.txt") }, 3));
+    tassert_eqi(0, str.cmp(out, s$("a/b/c.txt")));
+    tassert(strcmp(buf, "a/b/c.txt") == 0);
+
+    // no double separators, empty parts are skipped
+    tassert_eqe(EOK, os.path.join_buf(buf, sizeof(buf), &out, (str_c[]){ s$("a/"), s$(""), s$("b") }, 3));
+    tassert_eqi(0, str.cmp(out, s$("a/b")));
+
+    // absolute part resets
+    tassert_eqe(EOK, os.path.join_buf(buf, sizeof(buf), &out, (str_c[]){ s$("a"), s$("/b"), s$("c") }, 3));
+    tassert_eqi(0, str.cmp(out, s$("/b/c")));
+
+    // views are not null terminated
+    str_c dir = str.sub(s$("tests/build/xxx"), 0, 11);
+    tassert_eqe(EOK, os.path.join_buf(buf, sizeof(buf), &out, (str_c[]){ dir, s$("f.c") }, 2));
+    tassert_eqi(0, str.cmp(out, s$("tests/build/f.c")));
+
+    tassert_eqe(EOK, os.path.join_buf(buf, sizeof(buf), &out, NULL, 0));
+    tassert_eqi(out.len, 0);
+    tassert(buf[0] == '\0');
+
+    char small[4];
+    tassert_eqe(EOK, os.path.join_buf(small, sizeof(small), &out, (str_c[]){ s$("a"), s$("b") }, 2));
+    tassert_eqe(Error.overflow, os.path.join_buf(small, sizeof(small), &out, (str_c[]){ s$("a"), s$("bc") }, 2));
+    tassert_eqe(Error.argument, os.path.join_buf(buf, sizeof(buf), &out, (str_c[]){ str.cstr(NULL) }, 1));
+    return EOK;
+}
+
+test$case(test_os_path_iter)
+{
+    const char* expected[] = { "/", "a", "b", "..", "c" };
+    u32 n = 0;
+    for$iter(str_c, it, os.path.iter(s$("/a//./b/../c/"), &it.iterator))
+    {
+        tassert_eqi(it.idx.i, n);
+        tassert_eqi(0, str.cmp(*it.val, s$(expected[n])));
+        n++;
+    }
+    tassert_eqi(n, arr$len(expected));
+
+    n = 0;
+    for$iter(str_c, it, os.path.iter(s$("a/b"), &it.iterator))
+    {
+        tassert_eqi(0, str.cmp(*it.val, s$(expected[n + 1])));
+        n++;
+    }
+    tassert_eqi(n, 2);
+
+    for$iter(str_c, it, os.path.iter(s$("./"), &it.iterator))
+    {
+        tassert(false && "no components");
+    }
+    for$iter(str_c, it, os.path.iter(str.cstr(NULL), &it.iterator))
+    {
+        tassert(false && "null");
+    }
+    return EOK;
+}
+
+static Exception
+make_walk_tree(void)
+{
+    // tests/build/test_os_walk/
+    //   f1.c f2.h .hidden.c
+    //   a/ a1.c a2.txt
+    //   a/b/ b1.c
+    //   a/b/c/ c1.c
+    //   .git/ g1.c
+    //   link -> a
+    const char* dirs[] = {
+        "tests/build/test_os_walk",          "tests/build/test_os_walk/a",
+        "tests/build/test_os_walk/a/b",      "tests/build/test_os_walk/a/b/c",
+        "tests/build/test_os_walk/.git",
+    };
+    const char* files[] = {
+        "tests/build/test_os_walk/f1.c",     "tests/build/test_os_walk/f2.h",
+        "tests/build/test_os_walk/.hidden.c", "tests/build/test_os_walk/a/a1.c",
+        "tests/build/test_os_walk/a/a2.txt", "tests/build/test_os_walk/a/b/b1.c",
+        "tests/build/test_os_walk/a/b/c/c1.c", "tests/build/test_os_walk/.git/g1.c",
+    };
+    for (u32 i = 0; i < arr$len(dirs); i++) {
+        if (mkdir(dirs[i], 0755) == -1 && errno != EEXIST) {
+            return Error.io;
+        }
+    }
+    for (u32 i = 0; i < arr$len(files); i++) {
+        int fd = open(files[i], O_CREAT | O_WRONLY, 0644);
+        if (fd == -1) {
+            return Error.io;
+        }
+        close(fd);
+    }
+    if (symlink("a", "tests/build/test_os_walk/link") == -1 && errno != EEXIST) {
+        return Error.io;
+    }
+    return EOK;
+}
+
+static u32
+walk_count(const char* root, const char* pattern, u32 max_depth, u32 flags)
+{
+    os_walk_c w;
+    os_walk_entry_s* e;
+    u32 n = 0;
+    if (os.walk.open(&w, s$(root), pattern, max_depth, flags, allocator)) {
+        return UINT32_MAX;
+    }
+    while (os.walk.next(&w, &e) == EOK) {
+        n++;
+    }
+    os.walk.close(&w);
+    return n;
+}
+
+test$case(test_os_walk)
+{
+    tassert_eqe(EOK, make_walk_tree());
+
+    os_walk_c w;
+    os_walk_entry_s* e;
+    Exc err;
+    u32 nfiles = 0;
+    u32 ndirs = 0;
+    u32 nlinks = 0;
+    tassert_eqe(EOK, os.walk.open(&w, s$("tests/build/test_os_walk/"), NULL, 0, 0, allocator));
+    while ((err = os.walk.next(&w, &e)) == EOK) {
+        tassert(str.starts_with(e->path, s$("tests/build/test_os_walk/")));
+        tassert(str.ends_with(e->path, e->name));
+        tassert(e->name.buf[0] != '.');
+        if (str.cmp(e->name, s$("c1.c")) == 0) {
+            tassert_eqi(0, str.cmp(e->path, s$("tests/build/test_os_walk/a/b/c/c1.c")));
+            tassert_eqi(e->depth, 3);
+        }
+        if (str.cmp(e->name, s$("f1.c")) == 0) {
+            tassert_eqi(e->depth, 0);
+        }
+        switch (e->type) {
+            case OS_FTYPE_FILE:
+                nfiles++;
+                break;
+            case OS_FTYPE_DIR:
+                ndirs++;
+                break;
+            case OS_FTYPE_LINK:
+                nlinks++;
+                break;
+            default:
+                tassert(false && "unexpected type");
+        }
+    }
+    tassert_eqe(Error.eof, err);
+    tassert_eqe(Error.eof, os.walk.next(&w, &e));
+    os.walk.close(&w);
+    os.walk.close(&w);
+    // symlink is not followed, hidden entries are skipped
+    tassert_eqi(nfiles, 6);
+    tassert_eqi(ndirs, 3);
+    tassert_eqi(nlinks, 1);
+
+    // filters
+    tassert_eqi(walk_count("tests/build/test_os_walk", NULL, 0, OS_WALK_HIDDEN), 13);
+    tassert_eqi(walk_count("tests/build/test_os_walk", "*.c", 0, 0), 4);
+    tassert_eqi(walk_count("tests/build/test_os_walk", "*.c|*.h", 0, OS_WALK_FILES), 5);
+    tassert_eqi(walk_count("tests/build/test_os_walk", "*.c", 0, OS_WALK_HIDDEN), 6);
+    tassert_eqi(walk_count("tests/build/test_os_walk", NULL, 0, OS_WALK_DIRS), 3);
+    tassert_eqi(walk_count("tests/build/test_os_walk", NULL, 1, 0), 4);
+    tassert_eqi(walk_count("tests/build/test_os_walk", "*.c", 2, 0), 2);
+    tassert_eqi(walk_count("tests/build/test_os_walk/a/b/c", NULL, 0, 0), 1);
+
+    // symlinked root is followed, like opendir()
+    tassert_eqi(walk_count("tests/build/test_os_walk/link", NULL, 0, 0), 6);
+    tassert_eqi(walk_count("tests/build/test_os_walk/link/", "*.c", 0, 0), 3);
+
+    // skip subtree
+    u32 n = 0;
+    tassert_eqe(EOK, os.walk.open(&w, s$("tests/build/test_os_walk"), NULL, 0, 0, allocator));
+    while (os.walk.next(&w, &e) == EOK) {
+        if (str.cmp(e->name, s$("a")) == 0) {
+            os.walk.skip(&w);
+        }
+        n++;
+    }
+    os.walk.close(&w);
+    tassert_eqi(n, 4);
+
+    tassert_eqe(Error.not_found, os.walk.open(&w, s$("tests/build/not_exists"), NULL, 0, 0, allocator));
+    tassert_eqe(Error.argument, os.walk.open(&w, s$("tests/build/test_os_walk/f1.c"), NULL, 0, 0, allocator));
+    tassert_eqe(Error.argument, os.walk.open(&w, s$(""), NULL, 0, 0, allocator));
+    os.walk.close(&w);
+    return EOK;
+}
+
+typedef struct
+{
+    u32 nentries;
+    u32 nfiles_c;
+    u32 fail_after;
+} walk_ctx_s;
+
+static Exception
+walk_counter(os_walk_entry_s* entry, void* ctx)
+{
+    walk_ctx_s* c = ctx;
+    u32 n = __atomic_add_fetch(&c->nentries, 1, __ATOMIC_RELAXED);
+    if (str.ends_with(entry->name, s$(".c"))) {
+        __atomic_add_fetch(&c->nfiles_c, 1, __ATOMIC_RELAXED);
+    }
+    if (c->fail_after > 0 && n >= c->fail_after) {
+        return Error.integrity;
+    }
+    return EOK;
+}
+
+test$case(test_os_walk_parallel)
+{
+    tassert_eqe(EOK, make_walk_tree());
+
+    u32 threads[] = { 1, 2, 4, 0 };
+    for (u32 i = 0; i < arr$len(threads); i++) {
+        walk_ctx_s ctx = { 0 };
+        tassert_eqe(
+            EOK,
+            os.walk.parallel(s$("tests/build/test_os_walk"), NULL, 0, 0, threads[i], walk_counter, &ctx, allocator)
+        );
+        tassert_eqi(ctx.nentries, 10);
+        tassert_eqi(ctx.nfiles_c, 4);
+
+        ctx = (walk_ctx_s){ 0 };
+        tassert_eqe(
+            EOK,
+            os.walk.parallel(s$("tests/build/test_os_walk"), "*.c", 2, OS_WALK_HIDDEN, threads[i], walk_counter, &ctx, allocator)
+        );
+        tassert_eqi(ctx.nentries, 4);
+    }
+
+    walk_ctx_s ctx = { 0 };
+    tassert_eqe(
+        EOK,
+        os.walk.parallel(s$("tests/build/test_os_walk/link"), NULL, 0, 0, 2, walk_counter, &ctx, allocator)
+    );
+    tassert_eqi(ctx.nentries, 6);
+    tassert_eqi(ctx.nfiles_c, 3);
+
+    ctx = (walk_ctx_s){ .fail_after = 2 };
+    tassert_eqe(
+        Error.integrity,
+        os.walk.parallel(s$("tests/build/test_os_walk"), NULL, 0, 0, 4, walk_counter, &ctx, allocator)
+    );
+    tassert_eqe(
+        Error.not_found,
+        os.walk.parallel(s$("tests/build/not_exists"), NULL, 0, 0, 4, walk_counter, &ctx, allocator)
+    );
+    return EOK;
+}
+
+test$case(test_os_dir)
+{
+    tassert_eqe(EOK, make_walk_tree());
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_os_walk/f1.c", "w", allocator));
+    tassert_eqe(EOK, io.fprintf(&file, "hello"));
+    io.close(&file);
+
+    os_dir_c dir;
+    // non null-terminated path
+    tassert_eqe(EOK, os.dir.read(&dir, str.sub(s$("tests/build/test_os_walk/f1.c"), 0, -5), allocator));
+    tassert_eqi(dir.len, 6);
+    u32 nfound = 0;
+    for (u32 i = 0; i < dir.len; i++) {
+        os_dirent_s* e = &dir.entries[i];
+        tassert_eqi(e->name.buf[e->name.len], '\0');
+        tassert(e->mtime > 0);
+        if (str.cmp(e->name, s$("f1.c")) == 0) {
+            tassert_eqi(e->type, OS_FTYPE_FILE);
+            tassert_eql(e->size, 5);
+            nfound++;
+        } else if (str.cmp(e->name, s$("a")) == 0) {
+            tassert_eqi(e->type, OS_FTYPE_DIR);
+            nfound++;
+        } else if (str.cmp(e->name, s$("link")) == 0) {
+            tassert_eqi(e->type, OS_FTYPE_LINK);
+            nfound++;
+        } else if (str.cmp(e->name, s$(".hidden.c")) == 0) {
+            tassert_eqi(e->type, OS_FTYPE_FILE);
+            tassert_eql(e->size, 0);
+            nfound++;
+        }
+    }
+    tassert_eqi(nfound, 4);
+    os.dir.destroy(&dir);
+    os.dir.destroy(&dir);
+
+    // symlinked directory is followed, like os.listdir()
+    tassert_eqe(EOK, os.dir.read(&dir, s$("tests/build/test_os_walk/link"), allocator));
+    tassert_eqi(dir.len, 3);
+    os.dir.destroy(&dir);
+
+    // entries and names arena are grown
+    if (mkdir("tests/build/test_os_dir", 0755) == -1) {
+        tassert_eqi(errno, EEXIST);
+    }
+    char path[64];
+    for (u32 i = 0; i < 300; i++) {
+        snprintf(path, sizeof(path), "tests/build/test_os_dir/file_with_long_name_%03d.txt", i);
+        int fd = open(path, O_CREAT | O_WRONLY, 0644);
+        tassert(fd != -1);
+        close(fd);
+    }
+    tassert_eqe(EOK, os.dir.read(&dir, s$("tests/build/test_os_dir"), allocator));
+    tassert_eqi(dir.len, 300);
+    u64 sum = 0;
+    for (u32 i = 0; i < dir.len; i++) {
+        u32 n;
+        tassert_eqe(EOK, str.to_u32(str.sub(dir.entries[i].name, 20, 23), &n));
+        sum += n;
+    }
+    tassert_eql(sum, 300 * 299 / 2);
+    os.dir.destroy(&dir);
+
+    tassert_eqe(Error.not_found, os.dir.read(&dir, s$("tests/build/not_exists"), allocator));
+    tassert_eqe(Error.argument, os.dir.read(&dir, s$("tests/build/test_os_walk/f1.c"), allocator));
+    tassert_eqe(Error.argument, os.dir.read(&dir, s$(""), allocator));
+    tassert_eqi(dir.len, 0);
+    return EOK;
+}
+
+static Exception
+write_file(const char* path, const char* content)
+{
+    io_c file;
+    e$ret(io.fopen(&file, path, "w", allocator));
+    Exc result = io.fprintf(&file, "%s", content);
+    io.close(&file);
+    return result;
+}
+
+typedef struct
+{
+    u32 nevents;
+    u32 events[8];
+    char paths[8][128];
+} watch_ctx_s;
+
+static Exception
+watch_collect(os_watch_event_s* e, void* ctx)
+{
+    watch_ctx_s* c = ctx;
+    e$assert(c->nevents < arr$len(c->events));
+    e$assert(e->path.buf[e->path.len] == '\0');
+    c->events[c->nevents] = e->events;
+    snprintf(c->paths[c->nevents], sizeof(c->paths[0]), "%s", e->path.buf);
+    c->nevents++;
+    return EOK;
+}
+
+// Returns events of path in ctx, or 0 if not found
+static u32
+watch_events(watch_ctx_s* c, const char* path)
+{
+    for (u32 i = 0; i < c->nevents; i++) {
+        if (strcmp(c->paths[i], path) == 0) {
+            return c->events[i];
+        }
+    }
+    return 0;
+}
+
+test$case(test_os_watch_file)
+{
+    if (mkdir("tests/build/test_os_watch", 0755) == -1) {
+        tassert_eqi(errno, EEXIST);
+    }
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/cfg.txt", "v1"));
+
+    os_watch_c w;
+    os_watch_event_s* e;
+    tassert_eqe(EOK, os.watch.create(&w, 20, allocator));
+    tassert_eqe(EOK, os.watch.add(&w, s$("tests/build/test_os_watch/cfg.txt"), false));
+    tassert_eqe(EOK, os.watch.add(&w, s$("tests/build/test_os_watch/cfg.txt"), false));
+    tassert_eqe(Error.empty, os.watch.next(&w, 0, &e));
+
+    // multiple writes are reported once
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/cfg.txt", "v2"));
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/cfg.txt", "v3"));
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(0, str.cmp(e->path, s$("tests/build/test_os_watch/cfg.txt")));
+    tassert_eqi(e->events, OS_WATCH_MODIFY);
+    tassert_eqi(e->is_dir, false);
+    tassert_eqe(Error.empty, os.watch.next(&w, 100, &e));
+
+    // other files of directory are not reported
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/other.txt", "x"));
+    tassert_eqe(Error.empty, os.watch.next(&w, 100, &e));
+
+    // atomic save via rename is tracked
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/cfg.txt.tmp", "v4"));
+    tassert(rename("tests/build/test_os_watch/cfg.txt.tmp", "tests/build/test_os_watch/cfg.txt") == 0);
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(0, str.cmp(e->path, s$("tests/build/test_os_watch/cfg.txt")));
+    tassert_eqi(e->events, OS_WATCH_CREATE);
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/cfg.txt", "v5"));
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(e->events, OS_WATCH_MODIFY);
+
+    // deleted and created again is modified
+    tassert(unlink("tests/build/test_os_watch/cfg.txt") == 0);
+    tassert_eqe(EOK, write_file("tests/build/test_os_watch/cfg.txt", "v6"));
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(e->events, OS_WATCH_MODIFY);
+
+    tassert(unlink("tests/build/test_os_watch/cfg.txt") == 0);
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(e->events, OS_WATCH_DELETE);
+
+    tassert_eqe(Error.not_found, os.watch.add(&w, s$("tests/build/test_os_watch/cfg.txt"), false));
+    tassert_eqe(Error.argument, os.watch.add(&w, s$(""), false));
+    os.watch.destroy(&w);
+    os.watch.destroy(&w);
+    return EOK;
+}
+
+test$case(test_os_watch_tree)
+{
+    tassert_eqe(EOK, make_walk_tree());
+
+    os_watch_c w;
+    os_watch_event_s* e;
+    tassert_eqe(EOK, os.watch.create(&w, 20, allocator));
+    tassert_eqe(EOK, os.watch.add(&w, s$("tests/build/test_os_walk/"), true));
+
+    // changes in subdirectories
+    watch_ctx_s ctx = { 0 };
+    tassert_eqe(EOK, write_file("tests/build/test_os_walk/a/b/c/c1.c", "x"));
+    tassert_eqe(EOK, write_file("tests/build/test_os_walk/f1.c", "x"));
+    tassert_eqe(EOK, os.watch.poll(&w, 1000, watch_collect, &ctx));
+    tassert_eqi(ctx.nevents, 2);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/a/b/c/c1.c"), OS_WATCH_MODIFY);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/f1.c"), OS_WATCH_MODIFY);
+
+    // temporary file is not reported
+    tassert_eqe(EOK, write_file("tests/build/test_os_walk/a/tmp.txt", "x"));
+    tassert(unlink("tests/build/test_os_walk/a/tmp.txt") == 0);
+    tassert_eqe(Error.empty, os.watch.next(&w, 100, &e));
+
+    // hidden subdirectories are not watched
+    tassert_eqe(EOK, write_file("tests/build/test_os_walk/.git/g1.c", "x"));
+    tassert_eqe(Error.empty, os.watch.next(&w, 100, &e));
+
+    // new directories are watched, and their entries created before watch are reported
+    rmdir("tests/build/test_os_walk/new/deep");
+    rmdir("tests/build/test_os_walk/new");
+    tassert(mkdir("tests/build/test_os_walk/new", 0755) == 0);
+    tassert(mkdir("tests/build/test_os_walk/new/deep", 0755) == 0);
+    ctx = (watch_ctx_s){ 0 };
+    tassert_eqe(EOK, os.watch.poll(&w, 1000, watch_collect, &ctx));
+    tassert_eqi(ctx.nevents, 2);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/new"), OS_WATCH_CREATE);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/new/deep"), OS_WATCH_CREATE);
+    tassert_eqi(ctx.events[0] | ctx.events[1], OS_WATCH_CREATE);
+
+    tassert_eqe(EOK, write_file("tests/build/test_os_walk/new/deep/d.txt", "x"));
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(0, str.cmp(e->path, s$("tests/build/test_os_walk/new/deep/d.txt")));
+    tassert_eqi(e->events, OS_WATCH_CREATE);
+
+    // deleted directories
+    tassert(unlink("tests/build/test_os_walk/new/deep/d.txt") == 0);
+    tassert(rmdir("tests/build/test_os_walk/new/deep") == 0);
+    tassert(rmdir("tests/build/test_os_walk/new") == 0);
+    ctx = (watch_ctx_s){ 0 };
+    tassert_eqe(EOK, os.watch.poll(&w, 1000, watch_collect, &ctx));
+    tassert_eqi(ctx.nevents, 3);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/new"), OS_WATCH_DELETE);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/new/deep"), OS_WATCH_DELETE);
+    tassert_eqi(watch_events(&ctx, "tests/build/test_os_walk/new/deep/d.txt"), OS_WATCH_DELETE);
+    tassert_eqi(w._ndirs, 4);
+    os.watch.destroy(&w);
+
+    // symlinked directory is followed, events are reported by the added path
+    tassert_eqe(EOK, os.watch.create(&w, 20, allocator));
+    tassert_eqe(EOK, os.watch.add(&w, s$("tests/build/test_os_walk/link"), true));
+    tassert_eqe(EOK, write_file("tests/build/test_os_walk/a/b/b1.c", "x"));
+    tassert_eqe(EOK, os.watch.next(&w, 1000, &e));
+    tassert_eqi(0, str.cmp(e->path, s$("tests/build/test_os_walk/link/b/b1.c")));
+    tassert_eqi(e->events, OS_WATCH_MODIFY);
+    os.watch.destroy(&w);
+    return EOK;
+}
+
+typedef struct
+{
+    u32 ncreate;
+    u32 nother;
+} watch_count_s;
+
+static Exception
+watch_count(os_watch_event_s* e, void* ctx)
+{
+    watch_count_s* c = ctx;
+    if (e->events == OS_WATCH_CREATE) {
+        c->ncreate++;
+    } else {
+        c->nother++;
+    }
+    return EOK;
+}
+
+test$case(test_os_watch_burst)
+{
+    if (mkdir("tests/build/test_os_watch_burst", 0755) == -1) {
+        tassert_eqi(errno, EEXIST);
+    }
+    enum { NFILES = 3000 };
+    char path[64];
+    for (u32 i = 0; i < NFILES; i++) {
+        snprintf(path, sizeof(path), "tests/build/test_os_watch_burst/f%04u.txt", i);
+        unlink(path);
+    }
+
+    os_watch_c w;
+    tassert_eqe(EOK, os.watch.create(&w, 50, allocator));
+    tassert_eqe(EOK, os.watch.add(&w, s$("tests/build/test_os_watch_burst"), false));
+
+    // every file is created and modified twice, paths arena is reallocated many times
+    for (u32 k = 0; k < 2; k++) {
+        for (u32 i = 0; i < NFILES; i++) {
+            snprintf(path, sizeof(path), "tests/build/test_os_watch_burst/f%04u.txt", i);
+            tassert_eqe(EOK, write_file(path, "x"));
+        }
+    }
+    watch_count_s ctx = { 0 };
+    Exc err;
+    while ((err = os.watch.poll(&w, 200, watch_count, &ctx)) == EOK) {
+    }
+    tassert_eqe(Error.empty, err);
+    tassert_eqi(ctx.ncreate, NFILES);
+    // modify events are coalesced with creation, unless the burst was split by max delay
+    tassert(ctx.nother < NFILES);
+
+    os.watch.destroy(&w);
+    return EOK;
+}
+
+test$case(test_os_proc_run)
+{
+    sbuf_c out, err;
+    tassert_eqe(EOK, sbuf.create(&out, 64, allocator));
+    tassert_eqe(EOK, sbuf.create(&err, 64, allocator));
+    int code = -1;
+
+    tassert_eqe(EOK, os.proc.run((const char*[]){ "echo", "hello", NULL }, &(os_proc_opt_s){ .out = &out }, &code));
+    tassert_eqi(code, 0);
+    tassert_eqs(out, "hello\n");
+
+    sbuf.clear(&out);
+    os_proc_opt_s opt = { .out = &out, .err = &err };
+    tassert_eqe(
+        EOK,
+        os.proc.run((const char*[]){ "sh", "-c", "echo out; echo err >&2; exit 3", NULL }, &opt, &code)
+    );
+    tassert_eqi(code, 3);
+    tassert_eqs(out, "out\n");
+    tassert_eqs(err, "err\n");
+
+    // both pipes are drained concurrently (no deadlock on full pipe)
+    sbuf.clear(&out);
+    sbuf.clear(&err);
+    tassert_eqe(
+        EOK,
+        os.proc.run(
+            (const char*[]){ "sh", "-c", "head -c 300000 /dev/zero >&2; head -c 1000000 /dev/zero", NULL },
+            &opt,
+            &code
+        )
+    );
+    tassert_eqi(code, 0);
+    tassert_eqi(sbuf.len(&out), 1000000);
+    tassert_eqi(sbuf.len(&err), 300000);
+
+    // environment, stdin is /dev/null
+    sbuf.clear(&out);
+    opt = (os_proc_opt_s){ .out = &out, .env = (const char*[]){ "FOO=bar", NULL } };
+    tassert_eqe(EOK, os.proc.run((const char*[]){ "sh", "-c", "echo $FOO; cat", NULL }, &opt, &code));
+    tassert_eqs(out, "bar\n");
+
+    // killed by signal
+    tassert_eqe(EOK, os.proc.run((const char*[]){ "sh", "-c", "kill -TERM $$", NULL }, NULL, &code));
+    tassert_eqi(code, 128 + SIGTERM);
+
+    // streaming to io_c
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_os_proc.txt", "w", allocator));
+    os_proc_c proc;
+    tassert_eqe(EOK, os.proc.spawn(&proc, (const char*[]){ "seq", "1", "10000", NULL }, &(os_proc_opt_s){ .out_io = &file }));
+    tassert(proc.pid > 0);
+    tassert_eqe(EOK, os.proc.wait(&proc));
+    tassert_eqe(EOK, os.proc.wait(&proc));
+    tassert_eqi(proc.exit_code, 0);
+    io.close(&file);
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_os_proc.txt", "r", allocator));
+    str_c content;
+    tassert_eqe(EOK, io.readall(&file, &content));
+    tassert_eqi(content.len, 48894);
+    tassert_eqi(0, str.cmp(str.sub(content, -6, 0), s$("10000\n")));
+    io.close(&file);
+
+    // exit code is set when process is not started
+    code = 0;
+    tassert_eqe(Error.not_found, os.proc.run((const char*[]){ "test_os_proc_not_exists", NULL }, NULL, &code));
+    tassert_eqi(code, -1);
+    code = 0;
+    tassert_eqe(Error.argument, os.proc.run((const char*[]){ NULL }, NULL, &code));
+    tassert_eqi(code, -1);
+
+    // pipe ends are not inherited by the child (only its stdin / stdout / stderr are open)
+    sbuf.clear(&out);
+    opt = (os_proc_opt_s){ .out = &out, .err = &err };
+    tassert_eqe(EOK, os.proc.run((const char*[]){ "ls", "/proc/self/fd", NULL }, &opt, &code));
+    tassert_eqs(out, "0\n1\n2\n3\n"); // 3 - directory fd of ls itself
+
+    sbuf.destroy(&out);
+    sbuf.destroy(&err);
+    return EOK;
+}
+
+static u64
+test_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+test$case(test_os_proc_timeout)
+{
+    sbuf_c out;
+    tassert_eqe(EOK, sbuf.create(&out, 64, allocator));
+    int code = -1;
+
+    u64 start = test_now_ms();
+    os_proc_opt_s opt = { .timeout_ms = 100 };
+    tassert_eqe(Error.timeout, os.proc.run((const char*[]){ "sleep", "5", NULL }, &opt, &code));
+    tassert_eqi(code, 128 + SIGKILL);
+
+    // grandchild keeps output pipe open
+    opt = (os_proc_opt_s){ .out = &out, .timeout_ms = 100 };
+    tassert_eqe(Error.timeout, os.proc.run((const char*[]){ "sh", "-c", "echo started; sleep 5; echo done", NULL }, &opt, &code));
+    tassert_eqs(out, "started\n");
+    tassert(test_now_ms() - start < 2000);
+
+    // finished in time
+    tassert_eqe(EOK, os.proc.run((const char*[]){ "true", NULL }, &opt, &code));
+    tassert_eqi(code, 0);
+
+    // deadline beyond INT_MAX ms of poll() timeout
+    opt = (os_proc_opt_s){ .timeout_ms = 3000000000u };
+    start = test_now_ms();
+    tassert_eqe(EOK, os.proc.run((const char*[]){ "true", NULL }, &opt, &code));
+    tassert_eqi(code, 0);
+    tassert(test_now_ms() - start < 2000);
+
+    sbuf.destroy(&out);
+    return EOK;
+}
+
+test$case(test_os_proc_run_all)
+{
+    os_proc_cmd_s cmds[20];
+    sbuf_c outs[arr$len(cmds)];
+    char* args[arr$len(cmds)][4];
+    char scripts[arr$len(cmds)][32];
+    for (u32 i = 0; i < arr$len(cmds); i++) {
+        tassert_eqe(EOK, sbuf.create(&outs[i], 64, allocator));
+        snprintf(scripts[i], sizeof(scripts[i]), "echo %d; exit %d", i, i % 3);
+        args[i][0] = "sh";
+        args[i][1] = "-c";
+        args[i][2] = scripts[i];
+        args[i][3] = NULL;
+    }
+
+    u32 parallel[] = { 1, 4, 0, 100 };
+    for (u32 p = 0; p < arr$len(parallel); p++) {
+        for (u32 i = 0; i < arr$len(cmds); i++) {
+            sbuf.clear(&outs[i]);
+            cmds[i] = (os_proc_cmd_s){ .argv = (const char* const*)args[i], .opt = { .out = &outs[i] } };
+        }
+        tassert_eqe(EOK, os.proc.run_all(cmds, arr$len(cmds), parallel[p]));
+        for (u32 i = 0; i < arr$len(cmds); i++) {
+            u32 n;
+            tassert_eqe(EOK, str.to_u32(str.sub(sbuf.to_str(&outs[i]), 0, -1), &n));
+            tassert_eqi(n, i);
+            tassert_eqi(cmds[i].exit_code, i % 3);
+            tassert_eqe(EOK, cmds[i].error);
+        }
+    }
+
+    // commands run concurrently
+    const char* sleep_args[] = { "sleep", "0.3", NULL };
+    u64 start = test_now_ms();
+    for (u32 i = 0; i < 8; i++) {
+        cmds[i] = (os_proc_cmd_s){ .argv = sleep_args };
+    }
+    tassert_eqe(EOK, os.proc.run_all(cmds, 8, 8));
+    tassert(test_now_ms() - start < 1500);
+
+    // errors don't stop other commands
+    cmds[0] = (os_proc_cmd_s){ .argv = (const char*[]){ "true", NULL } };
+    cmds[1] = (os_proc_cmd_s){ .argv = (const char*[]){ "test_os_proc_not_exists", NULL } };
+    cmds[2] = (os_proc_cmd_s){ .argv = (const char*[]){ "sleep", "5", NULL }, .opt = { .timeout_ms = 50 } };
+    cmds[3] = (os_proc_cmd_s){ .argv = (const char* const*)args[1], .opt = { .out = &outs[0] } };
+    sbuf.clear(&outs[0]);
+    tassert_eqe(Error.not_found, os.proc.run_all(cmds, 4, 2));
+    tassert_eqe(EOK, cmds[0].error);
+    tassert_eqe(Error.not_found, cmds[1].error);
+    tassert_eqe(Error.timeout, cmds[2].error);
+    tassert_eqe(EOK, cmds[3].error);
+    tassert_eqi(cmds[3].exit_code, 1);
+    tassert_eqs(outs[0], "1\n");
+
+    tassert_eqe(EOK, os.proc.run_all(NULL, 0, 0));
+    for (u32 i = 0; i < arr$len(cmds); i++) {
+        sbuf.destroy(&outs[i]);
+    }
+    return EOK;
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -202,6 +1022,20 @@ main(int argc, char* argv[])
     test$run(test_os_path_join);
     test$run(test_os_setenv);
     test$run(test_os_path_splitext);
+    test$run(test_os_path_split);
+    test$run(test_os_path_normalize);
+    test$run(test_os_path_relpath);
+    test$run(test_os_path_join_buf);
+    test$run(test_os_path_iter);
+    test$run(test_os_walk);
+    test$run(test_os_walk_parallel);
+    test$run(test_os_dir);
+    test$run(test_os_watch_file);
+    test$run(test_os_watch_tree);
+    test$run(test_os_watch_burst);
+    test$run(test_os_proc_run);
+    test$run(test_os_proc_timeout);
+    test$run(test_os_proc_run_all);
     
     test$print_footer();  // ^^^^^ all tests runs are above
     return test$exit_code();
@@ -0,0 +1,221 @@
+#include <cex.c>
+#include <cex/plines/plines.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+typedef struct
+{
+    str_c data;
+    u64 nlines[PLINES_MAX_WORKERS];
+    u64 sum[PLINES_MAX_WORKERS];
+    u32 nchunks;
+    size_t merged_len;
+    u64 total_lines;
+    u64 total_sum;
+    u32 fail_chunk; // worker of this chunk returns error (if > 0)
+} test_ctx_s;
+
+static Exception
+count_worker(plines_chunk_s* chunk)
+{
+    test_ctx_s* ctx = chunk->ctx;
+    if (ctx->fail_chunk > 0 && chunk->index == ctx->fail_chunk) {
+        return Error.integrity;
+    }
+    for$iter(str_c, it, plines.iter(chunk->data, &it.iterator))
+    {
+        // lines are "line <N>"
+        u64 n;
+        e$ret(str.to_u64(str.sub(*it.val, 5, 0), &n));
+        ctx->sum[chunk->index] += n;
+        ctx->nlines[chunk->index]++;
+    }
+    return EOK;
+}
+
+static Exception
+count_merge(plines_chunk_s* chunk)
+{
+    test_ctx_s* ctx = chunk->ctx;
+    // chunks are merged in order, and cover whole input
+    e$assert(chunk->index == ctx->nchunks);
+    e$assert(chunk->offset == ctx->merged_len);
+    e$assert(chunk->data.buf == ctx->data.buf + chunk->offset);
+    if (chunk->data.len > 0 && chunk->offset + chunk->data.len < ctx->data.len) {
+        e$assert(chunk->data.buf[chunk->data.len - 1] == '\n');
+    }
+    ctx->nchunks++;
+    ctx->merged_len += chunk->data.len;
+    ctx->total_lines += ctx->nlines[chunk->index];
+    ctx->total_sum += ctx->sum[chunk->index];
+    return EOK;
+}
+
+static Exception
+make_lines(sbuf_c* s, u32 nlines)
+{
+    for (u32 i = 0; i < nlines; i++) {
+        e$ret(sbuf.sprintf(s, (i % 7 == 0) ? "line %d\r\n" : "line %d\n", i));
+    }
+    return EOK;
+}
+
+test$case(test_plines_iter)
+{
+    const char* expected[] = { "a", "", "bc", "d" };
+    u32 n = 0;
+    for$iter(str_c, it, plines.iter(s$("a\n\r\nbc\r\nd"), &it.iterator))
+    {
+        tassert_eqi(it.idx.i, n);
+        tassert_eqi(0, str.cmp(*it.val, s$(expected[n])));
+        n++;
+    }
+    tassert_eqi(n, 4);
+
+    // trailing new line doesn't make empty line
+    n = 0;
+    for$iter(str_c, it, plines.iter(s$("a\nb\n"), &it.iterator))
+    {
+        n++;
+    }
+    tassert_eqi(n, 2);
+
+    for$iter(str_c, it, plines.iter(s$(""), &it.iterator))
+    {
+        tassert(false && "empty");
+    }
+    for$iter(str_c, it, plines.iter(str.cstr(NULL), &it.iterator))
+    {
+        tassert(false && "null");
+    }
+    return EOK;
+}
+
+test$case(test_plines_process)
+{
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 1024, allocator));
+    const u32 nlines = 300000;
+    tassert_eqe(EOK, make_lines(&s, nlines));
+    tassert(sbuf.len(&s) > PLINES_MIN_CHUNK * 4);
+
+    u32 workers[] = { 1, 3, 4, 0, 1000 };
+    for (u32 w = 0; w < arr$len(workers); w++) {
+        test_ctx_s ctx = { .data = str.cbuf(s, sbuf.len(&s)) };
+        tassert_eqe(EOK, plines.process(ctx.data, workers[w], count_worker, count_merge, &ctx));
+        tassert_eqi(ctx.merged_len, sbuf.len(&s));
+        tassert_eql(ctx.total_lines, nlines);
+        tassert_eql(ctx.total_sum, (u64)nlines * (nlines - 1) / 2);
+        if (workers[w] == 3 || workers[w] == 4) {
+            tassert_eqi(ctx.nchunks, workers[w]);
+        }
+    }
+
+    // small inputs are not split
+    test_ctx_s ctx = { .data = s$("line 1\nline 2\nline 3") };
+    tassert_eqe(EOK, plines.process(ctx.data, 8, count_worker, count_merge, &ctx));
+    tassert_eqi(ctx.nchunks, 1);
+    tassert_eql(ctx.total_sum, 6);
+
+    // single long line takes all the input, other chunks are empty
+    sbuf.clear(&s);
+    tassert_eqe(EOK, sbuf.append(&s, s$("line ")));
+    for (u32 i = 0; i < PLINES_MIN_CHUNK * 2; i++) {
+        tassert_eqe(EOK, sbuf.append(&s, s$("0")));
+    }
+    tassert_eqe(EOK, sbuf.append(&s, s$("7\nline 1\n")));
+    ctx = (test_ctx_s){ .data = str.cbuf(s, sbuf.len(&s)) };
+    tassert_eqe(EOK, plines.process(ctx.data, 4, count_worker, count_merge, &ctx));
+    tassert_eqi(ctx.nchunks, 3);
+    tassert_eql(ctx.total_lines, 2);
+    tassert_eql(ctx.total_sum, 8);
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_plines_errors)
+{
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 1024, allocator));
+    tassert_eqe(EOK, make_lines(&s, 300000));
+
+    // worker error is returned after all workers are joined, merge is not called
+    test_ctx_s ctx = { .data = str.cbuf(s, sbuf.len(&s)), .fail_chunk = 2 };
+    tassert_eqe(Error.integrity, plines.process(ctx.data, 4, count_worker, count_merge, &ctx));
+    tassert_eqi(ctx.nchunks, 0);
+
+    // bad line
+    tassert_eqe(EOK, sbuf.append(&s, s$("line x\n")));
+    ctx = (test_ctx_s){ .data = str.cbuf(s, sbuf.len(&s)) };
+    tassert_eqe(Error.argument, plines.process(ctx.data, 4, count_worker, NULL, &ctx));
+
+    tassert_eqe(Error.argument, plines.process(str.cstr(NULL), 4, count_worker, NULL, &ctx));
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+test$case(test_plines_process_file)
+{
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 1024, allocator));
+    const u32 nlines = 200000;
+    tassert_eqe(EOK, make_lines(&s, nlines));
+
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_plines.txt", "w", allocator));
+    tassert_eqe(EOK, io.write(&file, s, 1, sbuf.len(&s)));
+    io.close(&file);
+
+    test_ctx_s ctx = { 0 };
+    // mmap-ed data is not visible here, so only line counts are checked
+    tassert_eqe(EOK, plines.process_file("tests/build/test_plines.txt", 4, count_worker, NULL, &ctx));
+    u64 total = 0;
+    for (u32 i = 0; i < PLINES_MAX_WORKERS; i++) {
+        total += ctx.nlines[i];
+    }
+    tassert_eql(total, nlines);
+
+    // empty file
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_plines.txt", "w", allocator));
+    io.close(&file);
+    ctx = (test_ctx_s){ .data = s$("") };
+    tassert_eqe(EOK, plines.process_file("tests/build/test_plines.txt", 4, count_worker, count_merge, &ctx));
+    tassert_eqi(ctx.nchunks, 1);
+    tassert_eql(ctx.total_lines, 0);
+
+    tassert_eqe(Error.not_found, plines.process_file("tests/build/not_exists.txt", 4, count_worker, NULL, &ctx));
+    tassert_eqe(Error.argument, plines.process_file("tests/build", 4, count_worker, NULL, &ctx));
+
+    sbuf.destroy(&s);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_plines_iter);
+    test$run(test_plines_process);
+    test$run(test_plines_errors);
+    test$run(test_plines_process_file);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -0,0 +1,170 @@
+#include <cex.c>
+#include <cex/rope/rope.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+test$case(test_rope_create_destroy)
+{
+    rope_c r;
+    tassert_eqe(EOK, rope.create(&r, 0, allocator));
+    tassert_eqi(rope.len(&r), 0);
+    tassert(r._chunk_size == ROPE_CHUNK_SIZE);
+    tassert(r._head == NULL);
+
+    rope.destroy(&r);
+    tassert(r._allocator == NULL);
+
+    // double destroy is allowed
+    rope.destroy(&r);
+
+    uassert_disable();
+    tassert_eqe(Error.argument, rope.create(&r, 0, NULL));
+    tassert_eqe(Error.argument, rope.create(NULL, 0, allocator));
+    return EOK;
+}
+
+test$case(test_rope_append)
+{
+    rope_c r;
+    tassert_eqe(EOK, rope.create(&r, 16, allocator));
+
+    tassert_eqe(Error.argument, rope.append(&r, str.cstr(NULL)));
+    tassert_eqe(EOK, rope.append(&r, s$("")));
+    tassert_eqi(rope.len(&r), 0);
+
+    tassert_eqe(EOK, rope.append(&r, s$("0123456789")));
+    tassert_eqi(r._nchunks, 1);
+    tassert_eqe(EOK, rope.append(&r, s$("abcdefghijklmnopqrstuvwxyz")));
+    tassert_eqi(rope.len(&r), 36);
+    tassert_eqi(r._nchunks, 3);
+
+    // chunks are filled up to capacity
+    tassert_eqi(r._head->len, 16);
+    tassert_eqi(r._head->next->len, 16);
+    tassert_eqi(r._tail->len, 4);
+
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 16, allocator));
+    tassert_eqe(EOK, sbuf.append(&s, s$(">")));
+    tassert_eqe(EOK, rope.to_sbuf(&r, &s));
+    tassert_eqs(s, ">0123456789abcdefghijklmnopqrstuvwxyz");
+    tassert_eqi(sbuf.len(&s), 37);
+
+    rope.clear(&r);
+    tassert_eqi(rope.len(&r), 0);
+    tassert_eqi(r._nchunks, 1);
+    tassert_eqe(EOK, rope.append(&r, s$("xyz")));
+
+    sbuf.clear(&s);
+    tassert_eqe(EOK, rope.to_sbuf(&r, &s));
+    tassert_eqs(s, "xyz");
+
+    sbuf.destroy(&s);
+    rope.destroy(&r);
+    return EOK;
+}
+
+test$case(test_rope_sprintf)
+{
+    rope_c r;
+    tassert_eqe(EOK, rope.create(&r, 32, allocator));
+
+    tassert_eqe(EOK, rope.sprintf(&r, "%s-%d", "foo", 1));
+    tassert_eqe(EOK, rope.sprintf(&r, "%s", ""));
+    tassert_eqi(rope.len(&r), 5);
+    tassert_eqi(r._nchunks, 1);
+
+    // doesn't fit into the rest of the chunk
+    tassert_eqe(EOK, rope.sprintf(&r, "%030d", 7));
+    tassert_eqi(rope.len(&r), 35);
+    tassert_eqi(r._nchunks, 2);
+
+    // bigger than chunk
+    char big[100];
+    memset(big, 'z', sizeof(big));
+    tassert_eqe(EOK, rope.sprintf(&r, "[%S]", str.cbuf(big, sizeof(big))));
+    tassert_eqi(rope.len(&r), 137);
+    tassert_eqi(r._nchunks, 5);
+    tassert_eqi(r._tail->len, 9);
+
+    // fills exactly to the capacity
+    rope.destroy(&r);
+    tassert_eqe(EOK, rope.create(&r, 4, allocator));
+    tassert_eqe(EOK, rope.sprintf(&r, "%d", 1234));
+    tassert_eqe(EOK, rope.sprintf(&r, "%d", 5678));
+    tassert_eqi(r._nchunks, 2);
+
+    sbuf_c s;
+    tassert_eqe(EOK, sbuf.create(&s, 16, allocator));
+    tassert_eqe(EOK, rope.to_sbuf(&r, &s));
+    tassert_eqs(s, "12345678");
+
+    sbuf.destroy(&s);
+    rope.destroy(&r);
+    return EOK;
+}
+
+test$case(test_rope_write)
+{
+    rope_c r;
+    tassert_eqe(EOK, rope.create(&r, 64, allocator));
+
+    sbuf_c expected;
+    tassert_eqe(EOK, sbuf.create(&expected, 1024, allocator));
+    tassert_eqe(EOK, sbuf.append(&expected, s$("header\n")));
+
+    // more chunks than one writev() batch
+    for (u32 i = 0; i < 2000; i++) {
+        tassert_eqe(EOK, rope.sprintf(&r, "line %05d: %s\n", i, "some text to fill the chunks"));
+        tassert_eqe(EOK, sbuf.sprintf(&expected, "line %05d: %s\n", i, "some text to fill the chunks"));
+    }
+    tassert(r._nchunks > 1024);
+    tassert_eqe(EOK, sbuf.append(&expected, s$("footer\n")));
+
+    io_c file;
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_rope_write.txt", "w+", allocator));
+    // stdio buffered data goes before rope data
+    tassert_eqe(EOK, io.fprintf(&file, "header\n"));
+    tassert_eqe(EOK, rope.write(&r, &file));
+    tassert_eqe(EOK, io.fprintf(&file, "footer\n"));
+    io.close(&file);
+
+    tassert_eqe(EOK, io.fopen(&file, "tests/build/test_rope_write.txt", "r", allocator));
+    str_c content;
+    tassert_eqe(EOK, io.readall(&file, &content));
+    tassert_eqi(content.len, sbuf.len(&expected));
+    tassert(memcmp(content.buf, expected, content.len) == 0);
+    io.close(&file);
+
+    sbuf.destroy(&expected);
+    rope.destroy(&r);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_rope_create_destroy);
+    test$run(test_rope_append);
+    test$run(test_rope_sprintf);
+    test$run(test_rope_write);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}
@@ -0,0 +1,216 @@
+#include <cex.c>
+#include <cex/strintern/strintern.c>
+
+const Allocator_i* allocator;
+
+test$teardown()
+{
+    allocator = allocators.heap.destroy(); // this also nullifies allocator
+    return EOK;
+}
+
+test$setup()
+{
+    uassert_enable(); // re-enable if you disabled it in some test case
+    allocator = allocators.heap.create();
+    return EOK;
+}
+
+test$case(test_strintern_create_destroy)
+{
+    strintern_c pool;
+    tassert_eqe(EOK, strintern.create(&pool, 0, allocator));
+    tassert_eqi(strintern.len(&pool), 0);
+    tassert(pool._chunk_size == STRINTERN_CHUNK_SIZE);
+    tassert(strintern.get(&pool, 0).buf == NULL);
+    tassert(strintern.get(&pool, 1).buf == NULL);
+    strintern.destroy(&pool);
+    tassert(pool._allocator == NULL);
+
+    // double destroy is allowed
+    strintern.destroy(&pool);
+    return EOK;
+}
+
+test$case(test_strintern_intern)
+{
+    strintern_c pool;
+    tassert_eqe(EOK, strintern.create(&pool, 0, allocator));
+
+    char buf[] = "foo,bar,foo";
+    str_c foo1 = str.sub(s$(buf), 0, 3);
+    str_c foo2 = str.sub(s$(buf), 8, 0);
+    tassert(foo1.buf != foo2.buf);
+
+    str_c i1 = strintern.intern(&pool, foo1);
+    str_c i2 = strintern.intern(&pool, foo2);
+    tassert(i1.buf != NULL);
+    tassert(i1.buf == i2.buf);
+    tassert(i1.buf != foo1.buf);
+    tassert_eqi(i1.len, 3);
+    tassert_eqs(i1.buf, "foo"); // null terminated copy
+    tassert_eqi(strintern.len(&pool), 1);
+
+    str_c bar = strintern.intern(&pool, str.sub(s$(buf), 4, 7));
+    tassert_eqs(bar.buf, "bar");
+    tassert(bar.buf != i1.buf);
+    tassert_eqi(strintern.len(&pool), 2);
+
+    // source buffer can be changed, interned strings are copies
+    memset(buf, 'x', sizeof(buf) - 1);
+    tassert_eqs(i1.buf, "foo");
+    tassert_eqs(bar.buf, "bar");
+
+    str_c empty = strintern.intern(&pool, s$(""));
+    tassert(empty.buf != NULL);
+    tassert_eqi(empty.len, 0);
+    tassert(strintern.intern(&pool, s$("")).buf == empty.buf);
+    tassert_eqi(strintern.len(&pool), 3);
+
+    // invalid strings
+    tassert(strintern.intern(&pool, str.cstr(NULL)).buf == NULL);
+    tassert_eqe(Error.argument, strintern.add(&pool, str.cstr(NULL), NULL));
+    tassert_eqi(strintern.len(&pool), 3);
+
+    strintern.destroy(&pool);
+    return EOK;
+}
+
+test$case(test_strintern_ids)
+{
+    strintern_c pool;
+    tassert_eqe(EOK, strintern.create(&pool, 0, allocator));
+
+    u32 id_foo = 0;
+    u32 id_bar = 0;
+    u32 id = 0;
+    tassert_eqe(EOK, strintern.add(&pool, s$("foo"), &id_foo));
+    tassert_eqe(EOK, strintern.add(&pool, s$("bar"), &id_bar));
+    tassert_eqi(id_foo, 1);
+    tassert_eqi(id_bar, 2);
+    tassert_eqe(EOK, strintern.add(&pool, s$("foo"), &id));
+    tassert_eqi(id, id_foo);
+    tassert_eqe(EOK, strintern.add(&pool, s$("bar"), NULL));
+
+    tassert_eqi(strintern.find(&pool, s$("foo")), id_foo);
+    tassert_eqi(strintern.find(&pool, s$("bar")), id_bar);
+    tassert_eqi(strintern.find(&pool, s$("baz")), 0);
+    tassert_eqi(strintern.find(&pool, str.cstr(NULL)), 0);
+    tassert_eqi(strintern.len(&pool), 2); // find() does not intern
+
+    tassert_eqs(strintern.get(&pool, id_foo).buf, "foo");
+    tassert_eqs(strintern.get(&pool, id_bar).buf, "bar");
+    tassert(strintern.get(&pool, id_foo).buf == strintern.intern(&pool, s$("foo")).buf);
+    tassert(strintern.get(&pool, 3).buf == NULL);
+
+    strintern.destroy(&pool);
+    return EOK;
+}
+
+test$case(test_strintern_many_chunks)
+{
+    strintern_c pool;
+    // tiny chunks make arena allocate new chunk frequently
+    tassert_eqe(EOK, strintern.create(&pool, 16, allocator));
+
+    char buf[64];
+    str_c interned[1000];
+    for (u32 i = 0; i < arr$len(interned); i++) {
+        int len = snprintf(buf, sizeof(buf), "item_%u", i);
+        interned[i] = strintern.intern(&pool, str.cbuf(buf, len));
+        tassert(interned[i].buf != NULL);
+    }
+    tassert_eqi(strintern.len(&pool), arr$len(interned));
+
+    // oversized string goes into dedicated chunk
+    char big[100];
+    memset(big, 'z', sizeof(big));
+    str_c ibig = strintern.intern(&pool, str.cbuf(big, sizeof(big)));
+    tassert_eqi(ibig.len, sizeof(big));
+    tassert_eqi(ibig.buf[sizeof(big)], '\0');
+
+    for (u32 i = 0; i < arr$len(interned); i++) {
+        snprintf(buf, sizeof(buf), "item_%u", i);
+        tassert_eqs(interned[i].buf, buf);
+        tassert(strintern.intern(&pool, s$(buf)).buf == interned[i].buf);
+        tassert_eqi(strintern.find(&pool, s$(buf)), i + 1);
+        tassert(strintern.get(&pool, i + 1).buf == interned[i].buf);
+    }
+    tassert(strintern.intern(&pool, str.cbuf(big, sizeof(big))).buf == ibig.buf);
+    tassert_eqi(strintern.len(&pool), arr$len(interned) + 1);
+
+    strintern.destroy(&pool);
+    return EOK;
+}
+
+static bool fail_alloc = false;
+
+static void*
+failing_malloc(size_t size)
+{
+    return fail_alloc ? NULL : allocator->malloc(size);
+}
+
+static void*
+failing_realloc(void* ptr, size_t new_size)
+{
+    return fail_alloc ? NULL : allocator->realloc(ptr, new_size);
+}
+
+test$case(test_strintern_add_failure)
+{
+    Allocator_i failing = *allocator;
+    failing.malloc = failing_malloc;
+    failing.realloc = failing_realloc;
+
+    strintern_c pool;
+    // big chunk, so only index (or ids list) growth needs memory
+    tassert_eqe(EOK, strintern.create(&pool, 1024 * 1024, &failing));
+    tassert_eqe(EOK, strintern.add(&pool, s$("first"), NULL));
+
+    fail_alloc = true;
+    char buf[32];
+    Exc err = EOK;
+    u32 nadded = 1;
+    for (u32 i = 0; i < 1000 && err == EOK; i++) {
+        str.sprintf(buf, sizeof(buf), "str_%u", i);
+        u32 id = 0;
+        err = strintern.add(&pool, str.cstr(buf), &id);
+        if (err == EOK) {
+            nadded++;
+            tassert_eqi(id, nadded);
+        }
+    }
+    fail_alloc = false;
+    tassert_eqe(Error.memory, err);
+
+    // failed string is not interned, ids and index are in sync
+    tassert_eqi(strintern.len(&pool), nadded);
+    tassert_eqi(dict.len(&pool._index), nadded);
+    tassert_eqi(strintern.find(&pool, str.cstr(buf)), 0);
+
+    u32 id = 0;
+    tassert_eqe(EOK, strintern.add(&pool, str.cstr(buf), &id));
+    tassert_eqi(id, nadded + 1);
+    tassert_eqi(0, str.cmp(strintern.get(&pool, id), str.cstr(buf)));
+    tassert_eqi(strintern.find(&pool, str.cstr(buf)), id);
+
+    strintern.destroy(&pool);
+    return EOK;
+}
+
+int
+main(int argc, char* argv[])
+{
+    test$args_parse(argc, argv);
+    test$print_header();  // >>> all tests below
+    
+    test$run(test_strintern_create_destroy);
+    test$run(test_strintern_intern);
+    test$run(test_strintern_ids);
+    test$run(test_strintern_many_chunks);
+    test$run(test_strintern_add_failure);
+    
+    test$print_footer();  // ^^^^^ all tests runs are above
+    return test$exit_code();
+}